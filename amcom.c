@@ -8,11 +8,72 @@
 const uint8_t  AMCOM_SOP         = 0xA1;
 const uint16_t AMCOM_INITIAL_CRC = 0xFFFF;
 
-static uint16_t AMCOM_UpdateCRC(uint8_t byte, uint16_t crc)
+/*
+ * Table-driven CRC (CRC-16/MCRF4XX: reflected polynomial 0x8408, initial value 0xFFFF).
+ *
+ * AMCOM_CRC_TABLE[k][i] is the CRC contribution of byte i followed by k zero bytes, which
+ * allows the payload to be processed eight bytes at a time ("slicing-by-8"). The CRC is
+ * linear, so every entry is the XOR of the contributions of the set bits of i - the tables
+ * are generated at compile time from the 8 single-bit values of each slice.
+ */
+#define AMCOM_CRC_BASIS_0 0x1189, 0x2312, 0x4624, 0x8C48, 0x1081, 0x2102, 0x4204, 0x8408
+#define AMCOM_CRC_BASIS_1 0x19D8, 0x33B0, 0x6760, 0xCEC0, 0x9591, 0x2333, 0x4666, 0x8CCC
+#define AMCOM_CRC_BASIS_2 0x5ADC, 0xB5B8, 0x6361, 0xC6C2, 0x8595, 0x033B, 0x0676, 0x0CEC
+#define AMCOM_CRC_BASIS_3 0x1CBB, 0x3976, 0x72EC, 0xE5D8, 0xC3A1, 0x8F53, 0x16B7, 0x2D6E
+#define AMCOM_CRC_BASIS_4 0x0B44, 0x1688, 0x2D10, 0x5A20, 0xB440, 0x6091, 0xC122, 0x8A55
+#define AMCOM_CRC_BASIS_5 0x042B, 0x0856, 0x10AC, 0x2158, 0x42B0, 0x8560, 0x02D1, 0x05A2
+#define AMCOM_CRC_BASIS_6 0x9FD5, 0x37BB, 0x6F76, 0xDEEC, 0xB5C9, 0x6383, 0xC706, 0x861D
+#define AMCOM_CRC_BASIS_7 0x81BF, 0x0B6F, 0x16DE, 0x2DBC, 0x5B78, 0xB6F0, 0x65F1, 0xCBE2
+
+#define AMCOM_CRC_ENTRY(k, i)   AMCOM_CRC_ENTRY_((i), AMCOM_CRC_BASIS_##k)
+#define AMCOM_CRC_ENTRY_(i, basis) AMCOM_CRC_ENTRY__(i, basis)
+#define AMCOM_CRC_ENTRY__(i, b0, b1, b2, b3, b4, b5, b6, b7) \
+	(uint16_t)(((i) & 0x01 ? (b0) : 0) ^ ((i) & 0x02 ? (b1) : 0) ^ ((i) & 0x04 ? (b2) : 0) ^ ((i) & 0x08 ? (b3) : 0) ^ \
+	           ((i) & 0x10 ? (b4) : 0) ^ ((i) & 0x20 ? (b5) : 0) ^ ((i) & 0x40 ? (b6) : 0) ^ ((i) & 0x80 ? (b7) : 0))
+#define AMCOM_CRC_ROW4(k, n)    AMCOM_CRC_ENTRY(k, (n)), AMCOM_CRC_ENTRY(k, (n) + 1), \
+	                            AMCOM_CRC_ENTRY(k, (n) + 2), AMCOM_CRC_ENTRY(k, (n) + 3)
+#define AMCOM_CRC_ROW16(k, n)   AMCOM_CRC_ROW4(k, (n)), AMCOM_CRC_ROW4(k, (n) + 4), \
+	                            AMCOM_CRC_ROW4(k, (n) + 8), AMCOM_CRC_ROW4(k, (n) + 12)
+#define AMCOM_CRC_ROW64(k, n)   AMCOM_CRC_ROW16(k, (n)), AMCOM_CRC_ROW16(k, (n) + 16), \
+	                            AMCOM_CRC_ROW16(k, (n) + 32), AMCOM_CRC_ROW16(k, (n) + 48)
+#define AMCOM_CRC_ROW256(k)     AMCOM_CRC_ROW64(k, 0), AMCOM_CRC_ROW64(k, 64), \
+	                            AMCOM_CRC_ROW64(k, 128), AMCOM_CRC_ROW64(k, 192)
+
+static const uint16_t AMCOM_CRC_TABLE[8][256] = {
+	{ AMCOM_CRC_ROW256(0) }, { AMCOM_CRC_ROW256(1) }, { AMCOM_CRC_ROW256(2) }, { AMCOM_CRC_ROW256(3) },
+	{ AMCOM_CRC_ROW256(4) }, { AMCOM_CRC_ROW256(5) }, { AMCOM_CRC_ROW256(6) }, { AMCOM_CRC_ROW256(7) },
+};
+
+static inline uint16_t AMCOM_UpdateCRC(uint8_t byte, uint16_t crc)
+{
+	return (uint16_t)((crc >> 8) ^ AMCOM_CRC_TABLE[0][(uint8_t)(crc ^ byte)]);
+}
+
+static uint16_t AMCOM_UpdateCRCBlock(const uint8_t* bytes, size_t size, uint16_t crc)
 {
-	byte ^= (uint8_t)(crc & 0x00ff);
-	byte ^= (uint8_t)(byte << 4);
-	return ((((uint16_t)byte << 8) | (uint8_t)(crc >> 8)) ^ (uint8_t)(byte >> 4) ^ ((uint16_t)byte << 3));
+	const uint16_t (*t)[256] = AMCOM_CRC_TABLE;
+	// slicing-by-8: the current CRC is folded into the first two bytes of each block
+	while (size >= 8) {
+		crc ^= (uint16_t)(bytes[0] | (bytes[1] << 8));
+		crc = t[7][crc & 0xff] ^ t[6][crc >> 8] ^ t[5][bytes[2]] ^ t[4][bytes[3]] ^
+		      t[3][bytes[4]]   ^ t[2][bytes[5]] ^ t[1][bytes[6]] ^ t[0][bytes[7]];
+		bytes += 8;
+		size -= 8;
+	}
+	while (size-- > 0) {
+		crc = AMCOM_UpdateCRC(*bytes++, crc);
+	}
+	return crc;
+}
+
+uint16_t AMCOM_ComputeCRC(uint8_t packetType, uint8_t packetLength, const void* payload, size_t payloadSize) {
+	uint16_t crc = AMCOM_INITIAL_CRC;
+	crc = AMCOM_UpdateCRC(packetType, crc);
+	crc = AMCOM_UpdateCRC(packetLength, crc);
+	if (payload != NULL && payloadSize > 0) {
+		crc = AMCOM_UpdateCRCBlock((const uint8_t*)payload, payloadSize, crc);
+	}
+	return crc;
 }
 
 
@@ -23,11 +84,21 @@ void AMCOM_InitReceiver(AMCOM_Receiver* receiver, AMCOM_PacketHandler packetHand
 	}
 	receiver->receivedPacketState = AMCOM_PACKET_STATE_EMPTY;
 	receiver->payloadCounter=0;
+	receiver->runningCrc = AMCOM_INITIAL_CRC;
 	receiver->packetHandler = packetHandlerCallback;
+	receiver->packetViewHandler = NULL;
 	receiver->userContext = userContext;
 	memset(&receiver->receivedPacket, 0, sizeof(AMCOM_Packet));
 }
 
+void AMCOM_InitViewReceiver(AMCOM_Receiver* receiver, AMCOM_PacketViewHandler packetViewHandlerCallback, void* userContext) {
+	if(receiver==NULL){
+	    return;
+	}
+	AMCOM_InitReceiver(receiver, NULL, userContext);
+	receiver->packetViewHandler = packetViewHandlerCallback;
+}
+
 size_t AMCOM_Serialize(uint8_t packetType, const void* payload, size_t payloadSize, uint8_t* destinationBuffer) {
 	// TODO
 	if(destinationBuffer == NULL){
@@ -45,16 +116,7 @@ size_t AMCOM_Serialize(uint8_t packetType, const void* payload, size_t payloadSi
 	header->type = packetType;
 	header->length = (uint8_t)payloadSize;
 	//crc
-	uint16_t crc = AMCOM_INITIAL_CRC;
-	crc = AMCOM_UpdateCRC(header->type,crc);
-	crc = AMCOM_UpdateCRC(header->length,crc);
-	//jesli jest payload
-	if(payloadSize>0){
-	    const uint8_t* payloadBytes = (const uint8_t*)payload;
-	    for(size_t i=0;i<payloadSize;++i){
-	        crc = AMCOM_UpdateCRC(payloadBytes[i],crc);
-	    }
-	}
+	uint16_t crc = AMCOM_ComputeCRC(header->type, header->length, payload, payloadSize);
 	
 	header->crc = crc;
 	if(payloadSize>0){
@@ -64,14 +126,103 @@ size_t AMCOM_Serialize(uint8_t packetType, const void* payload, size_t payloadSi
 	return sizeof(AMCOM_PacketHeader)+payloadSize;
 }
 
+/**
+ * Completes a packet assembled by the byte-wise state machine. The CRC was accumulated while
+ * the bytes were arriving, so only the final comparison is left.
+ */
+static void AMCOM_FinishPacket(AMCOM_Receiver* receiver) {
+    if(receiver->runningCrc==receiver->receivedPacket.header.crc){
+        if(receiver->packetViewHandler!=NULL){
+            AMCOM_PacketView view;
+            view.header = receiver->receivedPacket.header;
+            view.payload = receiver->receivedPacket.payload;
+            view.payloadSize = receiver->receivedPacket.header.length;
+            receiver->packetViewHandler(&view,receiver->userContext);
+        }else if(receiver->packetHandler!=NULL){
+            receiver->packetHandler(&receiver->receivedPacket,receiver->userContext);
+        }
+    }
+    receiver->receivedPacketState=AMCOM_PACKET_STATE_EMPTY;
+    receiver->payloadCounter=0;
+}
+
+/**
+ * Delivers a packet that is available as one contiguous block of bytes (header + payload).
+ * The CRC is verified over the block in one pass. In view mode the handler gets a view into the
+ * caller's buffer, otherwise the packet is copied to the receiver with a single memcpy.
+ */
+static void AMCOM_DeliverContiguousPacket(AMCOM_Receiver* receiver, const uint8_t* packetBytes) {
+    const AMCOM_PacketHeader* header = (const AMCOM_PacketHeader*)packetBytes;
+    const uint8_t* payload = packetBytes + sizeof(AMCOM_PacketHeader);
+    uint16_t calculated_crc = AMCOM_ComputeCRC(header->type, header->length, payload, header->length);
+    if(calculated_crc==header->crc){
+        if(receiver->packetViewHandler!=NULL){
+            AMCOM_PacketView view;
+            memcpy(&view.header, header, sizeof(AMCOM_PacketHeader));
+            view.payload = payload;
+            view.payloadSize = header->length;
+            receiver->packetViewHandler(&view,receiver->userContext);
+            return;
+        }
+        memcpy(&receiver->receivedPacket, packetBytes, sizeof(AMCOM_PacketHeader) + header->length);
+        if(receiver->packetHandler!=NULL){
+            receiver->packetHandler(&receiver->receivedPacket,receiver->userContext);
+        }
+    }
+}
+
 void AMCOM_Deserialize(AMCOM_Receiver* receiver, const void* data, size_t dataSize) {
     // TODO
     if(receiver==NULL || data==NULL){
         return;
     }
     const uint8_t* dataBytes = (const uint8_t*)data;
-    for(size_t i=0;i<dataSize;++i){
-        uint8_t currentByte = dataBytes[i];
+    size_t i=0;
+    while(i<dataSize){
+        // fast path: find SOP with memchr and deliver packets that lie entirely in the buffer
+        if(receiver->receivedPacketState==AMCOM_PACKET_STATE_EMPTY ||
+           receiver->receivedPacketState==AMCOM_PACKET_STATE_GOT_WHOLE_PACKET){
+            const uint8_t* sop = (const uint8_t*)memchr(dataBytes + i, AMCOM_SOP, dataSize - i);
+            if(sop==NULL){
+                receiver->receivedPacketState=AMCOM_PACKET_STATE_EMPTY;
+                return;
+            }
+            i = (size_t)(sop - dataBytes);
+            size_t available = dataSize - i;
+            if(available>=sizeof(AMCOM_PacketHeader)){
+                const AMCOM_PacketHeader* header = (const AMCOM_PacketHeader*)sop;
+                if(header->length>AMCOM_MAX_PAYLOAD_SIZE){
+                    // same as the state machine: drop SOP, TYPE and LENGTH and look for the next SOP
+                    receiver->receivedPacketState=AMCOM_PACKET_STATE_EMPTY;
+                    i += 3;
+                    continue;
+                }
+                size_t packetSize = sizeof(AMCOM_PacketHeader) + header->length;
+                if(available>=packetSize){
+                    AMCOM_DeliverContiguousPacket(receiver, sop);
+                    receiver->receivedPacketState=AMCOM_PACKET_STATE_EMPTY;
+                    receiver->payloadCounter=0;
+                    i += packetSize;
+                    continue;
+                }
+            }
+            // packet is split across calls - continue byte by byte from the SOP
+        }
+        // rest of the payload of a packet split across calls - copied in one go
+        if(receiver->receivedPacketState==AMCOM_PACKET_STATE_GETTING_PAYLOAD){
+            size_t missing = receiver->receivedPacket.header.length - receiver->payloadCounter;
+            size_t chunk = (dataSize - i < missing) ? dataSize - i : missing;
+            memcpy(&receiver->receivedPacket.payload[receiver->payloadCounter], dataBytes + i, chunk);
+            receiver->runningCrc=AMCOM_UpdateCRCBlock(dataBytes + i, chunk, receiver->runningCrc);
+            receiver->payloadCounter += chunk;
+            i += chunk;
+            if(receiver->payloadCounter==receiver->receivedPacket.header.length){
+                receiver->receivedPacketState=AMCOM_PACKET_STATE_GOT_WHOLE_PACKET;
+                AMCOM_FinishPacket(receiver);
+            }
+            continue;
+        }
+        uint8_t currentByte = dataBytes[i++];
         bool packetComplete = false;
         //maszyna stanów
         switch(receiver->receivedPacketState){
@@ -83,12 +234,14 @@ void AMCOM_Deserialize(AMCOM_Receiver* receiver, const void* data, size_t dataSi
                 break;
             case AMCOM_PACKET_STATE_GOT_SOP:
                 receiver->receivedPacket.header.type=currentByte;
+                receiver->runningCrc=AMCOM_UpdateCRC(currentByte,AMCOM_INITIAL_CRC);
                 receiver->receivedPacketState=AMCOM_PACKET_STATE_GOT_TYPE;
                 break;
             case AMCOM_PACKET_STATE_GOT_TYPE:
                 if(currentByte<=AMCOM_MAX_PAYLOAD_SIZE){
                     receiver->receivedPacket.header.length=currentByte;
                     receiver->payloadCounter=0;
+                    receiver->runningCrc=AMCOM_UpdateCRC(currentByte,receiver->runningCrc);
                     receiver->receivedPacketState=AMCOM_PACKET_STATE_GOT_LENGTH;
                 }else{
                     receiver->receivedPacketState=AMCOM_PACKET_STATE_EMPTY;
@@ -113,14 +266,6 @@ void AMCOM_Deserialize(AMCOM_Receiver* receiver, const void* data, size_t dataSi
                     receiver->receivedPacketState = AMCOM_PACKET_STATE_GETTING_PAYLOAD;
                 }
                 break;
-            case AMCOM_PACKET_STATE_GETTING_PAYLOAD:
-                receiver->receivedPacket.payload[receiver->payloadCounter]=currentByte;
-                receiver->payloadCounter++;
-                if(receiver->payloadCounter==receiver->receivedPacket.header.length){
-                    receiver->receivedPacketState=AMCOM_PACKET_STATE_GOT_WHOLE_PACKET;
-                    packetComplete=true;
-                }
-                break;
             case AMCOM_PACKET_STATE_GOT_WHOLE_PACKET:
             default:
                 if(currentByte==AMCOM_SOP){
@@ -132,19 +277,7 @@ void AMCOM_Deserialize(AMCOM_Receiver* receiver, const void* data, size_t dataSi
                 break;
         }
         if(packetComplete){
-            uint16_t calculated_crc = AMCOM_INITIAL_CRC;
-            calculated_crc = AMCOM_UpdateCRC(receiver->receivedPacket.header.type,calculated_crc);
-            calculated_crc = AMCOM_UpdateCRC(receiver->receivedPacket.header.length,calculated_crc);
-            for(size_t j = 0;j<receiver->receivedPacket.header.length;++j){
-                calculated_crc = AMCOM_UpdateCRC(receiver->receivedPacket.payload[j],calculated_crc);
-            }
-            if(calculated_crc==receiver->receivedPacket.header.crc){
-                if(receiver->packetHandler!=NULL){
-                    receiver->packetHandler(&receiver->receivedPacket,receiver->userContext);
-                }
-            }
-            receiver->receivedPacketState=AMCOM_PACKET_STATE_EMPTY;
-            receiver->payloadCounter=0;
+            AMCOM_FinishPacket(receiver);
         }
     }
 }
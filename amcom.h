@@ -78,6 +78,27 @@ static_assert(205 == sizeof(AMCOM_Packet), "205 != sizeof(AMCOM_Packet)");
  */
 typedef void (*AMCOM_PacketHandler)(const AMCOM_Packet* packet, void* userContext);
 
+/**
+ * Read-only view of a received packet.
+ *
+ * The payload pointer refers either directly to the data buffer passed to @ref AMCOM_Deserialize (when the
+ * whole packet was contiguous in it) or to the receiver's internal buffer (when the packet was split between
+ * calls). In both cases it is only valid for the duration of the callback.
+ */
+typedef struct {
+	AMCOM_PacketHeader header;   ///< packet header
+	const uint8_t* payload;      ///< packet payload (may be unaligned)
+	size_t payloadSize;          ///< number of payload bytes (equal to header.length)
+} AMCOM_PacketView;
+
+/**
+ * Type describing a callback function that will be called with a view of each received packet.
+ *
+ * @param packet view of the packet that is received
+ * @param userContext user defined context associated with the protocol receiver instance
+ */
+typedef void (*AMCOM_PacketViewHandler)(const AMCOM_PacketView* packet, void* userContext);
+
 /** Possible states of the packet reception. */
 typedef enum {
 	/// Packet was not started yet
@@ -102,10 +123,14 @@ typedef struct {
 	AMCOM_Packet receivedPacket;
 	/// Counter that will be used to count the number of received payload bytes
 	size_t payloadCounter;
+	/// CRC of the packet bytes received so far (updated as the bytes arrive)
+	uint16_t runningCrc;
 	/// State of the packet reception
 	AMCOM_PacketState receivedPacketState;
 	/// User-defined packet handler (callback)
 	AMCOM_PacketHandler packetHandler;
+	/// User-defined packet view handler (callback), used instead of packetHandler when set
+	AMCOM_PacketViewHandler packetViewHandler;
 	/// User-defined context (universal, general-purpose pointer)
 	void* userContext;
 } AMCOM_Receiver;
@@ -121,6 +146,32 @@ typedef struct {
  */
 void AMCOM_InitReceiver(AMCOM_Receiver* receiver, AMCOM_PacketHandler packetHandlerCallback, void* userContext);
 
+/**
+ * @brief Initializes the AMCOM packet receiver in zero-copy (view) mode.
+ *
+ * Works like @ref AMCOM_InitReceiver, but received packets are passed to the callback as a
+ * @ref AMCOM_PacketView. Packets that are contiguous in the data given to @ref AMCOM_Deserialize are not
+ * copied at all; only packets split between calls are assembled in the receiver's internal buffer.
+ * @param receiver pointer to the AMCOM receiver structure
+ * @param packetViewHandlerCallback callback function that will be called each time a packet is received
+ * @param userContext user defined, general purpose context, that will be fed back to the callback function
+ */
+void AMCOM_InitViewReceiver(AMCOM_Receiver* receiver, AMCOM_PacketViewHandler packetViewHandlerCallback, void* userContext);
+
+/**
+ * @brief Computes the CRC of an AMCOM packet
+ *
+ * The checksum covers the TYPE and LENGTH header fields followed by the payload bytes. This is the value
+ * stored in the CRC field by @ref AMCOM_Serialize and checked by @ref AMCOM_Deserialize.
+ * @param packetType type of packet
+ * @param packetLength value of the LENGTH field
+ * @param payload pointer to the payload data or NULL if the packet has no payload
+ * @param payloadSize number of payload bytes to include in the checksum
+ *
+ * @return CRC of the packet
+ */
+uint16_t AMCOM_ComputeCRC(uint8_t packetType, uint8_t packetLength, const void* payload, size_t payloadSize);
+
 /**
  * @brief Serializes the packet
  *
@@ -145,6 +196,9 @@ size_t AMCOM_Serialize(uint8_t packetType, const void* payload, size_t payloadSi
  * AMCOM packet in this stream. The state of the packet reception shall be stored within the receiver structure.
  * If a valid packet is found and buffered, this function shall call the packetHandlerCallback function defined
  * through a previous call to @ref AMCOM_InitReceiver.
+ *
+ * Packets that lie entirely within the data chunk are checked and copied in bulk; only packets split
+ * between consecutive calls go through the byte-by-byte reception state machine.
  * @param receiver pointer to the AMCOM receiver structure
  * @param data incoming data
  * @param dataSize number of bytes in the incoming data
@@ -0,0 +1,30 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+/**
+ * Small helpers shared by the benchmark programs: a monotonic clock and a deterministic
+ * pseudo-random generator (so that every run measures exactly the same input).
+ */
+
+#include <stdint.h>
+#include "platform.h"
+
+/// Returns a monotonic timestamp in nanoseconds
+static inline uint64_t benchNowNs(void) {
+    return PLATFORM_NowNs();
+}
+
+/// xorshift32 step - returns the next pseudo-random number and updates the state
+static inline uint32_t benchRandom(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/// Keeps the optimizer from removing a computation whose result is otherwise unused
+static volatile uint32_t benchSink;
+
+#endif /* BENCH_H_ */
@@ -0,0 +1,231 @@
+/**
+ * Churns thousands of game objects through a long game and checks the bookkeeping of the object tables.
+ *
+ * Usage: churn_bench
+ *
+ * Every tick some transistors are eaten (sent with HP 0) and new ones appear under fresh object numbers, glue
+ * spots vanish and reappear elsewhere, players die and join, and the survivors move; the number of live
+ * transistors swings around the size from which the spatial index is used. After every tick the tables must
+ * hold exactly the live objects (no live object dropped, no dead one kept), and a second bot without the
+ * memoized targets must choose the same angle - the program fails otherwise. The decision time is printed
+ * for every part of the game, so it can be seen staying flat while the eaten objects pile up.
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "bot.h"
+#include "bench.h"
+
+#define MAP_SIZE 2000.0f
+#define TICKS 20000
+#define SEGMENTS 10
+#define MY_PLAYER_NUMBER 0
+#define MAX_LIVE 256
+#define TYPE_COUNT 4
+
+typedef struct {
+    uint16_t objectNo;
+    int8_t hp;
+    float x, y;
+} LiveObject;
+
+typedef struct {
+    LiveObject objects[MAX_LIVE];
+    uint32_t count;
+    uint16_t nextNo;
+} LiveSet;
+
+typedef struct {
+    AMCOM_ObjectUpdateRequestPayload update;
+    uint32_t pending;
+    GameState* bots[2];
+} Sender;
+
+static void deliver(GameState* gameState, uint8_t type, const void* payload, size_t size) {
+    AMCOM_PacketView view;
+    memset(&view, 0, sizeof(view));
+    view.header.type = type;
+    view.header.length = (uint8_t)size;
+    view.payload = (const uint8_t*)payload;
+    view.payloadSize = size;
+    if (type == AMCOM_OBJECT_UPDATE_REQUEST) {
+        processObjectUpdate(gameState, &view);
+    } else {
+        uint8_t response[AMCOM_MAX_PACKET_SIZE];
+        handleGamePacket(gameState, &view, response);
+    }
+}
+
+static void flush(Sender* sender) {
+    if (sender->pending == 0) {
+        return;
+    }
+    for (int b = 0; b < 2; ++b) {
+        deliver(sender->bots[b], AMCOM_OBJECT_UPDATE_REQUEST, &sender->update,
+                sender->pending * sizeof(AMCOM_ObjectState));
+    }
+    sender->pending = 0;
+}
+
+static void send(Sender* sender, uint8_t type, const LiveObject* object, int8_t hp) {
+    AMCOM_ObjectState* state = &sender->update.objectState[sender->pending++];
+    state->objectType = type;
+    state->objectNo = object->objectNo;
+    state->hp = hp;
+    state->x = object->x;
+    state->y = object->y;
+    if (sender->pending == AMCOM_MAX_OBJECT_UPDATES) {
+        flush(sender);
+    }
+}
+
+static float randomCoordinate(uint32_t* seed) {
+    return (float)(benchRandom(seed) % 100000) * MAP_SIZE / 100000.0f;
+}
+
+static void spawn(Sender* sender, LiveSet* set, uint8_t type, uint32_t* seed, int8_t maxHp) {
+    LiveObject* object = &set->objects[set->count++];
+    object->objectNo = set->nextNo++;
+    if (set->nextNo == 0) {
+        set->nextNo = MY_PLAYER_NUMBER + 1;
+    }
+    object->hp = (int8_t)(1 + benchRandom(seed) % (uint32_t)maxHp);
+    object->x = randomCoordinate(seed);
+    object->y = randomCoordinate(seed);
+    send(sender, type, object, object->hp);
+}
+
+static void kill(Sender* sender, LiveSet* set, uint8_t type, uint32_t index) {
+    send(sender, type, &set->objects[index], 0);
+    set->objects[index] = set->objects[--set->count];
+}
+
+static const OBJTABLE_Table* tableOfType(const GameState* gameState, uint8_t type) {
+    switch (type) {
+        case 0: return &gameState->players;
+        case 1: return &gameState->transistors;
+        case 2: return &gameState->sparks;
+        default: return &gameState->glue;
+    }
+}
+
+/// Checks that the table holds exactly the live objects (plus our player in the player table)
+static bool matches(const GameState* gameState, uint8_t type, const LiveSet* set, int tick) {
+    const OBJTABLE_Table* table = tableOfType(gameState, type);
+    uint32_t expected = set->count + (type == 0 ? 1 : 0);
+    if (table->count != expected) {
+        printf("tick %d: type %u table holds %u objects, %u are alive\n", tick, type, table->count, expected);
+        return false;
+    }
+    for (uint32_t i = 0; i < set->count; ++i) {
+        const LiveObject* object = &set->objects[i];
+        int32_t index = OBJTABLE_Find(table, object->objectNo);
+        if (index == OBJTABLE_NOT_FOUND || table->x[index] != object->x || table->y[index] != object->y ||
+            table->hp[index] != (float)object->hp) {
+            printf("tick %d: type %u object %u lost or stale\n", tick, type, object->objectNo);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(void) {
+    static GameState cached, uncached;
+    static LiveSet live[TYPE_COUNT];
+    static const uint32_t baseCounts[TYPE_COUNT] = { 8, 128, 20, 10 };
+    static const int8_t maxHp[TYPE_COUNT] = { 60, 10, 1, 1 };
+    uint32_t seed = 0xC4u;
+    bool consistent = true;
+    uint64_t churned = 0;
+
+    initGameState(&cached, NULL);
+    initGameState(&uncached, NULL);
+    uncached.targetCaching = false;
+    AMCOM_NewGameRequestPayload newGame = { MY_PLAYER_NUMBER, 8, MAP_SIZE, MAP_SIZE };
+    deliver(&cached, AMCOM_NEW_GAME_REQUEST, &newGame, sizeof(newGame));
+    deliver(&uncached, AMCOM_NEW_GAME_REQUEST, &newGame, sizeof(newGame));
+
+    Sender sender;
+    sender.pending = 0;
+    sender.bots[0] = &cached;
+    sender.bots[1] = &uncached;
+    LiveObject me = { MY_PLAYER_NUMBER, 30, MAP_SIZE / 2, MAP_SIZE / 2 };
+    send(&sender, 0, &me, me.hp);
+    for (uint8_t type = 0; type < TYPE_COUNT; ++type) {
+        live[type].nextNo = MY_PLAYER_NUMBER + 1;
+        while (live[type].count < baseCounts[type]) {
+            spawn(&sender, &live[type], type, &seed, maxHp[type]);
+        }
+    }
+    flush(&sender);
+
+    printf("%14s %12s %8s %14s\n", "ticks", "transistors", "glue", "ns/decision");
+    uint64_t elapsed = 0;
+    for (int tick = 0; tick < TICKS; ++tick) {
+        // the number of transistors swings between about 100 and 160
+        uint32_t target = 130 + (uint32_t)lrintf(30.0f * sinf((float)tick * 0.002f));
+        LiveSet* transistors = &live[1];
+        for (int e = 0; e < 2 && transistors->count > 0; ++e) {
+            kill(&sender, transistors, 1, benchRandom(&seed) % transistors->count);
+            churned++;
+        }
+        while (transistors->count < target && transistors->count < MAX_LIVE) {
+            spawn(&sender, transistors, 1, &seed, maxHp[1]);
+        }
+        if (tick % 50 == 0) {
+            kill(&sender, &live[3], 3, benchRandom(&seed) % live[3].count);
+            spawn(&sender, &live[3], 3, &seed, maxHp[3]);
+            churned++;
+        }
+        if (tick % 200 == 0) {
+            kill(&sender, &live[0], 0, benchRandom(&seed) % live[0].count);
+            spawn(&sender, &live[0], 0, &seed, maxHp[0]);
+            churned++;
+        }
+        for (uint8_t type = 0; type < TYPE_COUNT; type += 2) {
+            for (uint32_t i = 0; i < live[type].count; ++i) {
+                LiveObject* object = &live[type].objects[i];
+                object->x = fminf(fmaxf(object->x + (float)((int)(benchRandom(&seed) % 7) - 3), 0.0f), MAP_SIZE);
+                object->y = fminf(fmaxf(object->y + (float)((int)(benchRandom(&seed) % 7) - 3), 0.0f), MAP_SIZE);
+                send(&sender, type, object, object->hp);
+            }
+        }
+        me.x = fminf(fmaxf(me.x + (float)((int)(benchRandom(&seed) % 11) - 5), 0.0f), MAP_SIZE);
+        me.y = fminf(fmaxf(me.y + (float)((int)(benchRandom(&seed) % 11) - 5), 0.0f), MAP_SIZE);
+        send(&sender, 0, &me, me.hp);
+        flush(&sender);
+
+        for (uint8_t type = 0; type < TYPE_COUNT && consistent; ++type) {
+            consistent = matches(&cached, type, &live[type], tick) && matches(&uncached, type, &live[type], tick);
+        }
+        if (!consistent) {
+            break;
+        }
+
+        cached.konamiIndex = uncached.konamiIndex = 0;
+        uint64_t start = benchNowNs();
+        float angle = calculateMovement(&cached);
+        elapsed += benchNowNs() - start;
+        float reference = calculateMovement(&uncached);
+        if (memcmp(&angle, &reference, sizeof(angle)) != 0) {
+            printf("tick %d: angle %.9g with memoized targets, %.9g without\n", tick, angle, reference);
+            consistent = false;
+            break;
+        }
+
+        if ((tick + 1) % (TICKS / SEGMENTS) == 0) {
+            char range[32];
+            snprintf(range, sizeof(range), "%d-%d", tick + 1 - TICKS / SEGMENTS, tick);
+            printf("%14s %12u %8u %14.1f\n", range, cached.transistors.count, cached.glue.count,
+                   (double)elapsed / (TICKS / SEGMENTS));
+            elapsed = 0;
+        }
+    }
+    printf("objects churned: %llu\n", (unsigned long long)churned);
+    printf("%s\n", consistent ? "tables consistent" : "TABLES INCONSISTENT");
+    freeGameState(&cached);
+    freeGameState(&uncached);
+    return consistent ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+/**
+ * Compares the table-driven AMCOM_ComputeCRC against the original bit-twiddling CRC routine.
+ *
+ * For every payload length from 0 to AMCOM_MAX_PAYLOAD_SIZE both implementations are checked
+ * for identical results and then timed over the same random payloads.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "amcom.h"
+#include "bench.h"
+
+#define ITERATIONS 20000
+
+/// The per-byte CRC update that AMCOM used before the table-driven engine
+static uint16_t bitwiseUpdateCRC(uint8_t byte, uint16_t crc) {
+    byte ^= (uint8_t)(crc & 0x00ff);
+    byte ^= (uint8_t)(byte << 4);
+    return ((((uint16_t)byte << 8) | (uint8_t)(crc >> 8)) ^ (uint8_t)(byte >> 4) ^ ((uint16_t)byte << 3));
+}
+
+static uint16_t bitwiseComputeCRC(uint8_t type, uint8_t length, const uint8_t* payload, size_t size) {
+    uint16_t crc = 0xFFFF;
+    crc = bitwiseUpdateCRC(type, crc);
+    crc = bitwiseUpdateCRC(length, crc);
+    for (size_t i = 0; i < size; ++i) {
+        crc = bitwiseUpdateCRC(payload[i], crc);
+    }
+    return crc;
+}
+
+int main(void) {
+    uint8_t payload[AMCOM_MAX_PAYLOAD_SIZE];
+    uint32_t seed = 0x12345678u;
+    int failures = 0;
+
+    // correctness: every length, several random payloads each
+    for (size_t len = 0; len <= AMCOM_MAX_PAYLOAD_SIZE; ++len) {
+        for (int round = 0; round < 64; ++round) {
+            for (size_t i = 0; i < len; ++i) {
+                payload[i] = (uint8_t)benchRandom(&seed);
+            }
+            uint8_t type = (uint8_t)benchRandom(&seed);
+            uint16_t expected = bitwiseComputeCRC(type, (uint8_t)len, payload, len);
+            uint16_t actual = AMCOM_ComputeCRC(type, (uint8_t)len, payload, len);
+            if (expected != actual) {
+                printf("MISMATCH: len=%u type=%u expected=0x%04X got=0x%04X\n",
+                       (unsigned)len, type, expected, actual);
+                failures++;
+            }
+        }
+    }
+    if (failures > 0) {
+        printf("%d mismatches found\n", failures);
+        return 1;
+    }
+    printf("table CRC matches bitwise CRC for payloads of 0..%d bytes\n\n", AMCOM_MAX_PAYLOAD_SIZE);
+
+    // performance
+    printf("%8s %14s %14s %9s\n", "length", "bitwise [ns]", "table [ns]", "speedup");
+    static const size_t lengths[] = { 0, 4, 12, 24, 48, 96, 127, 192, 200 };
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l) {
+        size_t len = lengths[l];
+        uint32_t acc = 0;
+
+        uint64_t start = benchNowNs();
+        for (int it = 0; it < ITERATIONS; ++it) {
+            payload[it % AMCOM_MAX_PAYLOAD_SIZE] = (uint8_t)it;
+            acc += bitwiseComputeCRC(AMCOM_MAX_PAYLOAD_SIZE, (uint8_t)len, payload, len);
+        }
+        uint64_t bitwiseNs = benchNowNs() - start;
+
+        start = benchNowNs();
+        for (int it = 0; it < ITERATIONS; ++it) {
+            payload[it % AMCOM_MAX_PAYLOAD_SIZE] = (uint8_t)it;
+            acc += AMCOM_ComputeCRC(AMCOM_MAX_PAYLOAD_SIZE, (uint8_t)len, payload, len);
+        }
+        uint64_t tableNs = benchNowNs() - start;
+        benchSink = acc;
+
+        double bitwisePer = (double)bitwiseNs / ITERATIONS;
+        double tablePer = (double)tableNs / ITERATIONS;
+        printf("%8u %14.1f %14.1f %8.2fx\n", (unsigned)len, bitwisePer, tablePer,
+               tablePer > 0 ? bitwisePer / tablePer : 0.0);
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+/**
+ * Measures the cost of one calculateMovement() decision for growing numbers of game objects,
+ * once for every scoring kernel level available on this CPU (scalar, SSE2, AVX2).
+ *
+ * Usage: decision_bench
+ *
+ * The world is generated deterministically: about 10% players, 10% sparks, 5% glue spots and
+ * transistors for the rest, spread over a map scaled so that the object density stays the same.
+ * Our player is moved to a number of positions and every kernel level must choose exactly the
+ * same angle as the scalar code at each of them - the program fails otherwise.
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "bot.h"
+#include "kernels.h"
+#include "bench.h"
+
+#define POSITIONS 64
+#define MIN_DECISIONS 20000
+#define MY_PLAYER_NUMBER 0
+
+static void deliver(GameState* gameState, uint8_t type, const void* payload, size_t size) {
+    AMCOM_PacketView view;
+    memset(&view, 0, sizeof(view));
+    view.header.type = type;
+    view.header.length = (uint8_t)size;
+    view.payload = (const uint8_t*)payload;
+    view.payloadSize = size;
+    if (type == AMCOM_OBJECT_UPDATE_REQUEST) {
+        processObjectUpdate(gameState, &view);
+    } else {
+        uint8_t response[AMCOM_MAX_PACKET_SIZE];
+        handleGamePacket(gameState, &view, response);
+    }
+}
+
+static void placeMyPlayer(GameState* gameState, float x, float y) {
+    AMCOM_ObjectState me = { 0, MY_PLAYER_NUMBER, 30, x, y };
+    deliver(gameState, AMCOM_OBJECT_UPDATE_REQUEST, &me, sizeof(me));
+}
+
+static void buildWorld(GameState* gameState, uint32_t objects, float mapSize) {
+    AMCOM_NewGameRequestPayload newGame = { MY_PLAYER_NUMBER, 8, mapSize, mapSize };
+    deliver(gameState, AMCOM_NEW_GAME_REQUEST, &newGame, sizeof(newGame));
+
+    uint32_t seed = 0xBADC0DEu ^ objects;
+    uint16_t numbers[4] = { MY_PLAYER_NUMBER + 1, 0, 0, 0 };
+    AMCOM_ObjectUpdateRequestPayload update;
+    uint32_t pending = 0;
+    for (uint32_t i = 0; i < objects; ++i) {
+        uint32_t kind = benchRandom(&seed) % 20;
+        uint8_t type = (kind < 2) ? 0 : (kind < 4) ? 2 : (kind < 5) ? 3 : 1;
+        AMCOM_ObjectState* object = &update.objectState[pending++];
+        object->objectType = type;
+        object->objectNo = numbers[type]++;
+        object->hp = (int8_t)(1 + benchRandom(&seed) % 60);
+        object->x = (float)(benchRandom(&seed) % 100000) * mapSize / 100000.0f;
+        object->y = (float)(benchRandom(&seed) % 100000) * mapSize / 100000.0f;
+        if (pending == AMCOM_MAX_OBJECT_UPDATES || i + 1 == objects) {
+            deliver(gameState, AMCOM_OBJECT_UPDATE_REQUEST, &update, pending * sizeof(AMCOM_ObjectState));
+            pending = 0;
+        }
+    }
+}
+
+int main(void) {
+    static const uint32_t objectCounts[] = { 10, 100, 1000, 10000 };
+    float referenceAngles[POSITIONS];
+    bool identical = true;
+
+    printf("%8s %8s %14s\n", "objects", "kernels", "ns/decision");
+    for (size_t c = 0; c < sizeof(objectCounts) / sizeof(objectCounts[0]); ++c) {
+        uint32_t objects = objectCounts[c];
+        float mapSize = 100.0f * sqrtf((float)objects);
+        GameState gameState;
+        initGameState(&gameState, NULL);
+        buildWorld(&gameState, objects, mapSize);
+
+        uint32_t repeats = 1 + MIN_DECISIONS / POSITIONS * 100 / objects;
+        for (int level = 0; level < KERNELS_LEVEL_COUNT; ++level) {
+            if (!KERNELS_Select((KERNELS_Level)level)) {
+                continue;
+            }
+            uint32_t seed = 0x5EEDu;
+            uint64_t elapsed = 0;
+            for (int p = 0; p < POSITIONS; ++p) {
+                float x = (float)(benchRandom(&seed) % 1000) * mapSize / 1000.0f;
+                float y = (float)(benchRandom(&seed) % 1000) * mapSize / 1000.0f;
+                placeMyPlayer(&gameState, x, y);
+
+                float angle = 0.0f;
+                uint64_t start = benchNowNs();
+                for (uint32_t r = 0; r < repeats; ++r) {
+                    gameState.konamiIndex = 0;
+                    angle = calculateMovement(&gameState);
+                }
+                elapsed += benchNowNs() - start;
+
+                if (level == KERNELS_SCALAR) {
+                    referenceAngles[p] = angle;
+                } else if (memcmp(&angle, &referenceAngles[p], sizeof(angle)) != 0) {
+                    printf("MISMATCH: %u objects, %s kernels, position %d: %.9g != %.9g\n", objects,
+                           KERNELS_Get()->name, p, angle, referenceAngles[p]);
+                    identical = false;
+                }
+            }
+            printf("%8u %8s %14.1f\n", objects, KERNELS_Get()->name,
+                   (double)elapsed / ((double)POSITIONS * repeats));
+        }
+        freeGameState(&gameState);
+    }
+    return identical ? 0 : 1;
+}
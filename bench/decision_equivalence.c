@@ -0,0 +1,430 @@
+/**
+ * Compares the angles chosen by calculateMovement() with the decision code it replaced (distances with sqrtf,
+ * scores numerator / (distance / mapDiagonal), atan2f per spark, per target and in the glue check) and measures
+ * the latency of both.
+ *
+ * Usage: decision_equivalence [--tolerance RAD] [--max-different FRACTION] [trace...]
+ *
+ * The states are taken from recorded traces (see trace.h): the inbound packets are fed through handleGamePacket
+ * and both implementations decide at every MOVE.request. Without traces, deterministic worlds like the one of
+ * strategy_bench are generated. Every decision is classified as identical (same bits), rounding (the angles
+ * differ by at most the tolerance, default 1e-3 rad) or different (another target or another evasion, e.g.
+ * a spark behind us at +-180 degrees that the old angle comparison did not wrap around). Decisions that differ
+ * only because of that are counted as wrapped: they match the replaced code with the angles compared on the
+ * circle. The program fails if more than the given fraction of the decisions (default 0.001) is different.
+ *
+ * The replaced code is measured as a plain scan of the object tables, without the kernels and spatial indexes
+ * the decision used around it, so its latency is a reference for the arithmetic rather than the former build.
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "bot.h"
+#include "histogram.h"
+#include "trace.h"
+#include "bench.h"
+
+// Game mechanics constants of the decision code (bot.c)
+#define PLAYER_BASE_RADIUS 25
+#define GLUE_RADIUS 100
+
+#define WORLDS 16
+#define POSITIONS 256
+#define MAP_SIZE 1000.0f
+#define MY_PLAYER_NUMBER 0
+#define REPORTED_DIFFERENCES 5
+
+/**
+ * Decisions compared so far
+ */
+typedef struct {
+    uint64_t states;                               // Number of compared decisions
+    uint64_t identical;                            // Same angle, bit for bit
+    uint64_t rounding;                             // Angles within the tolerance
+    uint64_t wrapped;                              // Spark avoidance fixed at +-180 degrees
+    uint64_t different;                            // Angles further apart
+    float maxRounding;                             // Largest difference classified as rounding [rad]
+    float tolerance;                               // Largest difference of angles classified as rounding [rad]
+    HISTOGRAM_Histogram referenceLatency;          // Time of a decision of the replaced code [ns]
+    HISTOGRAM_Histogram currentLatency;            // Time of a decision of calculateMovement [ns]
+    uint64_t referenceTotal;                       // Total time of the replaced code [ns]
+    uint64_t currentTotal;                         // Total time of calculateMovement [ns]
+} Comparison;
+
+/**
+ * State of a trace being replayed
+ */
+typedef struct {
+    GameState gameState;                           // Game state driven by the packets
+    Comparison* comparison;                        // Collected results
+    const char* source;                            // Name of the trace (for reports)
+} Equivalence;
+
+/**
+ * Spark avoidance of the replaced code: atan2f of the target and of every spark in the danger zone
+ * With wrapAngles the difference of the angles is taken on the circle, which the replaced code did not do.
+ */
+static float referenceAvoidSparkTrajectory(const GameState* gameState, float targetX, float targetY, bool wrapAngles) {
+    float baseAngle = atan2f(targetY - gameState->myY, targetX - gameState->myX);
+    const float dangerRadius = gameState->params.sparkAvoidanceRadius + PLAYER_BASE_RADIUS + gameState->myHP;
+
+    for (uint32_t i = 0; i < gameState->sparks.count; i++) {
+        float dx = gameState->sparks.x[i] - gameState->myX;
+        float dy = gameState->sparks.y[i] - gameState->myY;
+        float distanceToSpark = sqrtf(dx*dx + dy*dy);
+        if (distanceToSpark < dangerRadius) {
+            float sparkAngle = atan2f(dy, dx);
+            float angleDifference = sparkAngle - baseAngle;
+            if (wrapAngles && angleDifference > M_PI) {
+                angleDifference -= 2 * M_PI;
+            } else if (wrapAngles && angleDifference < -M_PI) {
+                angleDifference += 2 * M_PI;
+            }
+            if (fabsf(angleDifference) < gameState->params.sparkAvoidanceAngle) {
+                if (angleDifference > 0) {
+                    baseAngle -= gameState->params.evasionAngle;
+                } else {
+                    baseAngle += gameState->params.evasionAngle;
+                }
+                break;
+            }
+        }
+    }
+    return baseAngle;
+}
+
+/**
+ * Score of an object reached through glue in the replaced code (the glue check of the original decision,
+ * with atan2f of the target and of every glue spot in front of it)
+ */
+static float referenceGlueScore(Equivalence* equivalence, float numerator, float dx, float dy, float distance,
+                                float mapDiagonal) {
+    const GameState* gameState = &equivalence->gameState;
+    const OBJTABLE_Table* glue = &gameState->glue;
+    float adjustedDistance = distance;
+    for (uint32_t j = 0; j < glue->count; j++) {
+        if (glue->hp[j] <= 0) continue;
+
+        float glueX = glue->x[j] - gameState->myX;
+        float glueY = glue->y[j] - gameState->myY;
+        float glueDistance = sqrtf(glueX*glueX + glueY*glueY) - GLUE_RADIUS;
+
+        if (glueDistance < distance) {
+            float glueAngle = atan2f(GLUE_RADIUS, glueDistance);
+            float targetAngle = atan2f(dy, dx);
+            float glueTargetAngle = atan2f(glueY, glueX);
+
+            if (targetAngle < glueTargetAngle + glueAngle &&
+                targetAngle > glueTargetAngle - glueAngle) {
+                adjustedDistance = distance * gameState->params.glueMovementPenalty;
+                break;
+            }
+        }
+    }
+    return numerator / (adjustedDistance / mapDiagonal);
+}
+
+/**
+ * The decision code as it was before the squared-distance pipeline (full scans of the object tables,
+ * which select the same objects as the kernels and the spatial indexes did). Does not advance the dance.
+ */
+static float referenceMovement(Equivalence* equivalence, bool wrapAngles) {
+    const GameState* gameState = &equivalence->gameState;
+    if (!gameState->gameActive || !gameState->myPlayerFound) {
+        return 0.0f;
+    }
+    const PARAMS_Strategy* params = &gameState->params;
+    const float myX = gameState->myX, myY = gameState->myY, myHP = gameState->myHP;
+    const float mapDiagonal = sqrtf(pow(gameState->mapHeight,2) + pow(gameState->mapWidth,2));
+
+    float dangerX = 0, dangerY = 0, dangerScore = 0;
+    float foodX = 0, foodY = 0, foodScore = 0;
+    float huntX = 0, huntY = 0, huntScore = 0;
+    float sparkX = 0, sparkY = 0, sparkScore = 0;
+    float attackX = 0, attackY = 0, attackScore = 0;
+
+    const OBJTABLE_Table* players = &gameState->players;
+    const int32_t selfIndex = OBJTABLE_Find(players, gameState->myPlayerNumber);
+    const float dangerRange = params->dangerDetectionRange + PLAYER_BASE_RADIUS + myHP;
+    const float attackRange = params->attackRange;
+    for (uint32_t i = 0; i < players->count; i++) {
+        if ((int32_t)i == selfIndex) continue;
+        float hp = players->hp[i];
+        float dx = players->x[i] - myX;
+        float dy = players->y[i] - myY;
+        float distance = sqrtf(dx*dx + dy*dy);
+        if (hp > fmaxf(myHP, 0.0f) && !(distance > dangerRange)) {
+            float score = hp / (distance / mapDiagonal);
+            if (score > dangerScore) {
+                dangerX = players->x[i]; dangerY = players->y[i]; dangerScore = score;
+            }
+        }
+        if (hp > 0.0f && hp < myHP) {
+            if (!(distance > attackRange)) {
+                float score = myHP / (distance / mapDiagonal);
+                if (score > attackScore) {
+                    attackX = players->x[i]; attackY = players->y[i]; attackScore = score;
+                }
+            }
+            float score = referenceGlueScore(equivalence, myHP, dx, dy, distance, mapDiagonal);
+            if (score > huntScore) {
+                huntX = players->x[i]; huntY = players->y[i]; huntScore = score;
+            }
+        }
+    }
+
+    const OBJTABLE_Table* sparks = &gameState->sparks;
+    const float sparkRange = params->sparkDetectionRange + PLAYER_BASE_RADIUS + myHP;
+    for (uint32_t i = 0; i < sparks->count; i++) {
+        if (!(sparks->hp[i] > 0.0f)) continue;
+        float dx = sparks->x[i] - myX;
+        float dy = sparks->y[i] - myY;
+        float distance = sqrtf(pow(dx,2) + pow(dy,2));
+        if (distance > sparkRange) continue;
+        float score = sparks->hp[i] / (distance / mapDiagonal);
+        if (score > sparkScore) {
+            sparkX = sparks->x[i]; sparkY = sparks->y[i]; sparkScore = score;
+        }
+    }
+
+    const OBJTABLE_Table* transistors = &gameState->transistors;
+    for (uint32_t i = 0; i < transistors->count; i++) {
+        if (!(transistors->hp[i] > 0.0f)) continue;
+        float dx = transistors->x[i] - myX;
+        float dy = transistors->y[i] - myY;
+        float distance = sqrtf(dx*dx + dy*dy);
+        float score = referenceGlueScore(equivalence, transistors->hp[i], dx, dy, distance, mapDiagonal);
+        if (score > foodScore) {
+            foodX = transistors->x[i]; foodY = transistors->y[i]; foodScore = score;
+        }
+    }
+
+    float movementAngle;
+    if (dangerScore > 0) {
+        float escapeX = -dangerY + myY + myX;
+        float escapeY = dangerX - myX + myY;
+        movementAngle = referenceAvoidSparkTrajectory(gameState, escapeX, escapeY, wrapAngles);
+    } else if (sparkScore > 0) {
+        movementAngle = atan2f(-(sparkY - myY), -(sparkX - myX));
+    } else if (attackScore > 0) {
+        movementAngle = referenceAvoidSparkTrajectory(gameState, attackX, attackY, wrapAngles);
+    } else if (foodScore > 0) {
+        movementAngle = referenceAvoidSparkTrajectory(gameState, foodX, foodY, wrapAngles);
+    } else if (huntScore > 0) {
+        movementAngle = referenceAvoidSparkTrajectory(gameState, huntX, huntY, wrapAngles);
+    } else {
+        static const float konamiSequence[8] = {
+            3 * M_PI / 2, 3 * M_PI / 2, M_PI / 2, M_PI / 2, M_PI, 0, M_PI, 0
+        };
+        movementAngle = konamiSequence[gameState->konamiIndex];
+    }
+    while (movementAngle < 0) movementAngle += 2 * M_PI;
+    while (movementAngle >= 2 * M_PI) movementAngle -= 2 * M_PI;
+    return movementAngle;
+}
+
+/**
+ * Returns the difference between two angles on the circle
+ */
+static float angleDifference(float a, float b) {
+    float difference = fmodf(fabsf(a - b), 2.0f * (float)M_PI);
+    return (difference > (float)M_PI) ? 2.0f * (float)M_PI - difference : difference;
+}
+
+/**
+ * Lets both implementations decide in the current state and classifies the result
+ */
+static void compareDecision(Equivalence* equivalence) {
+    Comparison* comparison = equivalence->comparison;
+    GameState* gameState = &equivalence->gameState;
+
+    uint64_t start = benchNowNs();
+    float expected = referenceMovement(equivalence, false);
+    uint64_t middle = benchNowNs();
+    float produced = calculateMovement(gameState);
+    uint64_t end = benchNowNs();
+    HISTOGRAM_Record(&comparison->referenceLatency, middle - start);
+    HISTOGRAM_Record(&comparison->currentLatency, end - middle);
+    comparison->referenceTotal += middle - start;
+    comparison->currentTotal += end - middle;
+
+    comparison->states++;
+    if (memcmp(&expected, &produced, sizeof(float)) == 0) {
+        comparison->identical++;
+        return;
+    }
+    float difference = angleDifference(expected, produced);
+    if (difference <= comparison->tolerance) {
+        comparison->rounding++;
+        if (difference > comparison->maxRounding) {
+            comparison->maxRounding = difference;
+        }
+        return;
+    }
+    if (angleDifference(referenceMovement(equivalence, true), produced) <= comparison->tolerance) {
+        comparison->wrapped++;
+        return;
+    }
+    if (comparison->different++ < REPORTED_DIFFERENCES) {
+        printf("  %s, game time %u: %.6f rad before, %.6f rad now\n", equivalence->source,
+               (unsigned)gameState->currentGameTime, expected, produced);
+    }
+}
+
+static void deliver(Equivalence* equivalence, uint8_t type, const void* payload, size_t size) {
+    AMCOM_PacketView view;
+    memset(&view, 0, sizeof(view));
+    view.header.type = type;
+    view.header.length = (uint8_t)size;
+    view.payload = (const uint8_t*)payload;
+    view.payloadSize = size;
+    if (type == AMCOM_MOVE_REQUEST) {
+        AMCOM_MoveRequestPayload move = { 0 };
+        memcpy(&move, payload, (size < sizeof(move)) ? size : sizeof(move));
+        equivalence->gameState.currentGameTime = move.gameTime;
+        compareDecision(equivalence);
+    } else {
+        uint8_t response[AMCOM_MAX_PACKET_SIZE];
+        handleGamePacket(&equivalence->gameState, &view, response);
+    }
+}
+
+static void packetHandler(const AMCOM_PacketView* packet, void* userContext) {
+    Equivalence* equivalence = (Equivalence*)userContext;
+    if (packet->header.type == AMCOM_MOVE_REQUEST) {
+        deliver(equivalence, AMCOM_MOVE_REQUEST, packet->payload, packet->payloadSize);
+    } else {
+        uint8_t response[AMCOM_MAX_PACKET_SIZE];
+        handleGamePacket(&equivalence->gameState, packet, response);
+    }
+}
+
+/**
+ * Compares the decisions at every MOVE.request of a trace
+ */
+static bool compareTrace(Equivalence* equivalence, const char* path) {
+    TRACE_Reader reader;
+    if (!TRACE_OpenReader(&reader, path)) {
+        printf("Unable to read trace %s\n", path);
+        return false;
+    }
+    AMCOM_Receiver receiver;
+    AMCOM_InitViewReceiver(&receiver, packetHandler, equivalence);
+    equivalence->source = path;
+
+    TRACE_Cursor cursor = TRACE_Begin(&reader);
+    TRACE_Packet packet;
+    while (TRACE_Next(&reader, &cursor, &packet)) {
+        if (packet.direction == TRACE_INBOUND) {
+            AMCOM_Deserialize(&receiver, packet.data, packet.size);
+        }
+    }
+    TRACE_CloseReader(&reader);
+    return true;
+}
+
+static void addObjects(Equivalence* equivalence, uint8_t type, uint16_t firstNumber, uint32_t count, uint32_t* seed) {
+    AMCOM_ObjectUpdateRequestPayload update;
+    uint32_t pending = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        AMCOM_ObjectState* object = &update.objectState[pending++];
+        object->objectType = type;
+        object->objectNo = (uint16_t)(firstNumber + i);
+        object->hp = (int8_t)(1 + benchRandom(seed) % 60);
+        object->x = (float)(benchRandom(seed) % 1000) * MAP_SIZE / 1000.0f;
+        object->y = (float)(benchRandom(seed) % 1000) * MAP_SIZE / 1000.0f;
+        if (pending == AMCOM_MAX_OBJECT_UPDATES || i + 1 == count) {
+            deliver(equivalence, AMCOM_OBJECT_UPDATE_REQUEST, &update, pending * sizeof(AMCOM_ObjectState));
+            pending = 0;
+        }
+    }
+}
+
+/**
+ * Compares the decisions in generated worlds (used when no trace is given)
+ */
+static void compareGenerated(Equivalence* equivalence) {
+    uint32_t seed = 0xE9u;
+    equivalence->source = "generated";
+    for (int world = 0; world < WORLDS; ++world) {
+        AMCOM_NewGameRequestPayload newGame = { MY_PLAYER_NUMBER, 8, MAP_SIZE, MAP_SIZE };
+        deliver(equivalence, AMCOM_NEW_GAME_REQUEST, &newGame, sizeof(newGame));
+        addObjects(equivalence, 0, MY_PLAYER_NUMBER + 1, 7, &seed);
+        addObjects(equivalence, 1, 0, 20 + benchRandom(&seed) % 100, &seed);
+        addObjects(equivalence, 2, 0, 5 + benchRandom(&seed) % 30, &seed);
+        addObjects(equivalence, 3, 0, benchRandom(&seed) % 8, &seed);
+        for (int p = 0; p < POSITIONS; ++p) {
+            AMCOM_ObjectState me = { 0, MY_PLAYER_NUMBER, (int8_t)(1 + benchRandom(&seed) % 60),
+                                     (float)(benchRandom(&seed) % 1000), (float)(benchRandom(&seed) % 1000) };
+            deliver(equivalence, AMCOM_OBJECT_UPDATE_REQUEST, &me, sizeof(me));
+            AMCOM_MoveRequestPayload move = { (uint32_t)p };
+            deliver(equivalence, AMCOM_MOVE_REQUEST, &move, sizeof(move));
+        }
+    }
+}
+
+static void printLatency(const char* name, const HISTOGRAM_Histogram* histogram, uint64_t total, uint64_t states) {
+    printf("%-10s %10.1f %10llu %10llu\n", name, (double)total / (double)states,
+           (unsigned long long)HISTOGRAM_Percentile(histogram, 0.5),
+           (unsigned long long)HISTOGRAM_Percentile(histogram, 0.99));
+}
+
+int main(int argc, char** argv) {
+    static Equivalence equivalence;
+    static Comparison comparison;
+    comparison.tolerance = 1e-3f;
+    double maxDifferent = 0.001;
+    int firstTrace = argc;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            comparison.tolerance = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max-different") == 0 && i + 1 < argc) {
+            maxDifferent = atof(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            printf("Usage: %s [--tolerance RAD] [--max-different FRACTION] [trace...]\n", argv[0]);
+            return 1;
+        } else {
+            firstTrace = i;
+            break;
+        }
+    }
+    HISTOGRAM_Init(&comparison.referenceLatency);
+    HISTOGRAM_Init(&comparison.currentLatency);
+
+    equivalence.comparison = &comparison;
+    for (int i = firstTrace; i <= argc; ++i) {
+        if (i == argc && firstTrace != argc) break;
+        initGameState(&equivalence.gameState, NULL);
+        if (i < argc) {
+            if (!compareTrace(&equivalence, argv[i])) {
+                return 1;
+            }
+        } else {
+            compareGenerated(&equivalence);
+        }
+        freeGameState(&equivalence.gameState);
+    }
+    if (comparison.states == 0) {
+        printf("No decisions to compare\n");
+        return 1;
+    }
+
+    double states = (double)comparison.states;
+    printf("decisions  %llu\n", (unsigned long long)comparison.states);
+    printf("identical  %llu (%.2f%%)\n", (unsigned long long)comparison.identical, 100.0 * comparison.identical / states);
+    printf("rounding   %llu (%.2f%%), largest difference %.3g rad\n", (unsigned long long)comparison.rounding,
+           100.0 * comparison.rounding / states, comparison.maxRounding);
+    printf("wrapped    %llu (%.2f%%)\n", (unsigned long long)comparison.wrapped, 100.0 * comparison.wrapped / states);
+    printf("different  %llu (%.2f%%)\n", (unsigned long long)comparison.different, 100.0 * comparison.different / states);
+    printf("%-10s %10s %10s %10s\n", "code", "ns/mean", "ns/p50", "ns/p99");
+    printLatency("replaced", &comparison.referenceLatency, comparison.referenceTotal, comparison.states);
+    printLatency("current", &comparison.currentLatency, comparison.currentTotal, comparison.states);
+
+    if (comparison.different > maxDifferent * states) {
+        printf("FAILED: more than %.2f%% of the decisions differ\n", 100.0 * maxDifferent);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ * Measures AMCOM_Deserialize throughput (MB/s and packets/s) on an inbound byte stream.
+ *
+ * Usage: deserialize_bench [stream.bin ...]
+ *
+ * Each file is a raw recording of the bytes received from the game server. Without arguments
+ * a synthetic stream that mimics a game (bursts of full OBJECT_UPDATE packets followed by a
+ * MOVE request every tick) is generated. The stream is fed in chunks of different sizes to
+ * show the cost of packets split across recv() calls versus packets that lie entirely in the
+ * buffer, both for the copying receiver and for the zero-copy view receiver.
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "amcom.h"
+#include "amcom_packets.h"
+#include "bench.h"
+
+#define SYNTHETIC_TICKS 20000
+#define MIN_BENCH_BYTES (256u * 1024u * 1024u)
+
+static size_t receivedPackets;
+
+static void countPacket(const AMCOM_Packet* packet, void* userContext) {
+    (void)userContext;
+    receivedPackets++;
+    benchSink += packet->header.type;
+}
+
+static void countPacketView(const AMCOM_PacketView* packet, void* userContext) {
+    (void)userContext;
+    receivedPackets++;
+    benchSink += packet->header.type;
+}
+
+static uint8_t* generateSyntheticStream(size_t* size) {
+    size_t capacity = (size_t)SYNTHETIC_TICKS * 8 * AMCOM_MAX_PACKET_SIZE;
+    uint8_t* stream = (uint8_t*)malloc(capacity);
+    if (stream == NULL) {
+        return NULL;
+    }
+    uint32_t seed = 0xC0FFEEu;
+    size_t used = 0;
+    for (uint32_t tick = 0; tick < SYNTHETIC_TICKS; ++tick) {
+        // a few full OBJECT_UPDATE packets and one partial one
+        int updates = 1 + (int)(benchRandom(&seed) % 6);
+        for (int u = 0; u < updates; ++u) {
+            AMCOM_ObjectUpdateRequestPayload update;
+            int objects = (u == updates - 1) ? 1 + (int)(benchRandom(&seed) % AMCOM_MAX_OBJECT_UPDATES)
+                                             : AMCOM_MAX_OBJECT_UPDATES;
+            for (int o = 0; o < objects; ++o) {
+                update.objectState[o].objectType = (uint8_t)(benchRandom(&seed) % 4);
+                update.objectState[o].objectNo = (uint16_t)(benchRandom(&seed) % 100);
+                update.objectState[o].hp = (int8_t)(benchRandom(&seed) % 50);
+                update.objectState[o].x = (float)(benchRandom(&seed) % 1000);
+                update.objectState[o].y = (float)(benchRandom(&seed) % 1000);
+            }
+            used += AMCOM_Serialize(AMCOM_OBJECT_UPDATE_REQUEST, &update,
+                                    objects * sizeof(AMCOM_ObjectState), stream + used);
+        }
+        AMCOM_MoveRequestPayload move = { tick };
+        used += AMCOM_Serialize(AMCOM_MOVE_REQUEST, &move, sizeof(move), stream + used);
+    }
+    *size = used;
+    return stream;
+}
+
+static uint8_t* loadStream(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t* stream = (length > 0) ? (uint8_t*)malloc((size_t)length) : NULL;
+    if (stream == NULL || fread(stream, 1, (size_t)length, file) != (size_t)length) {
+        free(stream);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+    *size = (size_t)length;
+    return stream;
+}
+
+static void benchReceiver(const uint8_t* stream, size_t size, bool viewMode) {
+    static const size_t chunkSizes[] = { 1, 7, 64, 512, 4096, 65536 };
+
+    for (size_t c = 0; c < sizeof(chunkSizes) / sizeof(chunkSizes[0]); ++c) {
+        size_t chunk = chunkSizes[c];
+        size_t passes = 1 + MIN_BENCH_BYTES / size / (chunk < 64 ? 8 : 1);
+        AMCOM_Receiver receiver;
+        if (viewMode) {
+            AMCOM_InitViewReceiver(&receiver, countPacketView, NULL);
+        } else {
+            AMCOM_InitReceiver(&receiver, countPacket, NULL);
+        }
+        receivedPackets = 0;
+
+        uint64_t start = benchNowNs();
+        for (size_t pass = 0; pass < passes; ++pass) {
+            for (size_t offset = 0; offset < size; offset += chunk) {
+                size_t n = (size - offset < chunk) ? size - offset : chunk;
+                AMCOM_Deserialize(&receiver, stream + offset, n);
+            }
+        }
+        double seconds = (double)(benchNowNs() - start) / 1e9;
+        double bytes = (double)size * (double)passes;
+        printf("%6s %10zu %12.1f %14.0f\n", viewMode ? "view" : "copy", chunk,
+               bytes / seconds / 1e6, (double)receivedPackets / seconds);
+    }
+}
+
+static void benchStream(const char* name, const uint8_t* stream, size_t size) {
+    printf("%s: %zu bytes\n", name, size);
+    printf("%6s %10s %12s %14s\n", "mode", "chunk [B]", "MB/s", "packets/s");
+    benchReceiver(stream, size, false);
+    benchReceiver(stream, size, true);
+    printf("\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        size_t size = 0;
+        uint8_t* stream = generateSyntheticStream(&size);
+        if (stream == NULL) {
+            printf("Out of memory\n");
+            return 1;
+        }
+        benchStream("synthetic game stream", stream, size);
+        free(stream);
+        return 0;
+    }
+    for (int a = 1; a < argc; ++a) {
+        size_t size = 0;
+        uint8_t* stream = loadStream(argv[a], &size);
+        if (stream == NULL) {
+            printf("Unable to read %s\n", argv[a]);
+            return 1;
+        }
+        benchStream(argv[a], stream, size);
+        free(stream);
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+/**
+ * Compares the cost of logging one decision line on the move path: formatting it with fprintf into a file
+ * (what the player did before) and queuing a binary record for the logger thread.
+ *
+ * Usage: log_bench
+ *
+ * Both methods write into a temporary file. The records are queued in bursts of one ring capacity, so nothing
+ * should be dropped - the program fails if the logger lost records.
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include "log.h"
+#include "bench.h"
+
+#define RING_CAPACITY 4096
+#define BURSTS 64
+
+int main(void) {
+    FILE* file = tmpfile();
+    if (file == NULL) {
+        printf("Unable to create a temporary file\n");
+        return 1;
+    }
+    uint32_t seed = 0x106u;
+    const uint32_t lines = BURSTS * RING_CAPACITY;
+
+    uint64_t start = benchNowNs();
+    for (uint32_t i = 0; i < lines; ++i) {
+        float x = (float)(benchRandom(&seed) % 10000) * 0.1f;
+        float y = (float)(benchRandom(&seed) % 10000) * 0.1f;
+        fprintf(file, "COLLECTING food at (%.1f, %.1f), score=%.2f\n", x, y, x / (y + 1.0f));
+    }
+    fflush(file);
+    uint64_t printfNs = benchNowNs() - start;
+
+    LOG_Logger* logger = LOG_Create(file, LOG_LEVEL_DEBUG, 1, RING_CAPACITY);
+    if (logger == NULL) {
+        printf("Logging is not available (compiled out?)\n");
+        fclose(file);
+        return 0;
+    }
+    uint64_t queueNs = 0;
+#if MNIAM_LOG_ENABLED
+    LOG_Ring* ring = LOG_GetRing(logger, 0);
+    for (int b = 0; b < BURSTS; ++b) {
+        start = benchNowNs();
+        for (uint32_t i = 0; i < RING_CAPACITY; ++i) {
+            float x = (float)(benchRandom(&seed) % 10000) * 0.1f;
+            float y = (float)(benchRandom(&seed) % 10000) * 0.1f;
+            LOG_WRITE(ring, LOG_EVENT_COLLECT, (uint32_t)i, x, y, x / (y + 1.0f));
+        }
+        queueNs += benchNowNs() - start;
+        // let the logger thread empty the ring before the next burst
+        PLATFORM_SleepMs(20);
+    }
+#endif
+
+    start = benchNowNs();
+    uint64_t dropped = LOG_DroppedCount(logger);
+    LOG_Destroy(logger);
+    uint64_t drainNs = benchNowNs() - start;
+    fclose(file);
+
+    printf("%10s %14s %14s %16s %10s\n", "lines", "fprintf [ns]", "queue [ns]", "final drain [us]", "dropped");
+    printf("%10u %14.1f %14.1f %16.1f %10llu\n", lines, (double)printfNs / lines, (double)queueNs / lines,
+           (double)drainNs / 1e3, (unsigned long long)dropped);
+    return dropped == 0 ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+/**
+ * Compares the incremental D* Lite repair of the navigation grid (nav.h) with searching from scratch on every tick.
+ *
+ * Usage: nav_bench
+ *
+ * Worlds with glue spots and moving sparks are generated deterministically; a walker follows the waypoints to a
+ * goal that is replaced when reached. Two grids see the same object moves: one keeps its search between the
+ * ticks, the other forgets it before every waypoint. The path costs of both must be the same on every tick -
+ * the program fails otherwise.
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <math.h>
+#include "nav.h"
+#include "bench.h"
+
+#define MAP_SIZE 1000.0f
+#define CELL_SIZE 25.0f
+#define GLUE_RADIUS 100.0f
+#define SPARK_ZONE_RADIUS 50.0f
+#define SPARK_SPEED 3.0f
+#define WALKER_SPEED 5.0f
+#define TICKS 5000
+#define MAX_SPARKS 100
+
+typedef struct {
+    float x, y, vx, vy;
+} Spark;
+
+static int compareNs(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static float randomCoordinate(uint32_t* seed) {
+    return (float)(benchRandom(seed) % 100000) * MAP_SIZE / 100000.0f;
+}
+
+int main(void) {
+    static const uint32_t sparkCounts[] = { 10, 30, 100 };
+    const float radii[NAV_LAYER_COUNT] = { GLUE_RADIUS, SPARK_ZONE_RADIUS };
+    const float penalties[NAV_LAYER_COUNT] = { 19.0f, 100.0f };
+    static Spark sparks[MAX_SPARKS];
+    bool identical = true;
+
+    printf("%8s %14s %14s %14s %14s %12s\n", "sparks", "repair [us]", "p99 [us]", "scratch [us]", "p99 [us]", "expanded");
+    for (size_t c = 0; c < sizeof(sparkCounts) / sizeof(sparkCounts[0]); ++c) {
+        uint32_t sparkCount = sparkCounts[c];
+        uint32_t seed = 0x4A7u ^ sparkCount;
+        NAV_Grid incremental, scratch;
+        NAV_Init(&incremental);
+        NAV_Init(&scratch);
+        NAV_Reset(&incremental, MAP_SIZE, MAP_SIZE, CELL_SIZE, radii, penalties);
+        NAV_Reset(&scratch, MAP_SIZE, MAP_SIZE, CELL_SIZE, radii, penalties);
+        for (int g = 0; g < 10; ++g) {
+            float x = randomCoordinate(&seed), y = randomCoordinate(&seed);
+            NAV_Move(&incremental, NAV_GLUE, false, 0, 0, true, x, y);
+            NAV_Move(&scratch, NAV_GLUE, false, 0, 0, true, x, y);
+        }
+        for (uint32_t s = 0; s < sparkCount; ++s) {
+            float direction = (float)(benchRandom(&seed) % 3600) * (float)M_PI / 1800.0f;
+            sparks[s].x = randomCoordinate(&seed);
+            sparks[s].y = randomCoordinate(&seed);
+            sparks[s].vx = SPARK_SPEED * cosf(direction);
+            sparks[s].vy = SPARK_SPEED * sinf(direction);
+            NAV_Move(&incremental, NAV_SPARK, false, 0, 0, true, sparks[s].x, sparks[s].y);
+            NAV_Move(&scratch, NAV_SPARK, false, 0, 0, true, sparks[s].x, sparks[s].y);
+        }
+
+        float walkerX = randomCoordinate(&seed), walkerY = randomCoordinate(&seed);
+        float goalX = randomCoordinate(&seed), goalY = randomCoordinate(&seed);
+        static uint64_t repairNs[TICKS], scratchNs[TICKS];
+        uint32_t measured = 0;
+        uint64_t expansionsBefore = incremental.stats.expansions;
+        for (int t = 0; t < TICKS; ++t) {
+            for (uint32_t s = 0; s < sparkCount; ++s) {
+                Spark* spark = &sparks[s];
+                float oldX = spark->x, oldY = spark->y;
+                spark->x += spark->vx;
+                spark->y += spark->vy;
+                if (spark->x < 0.0f || spark->x > MAP_SIZE) spark->vx = -spark->vx;
+                if (spark->y < 0.0f || spark->y > MAP_SIZE) spark->vy = -spark->vy;
+                spark->x = fminf(fmaxf(spark->x, 0.0f), MAP_SIZE);
+                spark->y = fminf(fmaxf(spark->y, 0.0f), MAP_SIZE);
+                NAV_Move(&incremental, NAV_SPARK, true, oldX, oldY, true, spark->x, spark->y);
+                NAV_Move(&scratch, NAV_SPARK, true, oldX, oldY, true, spark->x, spark->y);
+            }
+
+            float waypointX, waypointY, scratchX, scratchY;
+            uint64_t start = benchNowNs();
+            bool routed = NAV_NextWaypoint(&incremental, walkerX, walkerY, goalX, goalY, &waypointX, &waypointY);
+            uint64_t middle = benchNowNs();
+            NAV_Forget(&scratch);
+            bool scratchRouted = NAV_NextWaypoint(&scratch, walkerX, walkerY, goalX, goalY, &scratchX, &scratchY);
+            uint64_t end = benchNowNs();
+            repairNs[measured] = middle - start;
+            scratchNs[measured] = end - middle;
+            measured++;
+
+            float incrementalCost = NAV_PathCost(&incremental), scratchCost = NAV_PathCost(&scratch);
+            if (routed != scratchRouted || incrementalCost != scratchCost) {
+                printf("tick %d: path cost %.3f after repair, %.3f from scratch\n", t, incrementalCost, scratchCost);
+                identical = false;
+            }
+
+            if (!routed) {
+                waypointX = goalX;
+                waypointY = goalY;
+            }
+            float dx = waypointX - walkerX, dy = waypointY - walkerY;
+            float distance = sqrtf(dx*dx + dy*dy);
+            if (distance <= WALKER_SPEED) {
+                walkerX = waypointX;
+                walkerY = waypointY;
+            } else {
+                walkerX += dx * WALKER_SPEED / distance;
+                walkerY += dy * WALKER_SPEED / distance;
+            }
+            float goalDx = goalX - walkerX, goalDy = goalY - walkerY;
+            if (goalDx*goalDx + goalDy*goalDy < CELL_SIZE * CELL_SIZE) {
+                goalX = randomCoordinate(&seed);
+                goalY = randomCoordinate(&seed);
+            }
+        }
+
+        uint64_t repairTotal = 0, scratchTotal = 0;
+        for (uint32_t i = 0; i < measured; ++i) {
+            repairTotal += repairNs[i];
+            scratchTotal += scratchNs[i];
+        }
+        qsort(repairNs, measured, sizeof(uint64_t), compareNs);
+        qsort(scratchNs, measured, sizeof(uint64_t), compareNs);
+        printf("%8u %14.1f %14.1f %14.1f %14.1f %12.1f\n", sparkCount,
+               repairTotal / 1000.0 / measured, repairNs[measured * 99 / 100] / 1000.0,
+               scratchTotal / 1000.0 / measured, scratchNs[measured * 99 / 100] / 1000.0,
+               (double)(incremental.stats.expansions - expansionsBefore) / measured);
+        NAV_Free(&incremental);
+        NAV_Free(&scratch);
+    }
+    printf("%s\n", identical ? "path costs identical" : "PATH COSTS DIFFER");
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,108 @@
+/**
+ * Compares the per-target glue occlusion test that calculateMovement used to run (three atan2f calls for every
+ * target x glue pair) with the occlusion map (OCCLUSION_Build once per decision, then one lookup per target).
+ *
+ * Usage: occlusion_bench
+ *
+ * Maps with 10 to 10000 glue spots are generated deterministically and every target must be classified the same
+ * way by both methods - the program fails otherwise.
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "objtable.h"
+#include "occlusion.h"
+#include "bench.h"
+
+#define GLUE_RADIUS 100.0f
+#define TARGETS 1000
+#define OBSERVERS 16
+
+/// The glue test as it was written in calculateMovement
+static bool isPathBlockedByGlue(const OBJTABLE_Table* glue, float myX, float myY, float dx, float dy, float distance) {
+    for (uint32_t j = 0; j < glue->count; ++j) {
+        if (glue->hp[j] <= 0) continue;
+
+        float glueX = glue->x[j] - myX;
+        float glueY = glue->y[j] - myY;
+        float glueDistance = sqrtf(glueX*glueX + glueY*glueY) - GLUE_RADIUS;
+
+        if (glueDistance < distance) {
+            float glueAngle = atan2f(GLUE_RADIUS, glueDistance);
+            float targetAngle = atan2f(dy, dx);
+            float glueTargetAngle = atan2f(glueY, glueX);
+
+            if (targetAngle < glueTargetAngle + glueAngle &&
+                targetAngle > glueTargetAngle - glueAngle) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int main(void) {
+    static const uint32_t glueCounts[] = { 10, 100, 1000, 10000 };
+    static float targetX[TARGETS], targetY[TARGETS];
+    bool identical = true;
+
+    printf("%8s %16s %16s %14s %10s\n", "glue", "atan2f [ns/tgt]", "lookup [ns/tgt]", "build [us]", "blocked");
+    for (size_t c = 0; c < sizeof(glueCounts) / sizeof(glueCounts[0]); ++c) {
+        uint32_t glueCount = glueCounts[c];
+        float mapSize = 300.0f * sqrtf((float)glueCount);
+        uint32_t seed = 0x61DEu ^ glueCount;
+
+        OBJTABLE_Table glue;
+        OBJTABLE_Init(&glue, glueCount);
+        for (uint32_t i = 0; i < glueCount; ++i) {
+            AMCOM_ObjectState spot = { 3, (uint16_t)i, 1,
+                                       (float)(benchRandom(&seed) % 100000) * mapSize / 100000.0f,
+                                       (float)(benchRandom(&seed) % 100000) * mapSize / 100000.0f };
+            OBJTABLE_Upsert(&glue, &spot);
+        }
+        OCCLUSION_Map map;
+        OCCLUSION_Init(&map);
+
+        uint64_t referenceNs = 0, lookupNs = 0, buildNs = 0;
+        uint32_t blocked = 0;
+        for (int o = 0; o < OBSERVERS; ++o) {
+            float myX = (float)(benchRandom(&seed) % 1000) * mapSize / 1000.0f;
+            float myY = (float)(benchRandom(&seed) % 1000) * mapSize / 1000.0f;
+            for (int t = 0; t < TARGETS; ++t) {
+                targetX[t] = (float)(benchRandom(&seed) % 100000) * mapSize / 100000.0f - myX;
+                targetY[t] = (float)(benchRandom(&seed) % 100000) * mapSize / 100000.0f - myY;
+            }
+
+            static bool reference[TARGETS];
+            uint64_t start = benchNowNs();
+            for (int t = 0; t < TARGETS; ++t) {
+                float distance = sqrtf(targetX[t]*targetX[t] + targetY[t]*targetY[t]);
+                reference[t] = isPathBlockedByGlue(&glue, myX, myY, targetX[t], targetY[t], distance);
+            }
+            referenceNs += benchNowNs() - start;
+
+            start = benchNowNs();
+            OCCLUSION_Build(&map, &glue, myX, myY, GLUE_RADIUS);
+            uint64_t built = benchNowNs();
+            buildNs += built - start;
+            for (int t = 0; t < TARGETS; ++t) {
+                float distance = sqrtf(targetX[t]*targetX[t] + targetY[t]*targetY[t]);
+                bool result = OCCLUSION_IsBlocked(&map, targetX[t], targetY[t], distance);
+                if (result != reference[t]) {
+                    printf("MISMATCH: %u glue spots, observer %d, target %d\n", glueCount, o, t);
+                    identical = false;
+                }
+                blocked += result;
+            }
+            lookupNs += benchNowNs() - built;
+        }
+        printf("%8u %16.1f %16.1f %14.1f %9.1f%%\n", glueCount,
+               (double)referenceNs / (OBSERVERS * TARGETS), (double)lookupNs / (OBSERVERS * TARGETS),
+               (double)buildNs / OBSERVERS / 1e3, 100.0 * blocked / (OBSERVERS * TARGETS));
+        OCCLUSION_Free(&map);
+        OBJTABLE_Free(&glue);
+    }
+    return identical ? 0 : 1;
+}
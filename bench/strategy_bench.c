@@ -0,0 +1,99 @@
+/**
+ * Measures calculateMovement() in a game-sized world where the strategy parameters decide the outcome:
+ * sparks, stronger and weaker players around us, glue and food. Used to compare the development build
+ * (parameters loaded at run time) with a build specialized for a parameter file (MNIAM_STRATEGY_PARAMS).
+ *
+ * Usage: strategy_bench [checksum]
+ *
+ * Prints the time per decision and a checksum of all chosen angles. Builds with the same parameters must make
+ * the same decisions, so the checksum printed by one build can be passed to the other - the program fails if
+ * it differs.
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bot.h"
+#include "params.h"
+#include "bench.h"
+
+#define MAP_SIZE 1000.0f
+#define POSITIONS 256
+#define REPEATS 200
+#define MY_PLAYER_NUMBER 0
+
+static void deliver(GameState* gameState, uint8_t type, const void* payload, size_t size) {
+    AMCOM_PacketView view;
+    memset(&view, 0, sizeof(view));
+    view.header.type = type;
+    view.header.length = (uint8_t)size;
+    view.payload = (const uint8_t*)payload;
+    view.payloadSize = size;
+    if (type == AMCOM_OBJECT_UPDATE_REQUEST) {
+        processObjectUpdate(gameState, &view);
+    } else {
+        uint8_t response[AMCOM_MAX_PACKET_SIZE];
+        handleGamePacket(gameState, &view, response);
+    }
+}
+
+static void addObjects(GameState* gameState, uint8_t type, uint16_t firstNumber, uint32_t count, uint32_t* seed) {
+    AMCOM_ObjectUpdateRequestPayload update;
+    uint32_t pending = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        AMCOM_ObjectState* object = &update.objectState[pending++];
+        object->objectType = type;
+        object->objectNo = (uint16_t)(firstNumber + i);
+        object->hp = (int8_t)(1 + benchRandom(seed) % 60);
+        object->x = (float)(benchRandom(seed) % 1000) * MAP_SIZE / 1000.0f;
+        object->y = (float)(benchRandom(seed) % 1000) * MAP_SIZE / 1000.0f;
+        if (pending == AMCOM_MAX_OBJECT_UPDATES || i + 1 == count) {
+            deliver(gameState, AMCOM_OBJECT_UPDATE_REQUEST, &update, pending * sizeof(AMCOM_ObjectState));
+            pending = 0;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    GameState gameState;
+    initGameState(&gameState, NULL);
+    AMCOM_NewGameRequestPayload newGame = { MY_PLAYER_NUMBER, 8, MAP_SIZE, MAP_SIZE };
+    deliver(&gameState, AMCOM_NEW_GAME_REQUEST, &newGame, sizeof(newGame));
+    uint32_t seed = 0x57A7u;
+    addObjects(&gameState, 0, MY_PLAYER_NUMBER + 1, 7, &seed);
+    addObjects(&gameState, 1, 0, 100, &seed);
+    addObjects(&gameState, 2, 0, 20, &seed);
+    addObjects(&gameState, 3, 0, 5, &seed);
+
+    uint32_t checksum = 2166136261u;
+    uint64_t elapsed = 0;
+    for (int p = 0; p < POSITIONS; ++p) {
+        AMCOM_ObjectState me = { 0, MY_PLAYER_NUMBER, (int8_t)(1 + benchRandom(&seed) % 60),
+                                 (float)(benchRandom(&seed) % 1000), (float)(benchRandom(&seed) % 1000) };
+        deliver(&gameState, AMCOM_OBJECT_UPDATE_REQUEST, &me, sizeof(me));
+
+        float angle = 0.0f;
+        uint64_t start = benchNowNs();
+        for (int r = 0; r < REPEATS; ++r) {
+            gameState.konamiIndex = 0;
+            angle = calculateMovement(&gameState);
+        }
+        elapsed += benchNowNs() - start;
+
+        // FNV-1a over the bits of the angle
+        uint32_t bits;
+        memcpy(&bits, &angle, sizeof(bits));
+        for (int b = 0; b < 4; ++b) {
+            checksum = (checksum ^ ((bits >> (8 * b)) & 0xFFu)) * 16777619u;
+        }
+    }
+    freeGameState(&gameState);
+
+    printf("strategy parameters: %s\n", PARAMS_FIXED ? "compiled in (MNIAM_STRATEGY_PARAMS)" : "runtime (defaults)");
+    printf("%14.1f ns/decision, checksum %08x\n", (double)elapsed / ((double)POSITIONS * REPEATS), checksum);
+    if (argc > 1 && strtoul(argv[1], NULL, 16) != checksum) {
+        printf("MISMATCH: expected checksum %s\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+/**
+ * Measures the cost of recording packets into a trace and of seeking in the recorded trace.
+ *
+ * Usage: trace_bench [file]
+ *
+ * A number of games is recorded (NEW_GAME, then MOVE.request/MOVE.response pairs with object updates in
+ * between), the trace is mapped and every packet read back is compared with what was recorded. Seeks to random
+ * game times are checked against a linear scan, once through the block index and once through the block
+ * headers only (as for a trace whose recorder did not finish) - the program fails on any difference.
+ */
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include "amcom.h"
+#include "amcom_packets.h"
+#include "trace.h"
+#include "bench.h"
+
+#define GAMES 4
+#define MOVES_PER_GAME 20000
+#define SEEKS 10000
+
+static uint32_t recordPacket(TRACE_Recorder* recorder, TRACE_Direction direction, uint64_t timestamp,
+                             uint8_t type, const void* payload, size_t payloadSize) {
+    uint8_t buffer[AMCOM_MAX_PACKET_SIZE];
+    size_t size = AMCOM_Serialize(type, payload, payloadSize, buffer);
+    TRACE_Record(recorder, direction, timestamp, (const AMCOM_PacketHeader*)buffer, buffer + sizeof(AMCOM_PacketHeader));
+    return (uint32_t)size;
+}
+
+/// Position of the first packet with a key >= the given one, found by reading the whole trace
+static uint64_t linearSeek(const TRACE_Reader* reader, uint16_t game, uint32_t gameTime, uint64_t* timestamp) {
+    TRACE_Cursor cursor = TRACE_Begin(reader);
+    TRACE_Packet packet;
+    uint64_t position = 0;
+    while (TRACE_Next(reader, &cursor, &packet)) {
+        if (TRACE_Key(packet.game, packet.gameTime) >= TRACE_Key(game, gameTime)) {
+            *timestamp = packet.timestampNs;
+            return position;
+        }
+        position++;
+    }
+    *timestamp = UINT64_MAX;
+    return position;
+}
+
+static bool checkSeeks(const TRACE_Reader* reader, const char* label) {
+    uint32_t seed = 0x5EE7u;
+    uint64_t elapsed = 0;
+    bool identical = true;
+    for (int s = 0; s < SEEKS; ++s) {
+        uint16_t game = (uint16_t)(1 + benchRandom(&seed) % GAMES);
+        uint32_t gameTime = benchRandom(&seed) % (MOVES_PER_GAME + 10);
+        uint64_t start = benchNowNs();
+        TRACE_Cursor cursor = TRACE_Seek(reader, game, gameTime);
+        elapsed += benchNowNs() - start;
+
+        TRACE_Packet packet;
+        uint64_t timestamp = TRACE_Next(reader, &cursor, &packet) ? packet.timestampNs : UINT64_MAX;
+        if (s % 100 == 0) {
+            uint64_t expected;
+            linearSeek(reader, game, gameTime, &expected);
+            if (expected != timestamp) {
+                printf("MISMATCH (%s): seek to game %u time %u\n", label, game, gameTime);
+                identical = false;
+            }
+        }
+    }
+    printf("%-28s %10.1f ns/seek\n", label, (double)elapsed / SEEKS);
+    return identical;
+}
+
+int main(int argc, char** argv) {
+    const char* path = (argc > 1) ? argv[1] : "trace_bench.trace";
+    TRACE_Recorder* recorder = TRACE_CreateRecorder(path, 0);
+    if (recorder == NULL) {
+        printf("Unable to create %s\n", path);
+        return 1;
+    }
+
+    // timestamps are packet numbers, so every packet can be identified when it is read back
+    uint64_t packets = 0, bytes = 0;
+    uint32_t seed = 0x7ACEu;
+    uint64_t start = benchNowNs();
+    for (int g = 0; g < GAMES; ++g) {
+        AMCOM_NewGameRequestPayload newGame = { 0, 8, 1000.0f, 1000.0f };
+        bytes += recordPacket(recorder, TRACE_INBOUND, packets++, AMCOM_NEW_GAME_REQUEST, &newGame, sizeof(newGame));
+        AMCOM_NewGameResponsePayload hello = { "hello" };
+        bytes += recordPacket(recorder, TRACE_OUTBOUND, packets++, AMCOM_NEW_GAME_RESPONSE, &hello, sizeof(hello));
+        for (uint32_t t = 1; t <= MOVES_PER_GAME; ++t) {
+            AMCOM_ObjectUpdateRequestPayload update;
+            uint32_t objects = 1 + benchRandom(&seed) % AMCOM_MAX_OBJECT_UPDATES;
+            for (uint32_t i = 0; i < objects; ++i) {
+                AMCOM_ObjectState object = { (uint8_t)(i % 4), (uint16_t)i, 10, (float)t, (float)i };
+                update.objectState[i] = object;
+            }
+            bytes += recordPacket(recorder, TRACE_INBOUND, packets++, AMCOM_OBJECT_UPDATE_REQUEST, &update,
+                                  objects * sizeof(AMCOM_ObjectState));
+            AMCOM_MoveRequestPayload move = { t };
+            bytes += recordPacket(recorder, TRACE_INBOUND, packets++, AMCOM_MOVE_REQUEST, &move, sizeof(move));
+            AMCOM_MoveResponsePayload response = { 0.5f };
+            bytes += recordPacket(recorder, TRACE_OUTBOUND, packets++, AMCOM_MOVE_RESPONSE, &response, sizeof(response));
+        }
+    }
+    uint64_t recordNs = benchNowNs() - start;
+    start = benchNowNs();
+    bool closed = TRACE_CloseRecorder(recorder);
+    uint64_t closeNs = benchNowNs() - start;
+    if (!closed) {
+        printf("Writing %s failed\n", path);
+        return 1;
+    }
+    printf("%-28s %10.1f ns/packet (%llu packets, %llu bytes), close %.1f us\n", "record",
+           (double)recordNs / packets, (unsigned long long)packets, (unsigned long long)bytes, closeNs / 1e3);
+
+    TRACE_Reader reader;
+    if (!TRACE_OpenReader(&reader, path)) {
+        printf("Unable to read %s\n", path);
+        return 1;
+    }
+    bool identical = true;
+    TRACE_Cursor cursor = TRACE_Begin(&reader);
+    TRACE_Packet packet;
+    uint64_t count = 0;
+    start = benchNowNs();
+    while (TRACE_Next(&reader, &cursor, &packet)) {
+        if (packet.timestampNs != count || packet.data[0] != 0xA1 || packet.size != 5u + packet.data[2]) {
+            identical = false;
+        }
+        count++;
+    }
+    uint64_t scanNs = benchNowNs() - start;
+    if (count != packets) {
+        identical = false;
+    }
+    printf("%-28s %10.1f ns/packet (%u blocks)\n", "sequential read", (double)scanNs / count, reader.blockCount);
+
+    identical = checkSeeks(&reader, "seek (block index)") && identical;
+    reader.index = NULL;
+    identical = checkSeeks(&reader, "seek (block headers)") && identical;
+    TRACE_CloseReader(&reader);
+    remove(path);
+
+    if (!identical) {
+        printf("MISMATCH: the trace does not contain the recorded packets\n");
+    }
+    return identical ? 0 : 1;
+}
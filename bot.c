@@ -0,0 +1,1333 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <stdbool.h>
+#include "bot.h"
+#include "kernels.h"
+#include "platform.h"
+
+// Game mechanics constants
+#define PLAYER_BASE_RADIUS 25          // Base player collision radius
+#define SPARK_BASE_RADIUS 25           // Base spark collision radius  
+#define GLUE_RADIUS 100                // Glue area effect radius
+#define PLAYER_SPEED 5.0f              // Distance a player moves per tick outside glue
+
+// Strategy constants (params.h)
+#if PARAMS_FIXED
+#include "params_fixed.h"
+/// Strategy parameter: a constant of the build, folded into the expressions that use it
+#define BOT_PARAM(gameState, name) (PARAMS_FIXED_VALUES.name)
+/// Constant derived from the strategy parameters, computed when the build was configured
+#define BOT_DERIVED(gameState, name) (PARAMS_FIXED_DERIVED.name)
+#else
+/// Strategy parameter of the session (loaded at run time)
+#define BOT_PARAM(gameState, name) ((gameState)->params.name)
+/// Constant derived from the strategy parameters of the session (computed when the game starts)
+#define BOT_DERIVED(gameState, name) ((gameState)->derived.name)
+#endif
+
+// Spatial index configuration
+#define GRID_CELL_SIZE 128.0f          // Preferred cell size of the object grids
+#define GRID_MIN_OBJECTS 128            // Smaller tables are scanned whole by the kernels
+#define FIELD_CELL_SIZE 50.0f          // Preferred cell size of the potential field
+#define NAV_CELL_SIZE 25.0f            // Preferred cell size of the navigation grid
+#define SPARK_ZONE_COST 100.0f         // Cost added to the navigation cells a spark can hit us in
+
+// Memoized target selection
+#define TARGET_SLACK_MARGIN 0.01f      // Distance taken off every slack for the rounding of the scores
+#define GLUE_ANGLE_MARGIN 1e-4f        // Angle taken off the clearance of a glue spot for the rounding of the blocking test
+#define PASS_DANGER 0                  // Memoized passes over the players (positions in MEMO_Class.targets)
+#define PASS_ATTACK 1
+#define PASS_HUNT 2
+#define PASS_ONLY 0                    // The single pass over the sparks or the transistors
+
+/// Queues a log record of the session (formatted and written by the logger thread)
+#define BOT_LOG(gameState, event, ...) LOG_WRITE((gameState)->log, event, (gameState)->currentGameTime, ##__VA_ARGS__)
+
+/**
+ * Resets the game state of a session
+ * @param gameState Game state to initialize
+ * @param log Log ring of the thread serving the session (NULL disables logging)
+ */
+void initGameState(GameState* gameState, LOG_Ring* log) {
+    memset(gameState, 0, sizeof(GameState));
+    OBJTABLE_Init(&gameState->players, MAX_PLAYERS);
+    OBJTABLE_Init(&gameState->transistors, MAX_TRANSISTORS);
+    OBJTABLE_Init(&gameState->sparks, MAX_SPARKS);
+    OBJTABLE_Init(&gameState->glue, MAX_GLUE_SPOTS);
+    SPATIAL_Init(&gameState->playerGrid);
+    SPATIAL_Init(&gameState->transistorGrid);
+    SPATIAL_Init(&gameState->sparkGrid);
+    OCCLUSION_Init(&gameState->glueOcclusion);
+    MOTION_Init(&gameState->playerMotion);
+    MOTION_Init(&gameState->sparkMotion);
+    FIELD_Init(&gameState->field);
+    NAV_Init(&gameState->navigation);
+    MEMO_Init(&gameState->playerTargets);
+    MEMO_Init(&gameState->sparkTargets);
+    MEMO_Init(&gameState->transistorTargets);
+    gameState->targetCaching = true;
+#if PARAMS_FIXED
+    gameState->params = PARAMS_FIXED_VALUES;
+#else
+    PARAMS_Default(&gameState->params);
+#endif
+    gameState->log = log;
+}
+
+/**
+ * Releases the memory owned by the game state of a session
+ * @param gameState Game state to release
+ */
+void freeGameState(GameState* gameState) {
+    OBJTABLE_Free(&gameState->players);
+    OBJTABLE_Free(&gameState->transistors);
+    OBJTABLE_Free(&gameState->sparks);
+    OBJTABLE_Free(&gameState->glue);
+    SPATIAL_Free(&gameState->playerGrid);
+    SPATIAL_Free(&gameState->transistorGrid);
+    SPATIAL_Free(&gameState->sparkGrid);
+    OCCLUSION_Free(&gameState->glueOcclusion);
+    MOTION_Free(&gameState->playerMotion);
+    MOTION_Free(&gameState->sparkMotion);
+    FIELD_Free(&gameState->field);
+    NAV_Free(&gameState->navigation);
+    MEMO_Free(&gameState->playerTargets);
+    MEMO_Free(&gameState->sparkTargets);
+    MEMO_Free(&gameState->transistorTargets);
+    PLATFORM_AlignedFree(gameState->scratchSquaredDistances);
+    PLATFORM_AlignedFree(gameState->scratchScores);
+    free(gameState->scratchIndices);
+    gameState->scratchSquaredDistances = gameState->scratchScores = NULL;
+    gameState->scratchIndices = NULL;
+    gameState->scratchCapacity = 0;
+}
+
+/**
+ * Normalizes angle to range [0, 2π) for consistent direction calculations
+ * @param angle Input angle in radians
+ * @return Normalized angle in range [0, 2π)
+ */
+float normalizeAngle(float angle) {
+    while(angle < 0) angle += 2 * M_PI;
+    while(angle >= 2 * M_PI) angle -= 2 * M_PI;
+    return angle;
+}
+
+/**
+ * Stores an object in its table and keeps the spatial index and the dirty tracking of the table in sync
+ * @param table Table of the object class
+ * @param grid Spatial index of the table
+ * @param memo Memoized targets of the class, NULL if the object is never a target (our own player)
+ * @param object Object data from server
+ */
+static void trackObject(OBJTABLE_Table* table, SPATIAL_Grid* grid, MEMO_Class* memo, const AMCOM_ObjectState* object) {
+    uint32_t count = table->count;
+    int32_t index = OBJTABLE_Upsert(table, object);
+    if(index == OBJTABLE_NOT_FOUND) return;
+    
+    if(table->count != count) {
+        if(!SPATIAL_Insert(grid, table, (uint32_t)index)) {
+            // the grid cannot track an object it has no room for - forget the object entirely
+            OBJTABLE_Remove(table, object->objectNo);
+        }
+    } else {
+        SPATIAL_Move(grid, table, (uint32_t)index);
+    }
+    if(memo != NULL) {
+        MEMO_NoteUpdate(memo, table, index, table->count != count);
+    }
+}
+
+/**
+ * Removes an object from its table and from the spatial index of the table
+ * @param table Table of the object class
+ * @param grid Spatial index of the table
+ * @param memo Memoized targets of the class
+ * @param objectNo Number of the object to remove
+ */
+static void untrackObject(OBJTABLE_Table* table, SPATIAL_Grid* grid, MEMO_Class* memo, uint16_t objectNo) {
+    int32_t index = OBJTABLE_Find(table, objectNo);
+    if(index == OBJTABLE_NOT_FOUND) return;
+    
+    // the table moves its last object into the freed slot
+    MEMO_NoteRemoval(memo);
+    uint32_t last = table->count - 1;
+    SPATIAL_Remove(grid, (uint32_t)index);
+    OBJTABLE_Remove(table, objectNo);
+    if((uint32_t)index != last) {
+        SPATIAL_Relocate(grid, last, (uint32_t)index);
+    }
+}
+
+/**
+ * Updates player list with new player data, removing dead players
+ * @param gameState Game state of the session
+ * @param newPlayer Pointer to new player data from server
+ */
+void updatePlayerList(GameState* gameState, const AMCOM_ObjectState* newPlayer) {
+    // Remove dead players (HP <= 0) from active list, update or add the others
+    if(newPlayer->hp <= 0) {
+        untrackObject(&gameState->players, &gameState->playerGrid, &gameState->playerTargets, newPlayer->objectNo);
+        MOTION_Forget(&gameState->playerMotion, newPlayer->objectNo);
+    } else {
+        // our own moves are measured from our position, not as a drift of the players
+        bool ours = (newPlayer->objectNo == gameState->myPlayerNumber);
+        trackObject(&gameState->players, &gameState->playerGrid, ours ? NULL : &gameState->playerTargets, newPlayer);
+        MOTION_Record(&gameState->playerMotion, newPlayer->objectNo, gameState->currentGameTime, newPlayer->x, newPlayer->y);
+    }
+}
+
+/**
+ * Updates transistor list with new data, evicting eaten transistors
+ * @param gameState Game state of the session
+ * @param newTransistor Pointer to transistor data from server
+ */
+void updateTransistorList(GameState* gameState, const AMCOM_ObjectState* newTransistor) {
+    // an eaten transistor (HP <= 0) is never a target, the decision loops need not skip it over
+    if(newTransistor->hp <= 0) {
+        untrackObject(&gameState->transistors, &gameState->transistorGrid, &gameState->transistorTargets,
+                      newTransistor->objectNo);
+    } else {
+        trackObject(&gameState->transistors, &gameState->transistorGrid, &gameState->transistorTargets, newTransistor);
+    }
+}
+
+/**
+ * Updates spark list with current spark positions, evicting sparks that are gone (HP <= 0)
+ * @param gameState Game state of the session
+ * @param newSpark Pointer to spark data from server
+ */
+void updateSparkList(GameState* gameState, const AMCOM_ObjectState* newSpark) {
+    // a spark is scored by its HP, one without HP is no threat and the decision loops need not skip it over
+    if(newSpark->hp <= 0) {
+        untrackObject(&gameState->sparks, &gameState->sparkGrid, &gameState->sparkTargets, newSpark->objectNo);
+        MOTION_Forget(&gameState->sparkMotion, newSpark->objectNo);
+    } else {
+        trackObject(&gameState->sparks, &gameState->sparkGrid, &gameState->sparkTargets, newSpark);
+        MOTION_Record(&gameState->sparkMotion, newSpark->objectNo, gameState->currentGameTime, newSpark->x, newSpark->y);
+    }
+}
+
+/**
+ * Updates glue spot list with current glue positions, evicting spots that are gone (HP <= 0)
+ * @param gameState Game state of the session
+ * @param newGlue Pointer to glue data from server
+ */
+void updateGlueList(GameState* gameState, const AMCOM_ObjectState* newGlue) {
+    OBJTABLE_Table* glue = &gameState->glue;
+    int32_t index = OBJTABLE_Find(glue, newGlue->objectNo);
+    if(newGlue->hp <= 0) {
+        if(OBJTABLE_Remove(glue, newGlue->objectNo)) gameState->glueVersion++;
+        return;
+    }
+    if(index == OBJTABLE_NOT_FOUND || glue->x[index] != newGlue->x || glue->y[index] != newGlue->y ||
+       glue->hp[index] != newGlue->hp) {
+        gameState->glueVersion++;
+    }
+    OBJTABLE_Upsert(glue, newGlue);
+}
+
+/**
+ * Caches our player's current position and HP for quick access
+ * Called after each object update to maintain current state
+ * @param gameState Game state of the session
+ */
+void updateMyPlayerCache(GameState* gameState) {
+    int32_t me = OBJTABLE_Find(&gameState->players, gameState->myPlayerNumber);
+    gameState->myPlayerFound = (me != OBJTABLE_NOT_FOUND);
+    if(me != OBJTABLE_NOT_FOUND) {
+        gameState->myX = gameState->players.x[me];
+        gameState->myY = gameState->players.y[me];
+        gameState->myHP = gameState->players.hp[me];
+    }
+}
+
+/**
+ * Contribution of one object to the potential field
+ */
+typedef struct {
+    FIELD_Layer layer;                             // Layer the object adds to
+    float x, y;                                    // Position of the object
+    int32_t strength;                              // Multiplier of the kernel (0 = no contribution)
+} FieldContribution;
+
+/**
+ * Table of an object type of OBJECT_UPDATE
+ * @param gameState Game state of the session
+ * @param objectType Type of the object
+ * @return The table or NULL for an unknown type
+ */
+static const OBJTABLE_Table* tableOfType(const GameState* gameState, uint8_t objectType) {
+    switch(objectType) {
+        case 0: return &gameState->players;
+        case 1: return &gameState->transistors;
+        case 2: return &gameState->sparks;
+        case 3: return &gameState->glue;
+        default: return NULL;
+    }
+}
+
+/**
+ * Contribution of a tracked object to the potential field
+ * Transistors attract by their HP, sparks repel by their radius and glue costs its movement penalty. Players are
+ * classified against our HP: stronger ones repel by their radius, weaker ones attract by their HP.
+ * @param gameState Game state of the session
+ * @param objectType Type of the object
+ * @param index Position of the object in the table of its type (OBJTABLE_NOT_FOUND: no contribution)
+ * @param ourHP Our HP the players are classified with
+ * @return Contribution of the object
+ */
+static FieldContribution fieldContribution(const GameState* gameState, uint8_t objectType, int32_t index, float ourHP) {
+    FieldContribution contribution = { FIELD_ATTRACTION, 0.0f, 0.0f, 0 };
+    const OBJTABLE_Table* table = tableOfType(gameState, objectType);
+    if(table == NULL || index == OBJTABLE_NOT_FOUND) return contribution;
+    
+    const float hp = table->hp[index];
+    contribution.x = table->x[index];
+    contribution.y = table->y[index];
+    switch(objectType) {
+        case 0: // Players
+            if(table->objectNo[index] == gameState->myPlayerNumber || hp <= 0) break;
+            if(hp > ourHP) {
+                contribution.layer = FIELD_REPULSION;
+                contribution.strength = (int32_t)(PLAYER_BASE_RADIUS + hp);
+            } else if(hp < ourHP) {
+                contribution.strength = (int32_t)hp;
+            }
+            break;
+        case 1: // Transistors
+            if(hp > 0) contribution.strength = (int32_t)hp;
+            break;
+        case 2: // Sparks
+            if(hp > 0) {
+                contribution.layer = FIELD_REPULSION;
+                contribution.strength = (int32_t)(SPARK_BASE_RADIUS + hp);
+            }
+            break;
+        case 3: // Glue
+            if(hp > 0) {
+                contribution.layer = FIELD_GLUE;
+                contribution.strength = (int32_t)BOT_PARAM(gameState, glueMovementPenalty);
+            }
+            break;
+    }
+    return contribution;
+}
+
+/**
+ * Replaces the contribution of an object to the potential field with a new one
+ * @param gameState Game state of the session
+ * @param before Contribution before the change
+ * @param after Contribution after the change
+ */
+static void moveFieldContribution(GameState* gameState, const FieldContribution* before, const FieldContribution* after) {
+    FIELD_Move(&gameState->field, before->layer, before->x, before->y, before->strength,
+               after->layer, after->x, after->y, after->strength);
+}
+
+/**
+ * Classifies the players of the potential field again after our HP has changed
+ * @param gameState Game state of the session
+ */
+static void reclassifyFieldPlayers(GameState* gameState) {
+    if(!gameState->myPlayerFound || gameState->myHP == gameState->fieldHP) return;
+    for(uint32_t i = 0; i < gameState->players.count; i++) {
+        FieldContribution before = fieldContribution(gameState, 0, (int32_t)i, gameState->fieldHP);
+        FieldContribution after = fieldContribution(gameState, 0, (int32_t)i, gameState->myHP);
+        moveFieldContribution(gameState, &before, &after);
+    }
+    gameState->fieldHP = gameState->myHP;
+}
+
+/**
+ * Builds the potential field of a new map from all tracked objects
+ * @param gameState Game state of the session
+ */
+static void rebuildField(GameState* gameState) {
+    if(!FIELD_Reset(&gameState->field, gameState->mapWidth, gameState->mapHeight, FIELD_CELL_SIZE)) return;
+    gameState->fieldHP = gameState->myHP;
+    for(uint8_t type = 0; type < 4; type++) {
+        const OBJTABLE_Table* table = tableOfType(gameState, type);
+        for(uint32_t i = 0; i < table->count; i++) {
+            FieldContribution contribution = fieldContribution(gameState, type, (int32_t)i, gameState->fieldHP);
+            FIELD_Stamp(&gameState->field, contribution.layer, contribution.x, contribution.y, contribution.strength);
+        }
+    }
+}
+
+/**
+ * Area of the navigation grid covered by one object
+ */
+typedef struct {
+    bool covers;                                   // The object raises the cost of the cells around it
+    NAV_Layer layer;                               // Layer of the cost
+    float x, y;                                    // Position of the object
+} NavCoverage;
+
+/**
+ * Area of the navigation grid covered by a tracked object (glue spots and sparks)
+ * @param gameState Game state of the session
+ * @param objectType Type of the object
+ * @param index Position of the object in the table of its type (OBJTABLE_NOT_FOUND: covers nothing)
+ * @return Coverage of the object
+ */
+static NavCoverage navCoverage(const GameState* gameState, uint8_t objectType, int32_t index) {
+    NavCoverage coverage = { false, NAV_GLUE, 0.0f, 0.0f };
+    const OBJTABLE_Table* table = tableOfType(gameState, objectType);
+    if(table == NULL || index == OBJTABLE_NOT_FOUND) return coverage;
+    
+    coverage.x = table->x[index];
+    coverage.y = table->y[index];
+    if(table->hp[index] > 0 && (objectType == 2 || objectType == 3)) {
+        coverage.covers = true;
+        coverage.layer = (objectType == 2) ? NAV_SPARK : NAV_GLUE;
+    }
+    return coverage;
+}
+
+/**
+ * Builds the navigation grid of a new map from the tracked glue spots and sparks
+ * @param gameState Game state of the session
+ */
+static void rebuildNavigation(GameState* gameState) {
+    const float radii[NAV_LAYER_COUNT] = { GLUE_RADIUS, SPARK_BASE_RADIUS + PLAYER_BASE_RADIUS };
+    const float penalties[NAV_LAYER_COUNT] = { BOT_PARAM(gameState, glueMovementPenalty) - 1.0f, SPARK_ZONE_COST };
+    if(!NAV_Reset(&gameState->navigation, gameState->mapWidth, gameState->mapHeight, NAV_CELL_SIZE, radii, penalties)) return;
+    for(uint8_t type = 2; type <= 3; type++) {
+        const OBJTABLE_Table* table = tableOfType(gameState, type);
+        for(uint32_t i = 0; i < table->count; i++) {
+            NavCoverage coverage = navCoverage(gameState, type, (int32_t)i);
+            NAV_Move(&gameState->navigation, coverage.layer, false, 0.0f, 0.0f, coverage.covers, coverage.x, coverage.y);
+        }
+    }
+}
+
+/**
+ * Direction to a target: straight, or with pathfinding towards the next waypoint of the cheapest path when the
+ * straight line crosses glue or spark zones
+ * @param gameState Game state of the session
+ * @param targetX X of the target
+ * @param targetY Y of the target
+ * @param directionX Receives X of the movement direction
+ * @param directionY Receives Y of the movement direction
+ */
+static void routeToTarget(GameState* gameState, float targetX, float targetY, float* directionX, float* directionY) {
+    float waypointX = targetX, waypointY = targetY;
+    if(gameState->pathfinding) {
+        NAV_NextWaypoint(&gameState->navigation, gameState->myX, gameState->myY, targetX, targetY, &waypointX, &waypointY);
+    }
+    *directionX = waypointX - gameState->myX;
+    *directionY = waypointY - gameState->myY;
+}
+
+/**
+ * Turns a movement direction away from the first spark on the trajectory
+ * Works on the direction vector without trigonometry: the danger zone is checked with squared distances, the
+ * angle between the direction and a spark with a dot product and the side of the spark with a cross product.
+ * With a spark lookahead, a spark approaching us is checked at the point where it comes closest while we move
+ * along the direction (its estimated velocity against ours, at most sparkLookahead ticks ahead)
+ * @param gameState Game state of the session
+ * @param directionX X of the movement direction (towards the target), turned if a spark is on the path
+ * @param directionY Y of the movement direction (towards the target), turned if a spark is on the path
+ */
+void avoidSparkTrajectory(const GameState* gameState, float* directionX, float* directionY) {
+    // A target at our position has angle 0 (atan2f(0, 0)), whatever the signs of the zero offsets are
+    if(*directionX == 0.0f && *directionY == 0.0f) {
+        *directionX = 1.0f;
+        *directionY = 0.0f;
+    }
+    const float baseX = *directionX;
+    const float baseY = *directionY;
+    const float directionSquared = baseX*baseX + baseY*baseY;
+    
+    // Danger zone around us (spark radius + player radius + safety margin)
+    const float dangerRadius = BOT_PARAM(gameState, sparkAvoidanceRadius) + PLAYER_BASE_RADIUS + gameState->myHP;
+    const float dangerRadiusSquared = dangerRadius * dangerRadius;
+    
+    // The spark is on our path if the angle to it is below the avoidance angle: cos(angle) > cos(avoidanceAngle)
+    // with cos(angle) = dot / (|direction| * |spark|). t*|t| is monotonic, so comparing the signed squares of both
+    // sides needs no square root, and unlike a difference of atan2 angles it does not break at +-180 degrees.
+    const float cosine = BOT_DERIVED(gameState, sparkAvoidanceCosine);
+    const float signedCosineSquared = cosine * fabsf(cosine);
+    
+    // Our velocity along the direction, against which approaching sparks are followed
+    const float lookahead = BOT_PARAM(gameState, sparkLookahead);
+    float ourVx = 0.0f, ourVy = 0.0f;
+    if(lookahead > 0) {
+        float scale = PLAYER_SPEED / sqrtf(directionSquared);
+        ourVx = baseX * scale;
+        ourVy = baseY * scale;
+    }
+    
+    // Check each spark for collision risk
+    for(uint32_t i = 0; i < gameState->sparks.count; i++) {
+        float sparkX = gameState->sparks.x[i];
+        float sparkY = gameState->sparks.y[i];
+        float dx = sparkX - gameState->myX;
+        float dy = sparkY - gameState->myY;
+        float squaredDistance = dx*dx + dy*dy;
+        float sideX = dx, sideY = dy;
+        
+        const MOTION_Track* track = (lookahead > 0) ? MOTION_Find(&gameState->sparkMotion, gameState->sparks.objectNo[i]) : NULL;
+        float relativeVx = 0.0f, relativeVy = 0.0f, approach = 0.0f;
+        if(track != NULL) {
+            relativeVx = track->vx - ourVx;
+            relativeVy = track->vy - ourVy;
+            approach = -(dx*relativeVx + dy*relativeVy);
+        }
+        if(approach > 0) {
+            // Collision course: the closest point of the relative motion has to stay out of the danger zone
+            float ticks = fminf(approach / (relativeVx*relativeVx + relativeVy*relativeVy), lookahead);
+            float closestX = dx + relativeVx * ticks;
+            float closestY = dy + relativeVy * ticks;
+            if(!(closestX*closestX + closestY*closestY < dangerRadiusSquared)) continue;
+            if(baseX*closestY - baseY*closestX != 0) {
+                sideX = closestX;
+                sideY = closestY;
+            }
+        } else {
+            if(!(squaredDistance < dangerRadiusSquared)) continue;
+            
+            float dot = baseX*dx + baseY*dy;
+            if(!(dot * fabsf(dot) > signedCosineSquared * directionSquared * squaredDistance)) continue;
+        }
+        
+        BOT_LOG(gameState, LOG_EVENT_SPARK_ON_PATH, sparkX, sparkY, sqrtf(squaredDistance));
+        
+        // Turn away from spark: clockwise if it is on our left (counter-clockwise from the direction)
+        const float evasionSine = BOT_DERIVED(gameState, evasionSine);
+        const float evasionCosine = BOT_DERIVED(gameState, evasionCosine);
+        float sine = (baseX*sideY - baseY*sideX > 0) ? -evasionSine : evasionSine;
+        *directionX = baseX * evasionCosine - baseY * sine;
+        *directionY = baseX * sine + baseY * evasionCosine;
+        
+        BOT_LOG(gameState, LOG_EVENT_ADJUSTED_ANGLE, atan2f(*directionY, *directionX),
+                atan2f(*directionY, *directionX) * 180.0f / M_PI);
+        break; // Only avoid first detected spark
+    }
+}
+
+/**
+ * Moves a player target to where the player will be when we get there, following its estimated velocity for
+ * the time we need to cover the distance (at most playerLookahead ticks, nothing is moved without a lookahead)
+ * @param gameState Game state of the session
+ * @param index Position of the player in the player table
+ * @param targetX X of the target, replaced by the predicted one
+ * @param targetY Y of the target, replaced by the predicted one
+ */
+static void predictPlayerTarget(const GameState* gameState, int32_t index, float* targetX, float* targetY) {
+    const float lookahead = BOT_PARAM(gameState, playerLookahead);
+    if(!(lookahead > 0)) return;
+    const MOTION_Track* track = MOTION_Find(&gameState->playerMotion, gameState->players.objectNo[index]);
+    if(track == NULL) return;
+    
+    float dx = *targetX - gameState->myX;
+    float dy = *targetY - gameState->myY;
+    float ticks = fminf(sqrtf(dx*dx + dy*dy) / PLAYER_SPEED, lookahead);
+    MOTION_Predict(track, ticks, targetX, targetY);
+    // players cannot leave the map
+    *targetX = fminf(fmaxf(*targetX, 0.0f), gameState->mapWidth);
+    *targetY = fminf(fmaxf(*targetY, 0.0f), gameState->mapHeight);
+}
+
+/**
+ * Provides entertainment movement when no targets are available
+ * @param gameState Game state of the session
+ * @return Next angle in the dance sequence
+ */
+float getDanceAngle(GameState* gameState) {
+    // Konami Code directions mapped to angles
+    float konamiSequence[8] = {
+        3 * M_PI / 2,  // Up (270°)
+        3 * M_PI / 2,  // Up (270°)
+        M_PI / 2,      // Down (90°)
+        M_PI / 2,      // Down (90°)
+        M_PI,          // Left (180°)
+        0,             // Right (0°)
+        M_PI,          // Left (180°)
+        0              // Right (0°)
+    };
+    
+    float angle = konamiSequence[gameState->konamiIndex];
+    gameState->konamiIndex = (gameState->konamiIndex + 1) % 8; // Cycle through sequence
+    
+    return angle;
+}
+
+/**
+ * Makes sure the scratch arrays used by the scoring kernels can hold every object class
+ * @param gameState Game state of the session
+ * @return false if memory could not be allocated
+ */
+static bool reserveScratch(GameState* gameState) {
+    uint32_t needed = gameState->players.count;
+    if(gameState->transistors.count > needed) needed = gameState->transistors.count;
+    if(gameState->sparks.count > needed) needed = gameState->sparks.count;
+    if(needed <= gameState->scratchCapacity && gameState->scratchScores != NULL) {
+        return true;
+    }
+    uint32_t capacity = (needed + 63) & ~63u;
+    PLATFORM_AlignedFree(gameState->scratchSquaredDistances);
+    PLATFORM_AlignedFree(gameState->scratchScores);
+    free(gameState->scratchIndices);
+    gameState->scratchSquaredDistances = (float*)PLATFORM_AlignedAlloc(capacity * sizeof(float), KERNELS_ALIGNMENT);
+    gameState->scratchScores = (float*)PLATFORM_AlignedAlloc(capacity * sizeof(float), KERNELS_ALIGNMENT);
+    gameState->scratchIndices = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+    gameState->scratchCapacity = capacity;
+    if(gameState->scratchSquaredDistances == NULL || gameState->scratchScores == NULL || gameState->scratchIndices == NULL) {
+        PLATFORM_AlignedFree(gameState->scratchSquaredDistances);
+        PLATFORM_AlignedFree(gameState->scratchScores);
+        free(gameState->scratchIndices);
+        gameState->scratchSquaredDistances = gameState->scratchScores = NULL;
+        gameState->scratchIndices = NULL;
+        gameState->scratchCapacity = 0;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Checks whether a glue spot lies on the straight path to a target
+ * The glue occlusion map is built on the first check of a decision and shared by the hunt and food passes
+ * @param gameState Game state of the session
+ * @param dx Target X offset from our position
+ * @param dy Target Y offset from our position
+ * @param distance Distance to the target
+ * @return true if the target is behind a glue area
+ */
+static bool isPathBlockedByGlue(GameState* gameState, float dx, float dy, float distance) {
+    if(!gameState->glueOcclusionReady) {
+        if(!OCCLUSION_Build(&gameState->glueOcclusion, &gameState->glue, gameState->myX, gameState->myY, GLUE_RADIUS)) {
+            return false;
+        }
+        gameState->glueOcclusionReady = true;
+    }
+    return OCCLUSION_IsBlocked(&gameState->glueOcclusion, dx, dy, distance);
+}
+
+/**
+ * Scores the objects of a table, either all of them with the kernels or only the candidates from the spatial index
+ * The squared distances and squared scores land in the scratch arrays: entry j belongs to object candidates[j]
+ * (or to object j if candidates is NULL)
+ * @param gameState Game state of the session
+ * @param table Scored objects
+ * @param candidates Positions of the objects to score, NULL to score the whole table
+ * @param count Number of objects to score
+ * @param params Scoring parameters
+ * @param excludedIndex Object that must not be selected (our own player) or -1
+ */
+static void scoreObjects(GameState* gameState, const OBJTABLE_Table* table, const uint32_t* candidates, uint32_t count,
+                         const KERNELS_ScoreParams* params, int32_t excludedIndex) {
+    float* scores = gameState->scratchScores;
+    
+    if(candidates == NULL) {
+        KERNELS_Get()->score(table->x, table->y, table->hp, count, params, gameState->scratchSquaredDistances, scores);
+        if(excludedIndex >= 0) scores[excludedIndex] = 0.0f;
+    } else {
+        KERNELS_ScoreSelected(table->x, table->y, table->hp, candidates, count, params, gameState->scratchSquaredDistances, scores);
+        for(uint32_t j = 0; j < count; j++) {
+            if((int32_t)candidates[j] == excludedIndex) scores[j] = 0.0f;
+        }
+    }
+}
+
+/**
+ * Finds the best scored object within params->maxDistance
+ * Large tables are narrowed down to the objects around us with the spatial index first
+ * @param gameState Game state of the session
+ * @param table Scored objects
+ * @param grid Spatial index of the table
+ * @param params Scoring parameters (maxDistance must be finite)
+ * @param excludedIndex Object that must not be selected (our own player) or -1
+ * @param bestScore Receives the score of the selected object (unchanged if there is none)
+ * @return Position of the selected object in the table or -1
+ */
+static int32_t selectInRange(GameState* gameState, const OBJTABLE_Table* table, const SPATIAL_Grid* grid,
+                             const KERNELS_ScoreParams* params, int32_t excludedIndex, float* bestScore) {
+    const uint32_t* candidates = NULL;
+    uint32_t count = table->count;
+    
+    if(table->count >= GRID_MIN_OBJECTS) {
+        count = SPATIAL_QueryRadius(grid, params->originX, params->originY, params->maxDistance, gameState->scratchIndices);
+        candidates = gameState->scratchIndices;
+    }
+    scoreObjects(gameState, table, candidates, count, params, excludedIndex);
+    
+    // candidates come in ascending order, so the first maximum is the same object a full scan would pick
+    int32_t best = KERNELS_Get()->argMax(gameState->scratchScores, count);
+    if(best < 0) return -1;
+    *bestScore = gameState->scratchScores[best];
+    return (candidates != NULL) ? (int32_t)candidates[best] : best;
+}
+
+/**
+ * Applies the glue penalty to scored objects and updates the best target
+ * Glue only lowers a score, so objects that cannot beat the current best are not checked for glue at all.
+ * Ties go to the lower table position, which makes the result independent of the order the objects come in.
+ * @param gameState Game state of the session (scratch arrays hold the scores)
+ * @param table Scored objects
+ * @param candidates Positions of the scored objects, NULL if the whole table was scored
+ * @param count Number of scored objects
+ * @param best Position of the best target so far (-1 if none), updated
+ * @param bestValue Score of the best target so far, updated
+ */
+static void considerWithGluePenalty(GameState* gameState, const OBJTABLE_Table* table, const uint32_t* candidates,
+                                    uint32_t count, int32_t* best, float* bestValue) {
+    const float* squaredDistances = gameState->scratchSquaredDistances;
+    const float* scores = gameState->scratchScores;
+    const float penaltySquared = BOT_DERIVED(gameState, gluePenaltySquared);
+    
+    for(uint32_t j = 0; j < count; j++) {
+        int32_t i = (candidates != NULL) ? (int32_t)candidates[j] : (int32_t)j;
+        if(!(scores[j] > *bestValue || (scores[j] == *bestValue && scores[j] > 0 && i < *best))) continue;
+        
+        // only the objects that can still win need their distance for the glue check
+        float value = scores[j];
+        float dx = table->x[i] - gameState->myX;
+        float dy = table->y[i] - gameState->myY;
+        if(isPathBlockedByGlue(gameState, dx, dy, sqrtf(squaredDistances[j]))) {
+            value = scores[j] / penaltySquared;
+        }
+        if(value > *bestValue || (value == *bestValue && value > 0 && i < *best)) {
+            *best = i;
+            *bestValue = value;
+        }
+    }
+}
+
+/**
+ * Picks the best target of a table after applying the glue penalty (no distance limit)
+ * Large tables are searched ring by ring around us with the spatial index. The search stops as soon as
+ * no object in the remaining rings could beat the best target even with the highest possible numerator.
+ * @param gameState Game state of the session
+ * @param table Scored objects
+ * @param grid Spatial index of the table
+ * @param params Scoring parameters
+ * @param excludedIndex Object that must not be selected (our own player) or -1
+ * @param bestScore Receives the score of the selected target (unchanged if there is none)
+ * @return Position of the selected target in the table or -1
+ */
+static int32_t selectWithGluePenalty(GameState* gameState, const OBJTABLE_Table* table, const SPATIAL_Grid* grid,
+                                     const KERNELS_ScoreParams* params, int32_t excludedIndex, float* bestScore) {
+    int32_t best = -1;
+    float bestValue = 0;
+    
+    if(table->count < GRID_MIN_OBJECTS) {
+        scoreObjects(gameState, table, NULL, table->count, params, excludedIndex);
+        considerWithGluePenalty(gameState, table, NULL, table->count, &best, &bestValue);
+    } else {
+        // hp is transmitted as int8_t, so no object can have a larger numerator than this
+        const float maxNumerator = params->numeratorIsHp ? INT8_MAX : params->numerator;
+        const float maxWeight = maxNumerator * maxNumerator * params->mapDiagonalSquared;
+        const uint32_t lastRing = SPATIAL_LastRing(grid, params->originX, params->originY);
+        uint32_t* candidates = gameState->scratchIndices;
+        
+        for(uint32_t ring = 0; ring <= lastRing; ring++) {
+            if(best >= 0) {
+                float reach = SPATIAL_RingDistance(grid, params->originX, params->originY, ring);
+                if(maxWeight / (reach * reach) < bestValue) break;
+            }
+            uint32_t count = SPATIAL_QueryRing(grid, params->originX, params->originY, ring, candidates);
+            scoreObjects(gameState, table, candidates, count, params, excludedIndex);
+            considerWithGluePenalty(gameState, table, candidates, count, &best, &bestValue);
+        }
+    }
+    if(best >= 0) {
+        *bestScore = bestValue;
+    }
+    return best;
+}
+
+/**
+ * Distance we and a target may move apart before a glue spot could block the path to it
+ * A spot nearer than the target (edge distance e < distance) blocks the directions within w = atan2(GLUE_RADIUS, e)
+ * of its own (see occlusion.h; the intervals do not wrap around +-pi, so they only block directions of this cone).
+ * With the target at angle t from the spot, the sine of the gap t - w follows from the cross and dot products
+ * without trigonometry: sin(t - w) = (|T x G| * e - (T . G) * GLUE_RADIUS) / (|T| * |G| * sqrt(GLUE_RADIUS^2 + e^2)),
+ * and a positive sine is a lower bound of the gap. Moving by d turns the direction to the target by less than
+ * 2 * d / |T| and the one to the spot by less than 2 * d / |G| (as long as d stays below half of each) and widens
+ * the cone by less than d / GLUE_RADIUS, so a spot stays clear while the gap lasts. A spot behind the target stays
+ * clear until the target could get behind its edge.
+ * @param gameState Game state of the session
+ * @param dx Target X offset from our position
+ * @param dy Target Y offset from our position
+ * @param distance Distance to the target
+ * @param limit Largest distance of interest (spots that cannot block the path sooner are not measured)
+ * @return The distance (at most limit), 0 if a spot could block the path right away
+ */
+static float glueClearance(const GameState* gameState, float dx, float dy, float distance, float limit) {
+    const OBJTABLE_Table* glue = &gameState->glue;
+    const float radius = GLUE_RADIUS;
+    float clearance = limit;
+    
+    for(uint32_t i = 0; i < glue->count; i++) {
+        if(glue->hp[i] <= 0) continue;
+        
+        float glueX = glue->x[i] - gameState->myX;
+        float glueY = glue->y[i] - gameState->myY;
+        float centre = sqrtf(glueX*glueX + glueY*glueY);
+        float edge = centre - radius;
+        if(isnan(edge)) continue;
+        
+        float behind = (edge >= distance) ? 0.5f * (edge - distance) : 0.0f;
+        if(behind >= clearance) continue;
+        float beside = 0.0f;
+        if(centre > 0.0f && distance > 0.0f) {
+            float cross = fabsf(dx*glueY - dy*glueX);
+            float dot = dx*glueX + dy*glueY;
+            float sine = (cross*edge - dot*radius) / (distance * centre * sqrtf(radius*radius + edge*edge));
+            float gap = sine - GLUE_ANGLE_MARGIN;
+            if(gap > 0.0f) {
+                beside = fminf(gap / (2.0f / distance + 2.0f / centre + 1.0f / radius), 0.5f * fminf(distance, centre));
+            }
+        }
+        float spotClearance = fmaxf(behind, beside);
+        if(!(spotClearance >= clearance)) clearance = spotClearance;
+    }
+    return clearance;
+}
+
+/**
+ * Distance we and the objects of a table may move together before the target of a pass could change
+ * With score^2 = numerator^2 * mapDiagonal^2 / distance^2, object j cannot beat target b as long as
+ * nb / (db + d) > nj / (dj - d), i.e. d < (nb * dj - nj * db) / (nb + nj). Without a target, no object may get
+ * in range: d < dj - maxDistance. The glue penalty of a pass is assumed to hit the target and spare the others,
+ * unless the path to the target is clear and stays clear (glueClearance).
+ * The whole table must have been scored by the pass (the scratch arrays are read).
+ * @param gameState Game state of the session
+ * @param table Scored objects
+ * @param params Scoring parameters of the pass
+ * @param excludedIndex Object that must not be selected (our own player) or -1
+ * @param best Selected target or -1
+ * @param bestScore Score of the target (with the glue penalty)
+ * @param gluePenalty The pass applies the glue penalty
+ * @param blocked Receives whether the path to the target is blocked by glue
+ * @return The distance (not positive if the target could change right away)
+ */
+static float selectionSlack(const GameState* gameState, const OBJTABLE_Table* table, const KERNELS_ScoreParams* params,
+                            int32_t excludedIndex, int32_t best, float bestScore, bool gluePenalty, bool* blocked) {
+    const float* squaredDistances = gameState->scratchSquaredDistances;
+    const float penalty = BOT_PARAM(gameState, glueMovementPenalty);
+    float lowFactor = 1.0f, highFactor = 1.0f;      // Range of the factor the glue applies to a numerator
+    float slack = INFINITY;
+    float bestDistance = 0.0f, bestNumerator = 0.0f;
+    
+    *blocked = false;
+    if(gluePenalty) {
+        if(!(penalty > 0.0f)) return 0.0f;
+        lowFactor = fminf(1.0f, 1.0f / penalty);
+        highFactor = fmaxf(1.0f, 1.0f / penalty);
+    }
+    if(best >= 0) {
+        bestDistance = sqrtf(squaredDistances[best]);
+        bestNumerator = params->numeratorIsHp ? table->hp[best] : params->numerator;
+        slack = params->maxDistance - bestDistance;
+        if(gluePenalty) {
+            *blocked = (bestScore != gameState->scratchScores[best]);
+            if(*blocked) bestNumerator *= lowFactor;
+        }
+    }
+    
+    for(uint32_t j = 0; j < table->count; j++) {
+        if((int32_t)j == best || (int32_t)j == excludedIndex) continue;
+        if(!(table->hp[j] > params->minHp && table->hp[j] < params->maxHp)) continue;
+        
+        float distance = sqrtf(squaredDistances[j]);
+        float numerator = (params->numeratorIsHp ? table->hp[j] : params->numerator) * highFactor;
+        float bound = (best >= 0) ? (bestNumerator * distance - numerator * bestDistance) / (bestNumerator + numerator)
+                                  : distance - params->maxDistance;
+        if(!(bound >= slack)) slack = bound;
+    }
+    
+    // the glue is checked last, only as far as the other objects let the target stay
+    if(best >= 0 && gluePenalty && !*blocked && penalty > 1.0f && slack > 0.0f) {
+        slack = glueClearance(gameState, table->x[best] - gameState->myX, table->y[best] - gameState->myY,
+                              bestDistance, slack);
+    }
+    return slack - TARGET_SLACK_MARGIN;
+}
+
+/**
+ * Selects the target of a scoring pass, or takes the one memoized for it if its class is current
+ * A memoized target is scored again, so the score is the one a full scan would give. A selected target is
+ * stored in the memo and the slack of the pass is added to the slack of the class.
+ * @param gameState Game state of the session
+ * @param memo Memoized targets of the class
+ * @param pass Position of the pass in the memo
+ * @param current The memoized targets of the class are current (MEMO_IsCurrent)
+ * @param table Scored objects
+ * @param grid Spatial index of the table
+ * @param params Scoring parameters (maxDistance finite unless gluePenalty is set)
+ * @param excludedIndex Object that must not be selected (our own player) or -1
+ * @param gluePenalty Apply the glue penalty (selectWithGluePenalty) instead of the range (selectInRange)
+ * @param bestScore Receives the score of the target (unchanged if there is none)
+ * @param slack Slack of the class, lowered to the slack of this pass
+ * @return Position of the target in the table or -1
+ */
+static int32_t selectTarget(GameState* gameState, MEMO_Class* memo, int pass, bool current,
+                            const OBJTABLE_Table* table, const SPATIAL_Grid* grid, const KERNELS_ScoreParams* params,
+                            int32_t excludedIndex, bool gluePenalty, float* bestScore, float* slack) {
+    if(current) {
+        int32_t best = memo->targets[pass];
+        if(best >= 0) {
+            uint32_t position = (uint32_t)best;
+            float squaredDistance, score;
+            KERNELS_ScoreSelected(table->x, table->y, table->hp, &position, 1, params, &squaredDistance, &score);
+            if(memo->blocked[pass]) {
+                score = score / BOT_DERIVED(gameState, gluePenaltySquared);
+            }
+            *bestScore = score;
+        }
+        return best;
+    }
+    
+    int32_t best = gluePenalty ? selectWithGluePenalty(gameState, table, grid, params, excludedIndex, bestScore)
+                               : selectInRange(gameState, table, grid, params, excludedIndex, bestScore);
+    if(gameState->targetCaching) {
+        bool blocked = false;
+        // only a scan of the whole table leaves the distances of every object in the scratch arrays
+        float passSlack = (table->count < GRID_MIN_OBJECTS) ?
+                          selectionSlack(gameState, table, params, excludedIndex, best, *bestScore, gluePenalty, &blocked) : 0.0f;
+        if(!(passSlack >= *slack)) *slack = passSlack;
+        memo->targets[pass] = best;
+        memo->blocked[pass] = blocked;
+    }
+    return best;
+}
+
+/**
+ * Main decision-making function
+ * Analyzes game state and determines optimal movement direction
+ * Priority order: Escape > Avoid Sparks > Attack > Collect Food > Hunt > Dance
+ * @param gameState Game state of the session
+ * @return Movement angle in radians
+ */
+float calculateMovement(GameState* gameState) {
+    if (!gameState->gameActive || !gameState->myPlayerFound) {
+        return 0.0f; // Stay still if game inactive or position unknown
+    }
+    
+    // Target tracking variables (position, score for prioritization)
+    // Scores are squared (numerator^2 * mapDiagonal^2 / distance^2), see kernels.h
+    float dangerX = 0, dangerY = 0, dangerScore = 0;           // Dangerous players
+    float foodX = 0, foodY = 0, foodScore = 0;                 // Transistors to collect
+    float huntX = 0, huntY = 0, huntScore = 0;                 // Distant weak players
+    float sparkX = 0, sparkY = 0, sparkScore = 0;             // Threatening sparks
+    float attackX = 0, attackY = 0, attackScore = 0;          // Nearby weak players
+    
+    BOT_LOG(gameState, LOG_EVENT_POSITION, gameState->myX, gameState->myY, gameState->myHP);
+    
+    // Potential field: uphill from our position, the same cost whatever the number of objects
+    // (a flat field, e.g. with nothing in reach, leaves the decision to the priorities below)
+    if(gameState->fieldSteering && gameState->field.columns > 0) {
+        float gradientX, gradientY;
+        FIELD_Gradient(&gameState->field, gameState->myX, gameState->myY, &gradientX, &gradientY);
+        if(gradientX != 0.0f || gradientY != 0.0f) {
+            BOT_LOG(gameState, LOG_EVENT_FIELD_MOVE, gradientX, gradientY);
+            return normalizeAngle(atan2f(gradientY, gradientX));
+        }
+    }
+    
+    if(!reserveScratch(gameState)) {
+        return 0.0f;
+    }
+    gameState->glueOcclusionReady = false;
+    const OBJTABLE_Table* players = &gameState->players;
+    const int32_t selfIndex = OBJTABLE_Find(players, gameState->myPlayerNumber);
+    int32_t best;
+    
+    KERNELS_ScoreParams params;
+    params.originX = gameState->myX;
+    params.originY = gameState->myY;
+    params.mapDiagonalSquared = gameState->mapDiagonalSquared;
+    
+    // Targets of a class are selected again only if the class changed or we and its objects moved too far
+    // since they were selected; the slack of every class is collected from its passes
+    const bool caching = gameState->targetCaching;
+    MEMO_Class* playerTargets = &gameState->playerTargets;
+    MEMO_Class* sparkTargets = &gameState->sparkTargets;
+    MEMO_Class* transistorTargets = &gameState->transistorTargets;
+    const bool playersCurrent = caching &&
+        MEMO_IsCurrent(playerTargets, gameState->glueVersion, gameState->myX, gameState->myY, gameState->myHP);
+    const bool sparksCurrent = caching && MEMO_IsCurrent(sparkTargets, 0, gameState->myX, gameState->myY, gameState->myHP);
+    const bool transistorsCurrent = caching &&
+        MEMO_IsCurrent(transistorTargets, gameState->glueVersion, gameState->myX, gameState->myY, gameState->myHP);
+    float playerSlack = INFINITY, sparkSlack = INFINITY, transistorSlack = INFINITY;
+    
+    // === PLAYER ANALYSIS ===
+    // DANGEROUS PLAYER DETECTION - stronger players within detection range
+    // Score: higher HP and closer distance = higher threat
+    params.minHp = fmaxf(gameState->myHP, 0.0f);
+    params.maxHp = INFINITY;
+    params.maxDistance = BOT_PARAM(gameState, dangerDetectionRange) + PLAYER_BASE_RADIUS + gameState->myHP;
+    params.maxSquaredDistance = params.maxDistance * params.maxDistance;
+    params.numeratorIsHp = true;
+    best = selectTarget(gameState, playerTargets, PASS_DANGER, playersCurrent, players, &gameState->playerGrid,
+                        &params, selfIndex, false, &dangerScore, &playerSlack);
+    if(best >= 0) {
+        dangerX = players->x[best];
+        dangerY = players->y[best];
+        predictPlayerTarget(gameState, best, &dangerX, &dangerY);
+    }
+    
+    // WEAK PLAYER DETECTION - immediate attack opportunity
+    params.minHp = 0.0f;
+    params.maxHp = gameState->myHP;
+    params.maxDistance = BOT_PARAM(gameState, attackRange);
+    params.maxSquaredDistance = BOT_DERIVED(gameState, attackRangeSquared);
+    params.numerator = gameState->myHP;
+    params.numeratorIsHp = false;
+    best = selectTarget(gameState, playerTargets, PASS_ATTACK, playersCurrent, players, &gameState->playerGrid,
+                        &params, selfIndex, false, &attackScore, &playerSlack);
+    if(best >= 0) {
+        attackX = players->x[best];
+        attackY = players->y[best];
+        predictPlayerTarget(gameState, best, &attackX, &attackY);
+    }
+    
+    // WEAK PLAYER DETECTION - hunting opportunity (longer distance, consider glue)
+    params.maxDistance = params.maxSquaredDistance = INFINITY;
+    best = selectTarget(gameState, playerTargets, PASS_HUNT, playersCurrent, players, &gameState->playerGrid,
+                        &params, selfIndex, true, &huntScore, &playerSlack);
+    if(best >= 0) {
+        huntX = players->x[best];
+        huntY = players->y[best];
+        predictPlayerTarget(gameState, best, &huntX, &huntY);
+    }
+    if(caching && !playersCurrent) {
+        MEMO_Store(playerTargets, players, gameState->glueVersion, gameState->myX, gameState->myY, gameState->myHP, playerSlack);
+    }
+    
+    // === SPARK ANALYSIS ===
+    // Only consider close sparks as immediate threats
+    // Score: closer sparks are more dangerous
+    const OBJTABLE_Table* sparks = &gameState->sparks;
+    params.minHp = 0.0f;
+    params.maxHp = INFINITY;
+    params.maxDistance = BOT_PARAM(gameState, sparkDetectionRange) + PLAYER_BASE_RADIUS + gameState->myHP;
+    params.maxSquaredDistance = params.maxDistance * params.maxDistance;
+    params.numeratorIsHp = true;
+    best = selectTarget(gameState, sparkTargets, PASS_ONLY, sparksCurrent, sparks, &gameState->sparkGrid,
+                        &params, -1, false, &sparkScore, &sparkSlack);
+    if(best >= 0) {
+        sparkX = sparks->x[best];
+        sparkY = sparks->y[best];
+    }
+    if(caching && !sparksCurrent) {
+        MEMO_Store(sparkTargets, sparks, 0, gameState->myX, gameState->myY, gameState->myHP, sparkSlack);
+    }
+    
+    // === FOOD ANALYSIS ===
+    // Skip eaten transistors; score: higher HP food and closer distance = better target
+    const OBJTABLE_Table* transistors = &gameState->transistors;
+    params.maxDistance = params.maxSquaredDistance = INFINITY;
+    best = selectTarget(gameState, transistorTargets, PASS_ONLY, transistorsCurrent, transistors,
+                        &gameState->transistorGrid, &params, -1, true, &foodScore, &transistorSlack);
+    if(best >= 0) {
+        foodX = transistors->x[best];
+        foodY = transistors->y[best];
+    }
+    if(caching && !transistorsCurrent) {
+        MEMO_Store(transistorTargets, transistors, gameState->glueVersion, gameState->myX, gameState->myY, gameState->myHP,
+                   transistorSlack);
+    }
+    
+    // === DECISION MAKING (Priority Order) ===
+    // Every branch picks a direction vector, the angle is computed once at the end
+    float directionX = 0.0f, directionY = 0.0f;
+    
+    if(dangerScore > 0) {
+        // HIGHEST PRIORITY: Escape from dangerous players
+        // Perpendicular escape vector (90° from threat direction)
+        directionX = -(dangerY - gameState->myY);
+        directionY = dangerX - gameState->myX;
+        avoidSparkTrajectory(gameState, &directionX, &directionY);
+        BOT_LOG(gameState, LOG_EVENT_ESCAPE, dangerX, dangerY);
+        
+    } else if(sparkScore > 0) {
+        // HIGH PRIORITY: Avoid immediate spark threats
+        // Move directly away from spark (180° opposite)
+        directionX = -(sparkX - gameState->myX);
+        directionY = -(sparkY - gameState->myY);
+        BOT_LOG(gameState, LOG_EVENT_AVOID_SPARK, sparkX, sparkY);
+        
+    } else if(attackScore > 0) {
+        // MEDIUM-HIGH PRIORITY: Attack nearby weak players
+        routeToTarget(gameState, attackX, attackY, &directionX, &directionY);
+        avoidSparkTrajectory(gameState, &directionX, &directionY);
+        BOT_LOG(gameState, LOG_EVENT_ATTACK, attackX, attackY, sqrtf(attackScore));
+        
+    } else if(foodScore > 0) {
+        // MEDIUM PRIORITY: Collect food (transistors)
+        routeToTarget(gameState, foodX, foodY, &directionX, &directionY);
+        avoidSparkTrajectory(gameState, &directionX, &directionY);
+        BOT_LOG(gameState, LOG_EVENT_COLLECT, foodX, foodY, sqrtf(foodScore));
+        
+    } else if(huntScore > 0) {
+        // LOW PRIORITY: Hunt distant weak players
+        routeToTarget(gameState, huntX, huntY, &directionX, &directionY);
+        avoidSparkTrajectory(gameState, &directionX, &directionY);
+        BOT_LOG(gameState, LOG_EVENT_HUNT, huntX, huntY, sqrtf(huntScore));
+        
+    } else {
+        // LOWEST PRIORITY: Entertainment when no targets available
+        BOT_LOG(gameState, LOG_EVENT_DANCE);
+        return getDanceAngle(gameState);
+    }
+    
+    // Ensure angle is in valid range [0, 2π)
+    return normalizeAngle(atan2f(directionY, directionX));
+}
+
+/**
+ * Gives the inputs of the decision to the lookahead planner (once per state version)
+ * @param gameState Game state of the session
+ * @param greedyAngle Move chosen by calculateMovement for the current state
+ */
+static void publishSnapshot(GameState* gameState, float greedyAngle) {
+    if(gameState->planner == NULL || !gameState->myPlayerFound || gameState->plannedVersion == gameState->stateVersion) {
+        return;
+    }
+    PLANNER_Snapshot* snapshot = PLANNER_BeginSnapshot(gameState->planner);
+    snapshot->mapWidth = gameState->mapWidth;
+    snapshot->mapHeight = gameState->mapHeight;
+    snapshot->myX = gameState->myX;
+    snapshot->myY = gameState->myY;
+    snapshot->myHP = gameState->myHP;
+    snapshot->greedyAngle = greedyAngle;
+    int32_t me = OBJTABLE_Find(&gameState->players, gameState->myPlayerNumber);
+    PLANNER_CopyObjects(snapshot, PLANNER_PLAYERS, &gameState->players, me, &gameState->playerMotion);
+    PLANNER_CopyObjects(snapshot, PLANNER_TRANSISTORS, &gameState->transistors, OBJTABLE_NOT_FOUND, NULL);
+    PLANNER_CopyObjects(snapshot, PLANNER_SPARKS, &gameState->sparks, OBJTABLE_NOT_FOUND, &gameState->sparkMotion);
+    PLANNER_CopyObjects(snapshot, PLANNER_GLUE, &gameState->glue, OBJTABLE_NOT_FOUND, NULL);
+    gameState->plannedSnapshot = PLANNER_Publish(gameState->planner, gameState->receiveTimeNs);
+    gameState->plannedVersion = gameState->stateVersion;
+}
+
+/**
+ * Replaces the move with the best one the planner found for the current state within its time budget
+ * @param gameState Game state of the session
+ * @param move Move decided by calculateMovement, replaced by the planned one
+ */
+static void takePlannedMove(GameState* gameState, AMCOM_MoveResponsePayload* move) {
+    if(gameState->planner == NULL) return;
+    
+    uint32_t snapshot = (gameState->plannedVersion == gameState->stateVersion) ? gameState->plannedSnapshot : 0;
+    float angle;
+    if(PLANNER_TakePlan(gameState->planner, snapshot, &angle)) {
+        move->angle = angle;
+        BOT_LOG(gameState, LOG_EVENT_PLANNED_MOVE, angle, angle * 180.0f / M_PI);
+    }
+}
+
+/**
+ * Decides the next move ahead of the MOVE request (speculative move)
+ * The dance step is kept as it was, the move only advances it when MOVE takes it.
+ * Log records of the decision carry the game time of the previous MOVE.
+ * @param gameState Game state of the session
+ */
+void precomputeMove(GameState* gameState) {
+    // nothing changed since the last decision (made ahead or on MOVE)
+    if(!gameState->gameActive || gameState->speculativeVersion == gameState->stateVersion) {
+        return;
+    }
+    uint8_t konamiIndex = gameState->konamiIndex;
+    gameState->speculativeMove.angle = calculateMovement(gameState);
+    gameState->speculativeKonamiIndex = gameState->konamiIndex;
+    gameState->konamiIndex = konamiIndex;
+    gameState->speculativeVersion = gameState->stateVersion;
+    gameState->speculativeValid = true;
+    publishSnapshot(gameState, gameState->speculativeMove.angle);
+}
+
+/**
+ * Takes the move decided ahead if the game state has not changed since
+ * @param gameState Game state of the session
+ * @param move Receives the move
+ * @return false if there is no current move decided ahead
+ */
+static bool takePrecomputedMove(GameState* gameState, AMCOM_MoveResponsePayload* move) {
+    if(!gameState->speculativeValid || gameState->speculativeVersion != gameState->stateVersion) {
+        return false;
+    }
+    *move = gameState->speculativeMove;
+    gameState->konamiIndex = gameState->speculativeKonamiIndex;
+    gameState->speculativeValid = false;
+    return true;
+}
+
+/**
+ * Processes object update packets from server
+ * Routes different object types to appropriate update functions
+ * @param gameState Game state of the session
+ * @param packet View of the received AMCOM packet containing object data (read in place, not copied)
+ */
+void processObjectUpdate(GameState* gameState, const AMCOM_PacketView* packet) {
+    uint8_t objectCount = packet->payloadSize / sizeof(AMCOM_ObjectState);
+    if(objectCount == 0) return;
+    
+    const AMCOM_ObjectUpdateRequestPayload* updatePayload = (const AMCOM_ObjectUpdateRequestPayload*)packet->payload;
+    
+    // Process each object in the packet
+    for(uint8_t i = 0; i < objectCount; i++) {
+        const AMCOM_ObjectState* obj = &updatePayload->objectState[i];
+        
+        // The potential field and the navigation grid follow the change of the entry
+        // (taken back as it was, added as it is now)
+        const OBJTABLE_Table* table = (gameState->fieldMaintained || gameState->pathfinding) ?
+                                      tableOfType(gameState, obj->objectType) : NULL;
+        FieldContribution before;
+        NavCoverage coverBefore;
+        if(table != NULL) {
+            int32_t index = OBJTABLE_Find(table, obj->objectNo);
+            before = fieldContribution(gameState, obj->objectType, index, gameState->fieldHP);
+            coverBefore = navCoverage(gameState, obj->objectType, index);
+        }
+        
+        // Route to appropriate handler based on object type
+        switch(obj->objectType) {
+            case 0: // Players
+                updatePlayerList(gameState, obj);
+                break;
+            case 1: // Transistors
+                updateTransistorList(gameState, obj);
+                break;
+            case 2: // Sparks
+                updateSparkList(gameState, obj);
+                break;
+            case 3: // Glue
+                updateGlueList(gameState, obj);
+                break;
+        }
+        
+        if(table != NULL) {
+            int32_t index = OBJTABLE_Find(table, obj->objectNo);
+            if(gameState->fieldMaintained) {
+                FieldContribution after = fieldContribution(gameState, obj->objectType, index, gameState->fieldHP);
+                moveFieldContribution(gameState, &before, &after);
+            }
+            if(gameState->pathfinding) {
+                NavCoverage coverAfter = navCoverage(gameState, obj->objectType, index);
+                NAV_Move(&gameState->navigation, coverAfter.layer, coverBefore.covers, coverBefore.x, coverBefore.y,
+                         coverAfter.covers, coverAfter.x, coverAfter.y);
+            }
+        }
+    }
+    
+    // Update our cached position after processing all objects
+    updateMyPlayerCache(gameState);
+    if(gameState->fieldMaintained) {
+        reclassifyFieldPlayers(gameState);
+    }
+    gameState->stateVersion++;
+}
+
+/**
+ * Handles a single packet received from the game server and prepares the response (if any)
+ * @param gameState Game state of the session the packet belongs to
+ * @param packet View of the received packet
+ * @param responseBuffer Place for the response packet (at least AMCOM_MAX_PACKET_SIZE bytes)
+ * @return Size of the response packet, 0 if no response shall be sent
+ */
+size_t handleGamePacket(GameState* gameState, const AMCOM_PacketView* packet, uint8_t* responseBuffer) {
+    size_t responseSize = 0;
+
+    switch (packet->header.type) {
+        case AMCOM_IDENTIFY_REQUEST:
+            BOT_LOG(gameState, LOG_EVENT_IDENTIFY);
+            AMCOM_IdentifyResponsePayload identifyResponse;
+            sprintf(identifyResponse.playerName, "sAMobujca");
+            responseSize = AMCOM_Serialize(AMCOM_IDENTIFY_RESPONSE, &identifyResponse, 
+                                         sizeof(identifyResponse), responseBuffer);
+            break;
+            
+        case AMCOM_NEW_GAME_REQUEST:
+            BOT_LOG(gameState, LOG_EVENT_NEW_GAME);
+            const AMCOM_NewGameRequestPayload* newGameReq = (const AMCOM_NewGameRequestPayload*)packet->payload;
+            
+            // Initialize game state
+            gameState->myPlayerNumber = newGameReq->playerNumber;
+            gameState->mapWidth = newGameReq->mapWidth;
+            gameState->mapHeight = newGameReq->mapHeight;
+            gameState->gameActive = true;
+            gameState->konamiIndex = 0; // Reset dance sequence
+            
+            // Constants of the decisions in this game (the strategy parameters are set before the game starts)
+            gameState->mapDiagonalSquared = (float)((double)gameState->mapWidth * gameState->mapWidth
+                                                    + (double)gameState->mapHeight * gameState->mapHeight);
+            PARAMS_Derive(&gameState->params, &gameState->derived);
+            gameState->stateVersion++;
+            
+            // Motion histories of the previous game do not belong to the objects of this one
+            MOTION_Clear(&gameState->playerMotion);
+            MOTION_Clear(&gameState->sparkMotion);
+            
+            // Targets were selected with the constants of the previous game
+            MEMO_Invalidate(&gameState->playerTargets);
+            MEMO_Invalidate(&gameState->sparkTargets);
+            MEMO_Invalidate(&gameState->transistorTargets);
+            
+            // The potential field is sized for the new map and then kept up to date by the object updates
+            if(gameState->fieldMaintained) {
+                rebuildField(gameState);
+            }
+            if(gameState->pathfinding) {
+                rebuildNavigation(gameState);
+            }
+            
+            // Size the spatial indexes for the new map
+            SPATIAL_Reset(&gameState->playerGrid, &gameState->players, gameState->mapWidth, gameState->mapHeight, GRID_CELL_SIZE);
+            SPATIAL_Reset(&gameState->transistorGrid, &gameState->transistors, gameState->mapWidth, gameState->mapHeight, GRID_CELL_SIZE);
+            SPATIAL_Reset(&gameState->sparkGrid, &gameState->sparks, gameState->mapWidth, gameState->mapHeight, GRID_CELL_SIZE);
+            
+            BOT_LOG(gameState, LOG_EVENT_GAME_PARAMETERS,
+                    gameState->myPlayerNumber, gameState->mapWidth, gameState->mapHeight);
+            
+            AMCOM_NewGameResponsePayload newGameResponse;
+            sprintf(newGameResponse.helloMessage, "Bedzie magik i to za dwa lata");
+            responseSize = AMCOM_Serialize(AMCOM_NEW_GAME_RESPONSE, &newGameResponse, 
+                                         sizeof(newGameResponse), responseBuffer);
+            break;
+            
+        case AMCOM_OBJECT_UPDATE_REQUEST:
+            processObjectUpdate(gameState, packet);
+            break;
+            
+        case AMCOM_MOVE_REQUEST:
+            const AMCOM_MoveRequestPayload* moveReq = (const AMCOM_MoveRequestPayload*)packet->payload;
+            gameState->currentGameTime = moveReq->gameTime;
+            
+            // the move decided ahead is only serialized, unless the state changed after it was decided
+            AMCOM_MoveResponsePayload moveResponse;
+            if(!takePrecomputedMove(gameState, &moveResponse)) {
+                moveResponse.angle = calculateMovement(gameState);
+                gameState->speculativeVersion = gameState->stateVersion;
+                gameState->speculativeValid = false;
+                // the updates came with MOVE: the planner searches now, until the budget from their receipt is used
+                publishSnapshot(gameState, moveResponse.angle);
+            }
+            takePlannedMove(gameState, &moveResponse);
+            responseSize = AMCOM_Serialize(AMCOM_MOVE_RESPONSE, &moveResponse, 
+                                         sizeof(moveResponse), responseBuffer);
+            break;
+            
+        case AMCOM_GAME_OVER_REQUEST:
+            BOT_LOG(gameState, LOG_EVENT_GAME_OVER);
+            gameState->gameActive = false;
+            gameState->stateVersion++;
+            
+            AMCOM_GameOverResponsePayload gameOverResponse;
+            sprintf(gameOverResponse.endMessage, "GG WP!");
+            responseSize = AMCOM_Serialize(AMCOM_GAME_OVER_RESPONSE, &gameOverResponse, 
+                                         sizeof(gameOverResponse), responseBuffer);
+            break;
+            
+        default:
+            BOT_LOG(gameState, LOG_EVENT_UNKNOWN_PACKET, packet->header.type);
+            break;
+    }
+
+    return responseSize;
+}
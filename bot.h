@@ -0,0 +1,160 @@
+#ifndef BOT_H_
+#define BOT_H_
+
+/**
+ * Game state and decision making of the mniAM player.
+ *
+ * All functions operate on an explicit GameState, so that one process can play many games at once
+ * (one GameState per connection).
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "amcom.h"
+#include "amcom_packets.h"
+#include "field.h"
+#include "log.h"
+#include "memo.h"
+#include "motion.h"
+#include "nav.h"
+#include "objtable.h"
+#include "occlusion.h"
+#include "params.h"
+#include "planner.h"
+#include "spatial.h"
+
+// Initial capacities of the object tables (they grow on demand)
+#define MAX_PLAYERS 10
+#define MAX_TRANSISTORS 100
+#define MAX_SPARKS 20
+#define MAX_GLUE_SPOTS 10
+
+/**
+ * Game state structure containing all game objects and player information
+ */
+typedef struct {
+    // Game objects storage - separated by type, indexed by objectNo
+    OBJTABLE_Table players;                        // All players on the map
+    OBJTABLE_Table transistors;                    // Food objects (+HP when collected)
+    OBJTABLE_Table sparks;                         // Dangerous moving objects (-3 HP)
+    OBJTABLE_Table glue;                           // Slow zones (20x movement penalty)
+    
+    // Spatial indexes of the object tables (sized for the map on NEW_GAME)
+    SPATIAL_Grid playerGrid;                       // Cells of the players
+    SPATIAL_Grid transistorGrid;                   // Cells of the transistors
+    SPATIAL_Grid sparkGrid;                        // Cells of the sparks
+    OCCLUSION_Map glueOcclusion;                   // Directions blocked by glue, rebuilt on every decision
+    bool glueOcclusionReady;                       // glueOcclusion was built for the current decision
+    
+    // Motion history of the moving objects (velocity estimates, indexed by objectNo)
+    MOTION_Tracker playerMotion;                   // Tracks of the players
+    MOTION_Tracker sparkMotion;                    // Tracks of the sparks
+    
+    // Potential field of the map (maintained with deltas from the object updates, see field.h)
+    FIELD_Map field;                               // Attraction, repulsion and glue layers (no cells unless maintained)
+    bool fieldMaintained;                          // Keep the field up to date (set before the game starts)
+    bool fieldSteering;                            // Move along the gradient of the field (needs fieldMaintained)
+    float fieldHP;                                 // Our HP the players in the field were classified with
+    
+    // Navigation grid (glue and spark zone costs maintained with deltas, paths repaired with D* Lite, see nav.h)
+    NAV_Grid navigation;                           // Cell costs and the search towards the current target
+    bool pathfinding;                              // Route to targets around glue and sparks (set before the game starts)
+    
+    // Memoized target selection (targets kept while no other object can have overtaken them, see calculateMovement)
+    bool targetCaching;                            // Reuse the targets of earlier decisions (on after initGameState)
+    MEMO_Class playerTargets;                      // Danger, attack and hunt targets among the players
+    MEMO_Class sparkTargets;                       // Threatening spark
+    MEMO_Class transistorTargets;                  // Food target
+    uint64_t glueVersion;                          // Bumped by every change of the glue (hunt and food check paths for glue)
+    
+    // Game session information
+    uint32_t currentGameTime;                      // Server game time
+    uint8_t myPlayerNumber;                        // Our player identifier
+    float mapWidth, mapHeight;                     // Map dimensions
+    bool gameActive;                               // Game session status
+    
+    // Constants of the decision derived on NEW_GAME (from the map and the strategy parameters)
+    float mapDiagonalSquared;                      // Squared map diagonal (scores are relative to the diagonal)
+    PARAMS_Derived derived;                        // Squares, cosines and sines of the strategy constants
+    
+    // Cached player data for performance optimization
+    float myX, myY, myHP;                         // Our current position and health
+    bool myPlayerFound;                           // Flag indicating if we found ourselves
+    
+    // Strategy constants (PARAMS_Default after initGameState, may be replaced before the game starts)
+    PARAMS_Strategy params;
+    
+    // Entertainment feature
+    uint8_t konamiIndex;                          // Current step in Konami Code dance
+    
+    // Speculative move (decided after the object updates of a tick, before MOVE asks for it)
+    uint64_t stateVersion;                        // Incremented by every packet that changes the decision inputs
+    uint64_t speculativeVersion;                  // stateVersion of the last decision (made ahead or on MOVE)
+    bool speculativeValid;                        // The move decided ahead has not been taken yet
+    AMCOM_MoveResponsePayload speculativeMove;    // Move decided ahead
+    uint8_t speculativeKonamiIndex;               // Dance step after the move decided ahead
+    
+    // Lookahead planner (searches in its own thread, MOVE takes its best move found within the time budget)
+    PLANNER_Planner* planner;                     // Planner of the session, owned by the caller (NULL = greedy only)
+    uint64_t plannedVersion;                      // stateVersion of the last snapshot given to the planner
+    uint32_t plannedSnapshot;                     // Sequence number of that snapshot
+    uint64_t receiveTimeNs;                       // Time the data being processed was received (0 = unknown)
+    
+    // Scratch arrays for the scoring kernels (aligned, sized for the largest object class)
+    float* scratchSquaredDistances;               // Squared distance of each object from us
+    float* scratchScores;                         // Score of each object
+    uint32_t* scratchIndices;                     // Candidates returned by the spatial indexes
+    uint32_t scratchCapacity;                     // Allocated length of the scratch arrays
+    
+    // Diagnostics
+    LOG_Ring* log;                                // Log ring of the thread serving the session (NULL = no logging)
+} GameState;
+
+/**
+ * Resets the game state of a session
+ * @param gameState Game state to initialize
+ * @param log Log ring of the thread serving the session (NULL disables logging)
+ */
+void initGameState(GameState* gameState, LOG_Ring* log);
+
+/**
+ * Releases the memory owned by the game state of a session
+ * @param gameState Game state to release
+ */
+void freeGameState(GameState* gameState);
+
+/**
+ * Main decision-making function
+ * Analyzes game state and determines optimal movement direction
+ * @param gameState Game state of the session
+ * @return Movement angle in radians
+ */
+float calculateMovement(GameState* gameState);
+
+/**
+ * Decides the next move ahead of the MOVE request (speculative move)
+ * Meant to be called when the received data has been processed and the thread has nothing else to do: the
+ * MOVE request then only serializes the cached answer. Nothing is done if the cached answer is still current;
+ * any packet changing the game state afterwards makes it stale and MOVE decides again.
+ * @param gameState Game state of the session
+ */
+void precomputeMove(GameState* gameState);
+
+/**
+ * Processes object update packets from server
+ * @param gameState Game state of the session
+ * @param packet View of the received AMCOM packet containing object data
+ */
+void processObjectUpdate(GameState* gameState, const AMCOM_PacketView* packet);
+
+/**
+ * Handles a single packet received from the game server and prepares the response (if any)
+ * @param gameState Game state of the session the packet belongs to
+ * @param packet View of the received packet
+ * @param responseBuffer Place for the response packet (at least AMCOM_MAX_PACKET_SIZE bytes)
+ * @return Size of the response packet, 0 if no response shall be sent
+ */
+size_t handleGamePacket(GameState* gameState, const AMCOM_PacketView* packet, uint8_t* responseBuffer);
+
+#endif /* BOT_H_ */
@@ -0,0 +1,203 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "field.h"
+
+/// Names of the layers in dumps
+static const char* const FIELD_LAYER_NAMES[FIELD_LAYER_COUNT] = { "attraction", "repulsion", "glue" };
+
+/// Shape of the kernel of a layer at a distance from its centre (1 at the centre, 0 beyond the reach)
+static float FIELD_Falloff(FIELD_Layer layer, float distance) {
+	switch(layer){
+	    case FIELD_ATTRACTION: {
+	        // long tail, tapered to 0 at the reach so that the edge adds no step
+	        float relative = distance / (0.25f * FIELD_ATTRACTION_REACH);
+	        return (distance < FIELD_ATTRACTION_REACH) ?
+	               (1.0f - distance / FIELD_ATTRACTION_REACH) / (1.0f + relative * relative) : 0.0f;
+	    }
+	    case FIELD_REPULSION:
+	        return (distance < FIELD_REPULSION_REACH) ? 1.0f - distance / FIELD_REPULSION_REACH : 0.0f;
+	    case FIELD_GLUE:
+	        return (distance <= FIELD_GLUE_REACH) ? 1.0f : 0.0f;
+	    default:
+	        return 0.0f;
+	}
+}
+
+/// Reach of a layer
+static float FIELD_Reach(FIELD_Layer layer) {
+	return (layer == FIELD_ATTRACTION) ? FIELD_ATTRACTION_REACH :
+	       (layer == FIELD_REPULSION) ? FIELD_REPULSION_REACH : FIELD_GLUE_REACH;
+}
+
+/// Samples the kernel of a layer at the cell centres (integer weights, so that stamps cancel exactly)
+static bool FIELD_BuildKernel(FIELD_Kernel* kernel, FIELD_Layer layer, float cellSize) {
+	int32_t radius = (int32_t)(FIELD_Reach(layer) / cellSize);
+	int32_t side = 2 * radius + 1;
+	int32_t* weights = (int32_t*)malloc((size_t)side * side * sizeof(int32_t));
+	if(weights == NULL){
+	    return false;
+	}
+	for(int32_t dy = -radius; dy <= radius; dy++){
+	    for(int32_t dx = -radius; dx <= radius; dx++){
+	        float distance = cellSize * sqrtf((float)(dx * dx + dy * dy));
+	        weights[(dy + radius) * side + dx + radius] = (int32_t)lroundf(FIELD_KERNEL_SCALE * FIELD_Falloff(layer, distance));
+	    }
+	}
+	free(kernel->weights);
+	kernel->weights = weights;
+	kernel->radius = radius;
+	return true;
+}
+
+/// Cell coordinate of a position along one axis, clamped to the field
+static int32_t FIELD_Coordinate(float value, float inverseCellSize, uint32_t cells) {
+	float cell = value * inverseCellSize;
+	if(!(cell >= 0.0f)){
+	    // negative or NaN
+	    return 0;
+	}
+	if(cell >= (float)cells){
+	    return (int32_t)cells - 1;
+	}
+	return (int32_t)cell;
+}
+
+/// Value of a cell (attraction - repulsion - glue)
+static inline int32_t FIELD_CellValue(const FIELD_Map* map, uint32_t cell) {
+	return map->layers[FIELD_ATTRACTION][cell] - map->layers[FIELD_REPULSION][cell] - map->layers[FIELD_GLUE][cell];
+}
+
+void FIELD_Init(FIELD_Map* map) {
+	memset(map, 0, sizeof(FIELD_Map));
+}
+
+void FIELD_Free(FIELD_Map* map) {
+	for(int l = 0; l < FIELD_LAYER_COUNT; l++){
+	    free(map->layers[l]);
+	    free(map->kernels[l].weights);
+	}
+	memset(map, 0, sizeof(FIELD_Map));
+}
+
+bool FIELD_Reset(FIELD_Map* map, float width, float height, float cellSize) {
+	FIELD_Free(map);
+	float largest = (width > height) ? width : height;
+	if(!(largest > 0.0f) || !(cellSize > 0.0f)){
+	    return false;
+	}
+	if(largest / cellSize > FIELD_MAX_CELLS_PER_AXIS){
+	    cellSize = largest / FIELD_MAX_CELLS_PER_AXIS;
+	}
+	uint32_t columns = (width > 0.0f) ? (uint32_t)ceilf(width / cellSize) : 1;
+	uint32_t rows = (height > 0.0f) ? (uint32_t)ceilf(height / cellSize) : 1;
+	columns = (columns < 1) ? 1 : (columns > FIELD_MAX_CELLS_PER_AXIS) ? FIELD_MAX_CELLS_PER_AXIS : columns;
+	rows = (rows < 1) ? 1 : (rows > FIELD_MAX_CELLS_PER_AXIS) ? FIELD_MAX_CELLS_PER_AXIS : rows;
+
+	for(int l = 0; l < FIELD_LAYER_COUNT; l++){
+	    map->layers[l] = (int32_t*)calloc((size_t)columns * rows, sizeof(int32_t));
+	    if(map->layers[l] == NULL || !FIELD_BuildKernel(&map->kernels[l], (FIELD_Layer)l, cellSize)){
+	        FIELD_Free(map);
+	        return false;
+	    }
+	}
+	map->cellSize = cellSize;
+	map->inverseCellSize = 1.0f / cellSize;
+	map->columns = columns;
+	map->rows = rows;
+	return true;
+}
+
+void FIELD_Clear(FIELD_Map* map) {
+	for(int l = 0; l < FIELD_LAYER_COUNT; l++){
+	    if(map->layers[l] != NULL){
+	        memset(map->layers[l], 0, (size_t)map->columns * map->rows * sizeof(int32_t));
+	    }
+	}
+}
+
+void FIELD_Stamp(FIELD_Map* map, FIELD_Layer layer, float x, float y, int32_t strength) {
+	if(map->columns == 0 || strength == 0){
+	    return;
+	}
+	const FIELD_Kernel* kernel = &map->kernels[layer];
+	const int32_t radius = kernel->radius;
+	const int32_t side = 2 * radius + 1;
+	const int32_t columns = (int32_t)map->columns, rows = (int32_t)map->rows;
+	const int32_t cx = FIELD_Coordinate(x, map->inverseCellSize, map->columns);
+	const int32_t cy = FIELD_Coordinate(y, map->inverseCellSize, map->rows);
+
+	// the part of the kernel that lies on the map
+	const int32_t left = (cx - radius < 0) ? -cx : -radius;
+	const int32_t right = (cx + radius >= columns) ? columns - 1 - cx : radius;
+	const int32_t top = (cy - radius < 0) ? -cy : -radius;
+	const int32_t bottom = (cy + radius >= rows) ? rows - 1 - cy : radius;
+	int32_t* values = map->layers[layer];
+	for(int32_t dy = top; dy <= bottom; dy++){
+	    int32_t* row = &values[(cy + dy) * columns + cx];
+	    const int32_t* weights = &kernel->weights[(dy + radius) * side + radius];
+	    for(int32_t dx = left; dx <= right; dx++){
+	        row[dx] += weights[dx] * strength;
+	    }
+	}
+}
+
+void FIELD_Move(FIELD_Map* map, FIELD_Layer oldLayer, float oldX, float oldY, int32_t oldStrength,
+                FIELD_Layer newLayer, float newX, float newY, int32_t newStrength) {
+	if(map->columns == 0){
+	    return;
+	}
+	if(oldLayer == newLayer && oldStrength == newStrength &&
+	   FIELD_Coordinate(oldX, map->inverseCellSize, map->columns) == FIELD_Coordinate(newX, map->inverseCellSize, map->columns) &&
+	   FIELD_Coordinate(oldY, map->inverseCellSize, map->rows) == FIELD_Coordinate(newY, map->inverseCellSize, map->rows)){
+	    return;
+	}
+	FIELD_Stamp(map, oldLayer, oldX, oldY, -oldStrength);
+	FIELD_Stamp(map, newLayer, newX, newY, newStrength);
+}
+
+float FIELD_Sample(const FIELD_Map* map, float x, float y) {
+	if(map->columns == 0){
+	    return 0.0f;
+	}
+	// position relative to the cell centres, clamped to the outermost centres
+	float fx = fminf(fmaxf(x * map->inverseCellSize - 0.5f, 0.0f), (float)(map->columns - 1));
+	float fy = fminf(fmaxf(y * map->inverseCellSize - 0.5f, 0.0f), (float)(map->rows - 1));
+	uint32_t x0 = (uint32_t)fx, y0 = (uint32_t)fy;
+	uint32_t x1 = (x0 + 1 < map->columns) ? x0 + 1 : x0;
+	uint32_t y1 = (y0 + 1 < map->rows) ? y0 + 1 : y0;
+	float tx = fx - (float)x0, ty = fy - (float)y0;
+
+	float top = (1.0f - tx) * (float)FIELD_CellValue(map, y0 * map->columns + x0) +
+	            tx * (float)FIELD_CellValue(map, y0 * map->columns + x1);
+	float bottom = (1.0f - tx) * (float)FIELD_CellValue(map, y1 * map->columns + x0) +
+	               tx * (float)FIELD_CellValue(map, y1 * map->columns + x1);
+	return (1.0f - ty) * top + ty * bottom;
+}
+
+void FIELD_Gradient(const FIELD_Map* map, float x, float y, float* gradientX, float* gradientY) {
+	const float step = map->cellSize;
+	*gradientX = FIELD_Sample(map, x + step, y) - FIELD_Sample(map, x - step, y);
+	*gradientY = FIELD_Sample(map, x, y + step) - FIELD_Sample(map, x, y - step);
+}
+
+bool FIELD_Dump(const FIELD_Map* map, FILE* file) {
+	fprintf(file, "# field %u x %u cells of %.1f\n", map->columns, map->rows, map->cellSize);
+	for(int l = 0; l < FIELD_LAYER_COUNT; l++){
+	    fprintf(file, "# %s\n", FIELD_LAYER_NAMES[l]);
+	    for(uint32_t r = 0; r < map->rows; r++){
+	        for(uint32_t c = 0; c < map->columns; c++){
+	            fprintf(file, (c == 0) ? "%d" : " %d", map->layers[l][r * map->columns + c]);
+	        }
+	        fputc('\n', file);
+	    }
+	}
+	fprintf(file, "# value\n");
+	for(uint32_t r = 0; r < map->rows; r++){
+	    for(uint32_t c = 0; c < map->columns; c++){
+	        fprintf(file, (c == 0) ? "%d" : " %d", FIELD_CellValue(map, r * map->columns + c));
+	    }
+	    fputc('\n', file);
+	}
+	return !ferror(file);
+}
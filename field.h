@@ -0,0 +1,124 @@
+#ifndef FIELD_H_
+#define FIELD_H_
+
+/**
+ * Coarse potential field over the game map: attraction of the things worth moving to, repulsion of the things
+ * worth running from and the cost of the glue, each in a layer of its own.
+ *
+ * Every object contributes a fixed kernel of its layer (attraction falls off slowly over a long reach, repulsion
+ * steeply over a short one, glue is a plateau over its area) centred on its cell and multiplied by an integer
+ * strength chosen by the caller. The layers are integer sums, so a contribution is taken back exactly by stamping
+ * the same kernel with the negated strength: an object that moves, changes or disappears is updated with a delta
+ * (@ref FIELD_Move) instead of rebuilding the field, and the field never drifts from the sum of its objects.
+ *
+ * Reading the field costs the same whatever the number of objects: @ref FIELD_Gradient interpolates a handful
+ * of cells around a point. @ref FIELD_Dump writes the layers as text for debugging.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/// Maximum number of cells along one axis of the field (larger maps get larger cells)
+#define FIELD_MAX_CELLS_PER_AXIS 128
+/// Distance over which an attraction reaches
+#define FIELD_ATTRACTION_REACH 400.0f
+/// Distance over which a repulsion reaches
+#define FIELD_REPULSION_REACH 100.0f
+/// Distance over which a glue cost reaches (the glue radius)
+#define FIELD_GLUE_REACH 100.0f
+/// Kernel value at the centre of a contribution of strength 1
+#define FIELD_KERNEL_SCALE 256
+
+/** Layers of the field */
+typedef enum {
+	FIELD_ATTRACTION = 0,          ///< raises the value of the cells around the object
+	FIELD_REPULSION,               ///< lowers the value of the cells around the object
+	FIELD_GLUE,                    ///< lowers the value of the cells covered by the object
+	FIELD_LAYER_COUNT
+} FIELD_Layer;
+
+/** Kernel of one layer (values of the cells around the centre) */
+typedef struct {
+	int32_t radius;                ///< cells reached on every side of the centre
+	int32_t* weights;              ///< (2 * radius + 1)^2 values, row by row
+} FIELD_Kernel;
+
+/** Structure of the field */
+typedef struct {
+	float cellSize;                             ///< length of the cell side
+	float inverseCellSize;                      ///< 1 / cellSize
+	uint32_t columns;                           ///< number of cells along the X axis (0 = no field)
+	uint32_t rows;                              ///< number of cells along the Y axis
+	int32_t* layers[FIELD_LAYER_COUNT];         ///< sums of the contributions of every layer, row by row
+	FIELD_Kernel kernels[FIELD_LAYER_COUNT];    ///< kernel of every layer for the current cell size
+} FIELD_Map;
+
+/**
+ * @brief Initializes an empty field (no cells until @ref FIELD_Reset).
+ */
+void FIELD_Init(FIELD_Map* map);
+
+/**
+ * @brief Releases all memory of the field.
+ */
+void FIELD_Free(FIELD_Map* map);
+
+/**
+ * @brief Changes the geometry of the field for a map of the given size and clears all layers.
+ *
+ * @param map field to reset
+ * @param width map width
+ * @param height map height
+ * @param cellSize preferred cell size (increased if the map would need more than FIELD_MAX_CELLS_PER_AXIS cells)
+ *
+ * @return true on success, on failure the field is left without cells
+ */
+bool FIELD_Reset(FIELD_Map* map, float width, float height, float cellSize);
+
+/**
+ * @brief Clears all layers (keeps the geometry).
+ */
+void FIELD_Clear(FIELD_Map* map);
+
+/**
+ * @brief Adds the kernel of a layer centred on the cell of a point, multiplied by strength.
+ *
+ * A negative strength takes a contribution back. Points outside the map are clamped to the border cells.
+ */
+void FIELD_Stamp(FIELD_Map* map, FIELD_Layer layer, float x, float y, int32_t strength);
+
+/**
+ * @brief Replaces a contribution with another one (old strength 0: none before, new strength 0: none after).
+ *
+ * Nothing is done if both are the same in the same cell.
+ */
+void FIELD_Move(FIELD_Map* map, FIELD_Layer oldLayer, float oldX, float oldY, int32_t oldStrength,
+                FIELD_Layer newLayer, float newX, float newY, int32_t newStrength);
+
+/**
+ * @brief Value of the field at a point: attraction - repulsion - glue, bilinear between the cell centres.
+ */
+float FIELD_Sample(const FIELD_Map* map, float x, float y);
+
+/**
+ * @brief Gradient of the field at a point (central differences one cell on either side), pointing to higher values.
+ */
+void FIELD_Gradient(const FIELD_Map* map, float x, float y, float* gradientX, float* gradientY);
+
+/**
+ * @brief Writes the geometry and every layer as text, one row of cells per line.
+ *
+ * @return false if writing failed
+ */
+bool FIELD_Dump(const FIELD_Map* map, FILE* file);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* FIELD_H_ */
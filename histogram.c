@@ -0,0 +1,80 @@
+#include <string.h>
+#include "histogram.h"
+
+static unsigned HISTOGRAM_BucketIndex(uint64_t value) {
+	if(value < HISTOGRAM_SUB_BUCKETS){
+	    return (unsigned)value;
+	}
+	unsigned exponent = 63u - (unsigned)__builtin_clzll(value);
+	unsigned sub = (unsigned)(value >> (exponent - HISTOGRAM_SUB_BUCKET_BITS)) & (HISTOGRAM_SUB_BUCKETS - 1);
+	return (exponent - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS + sub;
+}
+
+static uint64_t HISTOGRAM_BucketUpperBound(unsigned index) {
+	if(index < HISTOGRAM_SUB_BUCKETS){
+	    return index;
+	}
+	unsigned exponent = index / HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKET_BITS - 1;
+	uint64_t sub = index % HISTOGRAM_SUB_BUCKETS;
+	uint64_t lower = ((uint64_t)HISTOGRAM_SUB_BUCKETS + sub) << (exponent - HISTOGRAM_SUB_BUCKET_BITS);
+	return lower + ((uint64_t)1 << (exponent - HISTOGRAM_SUB_BUCKET_BITS)) - 1;
+}
+
+void HISTOGRAM_Init(HISTOGRAM_Histogram* histogram) {
+	memset(histogram, 0, sizeof(HISTOGRAM_Histogram));
+	histogram->min = UINT64_MAX;
+}
+
+void HISTOGRAM_Record(HISTOGRAM_Histogram* histogram, uint64_t value) {
+	histogram->buckets[HISTOGRAM_BucketIndex(value)]++;
+	histogram->count++;
+	histogram->sum += value;
+	if(value < histogram->min){
+	    histogram->min = value;
+	}
+	if(value > histogram->max){
+	    histogram->max = value;
+	}
+}
+
+void HISTOGRAM_Merge(HISTOGRAM_Histogram* destination, const HISTOGRAM_Histogram* source) {
+	for(unsigned i = 0; i < HISTOGRAM_BUCKETS; i++){
+	    destination->buckets[i] += source->buckets[i];
+	}
+	destination->count += source->count;
+	destination->sum += source->sum;
+	if(source->min < destination->min){
+	    destination->min = source->min;
+	}
+	if(source->max > destination->max){
+	    destination->max = source->max;
+	}
+}
+
+uint64_t HISTOGRAM_Percentile(const HISTOGRAM_Histogram* histogram, double fraction) {
+	if(histogram->count == 0){
+	    return 0;
+	}
+	uint64_t rank = (uint64_t)(fraction * (double)histogram->count);
+	if(rank >= histogram->count){
+	    rank = histogram->count - 1;
+	}
+	uint64_t seen = 0;
+	for(unsigned i = 0; i < HISTOGRAM_BUCKETS; i++){
+	    seen += histogram->buckets[i];
+	    if(seen > rank){
+	        uint64_t bound = HISTOGRAM_BucketUpperBound(i);
+	        return (bound < histogram->max) ? bound : histogram->max;
+	    }
+	}
+	return histogram->max;
+}
+
+void HISTOGRAM_Write(const HISTOGRAM_Histogram* histogram, FILE* file) {
+	for(unsigned i = 0; i < HISTOGRAM_BUCKETS; i++){
+	    if(histogram->buckets[i] != 0){
+	        fprintf(file, "%llu %llu\n", (unsigned long long)HISTOGRAM_BucketUpperBound(i),
+	                (unsigned long long)histogram->buckets[i]);
+	    }
+	}
+}
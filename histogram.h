@@ -0,0 +1,71 @@
+#ifndef HISTOGRAM_H_
+#define HISTOGRAM_H_
+
+/**
+ * Fixed-size log-linear histogram for latency measurements.
+ *
+ * Values are grouped by their power of two and each power of two is split into
+ * HISTOGRAM_SUB_BUCKETS linear sub-buckets, which gives a relative error of at most 1/HISTOGRAM_SUB_BUCKETS
+ * over the whole uint64_t range. Recording is O(1) and allocation free, so it can be used on the hot path.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+
+enum {
+	/// Number of linear sub-buckets per power of two (must be a power of two)
+	HISTOGRAM_SUB_BUCKETS = 8,
+	/// log2(HISTOGRAM_SUB_BUCKETS)
+	HISTOGRAM_SUB_BUCKET_BITS = 3,
+	/// Total number of buckets
+	HISTOGRAM_BUCKETS = 64 * HISTOGRAM_SUB_BUCKETS
+};
+
+/** Structure of the histogram */
+typedef struct {
+	uint64_t buckets[HISTOGRAM_BUCKETS];   ///< number of values in each bucket
+	uint64_t count;                        ///< number of recorded values
+	uint64_t sum;                          ///< sum of recorded values
+	uint64_t min;                          ///< smallest recorded value
+	uint64_t max;                          ///< largest recorded value
+} HISTOGRAM_Histogram;
+
+/**
+ * @brief Clears the histogram.
+ */
+void HISTOGRAM_Init(HISTOGRAM_Histogram* histogram);
+
+/**
+ * @brief Records one value.
+ */
+void HISTOGRAM_Record(HISTOGRAM_Histogram* histogram, uint64_t value);
+
+/**
+ * @brief Adds all values recorded in source to destination.
+ */
+void HISTOGRAM_Merge(HISTOGRAM_Histogram* destination, const HISTOGRAM_Histogram* source);
+
+/**
+ * @brief Returns the value below which the given fraction of the recorded values lie.
+ *
+ * @param histogram histogram to query
+ * @param fraction percentile as a fraction (e.g. 0.99 for p99)
+ *
+ * @return upper bound of the bucket containing the percentile (0 if the histogram is empty)
+ */
+uint64_t HISTOGRAM_Percentile(const HISTOGRAM_Histogram* histogram, double fraction);
+
+/**
+ * @brief Writes the non-empty buckets as "upper_bound count" lines.
+ */
+void HISTOGRAM_Write(const HISTOGRAM_Histogram* histogram, FILE* file);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* HISTOGRAM_H_ */
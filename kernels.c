@@ -0,0 +1,71 @@
+#include <stdatomic.h>
+#include <stddef.h>
+#include "kernels_internal.h"
+
+static void KERNELS_ScoreScalar(const float* x, const float* y, const float* hp, uint32_t count,
+                                const KERNELS_ScoreParams* params, float* squaredDistances, float* scores) {
+	for(uint32_t i = 0; i < count; i++){
+	    KERNELS_ScoreElement(x, y, hp, i, params, squaredDistances, scores);
+	}
+}
+
+static int32_t KERNELS_ArgMaxScalar(const float* scores, uint32_t count) {
+	int32_t best = -1;
+	float bestScore = 0.0f;
+	for(uint32_t i = 0; i < count; i++){
+	    if(scores[i] > bestScore){
+	        bestScore = scores[i];
+	        best = (int32_t)i;
+	    }
+	}
+	return best;
+}
+
+void KERNELS_ScoreSelected(const float* x, const float* y, const float* hp, const uint32_t* indices, uint32_t count,
+                           const KERNELS_ScoreParams* params, float* squaredDistances, float* scores) {
+	for(uint32_t j = 0; j < count; j++){
+	    uint32_t i = indices[j];
+	    KERNELS_ScoreElement(x + i, y + i, hp + i, 0, params, squaredDistances + j, scores + j);
+	}
+}
+
+static const KERNELS_Implementation KERNELS_scalarImplementation = {
+	"scalar", KERNELS_ScoreScalar, KERNELS_ArgMaxScalar
+};
+
+static _Atomic(const KERNELS_Implementation*) KERNELS_active = NULL;
+
+const KERNELS_Implementation* KERNELS_GetLevel(KERNELS_Level level) {
+	switch(level){
+	    case KERNELS_SCALAR:
+	        return &KERNELS_scalarImplementation;
+#ifdef MNIAM_X86_KERNELS
+	    case KERNELS_SSE2:
+	        return __builtin_cpu_supports("sse2") ? &KERNELS_sse2Implementation : NULL;
+	    case KERNELS_AVX2:
+	        return __builtin_cpu_supports("avx2") ? &KERNELS_avx2Implementation : NULL;
+#endif
+	    default:
+	        return NULL;
+	}
+}
+
+const KERNELS_Implementation* KERNELS_Get(void) {
+	const KERNELS_Implementation* implementation = atomic_load(&KERNELS_active);
+	if(implementation == NULL){
+	    for(int level = KERNELS_LEVEL_COUNT - 1; level >= 0 && implementation == NULL; level--){
+	        implementation = KERNELS_GetLevel((KERNELS_Level)level);
+	    }
+	    atomic_store(&KERNELS_active, implementation);
+	}
+	return implementation;
+}
+
+bool KERNELS_Select(KERNELS_Level level) {
+	const KERNELS_Implementation* implementation = KERNELS_GetLevel(level);
+	if(implementation == NULL){
+	    return false;
+	}
+	atomic_store(&KERNELS_active, implementation);
+	return true;
+}
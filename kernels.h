@@ -0,0 +1,97 @@
+#ifndef KERNELS_H_
+#define KERNELS_H_
+
+/**
+ * Vectorized scoring kernels used by calculateMovement.
+ *
+ * Every scoring pass of the decision (danger, attack, hunt, spark, food) has the same shape: for each object
+ * of a class compute the distance from our position, check HP and range conditions and compute
+ * score = numerator / (distance / mapDiagonal). The kernels work in the squared domain - they compute
+ * score^2 = numerator^2 * mapDiagonal^2 / distance^2 from the squared distance, which orders the objects the
+ * same way (numerators are positive) without a square root or a division per distance. They do this over the
+ * structure-of-arrays object tables and pick the best target. Implementations exist for plain C, SSE2 and AVX2; the best one supported by the CPU
+ * is selected at run time. All implementations perform the same IEEE operations in the same order, so they
+ * produce bit-identical scores.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** Available kernel implementations */
+typedef enum {
+	KERNELS_SCALAR = 0,
+	KERNELS_SSE2 = 1,
+	KERNELS_AVX2 = 2,
+	KERNELS_LEVEL_COUNT
+} KERNELS_Level;
+
+/** Parameters of a scoring pass */
+typedef struct {
+	float originX;            ///< X of the point distances are measured from (our position)
+	float originY;            ///< Y of the point distances are measured from (our position)
+	float minHp;              ///< only objects with hp > minHp are scored
+	float maxHp;              ///< only objects with hp < maxHp are scored
+	float maxDistance;        ///< range of the pass (INFINITY = no limit), used to query the spatial indexes
+	float maxSquaredDistance; ///< only objects with squared distance <= maxSquaredDistance are scored
+	float numerator;          ///< score numerator (> 0), unless numeratorIsHp is set
+	bool numeratorIsHp;       ///< use the object's hp as the score numerator
+	float mapDiagonalSquared; ///< distances are expressed as a fraction of the map diagonal
+} KERNELS_ScoreParams;
+
+/**
+ * Type of the scoring kernel: writes the squared distance and the squared score of every object.
+ * Objects that do not satisfy the conditions get score 0. All arrays must be KERNELS_ALIGNMENT aligned.
+ */
+typedef void (*KERNELS_ScoreFunction)(const float* x, const float* y, const float* hp, uint32_t count,
+                                      const KERNELS_ScoreParams* params, float* squaredDistances, float* scores);
+
+/**
+ * Type of the selection kernel: returns the first index holding the maximal score, or -1 if no score is > 0.
+ */
+typedef int32_t (*KERNELS_ArgMaxFunction)(const float* scores, uint32_t count);
+
+/** Structure describing one implementation of the kernels */
+typedef struct {
+	const char* name;                 ///< implementation name (for reports)
+	KERNELS_ScoreFunction score;      ///< scoring kernel
+	KERNELS_ArgMaxFunction argMax;    ///< selection kernel
+} KERNELS_Implementation;
+
+/// Required alignment of kernel arrays in bytes
+#define KERNELS_ALIGNMENT 32
+
+/**
+ * @brief Scores the objects at the given positions of the arrays (plain C, used for candidates from the spatial index).
+ *
+ * The result for indices[j] is written to squaredDistances[j] and scores[j]. It is identical to what the
+ * scoring kernels compute for that object.
+ */
+void KERNELS_ScoreSelected(const float* x, const float* y, const float* hp, const uint32_t* indices, uint32_t count,
+                           const KERNELS_ScoreParams* params, float* squaredDistances, float* scores);
+
+/**
+ * @brief Returns the active implementation (the best one supported by the CPU unless another was selected).
+ */
+const KERNELS_Implementation* KERNELS_Get(void);
+
+/**
+ * @brief Returns the given implementation or NULL if it is not compiled in or not supported by the CPU.
+ */
+const KERNELS_Implementation* KERNELS_GetLevel(KERNELS_Level level);
+
+/**
+ * @brief Makes the given implementation active (used by benchmarks to compare implementations).
+ *
+ * @return false if the implementation is not available
+ */
+bool KERNELS_Select(KERNELS_Level level);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* KERNELS_H_ */
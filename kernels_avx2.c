@@ -0,0 +1,62 @@
+#include <immintrin.h>
+#include "kernels_internal.h"
+
+static void KERNELS_ScoreAvx2(const float* x, const float* y, const float* hp, uint32_t count,
+                              const KERNELS_ScoreParams* params, float* squaredDistances, float* scores) {
+	const __m256 originX = _mm256_set1_ps(params->originX);
+	const __m256 originY = _mm256_set1_ps(params->originY);
+	const __m256 minHp = _mm256_set1_ps(params->minHp);
+	const __m256 maxHp = _mm256_set1_ps(params->maxHp);
+	const __m256 maxSquaredDistance = _mm256_set1_ps(params->maxSquaredDistance);
+	const __m256 weight = _mm256_set1_ps(KERNELS_Weight(params->numerator, params));
+	const __m256 mapDiagonalSquared = _mm256_set1_ps(params->mapDiagonalSquared);
+	uint32_t i = 0;
+	for(; i + 8 <= count; i += 8){
+	    __m256 dx = _mm256_sub_ps(_mm256_load_ps(x + i), originX);
+	    __m256 dy = _mm256_sub_ps(_mm256_load_ps(y + i), originY);
+	    __m256 squared = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+	    __m256 h = _mm256_load_ps(hp + i);
+	    __m256 valid = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(h, minHp, _CMP_GT_OQ), _mm256_cmp_ps(h, maxHp, _CMP_LT_OQ)),
+	                                 _mm256_cmp_ps(squared, maxSquaredDistance, _CMP_NGT_UQ));
+	    __m256 w = params->numeratorIsHp ? _mm256_mul_ps(_mm256_mul_ps(h, h), mapDiagonalSquared) : weight;
+	    __m256 score = _mm256_div_ps(w, squared);
+	    _mm256_store_ps(squaredDistances + i, squared);
+	    _mm256_store_ps(scores + i, _mm256_and_ps(valid, score));
+	}
+	for(; i < count; i++){
+	    KERNELS_ScoreElement(x, y, hp, i, params, squaredDistances, scores);
+	}
+}
+
+static int32_t KERNELS_ArgMaxAvx2(const float* scores, uint32_t count) {
+	__m256 best = _mm256_setzero_ps();
+	uint32_t i = 0;
+	for(; i + 8 <= count; i += 8){
+	    best = _mm256_max_ps(best, _mm256_load_ps(scores + i));
+	}
+	__m128 half = _mm_max_ps(_mm256_castps256_ps128(best), _mm256_extractf128_ps(best, 1));
+	half = _mm_max_ps(half, _mm_shuffle_ps(half, half, _MM_SHUFFLE(1, 0, 3, 2)));
+	half = _mm_max_ps(half, _mm_shuffle_ps(half, half, _MM_SHUFFLE(2, 3, 0, 1)));
+	float bestScore = _mm_cvtss_f32(half);
+	for(; i < count; i++){
+	    if(scores[i] > bestScore){
+	        bestScore = scores[i];
+	    }
+	}
+	if(!(bestScore > 0.0f)){
+	    return -1;
+	}
+	// first vector containing the maximum, then the exact position inside it
+	const __m256 target = _mm256_set1_ps(bestScore);
+	uint32_t j = 0;
+	for(; j + 8 <= count; j += 8){
+	    if(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_load_ps(scores + j), target, _CMP_EQ_OQ)) != 0){
+	        break;
+	    }
+	}
+	return KERNELS_FindFirst(scores, j, count, bestScore);
+}
+
+const KERNELS_Implementation KERNELS_avx2Implementation = {
+	"avx2", KERNELS_ScoreAvx2, KERNELS_ArgMaxAvx2
+};
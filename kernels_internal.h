@@ -0,0 +1,52 @@
+#ifndef KERNELS_INTERNAL_H_
+#define KERNELS_INTERNAL_H_
+
+/**
+ * Definitions shared by the kernel implementations (not part of the public kernels API).
+ */
+
+#include <math.h>
+#include "kernels.h"
+
+/// SIMD implementations, compiled with their own instruction set flags (x86 only)
+extern const KERNELS_Implementation KERNELS_sse2Implementation;
+extern const KERNELS_Implementation KERNELS_avx2Implementation;
+
+/**
+ * Numerator of a squared score: numerator^2 * mapDiagonal^2 (the SIMD kernels compute it in the same order).
+ */
+static inline float KERNELS_Weight(float numerator, const KERNELS_ScoreParams* params) {
+	return numerator * numerator * params->mapDiagonalSquared;
+}
+
+/**
+ * Scores a single object - the reference the SIMD kernels must match bit for bit.
+ * Also used by the SIMD kernels for the elements that do not fill a whole vector.
+ */
+static inline void KERNELS_ScoreElement(const float* x, const float* y, const float* hp, uint32_t i,
+                                        const KERNELS_ScoreParams* params, float* squaredDistances, float* scores) {
+	float dx = x[i] - params->originX;
+	float dy = y[i] - params->originY;
+	float squared = dx*dx + dy*dy;
+	bool valid = hp[i] > params->minHp && hp[i] < params->maxHp && !(squared > params->maxSquaredDistance);
+	float numerator = params->numeratorIsHp ? hp[i] : params->numerator;
+	squaredDistances[i] = squared;
+	scores[i] = valid ? KERNELS_Weight(numerator, params) / squared : 0.0f;
+}
+
+/**
+ * Returns the first index in [start, count) holding exactly the given score, or -1 if the score is not > 0.
+ */
+static inline int32_t KERNELS_FindFirst(const float* scores, uint32_t start, uint32_t count, float bestScore) {
+	if(!(bestScore > 0.0f)){
+	    return -1;
+	}
+	for(uint32_t i = start; i < count; i++){
+	    if(scores[i] == bestScore){
+	        return (int32_t)i;
+	    }
+	}
+	return -1;
+}
+
+#endif /* KERNELS_INTERNAL_H_ */
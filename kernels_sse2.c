@@ -0,0 +1,61 @@
+#include <emmintrin.h>
+#include "kernels_internal.h"
+
+static void KERNELS_ScoreSse2(const float* x, const float* y, const float* hp, uint32_t count,
+                              const KERNELS_ScoreParams* params, float* squaredDistances, float* scores) {
+	const __m128 originX = _mm_set1_ps(params->originX);
+	const __m128 originY = _mm_set1_ps(params->originY);
+	const __m128 minHp = _mm_set1_ps(params->minHp);
+	const __m128 maxHp = _mm_set1_ps(params->maxHp);
+	const __m128 maxSquaredDistance = _mm_set1_ps(params->maxSquaredDistance);
+	const __m128 weight = _mm_set1_ps(KERNELS_Weight(params->numerator, params));
+	const __m128 mapDiagonalSquared = _mm_set1_ps(params->mapDiagonalSquared);
+	uint32_t i = 0;
+	for(; i + 4 <= count; i += 4){
+	    __m128 dx = _mm_sub_ps(_mm_load_ps(x + i), originX);
+	    __m128 dy = _mm_sub_ps(_mm_load_ps(y + i), originY);
+	    __m128 squared = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+	    __m128 h = _mm_load_ps(hp + i);
+	    __m128 valid = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(h, minHp), _mm_cmplt_ps(h, maxHp)),
+	                              _mm_cmpngt_ps(squared, maxSquaredDistance));
+	    __m128 w = params->numeratorIsHp ? _mm_mul_ps(_mm_mul_ps(h, h), mapDiagonalSquared) : weight;
+	    __m128 score = _mm_div_ps(w, squared);
+	    _mm_store_ps(squaredDistances + i, squared);
+	    _mm_store_ps(scores + i, _mm_and_ps(valid, score));
+	}
+	for(; i < count; i++){
+	    KERNELS_ScoreElement(x, y, hp, i, params, squaredDistances, scores);
+	}
+}
+
+static int32_t KERNELS_ArgMaxSse2(const float* scores, uint32_t count) {
+	__m128 best = _mm_setzero_ps();
+	uint32_t i = 0;
+	for(; i + 4 <= count; i += 4){
+	    best = _mm_max_ps(best, _mm_load_ps(scores + i));
+	}
+	best = _mm_max_ps(best, _mm_shuffle_ps(best, best, _MM_SHUFFLE(1, 0, 3, 2)));
+	best = _mm_max_ps(best, _mm_shuffle_ps(best, best, _MM_SHUFFLE(2, 3, 0, 1)));
+	float bestScore = _mm_cvtss_f32(best);
+	for(; i < count; i++){
+	    if(scores[i] > bestScore){
+	        bestScore = scores[i];
+	    }
+	}
+	if(!(bestScore > 0.0f)){
+	    return -1;
+	}
+	// first vector containing the maximum, then the exact position inside it
+	const __m128 target = _mm_set1_ps(bestScore);
+	uint32_t j = 0;
+	for(; j + 4 <= count; j += 4){
+	    if(_mm_movemask_ps(_mm_cmpeq_ps(_mm_load_ps(scores + j), target)) != 0){
+	        break;
+	    }
+	}
+	return KERNELS_FindFirst(scores, j, count, bestScore);
+}
+
+const KERNELS_Implementation KERNELS_sse2Implementation = {
+	"sse2", KERNELS_ScoreSse2, KERNELS_ArgMaxSse2
+};
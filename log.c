@@ -0,0 +1,218 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "log.h"
+#include "platform.h"
+
+/// Size of a cache line, the producer and consumer indexes live on separate lines
+#define LOG_CACHE_LINE 64
+/// Time the writer thread sleeps when all rings are empty
+#define LOG_IDLE_SLEEP_MS 1
+
+/** Level and format of an event */
+typedef struct {
+	LOG_Level level;
+	const char* format;      ///< printf format taking up to LOG_MAX_VALUES doubles
+} LOG_EventInfo;
+
+static const LOG_EventInfo LOG_events[LOG_EVENT_COUNT] = {
+	[LOG_EVENT_IDENTIFY]          = { LOG_LEVEL_INFO,  "Got IDENTIFY.request. Responding with IDENTIFY.response\n" },
+	[LOG_EVENT_NEW_GAME]          = { LOG_LEVEL_INFO,  "Got NEW_GAME.request.\n" },
+	[LOG_EVENT_GAME_PARAMETERS]   = { LOG_LEVEL_INFO,  "Player number: %.0f, Map: %.1fx%.1f\n" },
+	[LOG_EVENT_GAME_OVER]         = { LOG_LEVEL_INFO,  "Got GAME_OVER.request\n" },
+	[LOG_EVENT_UNKNOWN_PACKET]    = { LOG_LEVEL_ERROR, "Unknown packet type: %.0f\n" },
+	[LOG_EVENT_CONNECTION_CLOSED] = { LOG_LEVEL_INFO,  "Connection closed\n" },
+	[LOG_EVENT_POSITION]          = { LOG_LEVEL_DEBUG, "My position: (%.1f, %.1f), HP: %.1f\n" },
+	[LOG_EVENT_SPARK_ON_PATH]     = { LOG_LEVEL_DEBUG, "AVOIDING SPARK at (%.1f, %.1f), distance=%.1f!\n" },
+	[LOG_EVENT_ADJUSTED_ANGLE]    = { LOG_LEVEL_DEBUG, "Adjusted angle to: %.2f rad (%.1f degrees)\n" },
+	[LOG_EVENT_ESCAPE]            = { LOG_LEVEL_DEBUG, "ESCAPING from dangerous player at (%.1f, %.1f)\n" },
+	[LOG_EVENT_AVOID_SPARK]       = { LOG_LEVEL_DEBUG, "AVOIDING spark at (%.1f, %.1f)\n" },
+	[LOG_EVENT_ATTACK]            = { LOG_LEVEL_DEBUG, "ATTACKING weak player at (%.1f, %.1f), score=%.2f\n" },
+	[LOG_EVENT_COLLECT]           = { LOG_LEVEL_DEBUG, "COLLECTING food at (%.1f, %.1f), score=%.2f\n" },
+	[LOG_EVENT_HUNT]              = { LOG_LEVEL_DEBUG, "HUNTING at (%.1f, %.1f), score=%.2f\n" },
+	[LOG_EVENT_DANCE]             = { LOG_LEVEL_DEBUG, "NO TARGETS - Performing Konami Code dance!\n" },
+	[LOG_EVENT_PLANNED_MOVE]      = { LOG_LEVEL_DEBUG, "PLANNED move: %.2f rad (%.1f degrees)\n" },
+	[LOG_EVENT_FIELD_MOVE]        = { LOG_LEVEL_DEBUG, "FIELD move: gradient (%.1f, %.1f)\n" },
+};
+
+struct LOG_Ring {
+	_Alignas(LOG_CACHE_LINE) atomic_uint_fast32_t head;    ///< next record to write (owned by the producer)
+	_Alignas(LOG_CACHE_LINE) atomic_uint_fast32_t tail;    ///< next record to read (owned by the writer thread)
+	_Alignas(LOG_CACHE_LINE) atomic_uint_fast64_t dropped; ///< records lost because the ring was full
+	const atomic_int* level;                               ///< level of the logger
+	uint32_t mask;                                         ///< capacity - 1
+	LOG_Record* records;                                   ///< storage of the ring
+};
+
+struct LOG_Logger {
+	atomic_int level;                ///< current LOG_Level
+	atomic_bool running;             ///< cleared to stop the writer thread
+	FILE* output;                    ///< destination of the formatted records
+	uint32_t ringCount;              ///< number of rings
+	LOG_Ring* rings;                 ///< rings of the producers
+	PLATFORM_Thread thread;          ///< writer thread
+};
+
+/// Formats and writes the records queued in one ring, returns the number of records written
+static uint32_t LOG_Drain(LOG_Logger* logger, uint32_t index) {
+	LOG_Ring* ring = &logger->rings[index];
+	uint32_t tail = (uint32_t)atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	uint32_t head = (uint32_t)atomic_load_explicit(&ring->head, memory_order_acquire);
+	uint32_t written = 0;
+	for(; tail != head; tail++, written++){
+	    const LOG_Record* record = &ring->records[tail & ring->mask];
+	    double values[LOG_MAX_VALUES] = { 0.0 };
+	    for(uint32_t i = 0; i < record->valueCount; i++){
+	        values[i] = record->values[i];
+	    }
+	    if(logger->ringCount > 1){
+	        fprintf(logger->output, "[%u] ", index);
+	    }
+	    fprintf(logger->output, LOG_events[record->event].format, values[0], values[1], values[2], values[3]);
+	}
+	atomic_store_explicit(&ring->tail, tail, memory_order_release);
+	return written;
+}
+
+#if MNIAM_LOG_ENABLED
+static void LOG_WriterThread(void* arg) {
+	LOG_Logger* logger = (LOG_Logger*)arg;
+	while(atomic_load_explicit(&logger->running, memory_order_acquire)){
+	    uint32_t written = 0;
+	    for(uint32_t i = 0; i < logger->ringCount; i++){
+	        written += LOG_Drain(logger, i);
+	    }
+	    if(written > 0){
+	        fflush(logger->output);
+	    } else {
+	        PLATFORM_SleepMs(LOG_IDLE_SLEEP_MS);
+	    }
+	}
+}
+#endif
+
+LOG_Logger* LOG_Create(FILE* output, LOG_Level level, uint32_t ringCount, uint32_t ringCapacity) {
+#if !MNIAM_LOG_ENABLED
+	(void)output;
+	(void)level;
+	(void)ringCount;
+	(void)ringCapacity;
+	return NULL;
+#else
+	if(output == NULL || ringCount == 0 || ringCapacity == 0 || ringCapacity > (1u << 24)){
+	    return NULL;
+	}
+	uint32_t capacity = 1;
+	while(capacity < ringCapacity){
+	    capacity *= 2;
+	}
+	LOG_Logger* logger = (LOG_Logger*)calloc(1, sizeof(LOG_Logger));
+	if(logger == NULL){
+	    return NULL;
+	}
+	logger->rings = (LOG_Ring*)PLATFORM_AlignedAlloc(ringCount * sizeof(LOG_Ring), LOG_CACHE_LINE);
+	if(logger->rings == NULL){
+	    free(logger);
+	    return NULL;
+	}
+	memset(logger->rings, 0, ringCount * sizeof(LOG_Ring));
+	logger->output = output;
+	logger->ringCount = ringCount;
+	atomic_init(&logger->level, (int)level);
+	atomic_init(&logger->running, true);
+	bool allocated = true;
+	for(uint32_t i = 0; i < ringCount; i++){
+	    LOG_Ring* ring = &logger->rings[i];
+	    atomic_init(&ring->head, 0);
+	    atomic_init(&ring->tail, 0);
+	    atomic_init(&ring->dropped, 0);
+	    ring->level = &logger->level;
+	    ring->mask = capacity - 1;
+	    ring->records = (LOG_Record*)malloc(capacity * sizeof(LOG_Record));
+	    allocated = allocated && ring->records != NULL;
+	}
+	if(!allocated || !PLATFORM_StartThread(&logger->thread, LOG_WriterThread, logger)){
+	    for(uint32_t i = 0; i < ringCount; i++){
+	        free(logger->rings[i].records);
+	    }
+	    PLATFORM_AlignedFree(logger->rings);
+	    free(logger);
+	    return NULL;
+	}
+	return logger;
+#endif
+}
+
+void LOG_Destroy(LOG_Logger* logger) {
+	if(logger == NULL){
+	    return;
+	}
+	atomic_store_explicit(&logger->running, false, memory_order_release);
+	PLATFORM_JoinThread(&logger->thread);
+	for(uint32_t i = 0; i < logger->ringCount; i++){
+	    LOG_Drain(logger, i);
+	}
+	uint64_t dropped = LOG_DroppedCount(logger);
+	if(dropped > 0){
+	    fprintf(logger->output, "Log: %llu records dropped (ring full)\n", (unsigned long long)dropped);
+	}
+	fflush(logger->output);
+	for(uint32_t i = 0; i < logger->ringCount; i++){
+	    free(logger->rings[i].records);
+	}
+	PLATFORM_AlignedFree(logger->rings);
+	free(logger);
+}
+
+LOG_Ring* LOG_GetRing(LOG_Logger* logger, uint32_t index) {
+	if(logger == NULL || index >= logger->ringCount){
+	    return NULL;
+	}
+	return &logger->rings[index];
+}
+
+void LOG_SetLevel(LOG_Logger* logger, LOG_Level level) {
+	if(logger != NULL){
+	    atomic_store_explicit(&logger->level, (int)level, memory_order_relaxed);
+	}
+}
+
+uint64_t LOG_DroppedCount(const LOG_Logger* logger) {
+	if(logger == NULL){
+	    return 0;
+	}
+	uint64_t dropped = 0;
+	for(uint32_t i = 0; i < logger->ringCount; i++){
+	    dropped += atomic_load_explicit(&logger->rings[i].dropped, memory_order_relaxed);
+	}
+	return dropped;
+}
+
+bool LOG_ParseLevel(const char* name, LOG_Level* level) {
+	static const char* const names[] = { "off", "error", "info", "debug" };
+	for(int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++){
+	    if(strcmp(name, names[i]) == 0){
+	        *level = (LOG_Level)i;
+	        return true;
+	    }
+	}
+	return false;
+}
+
+void LOG_Write(LOG_Ring* ring, LOG_Event event, uint32_t gameTime, uint32_t valueCount, const float* values) {
+	if((int)LOG_events[event].level > atomic_load_explicit(ring->level, memory_order_relaxed)){
+	    return;
+	}
+	uint32_t head = (uint32_t)atomic_load_explicit(&ring->head, memory_order_relaxed);
+	uint32_t tail = (uint32_t)atomic_load_explicit(&ring->tail, memory_order_acquire);
+	if(head - tail > ring->mask){
+	    atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+	    return;
+	}
+	LOG_Record* record = &ring->records[head & ring->mask];
+	record->event = (uint16_t)event;
+	record->valueCount = (uint16_t)(valueCount < LOG_MAX_VALUES ? valueCount : LOG_MAX_VALUES);
+	record->gameTime = gameTime;
+	memcpy(record->values, values, record->valueCount * sizeof(float));
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
@@ -0,0 +1,148 @@
+#ifndef LOG_H_
+#define LOG_H_
+
+/**
+ * Asynchronous binary logger that keeps text formatting and I/O off the move path.
+ *
+ * Every producer thread (a worker of the host) owns one @ref LOG_Ring - a single-producer/single-consumer ring of
+ * fixed-size records (event id, game time and up to LOG_MAX_VALUES floats). Writing a record is a level check,
+ * a copy and one release store. A background thread drains all rings, formats the records with the format string
+ * of their event and writes them to the output file. When a ring is full the record is dropped and counted.
+ *
+ * Building with MNIAM_LOG_ENABLED defined to 0 (CMake option MNIAM_LOGGING=OFF) removes the logging entirely:
+ * @ref LOG_WRITE expands to nothing and @ref LOG_Create returns NULL.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#ifndef MNIAM_LOG_ENABLED
+#define MNIAM_LOG_ENABLED 1
+#endif
+
+/// Number of float values carried by a record
+#define LOG_MAX_VALUES 4
+
+/** Log levels, a record is written when the level of its event is <= the level of the logger */
+typedef enum {
+	LOG_LEVEL_OFF = 0,
+	LOG_LEVEL_ERROR,
+	LOG_LEVEL_INFO,
+	LOG_LEVEL_DEBUG
+} LOG_Level;
+
+/** Events that can be logged (their level and format are defined in log.c) */
+typedef enum {
+	LOG_EVENT_IDENTIFY = 0,        ///< IDENTIFY.request received
+	LOG_EVENT_NEW_GAME,            ///< NEW_GAME.request received
+	LOG_EVENT_GAME_PARAMETERS,     ///< player number, map width, map height
+	LOG_EVENT_GAME_OVER,           ///< GAME_OVER.request received
+	LOG_EVENT_UNKNOWN_PACKET,      ///< packet type
+	LOG_EVENT_CONNECTION_CLOSED,   ///< the server closed the connection
+	LOG_EVENT_POSITION,            ///< our x, y, HP
+	LOG_EVENT_SPARK_ON_PATH,       ///< spark x, y, distance
+	LOG_EVENT_ADJUSTED_ANGLE,      ///< angle in radians, angle in degrees
+	LOG_EVENT_ESCAPE,              ///< dangerous player x, y
+	LOG_EVENT_AVOID_SPARK,         ///< spark x, y
+	LOG_EVENT_ATTACK,              ///< player x, y, score
+	LOG_EVENT_COLLECT,             ///< transistor x, y, score
+	LOG_EVENT_HUNT,                ///< player x, y, score
+	LOG_EVENT_DANCE,               ///< no targets
+	LOG_EVENT_PLANNED_MOVE,        ///< angle in radians, angle in degrees (move found by the planner)
+	LOG_EVENT_FIELD_MOVE,          ///< gradient X, gradient Y (move along the potential field)
+	LOG_EVENT_COUNT
+} LOG_Event;
+
+/** Record stored in a ring */
+typedef struct {
+	uint16_t event;                    ///< LOG_Event
+	uint16_t valueCount;               ///< number of used entries in values
+	uint32_t gameTime;                 ///< server game time at which the record was written
+	float values[LOG_MAX_VALUES];      ///< arguments of the format string of the event
+} LOG_Record;
+
+/** Opaque structure of a single-producer ring */
+typedef struct LOG_Ring LOG_Ring;
+
+/** Opaque structure of the logger (its rings and the writer thread) */
+typedef struct LOG_Logger LOG_Logger;
+
+/**
+ * @brief Creates the logger and starts its writer thread.
+ *
+ * @param output file the records are written to
+ * @param level initial log level
+ * @param ringCount number of rings (one per producer thread)
+ * @param ringCapacity number of records in each ring (rounded up to a power of two)
+ *
+ * @return the logger, or NULL if it could not be created or logging is compiled out
+ */
+LOG_Logger* LOG_Create(FILE* output, LOG_Level level, uint32_t ringCount, uint32_t ringCapacity);
+
+/**
+ * @brief Stops the writer thread, writes the records that are still queued and releases the logger.
+ *
+ * Reports the number of dropped records to the output. NULL is ignored.
+ */
+void LOG_Destroy(LOG_Logger* logger);
+
+/**
+ * @brief Returns the ring of one producer.
+ *
+ * @param logger logger (NULL returns NULL)
+ * @param index index of the ring (0 .. ringCount - 1)
+ *
+ * @return the ring, NULL if the logger is NULL or the index is out of range
+ */
+LOG_Ring* LOG_GetRing(LOG_Logger* logger, uint32_t index);
+
+/**
+ * @brief Changes the log level. Can be called from any thread while the logger runs.
+ */
+void LOG_SetLevel(LOG_Logger* logger, LOG_Level level);
+
+/**
+ * @brief Returns the total number of records dropped because a ring was full.
+ */
+uint64_t LOG_DroppedCount(const LOG_Logger* logger);
+
+/**
+ * @brief Parses a level name ("off", "error", "info" or "debug").
+ *
+ * @return true if the name is valid
+ */
+bool LOG_ParseLevel(const char* name, LOG_Level* level);
+
+/**
+ * @brief Queues one record. Must only be called by the thread owning the ring.
+ *
+ * @param ring ring of the calling thread
+ * @param event event to log
+ * @param gameTime server game time
+ * @param valueCount number of valid values (at most LOG_MAX_VALUES)
+ * @param values arguments of the format string of the event
+ */
+void LOG_Write(LOG_Ring* ring, LOG_Event event, uint32_t gameTime, uint32_t valueCount, const float* values);
+
+#if MNIAM_LOG_ENABLED
+/// Queues an event with its float arguments to the ring (a NULL ring disables logging)
+#define LOG_WRITE(ring, event, gameTime, ...) do { \
+        if ((ring) != NULL) { \
+            const float logValues_[] = { 0.0f, ##__VA_ARGS__ }; \
+            LOG_Write((ring), (event), (gameTime), (uint32_t)(sizeof(logValues_) / sizeof(float)) - 1, logValues_ + 1); \
+        } \
+    } while (0)
+#else
+#define LOG_WRITE(ring, event, gameTime, ...) do { } while (0)
+#endif
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* LOG_H_ */
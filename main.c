@@ -1,651 +1,400 @@
-#undef UNICODE
-#define WIN32_LEAN_AND_MEAN
-
-#include <windows.h>
-#include <winsock2.h>
-#include <ws2tcpip.h>
 #include <stdlib.h>
 #include <stdio.h>
-#include <math.h>
 #include <string.h>
 #include <stdbool.h>
 #include "amcom.h"
 #include "amcom_packets.h"
+#include "bot.h"
+#include "histogram.h"
+#include "log.h"
+#include "params.h"
+#include "planner.h"
+#include "platform.h"
+#include "trace.h"
+#include "transport.h"
+
+#define DEFAULT_GAME_SERVER "localhost"
+#define DEFAULT_GAME_SERVER_PORT "2001"
 
-// Game configuration constants
-#define MAX_PLAYERS 10
-#define MAX_TRANSISTORS 100
-#define MAX_SPARKS 20
-#define MAX_GLUE_SPOTS 10
+// Host mode limits
+#define MAX_SESSIONS 4096
+#define MAX_READY_SESSIONS 64
 
-// Game mechanics constants
-#define PLAYER_BASE_RADIUS 25          // Base player collision radius
-#define SPARK_BASE_RADIUS 25           // Base spark collision radius  
-#define GLUE_RADIUS 100                // Glue area effect radius
-#define DANGER_DETECTION_RANGE 100     // Range to detect dangerous players
-#define ATTACK_RANGE 150               // Range for attacking weaker players
-#define SPARK_DETECTION_RANGE 20       // Range to detect threatening sparks
-#define SPARK_AVOIDANCE_RADIUS 50      // Safety distance from sparks
-#define GLUE_MOVEMENT_PENALTY 20.0f    // Movement speed penalty in glue
-#define SPARK_AVOIDANCE_ANGLE (M_PI/3) // 60 degrees tolerance for spark detection
-#define EVASION_ANGLE (M_PI/2)         // 90 degrees turn for evasion
+// Records buffered per worker before the logger thread writes them out
+#define LOG_RING_CAPACITY 4096
 
 /**
- * Game state structure containing all game objects and player information
+ * State of a single game connection: socket, packet receiver and the game played on it
  */
 typedef struct {
-    // Game objects storage - separated by type for efficient access
-    AMCOM_ObjectState players[MAX_PLAYERS];        // All players on the map
-    uint8_t playerCount;                           // Current number of active players
-    
-    AMCOM_ObjectState transistors[MAX_TRANSISTORS]; // Food objects (+HP when collected)
-    uint8_t transistorCount;                       // Current number of transistors
-    
-    AMCOM_ObjectState sparks[MAX_SPARKS];          // Dangerous moving objects (-3 HP)
-    uint8_t sparkCount;                            // Current number of sparks
-    
-    AMCOM_ObjectState glue[MAX_GLUE_SPOTS];        // Slow zones (20x movement penalty)
-    uint8_t glueCount;                             // Current number of glue spots
-    
-    // Game session information
-    uint32_t currentGameTime;                      // Server game time
-    uint8_t myPlayerNumber;                        // Our player identifier
-    float mapWidth, mapHeight;                     // Map dimensions
-    bool gameActive;                               // Game session status
-    
-    // Cached player data for performance optimization
-    float myX, myY, myHP;                         // Our current position and health
-    bool myPlayerFound;                           // Flag indicating if we found ourselves
-    
-    // Entertainment feature
-    uint8_t konamiIndex;                          // Current step in Konami Code dance
-} GameState;
-
-// Global game state
-GameState gameState = {0};
+    TRANSPORT_Connection connection;               // Connection to the game server
+    AMCOM_Receiver receiver;                       // Packet receiver, its userContext points to this session
+    GameState gameState;                           // Game played on this connection
+    bool connected;                                // Cleared when the connection has to be closed
+    uint64_t receiveTimeNs;                        // Time at which the data being processed was received
+    HISTOGRAM_Histogram* moveLatency;              // Latency histogram of the worker serving this session
+    TRACE_Recorder* recorder;                      // Packet trace of this session (NULL = not recorded)
+} Session;
 
 /**
- * Normalizes angle to range [0, 2π) for consistent direction calculations
- * @param angle Input angle in radians
- * @return Normalized angle in range [0, 2π)
+ * Worker thread serving a group of sessions with its own event loop
  */
-float normalizeAngle(float angle) {
-    while(angle < 0) angle += 2 * M_PI;
-    while(angle >= 2 * M_PI) angle -= 2 * M_PI;
-    return angle;
-}
+typedef struct {
+    Session** sessions;                            // Sessions served by this worker
+    int sessionCount;                              // Number of sessions served by this worker
+    int cpu;                                       // CPU to pin the worker to (-1 = no pinning)
+    PLATFORM_Thread thread;                        // Worker thread
+    HISTOGRAM_Histogram moveLatency;               // recv -> send latency of MOVE responses [ns]
+    LOG_Ring* log;                                 // Log ring written by this worker (NULL = no logging)
+} Worker;
 
-/**
- * Updates player list with new player data, removing dead players
- * @param newPlayer Pointer to new player data from server
- */
-void updatePlayerList(AMCOM_ObjectState* newPlayer) {
-    bool playerExists = false;
-    
-    // Search for existing player to update
-    for(uint8_t i = 0; i < gameState.playerCount; i++) {
-        if(gameState.players[i].objectNo == newPlayer->objectNo) {
-            gameState.players[i] = *newPlayer;
-            playerExists = true;
-            break;
+void amPacketHandler(const AMCOM_PacketView* packet, void* userContext) {
+    uint8_t responseBuffer[AMCOM_MAX_PACKET_SIZE];
+    Session* session = (Session*)userContext;
+
+    TRACE_Record(session->recorder, TRACE_INBOUND, session->receiveTimeNs, &packet->header, packet->payload);
+    size_t responseSize = handleGamePacket(&session->gameState, packet, responseBuffer);
+
+    if (responseSize > 0 && session->connected) {
+        if (!TRANSPORT_Send(&session->connection, responseBuffer, responseSize)) {
+            printf("Socket send failed with error: %d\n", TRANSPORT_LastError());
+            session->connected = false;
+            return;
         }
-    }
-    
-    // Add new player if not found and space available
-    if(!playerExists && gameState.playerCount < MAX_PLAYERS) {
-        gameState.players[gameState.playerCount] = *newPlayer;
-        gameState.playerCount++;
-    }
-    
-    // Remove dead players (HP <= 0) from active list
-    for(uint8_t i = 0; i < gameState.playerCount; i++) {
-        if(gameState.players[i].hp <= 0) {
-            // Shift remaining players to fill gap
-            for(uint8_t j = i; j < gameState.playerCount - 1; j++) {
-                gameState.players[j] = gameState.players[j + 1];
-            }
-            gameState.playerCount--;
-            i--; // Recheck current index after shift
+        uint64_t sendTimeNs = PLATFORM_NowNs();
+        if (packet->header.type == AMCOM_MOVE_REQUEST) {
+            HISTOGRAM_Record(session->moveLatency, sendTimeNs - session->receiveTimeNs);
         }
+        TRACE_Record(session->recorder, TRACE_OUTBOUND, sendTimeNs, (const AMCOM_PacketHeader*)responseBuffer,
+                     responseBuffer + sizeof(AMCOM_PacketHeader));
     }
 }
 
 /**
- * Updates transistor list with new data
- * @param newTransistor Pointer to transistor data from server
+ * Reads and processes everything that is available on the session's connection
+ * @param session Session whose connection is readable
+ * @param recvbuf Receive buffer
+ * @param recvbuflen Size of the receive buffer
+ * @return false if the connection has been closed or failed
  */
-void updateTransistorList(AMCOM_ObjectState* newTransistor) {
-    bool transistorExists = false;
-    
-    // Search for existing transistor to update
-    for(uint8_t i = 0; i < gameState.transistorCount; i++) {
-        if(gameState.transistors[i].objectNo == newTransistor->objectNo) {
-            gameState.transistors[i] = *newTransistor;
-            transistorExists = true;
-            break;
+static bool serviceSession(Session* session, char* recvbuf, size_t recvbuflen) {
+    for (;;) {
+        int iResult = TRANSPORT_Receive(&session->connection, recvbuf, recvbuflen);
+        if (iResult > 0) {
+            session->receiveTimeNs = PLATFORM_NowNs();
+            session->gameState.receiveTimeNs = session->receiveTimeNs;
+            AMCOM_Deserialize(&session->receiver, recvbuf, iResult);
+            if (!session->connected) {
+                return false;
+            }
+        } else if (iResult == TRANSPORT_WOULD_BLOCK) {
+            return true;
+        } else if (iResult == 0) {
+            LOG_WRITE(session->gameState.log, LOG_EVENT_CONNECTION_CLOSED, session->gameState.currentGameTime);
+            return false;
+        } else {
+            printf("recv failed with error: %d\n", TRANSPORT_LastError());
+            return false;
         }
     }
-    
-    // Add new transistor if not found
-    if(!transistorExists && gameState.transistorCount < MAX_TRANSISTORS) {
-        gameState.transistors[gameState.transistorCount] = *newTransistor;
-        gameState.transistorCount++;
-    }
 }
 
 /**
- * Updates spark list with current spark positions
- * @param newSpark Pointer to spark data from server
+ * Event loop of a worker: waits for data on any of its sessions and processes it
+ * @param arg Worker structure
  */
-void updateSparkList(AMCOM_ObjectState* newSpark) {
-    bool sparkExists = false;
-    
-    for(uint8_t i = 0; i < gameState.sparkCount; i++) {
-        if(gameState.sparks[i].objectNo == newSpark->objectNo) {
-            gameState.sparks[i] = *newSpark;
-            sparkExists = true;
-            break;
-        }
-    }
-    
-    if(!sparkExists && gameState.sparkCount < MAX_SPARKS) {
-        gameState.sparks[gameState.sparkCount] = *newSpark;
-        gameState.sparkCount++;
+static void runWorker(void* arg) {
+    Worker* worker = (Worker*)arg;
+    char recvbuf[4096];
+    void* ready[MAX_READY_SESSIONS];
+
+    if (worker->cpu >= 0 && !PLATFORM_PinCurrentThread(worker->cpu)) {
+        printf("Unable to pin worker to CPU %d\n", worker->cpu);
     }
-}
 
-/**
- * Updates glue spot list with current glue positions
- * @param newGlue Pointer to glue data from server
- */
-void updateGlueList(AMCOM_ObjectState* newGlue) {
-    bool glueExists = false;
-    
-    for(uint8_t i = 0; i < gameState.glueCount; i++) {
-        if(gameState.glue[i].objectNo == newGlue->objectNo) {
-            gameState.glue[i] = *newGlue;
-            glueExists = true;
-            break;
-        }
+    TRANSPORT_Poller* poller = TRANSPORT_CreatePoller();
+    if (poller == NULL) {
+        printf("Unable to create poller, error: %d\n", TRANSPORT_LastError());
+        return;
     }
-    
-    if(!glueExists && gameState.glueCount < MAX_GLUE_SPOTS) {
-        gameState.glue[gameState.glueCount] = *newGlue;
-        gameState.glueCount++;
+    int activeSessions = 0;
+    for (int i = 0; i < worker->sessionCount; i++) {
+        if (TRANSPORT_PollerAdd(poller, &worker->sessions[i]->connection, worker->sessions[i])) {
+            activeSessions++;
+        } else {
+            worker->sessions[i]->connected = false;
+        }
     }
-}
 
-/**
- * Caches our player's current position and HP for quick access
- * Called after each object update to maintain current state
- */
-void updateMyPlayerCache() {
-    gameState.myPlayerFound = false;
-    
-    for(uint8_t i = 0; i < gameState.playerCount; i++) {
-        if(gameState.players[i].objectNo == gameState.myPlayerNumber) {
-            gameState.myX = gameState.players[i].x;
-            gameState.myY = gameState.players[i].y;
-            gameState.myHP = gameState.players[i].hp;
-            gameState.myPlayerFound = true;
+    while (activeSessions > 0) {
+        int readyCount = TRANSPORT_PollerWait(poller, ready, MAX_READY_SESSIONS, -1);
+        if (readyCount < 0) {
+            printf("Poll failed with error: %d\n", TRANSPORT_LastError());
             break;
         }
-    }
-}
-
-/**
- * Calculates safe movement angle avoiding sparks on trajectory
- * @param targetX Target X coordinate
- * @param targetY Target Y coordinate
- * @return Safe movement angle in radians, adjusted to avoid sparks
- */
-float avoidSparkTrajectory(float targetX, float targetY) {
-    // Calculate direct angle to target
-    float baseAngle = atan2f(targetY - gameState.myY, targetX - gameState.myX);
-    
-    // Check each spark for collision risk
-    for(uint8_t i = 0; i < gameState.sparkCount; i++) {
-        float sparkX = gameState.sparks[i].x;
-        float sparkY = gameState.sparks[i].y;
-        float dx = sparkX - gameState.myX;
-        float dy = sparkY - gameState.myY;
-        float distanceToSpark = sqrtf(dx*dx + dy*dy);
-        
-        // Check if spark is within danger zone (spark radius + player radius + safety margin)
-        float dangerRadius = SPARK_AVOIDANCE_RADIUS + PLAYER_BASE_RADIUS + gameState.myHP;
-        if(distanceToSpark < dangerRadius) {
-            float sparkAngle = atan2f(dy, dx);
-            float angleDifference = fabsf(sparkAngle - baseAngle);
-            
-            // If spark is roughly in our path (within 60 degrees)
-            if(angleDifference < SPARK_AVOIDANCE_ANGLE) {
-                printf("AVOIDING SPARK at (%.1f, %.1f), distance=%.1f!\n", 
-                       sparkX, sparkY, distanceToSpark);
-                
-                // Turn 90 degrees away from spark
-                if(sparkAngle > baseAngle) {
-                    baseAngle -= EVASION_ANGLE; // Turn left
-                } else {
-                    baseAngle += EVASION_ANGLE; // Turn right
-                }
-                
-                printf("Adjusted angle to: %.2f rad (%.1f degrees)\n", 
-                       baseAngle, baseAngle * 180.0f / M_PI);
-                break; // Only avoid first detected spark
+        for (int i = 0; i < readyCount; i++) {
+            Session* session = (Session*)ready[i];
+            if (!session->connected) continue;
+            if (!serviceSession(session, recvbuf, sizeof(recvbuf))) {
+                TRANSPORT_PollerRemove(poller, &session->connection);
+                TRANSPORT_Close(&session->connection);
+                session->connected = false;
+                activeSessions--;
+            }
+        }
+        // every ready connection is drained: decide the next moves now, so that MOVE requests arriving later
+        // are answered from the cache (the state has usually changed only for sessions that got updates)
+        for (int i = 0; i < readyCount; i++) {
+            Session* session = (Session*)ready[i];
+            if (session->connected) {
+                precomputeMove(&session->gameState);
             }
         }
     }
-    
-    return baseAngle;
+
+    TRANSPORT_DestroyPoller(poller);
 }
 
-/**
- * Provides entertainment movement when no targets are available
- * @return Next angle in the dance sequence
- */
-float getDanceAngle() {
-    // Konami Code directions mapped to angles
-    float konamiSequence[8] = {
-        3 * M_PI / 2,  // Up (270°)
-        3 * M_PI / 2,  // Up (270°)
-        M_PI / 2,      // Down (90°)
-        M_PI / 2,      // Down (90°)
-        M_PI,          // Left (180°)
-        0,             // Right (0°)
-        M_PI,          // Left (180°)
-        0              // Right (0°)
-    };
-    
-    float angle = konamiSequence[gameState.konamiIndex];
-    gameState.konamiIndex = (gameState.konamiIndex + 1) % 8; // Cycle through sequence
-    
-    return angle;
+static void printUsage(const char* program) {
+    printf("Usage: %s [--sessions N] [--threads T] [--log-level L] [--record FILE] [--params FILE] [--planner US] "
+           "[--field] [--paths] [host [port]]\n", program);
+    printf("  --sessions N  play N games at once over N connections (default 1)\n");
+    printf("  --threads T   number of worker threads, each pinned to one CPU (default: min(N, CPUs))\n");
+    printf("  --log-level L off, error, info or debug (default: debug for one session, off otherwise)\n");
+    printf("  --record FILE record all packets to a trace file (FILE.N for session N when N > 1)\n");
+    printf("  --params FILE load the strategy parameters (e.g. from mniam_tune) instead of the defaults\n");
+    printf("  --planner US  search moves ahead in a planner thread per session, US microseconds per tick from\n"
+           "                the receipt of the updates (MOVE waits for the search until then)\n");
+    printf("  --field       move along the gradient of the potential field instead of the priority decision\n");
+    printf("  --paths       route to targets around glue and sparks on a navigation grid\n");
 }
 
-/**
- * Main decision-making function
- * Analyzes game state and determines optimal movement direction
- * Priority order: Escape > Avoid Sparks > Attack > Collect Food > Hunt > Dance
- * @return Movement angle in radians
- */
-float calculateMovement() {
-    if (!gameState.gameActive || !gameState.myPlayerFound) {
-        return 0.0f; // Stay still if game inactive or position unknown
-    }
-    
-    // Calculate map diagonal for distance normalization
-    const float mapDiagonal = sqrtf(pow(gameState.mapHeight,2) + pow(gameState.mapWidth,2));
-    
-    // Target tracking variables (position, score for prioritization)
-    float dangerX = 0, dangerY = 0, dangerScore = 0;           // Dangerous players
-    float foodX = 0, foodY = 0, foodScore = 0;                 // Transistors to collect
-    float huntX = 0, huntY = 0, huntScore = 0;                 // Distant weak players
-    float sparkX = 0, sparkY = 0, sparkScore = 0;             // Threatening sparks
-    float attackX = 0, attackY = 0, attackScore = 0;          // Nearby weak players
-    
-    printf("My position: (%.1f, %.1f), HP: %.1f\n", gameState.myX, gameState.myY, gameState.myHP);
+int main(int argc, char **argv) {
+    printf("This is mniAM player. Let's eat some transistors! \n");
     
-    // === PLAYER ANALYSIS ===
-    for(uint8_t i = 0; i < gameState.playerCount; i++) {
-        // Skip self and dead players
-        if(gameState.players[i].objectNo == gameState.myPlayerNumber || gameState.players[i].hp <= 0) 
-            continue;
-        
-        float dx = gameState.players[i].x - gameState.myX;
-        float dy = gameState.players[i].y - gameState.myY;
-        float distance = sqrtf(dx*dx + dy*dy);
-        
-        if(gameState.players[i].hp > gameState.myHP) {
-            // DANGEROUS PLAYER DETECTION
-            float detectionRange = DANGER_DETECTION_RANGE + PLAYER_BASE_RADIUS + gameState.myHP;
-            if(distance > detectionRange) continue;
-            
-            // Score: higher HP and closer distance = higher threat
-            float threatScore = gameState.players[i].hp / (distance / mapDiagonal);
-            
-            if(threatScore > dangerScore) {
-                dangerX = gameState.players[i].x;
-                dangerY = gameState.players[i].y;
-                dangerScore = threatScore;
+    const char* gameServer = DEFAULT_GAME_SERVER;
+    const char* gameServerPort = DEFAULT_GAME_SERVER_PORT;
+    int sessionCount = 1;
+    int threadCount = 0;
+    int positional = 0;
+    bool logLevelSet = false;
+    LOG_Level logLevel = LOG_LEVEL_OFF;
+    const char* tracePath = NULL;
+    int plannerBudgetUs = 0;
+    bool fieldSteering = false;
+    bool pathfinding = false;
+    PARAMS_Strategy params;
+    PARAMS_Default(&params);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sessions") == 0 && i + 1 < argc) {
+            sessionCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            if (!LOG_ParseLevel(argv[++i], &logLevel)) {
+                printUsage(argv[0]);
+                return 1;
             }
-            
-        } else if(gameState.myHP > gameState.players[i].hp) {
-            // WEAK PLAYER DETECTION
-            
-            // Check for immediate attack opportunity
-            if(distance <= ATTACK_RANGE) {
-                float attackScore_temp = gameState.myHP / (distance / mapDiagonal);
-                if(attackScore_temp > attackScore) {
-                    attackX = gameState.players[i].x;
-                    attackY = gameState.players[i].y;
-                    attackScore = attackScore_temp;
-                }
+            logLevelSet = true;
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (strcmp(argv[i], "--params") == 0 && i + 1 < argc) {
+            if (PARAMS_FIXED) {
+                printf("The strategy parameters are compiled into this build, --params is not available\n");
+                return 1;
             }
-            
-            // Check for hunting opportunity (longer distance, consider glue)
-            float adjustedDistance = distance;
-            
-            // GLUE PENALTY CALCULATION
-            for(uint8_t j = 0; j < gameState.glueCount; j++) {
-                if(gameState.glue[j].hp <= 0) continue;
-                
-                float glueX = gameState.glue[j].x - gameState.myX;
-                float glueY = gameState.glue[j].y - gameState.myY;
-                float glueDistance = sqrtf(glueX*glueX + glueY*glueY) - GLUE_RADIUS;
-                
-                // Check if glue blocks path to target
-                if(glueDistance < distance) {
-                    float glueAngle = atan2f(GLUE_RADIUS, glueDistance);
-                    float targetAngle = atan2f(dy, dx);
-                    float glueTargetAngle = atan2f(glueY, glueX);
-                    
-                    // If target is behind glue area
-                    if(targetAngle < glueTargetAngle + glueAngle && 
-                       targetAngle > glueTargetAngle - glueAngle) {
-                        adjustedDistance = distance * GLUE_MOVEMENT_PENALTY;
-                        break;
-                    }
-                }
+            if (!PARAMS_Load(argv[++i], &params)) {
+                printf("Unable to load strategy parameters from %s\n", argv[i]);
+                return 1;
             }
-            
-            // Calculate hunt score with glue penalty
-            float huntScore_temp = gameState.myHP / (adjustedDistance / mapDiagonal);
-            if(huntScore_temp > huntScore) {
-                huntX = gameState.players[i].x;
-                huntY = gameState.players[i].y;
-                huntScore = huntScore_temp;
+        } else if (strcmp(argv[i], "--planner") == 0 && i + 1 < argc) {
+            plannerBudgetUs = atoi(argv[++i]);
+            if (plannerBudgetUs <= 0) {
+                printUsage(argv[0]);
+                return 1;
             }
+        } else if (strcmp(argv[i], "--field") == 0) {
+            fieldSteering = true;
+        } else if (strcmp(argv[i], "--paths") == 0) {
+            pathfinding = true;
+        } else if (argv[i][0] != '-' && positional == 0) {
+            gameServer = argv[i];
+            positional++;
+        } else if (argv[i][0] != '-' && positional == 1) {
+            gameServerPort = argv[i];
+            positional++;
+        } else {
+            printUsage(argv[0]);
+            return 1;
         }
     }
-    
-    // === SPARK ANALYSIS ===
-    for(uint8_t i = 0; i < gameState.sparkCount; i++) {
-        if(gameState.sparks[i].hp <= 0) continue;
-        
-        float dx = gameState.sparks[i].x - gameState.myX;
-        float dy = gameState.sparks[i].y - gameState.myY;
-        float distance = sqrtf(pow(dx,2) + pow(dy,2));
-        
-        // Only consider close sparks as immediate threats
-        float sparkThreatRange = SPARK_DETECTION_RANGE + PLAYER_BASE_RADIUS + gameState.myHP;
-        if(distance > sparkThreatRange) continue;
-        
-        // Score: closer sparks are more dangerous
-        float sparkThreatScore = gameState.sparks[i].hp / (distance / mapDiagonal);
-        if(sparkThreatScore > sparkScore) {
-            sparkX = gameState.sparks[i].x;
-            sparkY = gameState.sparks[i].y;
-            sparkScore = sparkThreatScore;
-        }
+    if (sessionCount < 1 || sessionCount > MAX_SESSIONS || threadCount < 0) {
+        printUsage(argv[0]);
+        return 1;
     }
-    
-    // === FOOD ANALYSIS ===
-    for(uint8_t i = 0; i < gameState.transistorCount; i++) {
-        if(gameState.transistors[i].hp <= 0) continue; // Skip eaten transistors
-        
-        float dx = gameState.transistors[i].x - gameState.myX;
-        float dy = gameState.transistors[i].y - gameState.myY;
-        float distance = sqrtf(dx*dx + dy*dy);
-        float adjustedDistance = distance;
-        
-        // GLUE PENALTY FOR FOOD COLLECTION
-        for(uint8_t j = 0; j < gameState.glueCount; j++) {
-            if(gameState.glue[j].hp <= 0) continue;
-            
-            float glueX = gameState.glue[j].x - gameState.myX;
-            float glueY = gameState.glue[j].y - gameState.myY;
-            float glueDistance = sqrtf(glueX*glueX + glueY*glueY) - GLUE_RADIUS;
-            
-            if(glueDistance < distance) {
-                float glueAngle = atan2f(GLUE_RADIUS, glueDistance);
-                float targetAngle = atan2f(dy, dx);
-                float glueTargetAngle = atan2f(glueY, glueX);
-                
-                if(targetAngle < glueTargetAngle + glueAngle && 
-                   targetAngle > glueTargetAngle - glueAngle) {
-                    adjustedDistance = distance * GLUE_MOVEMENT_PENALTY;
-                    break;
-                }
-            }
-        }
-        
-        // Score: higher HP food and closer distance = better target
-        float foodValue = gameState.transistors[i].hp / (adjustedDistance / mapDiagonal);
-        if(foodValue > foodScore) {
-            foodX = gameState.transistors[i].x;
-            foodY = gameState.transistors[i].y;
-            foodScore = foodValue;
-        }
+    const int cpuCount = PLATFORM_CpuCount();
+    if (threadCount == 0) {
+        threadCount = (sessionCount < cpuCount) ? sessionCount : cpuCount;
     }
-    
-    // === DECISION MAKING (Priority Order) ===
-    float movementAngle = 0.0f;
-    
-    if(dangerScore > 0) {
-        // HIGHEST PRIORITY: Escape from dangerous players
-        // Calculate perpendicular escape vector (90° from threat direction)
-        float escapeX = -dangerY + gameState.myY + gameState.myX;
-        float escapeY = dangerX - gameState.myX + gameState.myY;
-        movementAngle = avoidSparkTrajectory(escapeX, escapeY);
-        printf("ESCAPING from dangerous player at (%.1f, %.1f)\n", dangerX, dangerY);
-        
-    } else if(sparkScore > 0) {
-        // HIGH PRIORITY: Avoid immediate spark threats
-        // Move directly away from spark (180° opposite)
-        movementAngle = atan2f(-(sparkY - gameState.myY), -(sparkX - gameState.myX));
-        printf("AVOIDING spark at (%.1f, %.1f)\n", sparkX, sparkY);
-        
-    } else if(attackScore > 0) {
-        // MEDIUM-HIGH PRIORITY: Attack nearby weak players
-        movementAngle = avoidSparkTrajectory(attackX, attackY);
-        printf("ATTACKING weak player at (%.1f, %.1f), score=%.2f\n", attackX, attackY, attackScore);
-        
-    } else if(foodScore > 0) {
-        // MEDIUM PRIORITY: Collect food (transistors)
-        movementAngle = avoidSparkTrajectory(foodX, foodY);
-        printf("COLLECTING food at (%.1f, %.1f), score=%.2f\n", foodX, foodY, foodScore);
-        
-    } else if(huntScore > 0) {
-        // LOW PRIORITY: Hunt distant weak players
-        movementAngle = avoidSparkTrajectory(huntX, huntY);
-        printf("HUNTING at (%.1f, %.1f), score=%.2f\n", huntX, huntY, huntScore);
-        
-    } else {
-        // LOWEST PRIORITY: Entertainment when no targets available
-        movementAngle = getDanceAngle();
-        printf("NO TARGETS - Performing Konami Code dance!\n");
+    if (threadCount > sessionCount) {
+        threadCount = sessionCount;
+    }
+    if (!logLevelSet) {
+        logLevel = (sessionCount == 1) ? LOG_LEVEL_DEBUG : LOG_LEVEL_OFF;
     }
     
-    // Ensure angle is in valid range [0, 2π)
-    movementAngle = normalizeAngle(movementAngle);
-    
-    return movementAngle;
-}
+    if (!TRANSPORT_Init()) {
+        printf("Transport initialization failed with error: %d\n", TRANSPORT_LastError());
+        return 1;
+    }
 
-/**
- * Processes object update packets from server
- * Routes different object types to appropriate update functions
- * @param packet Received AMCOM packet containing object data
- */
-void processObjectUpdate(const AMCOM_Packet* packet) {
-    uint8_t objectCount = packet->header.length / sizeof(AMCOM_ObjectState);
-    if(objectCount == 0) return;
-    
-    AMCOM_ObjectUpdateRequestPayload* updatePayload = (AMCOM_ObjectUpdateRequestPayload*)packet->payload;
-    
-    // Process each object in the packet
-    for(uint8_t i = 0; i < objectCount; i++) {
-        AMCOM_ObjectState* obj = &updatePayload->objectState[i];
-        
-        // Route to appropriate handler based on object type
-        switch(obj->objectType) {
-            case 0: // Players
-                updatePlayerList(obj);
-                break;
-            case 1: // Transistors
-                updateTransistorList(obj);
-                break;
-            case 2: // Sparks
-                updateSparkList(obj);
-                break;
-            case 3: // Glue
-                updateGlueList(obj);
-                break;
-        }
+    printf("Connecting %d session(s) to game server %s:%s...\n", sessionCount, gameServer, gameServerPort);
+    
+    Session* sessions = (Session*)calloc((size_t)sessionCount, sizeof(Session));
+    Worker* workers = (Worker*)calloc((size_t)threadCount, sizeof(Worker));
+    Session** sessionSlots = (Session**)calloc((size_t)sessionCount, sizeof(Session*));
+    if (sessions == NULL || workers == NULL || sessionSlots == NULL) {
+        printf("Out of memory\n");
+        TRANSPORT_Cleanup();
+        return 1;
     }
-    
-    // Update our cached position after processing all objects
-    updateMyPlayerCache();
-}
 
-void amPacketHandler(const AMCOM_Packet* packet, void* userContext) {
-    uint8_t responseBuffer[AMCOM_MAX_PACKET_SIZE];
-    size_t responseSize = 0;
-    SOCKET ConnectSocket = *((SOCKET*)userContext);
+    // One log ring per worker, the logger thread formats and writes the records
+    LOG_Logger* logger = NULL;
+    if (logLevel != LOG_LEVEL_OFF) {
+        logger = LOG_Create(stdout, logLevel, (uint32_t)threadCount, LOG_RING_CAPACITY);
+    }
 
-    switch (packet->header.type) {
-        case AMCOM_IDENTIFY_REQUEST:
-            printf("Got IDENTIFY.request. Responding with IDENTIFY.response\n");
-            AMCOM_IdentifyResponsePayload identifyResponse;
-            sprintf(identifyResponse.playerName, "sAMobujca");
-            responseSize = AMCOM_Serialize(AMCOM_IDENTIFY_RESPONSE, &identifyResponse, 
-                                         sizeof(identifyResponse), responseBuffer);
-            break;
-            
-        case AMCOM_NEW_GAME_REQUEST:
-            printf("Got NEW_GAME.request.\n");
-            AMCOM_NewGameRequestPayload* newGameReq = (AMCOM_NewGameRequestPayload*)packet->payload;
-            
-            // Initialize game state
-            gameState.myPlayerNumber = newGameReq->playerNumber;
-            gameState.mapWidth = newGameReq->mapWidth;
-            gameState.mapHeight = newGameReq->mapHeight;
-            gameState.gameActive = true;
-            gameState.konamiIndex = 0; // Reset dance sequence
-            
-            printf("Player number: %d, Map: %.1fx%.1f\n",
-                   gameState.myPlayerNumber, gameState.mapWidth, gameState.mapHeight);
-            
-            AMCOM_NewGameResponsePayload newGameResponse;
-            sprintf(newGameResponse.helloMessage, "Bedzie magik i to za dwa lata");
-            responseSize = AMCOM_Serialize(AMCOM_NEW_GAME_RESPONSE, &newGameResponse, 
-                                         sizeof(newGameResponse), responseBuffer);
-            break;
-            
-        case AMCOM_OBJECT_UPDATE_REQUEST:
-            processObjectUpdate(packet);
-            break;
-            
-        case AMCOM_MOVE_REQUEST:
-            AMCOM_MoveRequestPayload* moveReq = (AMCOM_MoveRequestPayload*)packet->payload;
-            gameState.currentGameTime = moveReq->gameTime;
-            
-            AMCOM_MoveResponsePayload moveResponse;
-            moveResponse.angle = calculateMovement();
-            responseSize = AMCOM_Serialize(AMCOM_MOVE_RESPONSE, &moveResponse, 
-                                         sizeof(moveResponse), responseBuffer);
-            break;
-            
-        case AMCOM_GAME_OVER_REQUEST:
-            printf("Got GAME_OVER.request\n");
-            gameState.gameActive = false;
-            
-            AMCOM_GameOverResponsePayload gameOverResponse;
-            sprintf(gameOverResponse.endMessage, "GG WP!");
-            responseSize = AMCOM_Serialize(AMCOM_GAME_OVER_RESPONSE, &gameOverResponse, 
-                                         sizeof(gameOverResponse), responseBuffer);
-            break;
-            
-        default:
-            printf("Unknown packet type: %d\n", packet->header.type);
-            break;
+    // Distribute sessions evenly between the workers
+    int firstSlot = 0;
+    for (int w = 0; w < threadCount; w++) {
+        workers[w].sessions = &sessionSlots[firstSlot];
+        workers[w].sessionCount = sessionCount / threadCount + (w < sessionCount % threadCount ? 1 : 0);
+        workers[w].cpu = (sessionCount > 1) ? w % cpuCount : -1;
+        HISTOGRAM_Init(&workers[w].moveLatency);
+        workers[w].log = LOG_GetRing(logger, (uint32_t)w);
+        firstSlot += workers[w].sessionCount;
     }
 
-    if (responseSize > 0) {
-        int bytesSent = send(ConnectSocket, (const char*)responseBuffer, responseSize, 0);
-        if (bytesSent == SOCKET_ERROR) {
-            printf("Socket send failed with error: %d\n", WSAGetLastError());
-            closesocket(ConnectSocket);
-            return;
+    int connectedCount = 0;
+    int slot = 0;
+    for (int w = 0; w < threadCount; w++) {
+        for (int i = 0; i < workers[w].sessionCount; i++, slot++) {
+            Session* session = &sessions[slot];
+            sessionSlots[slot] = session;
+            initGameState(&session->gameState, workers[w].log);
+            session->gameState.params = params;
+            session->gameState.fieldMaintained = session->gameState.fieldSteering = fieldSteering;
+            session->gameState.pathfinding = pathfinding;
+            if (plannerBudgetUs > 0) {
+                session->gameState.planner = PLANNER_Create((uint32_t)plannerBudgetUs, PLANNER_DEFAULT_DEPTH, true);
+                if (session->gameState.planner == NULL) {
+                    printf("Unable to start the planner of session %d\n", slot);
+                }
+            }
+            session->moveLatency = &workers[w].moveLatency;
+            AMCOM_InitViewReceiver(&session->receiver, amPacketHandler, session);
+            session->connected = TRANSPORT_Connect(&session->connection, gameServer, gameServerPort);
+            if (session->connected) {
+                connectedCount++;
+            }
+            if (session->connected && tracePath != NULL) {
+                char path[1024];
+                if (sessionCount == 1) {
+                    snprintf(path, sizeof(path), "%s", tracePath);
+                } else {
+                    snprintf(path, sizeof(path), "%s.%d", tracePath, slot);
+                }
+                session->recorder = TRACE_CreateRecorder(path, 0);
+                if (session->recorder == NULL) {
+                    printf("Unable to create trace file %s\n", path);
+                }
+            }
         }
     }
-}
-
-#define GAME_SERVER "localhost"
-#define GAME_SERVER_PORT "2001"
 
-int main(int argc, char **argv) {
-    printf("This is mniAM player. Let's eat some transistors! \n");
-    
-    WSADATA wsaData;
-    int iResult = WSAStartup(MAKEWORD(2,2), &wsaData);
-    if (iResult != 0) {
-        printf("WSAStartup failed with error: %d\n", iResult);
+    if (connectedCount == 0) {
+        printf("Unable to connect to the game server!\n");
+        LOG_Destroy(logger);
+        for (int i = 0; i < sessionCount; i++) {
+            TRACE_CloseRecorder(sessions[i].recorder);
+            PLANNER_Destroy(sessions[i].gameState.planner);
+            freeGameState(&sessions[i].gameState);
+        }
+        free(sessionSlots);
+        free(workers);
+        free(sessions);
+        TRANSPORT_Cleanup();
         return 1;
+    } else {
+        printf("Connected to game server (%d/%d sessions)\n", connectedCount, sessionCount);
     }
 
-    SOCKET ConnectSocket = INVALID_SOCKET;
-    struct addrinfo *result = NULL, *ptr = NULL, hints;
-    char recvbuf[512];
-    int recvbuflen = sizeof(recvbuf);
+    if (threadCount == 1 && sessionCount == 1) {
+        // Single game - play it on the main thread
+        runWorker(&workers[0]);
+    } else {
+        for (int w = 0; w < threadCount; w++) {
+            if (!PLATFORM_StartThread(&workers[w].thread, runWorker, &workers[w])) {
+                printf("Unable to start worker thread %d\n", w);
+                workers[w].thread.handle = 0;
+            }
+        }
+        for (int w = 0; w < threadCount; w++) {
+            if (workers[w].thread.handle != 0) {
+                PLATFORM_JoinThread(&workers[w].thread);
+            }
+        }
+    }
 
-    ZeroMemory(&hints, sizeof(hints));
-    hints.ai_family = AF_INET;
-    hints.ai_socktype = SOCK_STREAM;
-    hints.ai_protocol = IPPROTO_TCP;
-    hints.ai_flags = AI_PASSIVE;
+    LOG_Destroy(logger);
 
-    iResult = getaddrinfo(GAME_SERVER, GAME_SERVER_PORT, &hints, &result);
-    if (iResult != 0) {
-        printf("getaddrinfo failed with error: %d\n", iResult);
-        WSACleanup();
-        return 1;
+    // Host report: how many sessions each core served and how fast MOVE requests were answered
+    HISTOGRAM_Histogram moveLatency;
+    HISTOGRAM_Init(&moveLatency);
+    for (int w = 0; w < threadCount; w++) {
+        HISTOGRAM_Merge(&moveLatency, &workers[w].moveLatency);
+    }
+    printf("Sessions: %d, worker threads: %d, sessions/core: %.1f\n",
+           connectedCount, threadCount, (double)connectedCount / threadCount);
+    if (moveLatency.count > 0) {
+        printf("MOVE latency (recv -> send) over %llu moves: p50 %.1f us, p99 %.1f us, max %.1f us\n",
+               (unsigned long long)moveLatency.count,
+               HISTOGRAM_Percentile(&moveLatency, 0.50) / 1e3,
+               HISTOGRAM_Percentile(&moveLatency, 0.99) / 1e3,
+               moveLatency.max / 1e3);
     }
 
-    printf("Connecting to game server...\n");
-    
-    for(ptr=result; ptr != NULL; ptr=ptr->ai_next) {
-        ConnectSocket = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
-        if (ConnectSocket == INVALID_SOCKET) {
-            printf("socket failed with error: %ld\n", WSAGetLastError());
-            WSACleanup();
-            return 1;
-        }
-
-        iResult = connect(ConnectSocket, ptr->ai_addr, (int)ptr->ai_addrlen);
-        if (iResult == SOCKET_ERROR) {
-            closesocket(ConnectSocket);
-            ConnectSocket = INVALID_SOCKET;
-            continue;
+    // Planner report: how many moves came from a plan and how far ahead the searches got
+    PLANNER_Stats plannerTotal = { 0, 0, 0, 0 };
+    for (int i = 0; i < sessionCount; i++) {
+        if (sessions[i].gameState.planner != NULL) {
+            PLANNER_Stats stats;
+            PLANNER_GetStats(sessions[i].gameState.planner, &stats);
+            plannerTotal.snapshots += stats.snapshots;
+            plannerTotal.searchedTicks += stats.searchedTicks;
+            plannerTotal.plannedMoves += stats.plannedMoves;
+            plannerTotal.unplannedMoves += stats.unplannedMoves;
         }
-        break;
     }
-
-    freeaddrinfo(result);
-    
-    if (ConnectSocket == INVALID_SOCKET) {
-        printf("Unable to connect to the game server!\n");
-        WSACleanup();
-        return 1;
-    } else {
-        printf("Connected to game server\n");
+    if (plannerTotal.snapshots > 0) {
+        printf("Planner: %llu of %llu moves planned, %.1f ticks searched ahead per snapshot\n",
+               (unsigned long long)plannerTotal.plannedMoves,
+               (unsigned long long)(plannerTotal.plannedMoves + plannerTotal.unplannedMoves),
+               (double)plannerTotal.searchedTicks / plannerTotal.snapshots);
     }
 
-    AMCOM_Receiver amReceiver;
-    AMCOM_InitReceiver(&amReceiver, amPacketHandler, &ConnectSocket);
-    
-    do {
-        iResult = recv(ConnectSocket, recvbuf, recvbuflen, 0);
-        if (iResult > 0) {
-            AMCOM_Deserialize(&amReceiver, recvbuf, iResult);
-        } else if (iResult == 0) {
-            printf("Connection closed\n");
-        } else {
-            printf("recv failed with error: %d\n", WSAGetLastError());
+    for (int i = 0; i < sessionCount; i++) {
+        TRANSPORT_Close(&sessions[i].connection);
+        PLANNER_Destroy(sessions[i].gameState.planner);
+        if (!TRACE_CloseRecorder(sessions[i].recorder)) {
+            printf("Writing the trace of session %d failed\n", i);
         }
-    } while(iResult > 0);
-
-    closesocket(ConnectSocket);
-    WSACleanup();
+        freeGameState(&sessions[i].gameState);
+    }
+    free(sessionSlots);
+    free(workers);
+    free(sessions);
+    TRANSPORT_Cleanup();
     return 0;
 }
@@ -0,0 +1,97 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "memo.h"
+
+/// Makes room for the anchors of count objects
+static bool MEMO_Reserve(MEMO_Class* memo, uint32_t count) {
+	if(count <= memo->anchorCapacity){
+	    return true;
+	}
+	uint32_t capacity = (count + 15) & ~15u;
+	float* anchorX = (float*)realloc(memo->anchorX, capacity * sizeof(float));
+	if(anchorX != NULL) memo->anchorX = anchorX;
+	float* anchorY = (float*)realloc(memo->anchorY, capacity * sizeof(float));
+	if(anchorY != NULL) memo->anchorY = anchorY;
+	float* anchorHp = (float*)realloc(memo->anchorHp, capacity * sizeof(float));
+	if(anchorHp != NULL) memo->anchorHp = anchorHp;
+	if(anchorX == NULL || anchorY == NULL || anchorHp == NULL){
+	    return false;
+	}
+	memo->anchorCapacity = capacity;
+	return true;
+}
+
+void MEMO_Init(MEMO_Class* memo) {
+	memset(memo, 0, sizeof(MEMO_Class));
+}
+
+void MEMO_Free(MEMO_Class* memo) {
+	free(memo->anchorX);
+	free(memo->anchorY);
+	free(memo->anchorHp);
+	MEMO_Init(memo);
+}
+
+void MEMO_Invalidate(MEMO_Class* memo) {
+	memo->stored = false;
+	memo->anchorCount = 0;
+	memo->version++;
+}
+
+void MEMO_NoteUpdate(MEMO_Class* memo, const OBJTABLE_Table* table, int32_t index, bool added) {
+	if(index < 0){
+	    return;
+	}
+	if(added || (uint32_t)index >= memo->anchorCount || table->hp[index] != memo->anchorHp[index]){
+	    memo->version++;
+	    return;
+	}
+	float dx = table->x[index] - memo->anchorX[index];
+	float dy = table->y[index] - memo->anchorY[index];
+	float squared = dx*dx + dy*dy;
+	if(!(squared <= memo->driftSquared)){
+	    // farther than any object so far (or NaN, which makes the drift NaN and every check fail)
+	    memo->driftSquared = squared;
+	}
+}
+
+void MEMO_NoteRemoval(MEMO_Class* memo) {
+	memo->version++;
+}
+
+bool MEMO_IsCurrent(MEMO_Class* memo, uint64_t glueVersion, float x, float y, float hp) {
+	bool current = memo->stored && memo->storedVersion == memo->version && memo->glueVersion == glueVersion &&
+	               memo->originHp == hp;
+	if(current){
+	    float dx = x - memo->originX, dy = y - memo->originY;
+	    current = sqrtf(dx*dx + dy*dy) + sqrtf(memo->driftSquared) < memo->slack;
+	}
+	if(current){
+	    memo->hits++;
+	} else {
+	    memo->misses++;
+	}
+	return current;
+}
+
+void MEMO_Store(MEMO_Class* memo, const OBJTABLE_Table* table, uint64_t glueVersion, float x, float y, float hp,
+                float slack) {
+	memo->stored = false;
+	memo->anchorCount = 0;
+	if(!(slack > 0.0f) || !MEMO_Reserve(memo, table->count)){
+	    return;
+	}
+	memcpy(memo->anchorX, table->x, table->count * sizeof(float));
+	memcpy(memo->anchorY, table->y, table->count * sizeof(float));
+	memcpy(memo->anchorHp, table->hp, table->count * sizeof(float));
+	memo->anchorCount = table->count;
+	memo->driftSquared = 0.0f;
+	memo->storedVersion = memo->version;
+	memo->glueVersion = glueVersion;
+	memo->originX = x;
+	memo->originY = y;
+	memo->originHp = hp;
+	memo->slack = slack;
+	memo->stored = true;
+}
@@ -0,0 +1,94 @@
+#ifndef MEMO_H_
+#define MEMO_H_
+
+/**
+ * Dirty tracking of an object class and memoization of the targets the decision selected from it.
+ *
+ * The update functions report every object update of the class (@ref MEMO_NoteUpdate, @ref MEMO_NoteRemoval):
+ * an object that appears, disappears or changes HP bumps the version of the class, an object that only moves
+ * adds to the drift - the largest distance any object moved from where it was when the targets were selected
+ * (its anchor). The decision stores its targets together with a slack: the distance we and the objects may move
+ * together before another object could score better than a target (computed by the caller from the scores).
+ * @ref MEMO_IsCurrent then tells whether the stored targets are still the ones a full scan would select: same
+ * version, same HP, and our move plus the drift still within the slack. A dirty class is always scanned again.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "objtable.h"
+
+/// Maximum number of scoring passes over one class whose targets are stored
+#define MEMO_MAX_PASSES 4
+
+/** Structure of a memoized class */
+typedef struct {
+	uint64_t version;              ///< bumped by every change of the class other than a move
+	uint64_t glueVersion;          ///< glue version the targets were selected with (paths checked for glue)
+	float* anchorX;                ///< X of every object when the targets were selected (by table position)
+	float* anchorY;                ///< Y of every object then
+	float* anchorHp;               ///< hp of every object then
+	uint32_t anchorCount;          ///< number of anchored objects
+	uint32_t anchorCapacity;       ///< allocated length of the anchor arrays
+	float driftSquared;            ///< largest squared distance an anchored object moved from its anchor since
+	bool stored;                   ///< targets are stored (cleared by @ref MEMO_Invalidate)
+	uint64_t storedVersion;        ///< version the targets were selected at
+	float originX, originY;        ///< our position then
+	float originHp;                ///< our hp then
+	float slack;                   ///< distance (our move + drift) the targets stay the best ones for
+	int32_t targets[MEMO_MAX_PASSES];      ///< selected object of every pass (-1 = none)
+	bool blocked[MEMO_MAX_PASSES];         ///< the path to the target was blocked by glue (passes with glue)
+	uint64_t hits;                 ///< decisions that reused the targets
+	uint64_t misses;               ///< decisions that scanned the class
+} MEMO_Class;
+
+/**
+ * @brief Initializes a class without stored targets.
+ */
+void MEMO_Init(MEMO_Class* memo);
+
+/**
+ * @brief Releases the anchors.
+ */
+void MEMO_Free(MEMO_Class* memo);
+
+/**
+ * @brief Forgets the stored targets (e.g. when the scoring constants change); the counters are kept.
+ */
+void MEMO_Invalidate(MEMO_Class* memo);
+
+/**
+ * @brief Notes an update of the object at a table position (added: it was not in the table before).
+ */
+void MEMO_NoteUpdate(MEMO_Class* memo, const OBJTABLE_Table* table, int32_t index, bool added);
+
+/**
+ * @brief Notes the removal of an object (the table moves other objects, so the class becomes dirty).
+ */
+void MEMO_NoteRemoval(MEMO_Class* memo);
+
+/**
+ * @brief Checks whether the stored targets are still the best ones and counts a hit or a miss.
+ *
+ * @return true if the targets were stored at the current version, glue version and hp, and our move from the
+ *         stored position plus the drift is smaller than the slack
+ */
+bool MEMO_IsCurrent(MEMO_Class* memo, uint64_t glueVersion, float x, float y, float hp);
+
+/**
+ * @brief Stores the targets selected from the current table (set in targets and blocked before) and anchors
+ *        the objects.
+ *
+ * Nothing is stored if the slack is not positive or the anchors cannot be allocated.
+ */
+void MEMO_Store(MEMO_Class* memo, const OBJTABLE_Table* table, uint64_t glueVersion, float x, float y, float hp,
+                float slack);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* MEMO_H_ */
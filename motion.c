@@ -0,0 +1,108 @@
+#include <stdlib.h>
+#include <string.h>
+#include "motion.h"
+
+/// Ring position of the sample that is `age` samples older than the newest one
+static inline uint32_t MOTION_Slot(const MOTION_Track* track, uint32_t age) {
+	return (track->newest + MOTION_HISTORY - age) & (MOTION_HISTORY - 1);
+}
+
+/// Restarts the history of a track from a single position
+static void MOTION_Restart(MOTION_Track* track, uint32_t time, float x, float y) {
+	track->newest = 0;
+	track->count = 1;
+	track->x[0] = x;
+	track->y[0] = y;
+	track->time[0] = time;
+	track->vx = track->vy = 0.0f;
+}
+
+/// Velocity from the oldest to the newest sample of the window
+static void MOTION_Estimate(MOTION_Track* track) {
+	if(track->count < 2){
+	    track->vx = track->vy = 0.0f;
+	    return;
+	}
+	uint32_t newest = track->newest;
+	uint32_t oldest = MOTION_Slot(track, track->count - 1u);
+	float elapsed = (float)(track->time[newest] - track->time[oldest]);
+	track->vx = (track->x[newest] - track->x[oldest]) / elapsed;
+	track->vy = (track->y[newest] - track->y[oldest]) / elapsed;
+}
+
+void MOTION_Init(MOTION_Tracker* tracker) {
+	memset(tracker, 0, sizeof(MOTION_Tracker));
+}
+
+void MOTION_Free(MOTION_Tracker* tracker) {
+	for(uint32_t i = 0; i < MOTION_PAGE_COUNT; i++){
+	    free(tracker->pages[i]);
+	}
+	memset(tracker, 0, sizeof(MOTION_Tracker));
+}
+
+void MOTION_Clear(MOTION_Tracker* tracker) {
+	for(uint32_t i = 0; i < MOTION_PAGE_COUNT; i++){
+	    if(tracker->pages[i] != NULL){
+	        memset(tracker->pages[i], 0, MOTION_PAGE_SIZE * sizeof(MOTION_Track));
+	    }
+	}
+}
+
+bool MOTION_Record(MOTION_Tracker* tracker, uint16_t objectNo, uint32_t time, float x, float y) {
+	MOTION_Track** page = &tracker->pages[objectNo / MOTION_PAGE_SIZE];
+	if(*page == NULL){
+	    *page = (MOTION_Track*)calloc(MOTION_PAGE_SIZE, sizeof(MOTION_Track));
+	    if(*page == NULL){
+	        return false;
+	    }
+	}
+	MOTION_Track* track = &(*page)[objectNo % MOTION_PAGE_SIZE];
+	if(track->count == 0 || time < track->time[track->newest]){
+	    MOTION_Restart(track, time, x, y);
+	    return true;
+	}
+	if(time == track->time[track->newest]){
+	    // several updates within one tick: the last one counts
+	    if(track->count == 1){
+	        MOTION_Restart(track, time, x, y);
+	    } else {
+	        track->x[track->newest] = x;
+	        track->y[track->newest] = y;
+	        MOTION_Estimate(track);
+	    }
+	    return true;
+	}
+
+	const float elapsed = (float)(time - track->time[track->newest]);
+	const float stepX = x - track->x[track->newest];
+	const float stepY = y - track->y[track->newest];
+	if(stepX * stepX + stepY * stepY > (MOTION_MAX_SPEED * elapsed) * (MOTION_MAX_SPEED * elapsed)){
+	    MOTION_Restart(track, time, x, y);
+	    return true;
+	}
+	const float gapX = stepX - track->vx * elapsed;
+	const float gapY = stepY - track->vy * elapsed;
+	const bool straight = gapX * gapX + gapY * gapY <=
+	                      (MOTION_TURN_TOLERANCE * elapsed) * (MOTION_TURN_TOLERANCE * elapsed);
+
+	track->newest = (uint8_t)MOTION_Slot(track, MOTION_HISTORY - 1u);
+	track->x[track->newest] = x;
+	track->y[track->newest] = y;
+	track->time[track->newest] = time;
+	if(!straight || track->count < 2){
+	    // the estimate starts again from the step just made
+	    track->count = 2;
+	} else if(track->count < MOTION_HISTORY){
+	    track->count++;
+	}
+	MOTION_Estimate(track);
+	return true;
+}
+
+void MOTION_Forget(MOTION_Tracker* tracker, uint16_t objectNo) {
+	MOTION_Track* page = tracker->pages[objectNo / MOTION_PAGE_SIZE];
+	if(page != NULL){
+	    page[objectNo % MOTION_PAGE_SIZE].count = 0;
+	}
+}
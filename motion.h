@@ -0,0 +1,107 @@
+#ifndef MOTION_H_
+#define MOTION_H_
+
+/**
+ * Motion history of moving game objects (players, sparks) and their estimated velocity.
+ *
+ * Every object gets a small ring buffer of its last MOTION_HISTORY positions, each stamped with the server game time
+ * at which it was received. The tracks are found by objectNo through a sparse index of pages (like the one of
+ * objtable.h), so recording a position and looking a track up are O(1). The velocity is updated with every recorded
+ * position from the oldest and the newest sample of the window, again O(1): straight motion is averaged over the
+ * whole window, while a step that does not fit the estimate (a turn, a bounce off the border) restarts the window
+ * from the last two samples and a step no object can make in the elapsed time (a respawn) restarts it from the new
+ * sample alone, with no velocity. @ref MOTION_Predict extrapolates the newest position linearly.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+enum {
+	/// Number of positions kept per object (power of two)
+	MOTION_HISTORY = 8,
+	/// Number of objectNo values covered by one page of the index
+	MOTION_PAGE_SIZE = 256,
+	/// Number of pages needed to cover the whole uint16_t objectNo range
+	MOTION_PAGE_COUNT = 65536 / MOTION_PAGE_SIZE
+};
+
+/// Longest distance an object can travel in one tick, longer steps are respawns
+#define MOTION_MAX_SPEED 20.0f
+/// Largest distance per tick of the gap between a new position and the estimate that is still straight motion
+#define MOTION_TURN_TOLERANCE 1.0f
+
+/** Motion history of one object */
+typedef struct {
+	float x[MOTION_HISTORY];       ///< recorded X positions (ring buffer)
+	float y[MOTION_HISTORY];       ///< recorded Y positions
+	uint32_t time[MOTION_HISTORY]; ///< game time of every position
+	uint8_t newest;                ///< position of the newest sample in the ring
+	uint8_t count;                 ///< samples in the estimation window (0 = object not tracked)
+	float vx, vy;                  ///< estimated velocity [distance per tick]
+} MOTION_Track;
+
+/** Tracks of all objects of one class, indexed by objectNo */
+typedef struct {
+	MOTION_Track* pages[MOTION_PAGE_COUNT];      ///< pages of tracks, allocated on the first object in their range
+} MOTION_Tracker;
+
+/**
+ * @brief Initializes an empty tracker.
+ */
+void MOTION_Init(MOTION_Tracker* tracker);
+
+/**
+ * @brief Releases all memory of the tracker. The tracker is empty afterwards and may be reused.
+ */
+void MOTION_Free(MOTION_Tracker* tracker);
+
+/**
+ * @brief Forgets all objects but keeps the allocated memory.
+ */
+void MOTION_Clear(MOTION_Tracker* tracker);
+
+/**
+ * @brief Records a position of an object and updates its velocity estimate.
+ *
+ * A position with the same game time as the newest one replaces it, a game time older than the newest one
+ * (a new game) restarts the history.
+ *
+ * @return false if memory for the track could not be allocated
+ */
+bool MOTION_Record(MOTION_Tracker* tracker, uint16_t objectNo, uint32_t time, float x, float y);
+
+/**
+ * @brief Forgets an object (it died or disappeared).
+ */
+void MOTION_Forget(MOTION_Tracker* tracker, uint16_t objectNo);
+
+/**
+ * @brief Finds the track of an object.
+ *
+ * @return the track or NULL if the object has no recorded position
+ */
+static inline const MOTION_Track* MOTION_Find(const MOTION_Tracker* tracker, uint16_t objectNo) {
+	const MOTION_Track* page = tracker->pages[objectNo / MOTION_PAGE_SIZE];
+	if(page == NULL || page[objectNo % MOTION_PAGE_SIZE].count == 0){
+	    return NULL;
+	}
+	return &page[objectNo % MOTION_PAGE_SIZE];
+}
+
+/**
+ * @brief Predicts the position of an object the given number of ticks after its newest recorded position.
+ */
+static inline void MOTION_Predict(const MOTION_Track* track, float ticks, float* x, float* y) {
+	*x = track->x[track->newest] + track->vx * ticks;
+	*y = track->y[track->newest] + track->vy * ticks;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* MOTION_H_ */
@@ -0,0 +1,402 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "nav.h"
+
+/// Length of a straight step in path cost units (per unit of the sum of both cell costs)
+#define NAV_STRAIGHT 70u
+/// Length of a diagonal step (99/70 = 1.41428...)
+#define NAV_DIAGONAL 99u
+
+/// Cell coordinate of a position along one axis, clamped to the grid
+static int32_t NAV_Coordinate(float value, float inverseCellSize, uint32_t cells) {
+	float cell = value * inverseCellSize;
+	if(!(cell >= 0.0f)){
+	    // negative or NaN
+	    return 0;
+	}
+	if(cell >= (float)cells){
+	    return (int32_t)cells - 1;
+	}
+	return (int32_t)cell;
+}
+
+static int32_t NAV_CellOf(const NAV_Grid* grid, float x, float y) {
+	return NAV_Coordinate(y, grid->inverseCellSize, grid->rows) * (int32_t)grid->columns +
+	       NAV_Coordinate(x, grid->inverseCellSize, grid->columns);
+}
+
+/// Lower bound of the path cost between two cells (octile distance on open ground)
+static uint32_t NAV_Heuristic(const NAV_Grid* grid, int32_t a, int32_t b) {
+	uint32_t dx = (uint32_t)abs(a % (int32_t)grid->columns - b % (int32_t)grid->columns);
+	uint32_t dy = (uint32_t)abs(a / (int32_t)grid->columns - b / (int32_t)grid->columns);
+	uint32_t straight = (dx > dy) ? dx - dy : dy - dx;
+	uint32_t diagonal = (dx > dy) ? dy : dx;
+	return 2 * NAV_COST_SCALE * (NAV_STRAIGHT * straight + NAV_DIAGONAL * diagonal);
+}
+
+/// Fills the neighbours of a cell and the lengths of the steps to them, returns their number
+static uint32_t NAV_Neighbours(const NAV_Grid* grid, int32_t cell, int32_t neighbours[8], uint32_t lengths[8]) {
+	const int32_t columns = (int32_t)grid->columns, rows = (int32_t)grid->rows;
+	const int32_t x = cell % columns, y = cell / columns;
+	uint32_t count = 0;
+	for(int32_t dy = -1; dy <= 1; dy++){
+	    if(y + dy < 0 || y + dy >= rows) continue;
+	    for(int32_t dx = -1; dx <= 1; dx++){
+	        if((dx == 0 && dy == 0) || x + dx < 0 || x + dx >= columns) continue;
+	        neighbours[count] = cell + dy * columns + dx;
+	        lengths[count] = (dx != 0 && dy != 0) ? NAV_DIAGONAL : NAV_STRAIGHT;
+	        count++;
+	    }
+	}
+	return count;
+}
+
+/// Cost of the path to the goal through a neighbour (NAV_UNREACHABLE if the neighbour is unreachable)
+static inline uint32_t NAV_Through(const NAV_Grid* grid, int32_t cell, int32_t neighbour, uint32_t length) {
+	if(grid->g[neighbour] == NAV_UNREACHABLE){
+	    return NAV_UNREACHABLE;
+	}
+	return grid->g[neighbour] + length * (grid->cost[cell] + grid->cost[neighbour]);
+}
+
+/// Key of a cell for the current start
+static NAV_QueueEntry NAV_Key(const NAV_Grid* grid, int32_t cell) {
+	uint64_t best = (grid->g[cell] < grid->rhs[cell]) ? grid->g[cell] : grid->rhs[cell];
+	NAV_QueueEntry entry = { best + NAV_Heuristic(grid, grid->start, cell) + grid->km, best, (uint32_t)cell };
+	return entry;
+}
+
+static bool NAV_KeyLess(const NAV_QueueEntry* a, const NAV_QueueEntry* b) {
+	return a->k1 < b->k1 || (a->k1 == b->k1 && a->k2 < b->k2);
+}
+
+static void NAV_QueuePlace(NAV_Grid* grid, uint32_t position, NAV_QueueEntry entry) {
+	grid->queue[position] = entry;
+	grid->queueIndex[entry.cell] = (int32_t)position;
+}
+
+/// Restores the heap order of an entry that may be out of place in either direction
+static void NAV_QueueFix(NAV_Grid* grid, uint32_t position) {
+	NAV_QueueEntry entry = grid->queue[position];
+	while(position > 0 && NAV_KeyLess(&entry, &grid->queue[(position - 1) / 2])){
+	    uint32_t parent = (position - 1) / 2;
+	    NAV_QueuePlace(grid, position, grid->queue[parent]);
+	    position = parent;
+	}
+	for(;;){
+	    uint32_t child = 2 * position + 1;
+	    if(child >= grid->queueSize) break;
+	    if(child + 1 < grid->queueSize && NAV_KeyLess(&grid->queue[child + 1], &grid->queue[child])) child++;
+	    if(!NAV_KeyLess(&grid->queue[child], &entry)) break;
+	    NAV_QueuePlace(grid, position, grid->queue[child]);
+	    position = child;
+	}
+	NAV_QueuePlace(grid, position, entry);
+}
+
+/// Inserts a cell or changes its key if it is queued already
+static void NAV_QueuePush(NAV_Grid* grid, NAV_QueueEntry entry) {
+	int32_t position = grid->queueIndex[entry.cell];
+	if(position < 0){
+	    position = (int32_t)grid->queueSize++;
+	}
+	NAV_QueuePlace(grid, (uint32_t)position, entry);
+	NAV_QueueFix(grid, (uint32_t)position);
+}
+
+static void NAV_QueueRemove(NAV_Grid* grid, uint32_t cell) {
+	int32_t position = grid->queueIndex[cell];
+	if(position < 0) return;
+	grid->queueIndex[cell] = -1;
+	grid->queueSize--;
+	if((uint32_t)position != grid->queueSize){
+	    NAV_QueuePlace(grid, (uint32_t)position, grid->queue[grid->queueSize]);
+	    NAV_QueueFix(grid, (uint32_t)position);
+	}
+}
+
+/// Recomputes the lookahead of a cell and queues it if it became inconsistent
+static void NAV_UpdateCell(NAV_Grid* grid, int32_t cell) {
+	if(cell != grid->goal){
+	    int32_t neighbours[8];
+	    uint32_t lengths[8];
+	    uint32_t count = NAV_Neighbours(grid, cell, neighbours, lengths);
+	    uint32_t best = NAV_UNREACHABLE;
+	    for(uint32_t n = 0; n < count; n++){
+	        uint32_t through = NAV_Through(grid, cell, neighbours[n], lengths[n]);
+	        if(through < best) best = through;
+	    }
+	    grid->rhs[cell] = best;
+	}
+	if(grid->g[cell] != grid->rhs[cell]){
+	    NAV_QueuePush(grid, NAV_Key(grid, cell));
+	} else {
+	    NAV_QueueRemove(grid, (uint32_t)cell);
+	}
+}
+
+/// Expands inconsistent cells until the start is consistent and nothing queued can improve it
+static void NAV_Search(NAV_Grid* grid) {
+	int32_t neighbours[8];
+	uint32_t lengths[8];
+	while(grid->queueSize > 0){
+	    NAV_QueueEntry startKey = NAV_Key(grid, grid->start);
+	    NAV_QueueEntry top = grid->queue[0];
+	    if(!NAV_KeyLess(&top, &startKey) && grid->rhs[grid->start] == grid->g[grid->start]){
+	        break;
+	    }
+	    grid->stats.expansions++;
+	    const int32_t cell = (int32_t)top.cell;
+	    NAV_QueueEntry current = NAV_Key(grid, cell);
+	    if(NAV_KeyLess(&top, &current)){
+	        // the key is out of date (the start moved)
+	        NAV_QueuePush(grid, current);
+	    } else if(grid->g[cell] > grid->rhs[cell]){
+	        grid->g[cell] = grid->rhs[cell];
+	        NAV_QueueRemove(grid, (uint32_t)cell);
+	        uint32_t count = NAV_Neighbours(grid, cell, neighbours, lengths);
+	        for(uint32_t n = 0; n < count; n++){
+	            NAV_UpdateCell(grid, neighbours[n]);
+	        }
+	    } else {
+	        grid->g[cell] = NAV_UNREACHABLE;
+	        uint32_t count = NAV_Neighbours(grid, cell, neighbours, lengths);
+	        for(uint32_t n = 0; n < count; n++){
+	            NAV_UpdateCell(grid, neighbours[n]);
+	        }
+	        NAV_UpdateCell(grid, cell);
+	    }
+	}
+}
+
+/// Drops the search and starts a new one towards a goal cell
+static void NAV_Restart(NAV_Grid* grid, int32_t goal, int32_t start) {
+	const uint32_t cells = grid->columns * grid->rows;
+	for(uint32_t c = 0; c < cells; c++){
+	    grid->g[c] = grid->rhs[c] = NAV_UNREACHABLE;
+	    grid->queueIndex[c] = -1;
+	    grid->changedFlag[c] = 0;
+	}
+	grid->queueSize = 0;
+	grid->changedCount = 0;
+	grid->goal = goal;
+	grid->start = grid->last = start;
+	grid->km = 0;
+	grid->rhs[goal] = 0;
+	NAV_QueuePush(grid, NAV_Key(grid, goal));
+	grid->stats.searches++;
+}
+
+/// Movement cost of a cell from the layers covering it
+static uint32_t NAV_CellCost(const NAV_Grid* grid, uint32_t cell) {
+	uint32_t cost = NAV_COST_SCALE;
+	for(int l = 0; l < NAV_LAYER_COUNT; l++){
+	    if(grid->covers[l][cell] > 0) cost += grid->penalties[l];
+	}
+	return cost;
+}
+
+/// Adds delta to the number of objects of a layer covering the cells around a cell
+static void NAV_Cover(NAV_Grid* grid, NAV_Layer layer, int32_t centre, int32_t delta) {
+	const int32_t columns = (int32_t)grid->columns, rows = (int32_t)grid->rows;
+	const int32_t cx = centre % columns, cy = centre / columns;
+	uint16_t* covers = grid->covers[layer];
+	for(uint32_t o = 0; o < grid->diskSizes[layer]; o++){
+	    const int32_t x = cx + grid->disks[layer][o].dx, y = cy + grid->disks[layer][o].dy;
+	    if(x < 0 || x >= columns || y < 0 || y >= rows) continue;
+	    const int32_t cell = y * columns + x;
+	    const bool coveredBefore = covers[cell] > 0;
+	    covers[cell] = (uint16_t)(covers[cell] + delta);
+	    if(coveredBefore == (covers[cell] > 0)) continue;
+
+	    // the cost of the cell changed
+	    grid->cost[cell] = NAV_CellCost(grid, (uint32_t)cell);
+	    if(!grid->changedFlag[cell]){
+	        grid->changedFlag[cell] = 1;
+	        grid->changed[grid->changedCount++] = (uint32_t)cell;
+	    }
+	}
+}
+
+/// Builds the list of cells whose centres lie within a radius of the centre of a cell
+static bool NAV_BuildDisk(NAV_Grid* grid, NAV_Layer layer, float radius) {
+	int32_t reach = (int32_t)(radius / grid->cellSize);
+	NAV_Offset* disk = (NAV_Offset*)malloc((size_t)(2 * reach + 1) * (2 * reach + 1) * sizeof(NAV_Offset));
+	if(disk == NULL){
+	    return false;
+	}
+	uint32_t size = 0;
+	for(int32_t dy = -reach; dy <= reach; dy++){
+	    for(int32_t dx = -reach; dx <= reach; dx++){
+	        if(grid->cellSize * grid->cellSize * (float)(dx * dx + dy * dy) <= radius * radius){
+	            disk[size].dx = (int16_t)dx;
+	            disk[size].dy = (int16_t)dy;
+	            size++;
+	        }
+	    }
+	}
+	grid->disks[layer] = disk;
+	grid->diskSizes[layer] = size;
+	return true;
+}
+
+void NAV_Init(NAV_Grid* grid) {
+	memset(grid, 0, sizeof(NAV_Grid));
+	grid->goal = -1;
+}
+
+void NAV_Free(NAV_Grid* grid) {
+	for(int l = 0; l < NAV_LAYER_COUNT; l++){
+	    free(grid->disks[l]);
+	    free(grid->covers[l]);
+	}
+	free(grid->cost);
+	free(grid->g);
+	free(grid->rhs);
+	free(grid->queue);
+	free(grid->queueIndex);
+	free(grid->changed);
+	free(grid->changedFlag);
+	NAV_Init(grid);
+}
+
+bool NAV_Reset(NAV_Grid* grid, float width, float height, float cellSize, const float radii[NAV_LAYER_COUNT],
+               const float penalties[NAV_LAYER_COUNT]) {
+	NAV_Stats stats = grid->stats;
+	NAV_Free(grid);
+	grid->stats = stats;
+	float largest = (width > height) ? width : height;
+	if(!(largest > 0.0f) || !(cellSize > 0.0f)){
+	    return false;
+	}
+	if(largest / cellSize > NAV_MAX_CELLS_PER_AXIS){
+	    cellSize = largest / NAV_MAX_CELLS_PER_AXIS;
+	}
+	uint32_t columns = (width > 0.0f) ? (uint32_t)ceilf(width / cellSize) : 1;
+	uint32_t rows = (height > 0.0f) ? (uint32_t)ceilf(height / cellSize) : 1;
+	columns = (columns < 1) ? 1 : (columns > NAV_MAX_CELLS_PER_AXIS) ? NAV_MAX_CELLS_PER_AXIS : columns;
+	rows = (rows < 1) ? 1 : (rows > NAV_MAX_CELLS_PER_AXIS) ? NAV_MAX_CELLS_PER_AXIS : rows;
+	const size_t cells = (size_t)columns * rows;
+	grid->cellSize = cellSize;
+	grid->inverseCellSize = 1.0f / cellSize;
+
+	bool allocated = true;
+	for(int l = 0; l < NAV_LAYER_COUNT; l++){
+	    grid->penalties[l] = (penalties[l] > 0.0f) ? (uint32_t)lroundf(penalties[l] * NAV_COST_SCALE) : 0;
+	    grid->covers[l] = (uint16_t*)calloc(cells, sizeof(uint16_t));
+	    allocated = allocated && grid->covers[l] != NULL && NAV_BuildDisk(grid, (NAV_Layer)l, radii[l]);
+	}
+	grid->cost = (uint32_t*)malloc(cells * sizeof(uint32_t));
+	grid->g = (uint32_t*)malloc(cells * sizeof(uint32_t));
+	grid->rhs = (uint32_t*)malloc(cells * sizeof(uint32_t));
+	grid->queue = (NAV_QueueEntry*)malloc(cells * sizeof(NAV_QueueEntry));
+	grid->queueIndex = (int32_t*)malloc(cells * sizeof(int32_t));
+	grid->changed = (uint32_t*)malloc(cells * sizeof(uint32_t));
+	grid->changedFlag = (uint8_t*)calloc(cells, sizeof(uint8_t));
+	if(!allocated || grid->cost == NULL || grid->g == NULL || grid->rhs == NULL || grid->queue == NULL ||
+	   grid->queueIndex == NULL || grid->changed == NULL || grid->changedFlag == NULL){
+	    NAV_Free(grid);
+	    grid->stats = stats;
+	    return false;
+	}
+	for(size_t c = 0; c < cells; c++){
+	    grid->cost[c] = NAV_COST_SCALE;
+	}
+	grid->columns = columns;
+	grid->rows = rows;
+	return true;
+}
+
+void NAV_Move(NAV_Grid* grid, NAV_Layer layer, bool coveredBefore, float oldX, float oldY,
+              bool coveredAfter, float newX, float newY) {
+	if(grid->columns == 0){
+	    return;
+	}
+	int32_t oldCell = coveredBefore ? NAV_CellOf(grid, oldX, oldY) : -1;
+	int32_t newCell = coveredAfter ? NAV_CellOf(grid, newX, newY) : -1;
+	if(oldCell == newCell){
+	    return;
+	}
+	if(oldCell >= 0) NAV_Cover(grid, layer, oldCell, -1);
+	if(newCell >= 0) NAV_Cover(grid, layer, newCell, 1);
+}
+
+bool NAV_NextWaypoint(NAV_Grid* grid, float fromX, float fromY, float toX, float toY, float* waypointX, float* waypointY) {
+	if(grid->columns == 0){
+	    return false;
+	}
+	const int32_t start = NAV_CellOf(grid, fromX, fromY);
+	const int32_t goal = NAV_CellOf(grid, toX, toY);
+	if(start == goal){
+	    return false;
+	}
+
+	if(goal != grid->goal){
+	    NAV_Restart(grid, goal, start);
+	} else {
+	    // the costs to the goal stay valid: only the key offset follows the start...
+	    if(start != grid->start){
+	        grid->km += NAV_Heuristic(grid, grid->last, start);
+	        grid->last = grid->start = start;
+	    }
+	    // ...and the cells around every cost change are repaired (all their edges changed cost)
+	    int32_t neighbours[8];
+	    uint32_t lengths[8];
+	    for(uint32_t i = 0; i < grid->changedCount; i++){
+	        int32_t cell = (int32_t)grid->changed[i];
+	        grid->changedFlag[cell] = 0;
+	        NAV_UpdateCell(grid, cell);
+	        uint32_t count = NAV_Neighbours(grid, cell, neighbours, lengths);
+	        for(uint32_t n = 0; n < count; n++){
+	            NAV_UpdateCell(grid, neighbours[n]);
+	        }
+	    }
+	    grid->stats.repairs += grid->changedCount;
+	    grid->changedCount = 0;
+	}
+	NAV_Search(grid);
+	if(grid->g[start] == NAV_UNREACHABLE || grid->g[start] <= NAV_Heuristic(grid, start, goal)){
+	    // no path, or nothing on the way costs more than open ground
+	    return false;
+	}
+
+	// follow the cheapest successors
+	int32_t cell = start;
+	int32_t neighbours[8];
+	uint32_t lengths[8];
+	for(int step = 0; step < NAV_WAYPOINT_CELLS && cell != goal; step++){
+	    uint32_t count = NAV_Neighbours(grid, cell, neighbours, lengths);
+	    int32_t next = -1;
+	    uint32_t best = NAV_UNREACHABLE;
+	    for(uint32_t n = 0; n < count; n++){
+	        uint32_t through = NAV_Through(grid, cell, neighbours[n], lengths[n]);
+	        if(through < best){
+	            best = through;
+	            next = neighbours[n];
+	        }
+	    }
+	    if(next < 0) break;
+	    cell = next;
+	}
+	if(cell == goal){
+	    *waypointX = toX;
+	    *waypointY = toY;
+	} else {
+	    *waypointX = ((float)(cell % (int32_t)grid->columns) + 0.5f) * grid->cellSize;
+	    *waypointY = ((float)(cell / (int32_t)grid->columns) + 0.5f) * grid->cellSize;
+	}
+	grid->stats.plans++;
+	return true;
+}
+
+void NAV_Forget(NAV_Grid* grid) {
+	grid->goal = -1;
+}
+
+float NAV_PathCost(const NAV_Grid* grid) {
+	if(grid->goal < 0 || grid->g[grid->start] == NAV_UNREACHABLE){
+	    return INFINITY;
+	}
+	return (float)grid->g[grid->start] * grid->cellSize / (float)(2 * NAV_STRAIGHT * NAV_COST_SCALE);
+}
@@ -0,0 +1,148 @@
+#ifndef NAV_H_
+#define NAV_H_
+
+/**
+ * Navigation grid over the game map with incremental shortest paths (D* Lite).
+ *
+ * Every cell has a movement cost: 1 on open ground plus the penalty of every layer covering it (glue makes a
+ * cell as expensive as the glue slowdown, the zone around a spark much more). An object covers the cells whose
+ * centres lie within the radius of its layer around the centre of its own cell, and the number of objects
+ * covering each cell is counted, so moving an object (@ref NAV_Move) changes only the cells it leaves and enters
+ * and the cells whose cost really changes are remembered.
+ *
+ * Paths are searched backwards from the goal cell with D* Lite: the costs to the goal (g) stay valid between
+ * calls, so when the start moves only the key offset changes and when cells change cost only those cells and
+ * the cells whose route led through them are expanded again. A new goal cell starts a new search. Moving from
+ * a cell to one of its 8 neighbours costs the distance between the centres times the mean cost of both cells.
+ *
+ * Costs are integers (cell costs in 1/NAV_COST_SCALE, a diagonal step 99/70 of a straight one), so the keys of
+ * the search compare exactly and the repaired paths are the same as the ones searched from scratch.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/// Maximum number of cells along one axis of the grid (larger maps get larger cells)
+#define NAV_MAX_CELLS_PER_AXIS 128
+/// Number of path cells followed to pick the waypoint (the path is smoothed over this many cells)
+#define NAV_WAYPOINT_CELLS 3
+/// Units of a cell cost of 1 (penalties are rounded to these units)
+#define NAV_COST_SCALE 16
+/// Path cost of unreachable cells
+#define NAV_UNREACHABLE UINT32_MAX
+
+/** Layers of cell costs */
+typedef enum {
+	NAV_GLUE = 0,                  ///< glue areas
+	NAV_SPARK,                     ///< zones around the sparks
+	NAV_LAYER_COUNT
+} NAV_Layer;
+
+/** Cell offset covered by an object of a layer */
+typedef struct {
+	int16_t dx, dy;
+} NAV_Offset;
+
+/** Entry of the priority queue of the search */
+typedef struct {
+	uint64_t k1, k2;               ///< key (compared lexicographically)
+	uint32_t cell;                 ///< cell of the entry
+} NAV_QueueEntry;
+
+/** Counters of a grid */
+typedef struct {
+	uint64_t plans;                ///< waypoints found
+	uint64_t searches;             ///< searches started from scratch (new map or new goal cell)
+	uint64_t repairs;              ///< cells repaired after a change of their cost
+	uint64_t expansions;           ///< cells taken from the queue by all searches
+} NAV_Stats;
+
+/** Structure of the grid */
+typedef struct {
+	float cellSize;                                ///< length of the cell side
+	float inverseCellSize;                         ///< 1 / cellSize
+	uint32_t columns;                              ///< number of cells along the X axis (0 = no grid)
+	uint32_t rows;                                 ///< number of cells along the Y axis
+	uint32_t penalties[NAV_LAYER_COUNT];           ///< cost added to a cell covered by the layer (scaled)
+	NAV_Offset* disks[NAV_LAYER_COUNT];            ///< cells covered by an object of the layer (around its cell)
+	uint32_t diskSizes[NAV_LAYER_COUNT];           ///< number of offsets of every disk
+	uint16_t* covers[NAV_LAYER_COUNT];             ///< number of objects of the layer covering every cell
+	uint32_t* cost;                                ///< movement cost of every cell (scaled)
+	uint32_t* g;                                   ///< cost of the path from every cell to the goal (integer units)
+	uint32_t* rhs;                                 ///< one-step lookahead of g
+	NAV_QueueEntry* queue;                         ///< binary heap of the inconsistent cells
+	int32_t* queueIndex;                           ///< position of every cell in the heap, -1 if not queued
+	uint32_t queueSize;                            ///< number of cells in the heap
+	uint32_t* changed;                             ///< cells whose cost changed since the last search
+	uint8_t* changedFlag;                          ///< cell is in the changed list
+	uint32_t changedCount;                         ///< number of changed cells
+	int32_t goal;                                  ///< goal cell of the search, -1 if none
+	int32_t start;                                 ///< start cell of the last search
+	int32_t last;                                  ///< start cell when the key offset was last updated
+	uint64_t km;                                   ///< key offset accumulated by the moves of the start
+	NAV_Stats stats;                               ///< counters
+} NAV_Grid;
+
+/**
+ * @brief Initializes an empty grid (no cells until @ref NAV_Reset).
+ */
+void NAV_Init(NAV_Grid* grid);
+
+/**
+ * @brief Releases all memory of the grid.
+ */
+void NAV_Free(NAV_Grid* grid);
+
+/**
+ * @brief Changes the geometry of the grid for a map of the given size, uncovers all cells and drops the search.
+ *
+ * @param grid grid to reset
+ * @param width map width
+ * @param height map height
+ * @param cellSize preferred cell size (increased if the map would need more than NAV_MAX_CELLS_PER_AXIS cells)
+ * @param radii radius of the area covered by an object of every layer
+ * @param penalties cost added to a cell covered by every layer (rounded to 1/NAV_COST_SCALE)
+ *
+ * @return true on success, on failure the grid is left without cells
+ */
+bool NAV_Reset(NAV_Grid* grid, float width, float height, float cellSize, const float radii[NAV_LAYER_COUNT],
+               const float penalties[NAV_LAYER_COUNT]);
+
+/**
+ * @brief Moves the area covered by an object (covered before: false = a new object; after: false = it is gone).
+ *
+ * Nothing is done if the object stays in its cell.
+ */
+void NAV_Move(NAV_Grid* grid, NAV_Layer layer, bool coveredBefore, float oldX, float oldY,
+              bool coveredAfter, float newX, float newY);
+
+/**
+ * @brief Finds the point to move to next on the cheapest path between two points.
+ *
+ * The search is repaired (or started, for a new goal cell) and the path is followed for NAV_WAYPOINT_CELLS
+ * cells: the waypoint is the centre of the cell reached, or the goal point itself if the path ends there.
+ *
+ * @return false if both points are in the same cell, there is no grid or no path, or the path costs no more than
+ *         on open ground (nothing to go around - the caller moves straight to the goal)
+ */
+bool NAV_NextWaypoint(NAV_Grid* grid, float fromX, float fromY, float toX, float toY, float* waypointX, float* waypointY);
+
+/**
+ * @brief Drops the search: the next @ref NAV_NextWaypoint searches from scratch.
+ */
+void NAV_Forget(NAV_Grid* grid);
+
+/**
+ * @brief Cost of the cheapest path from the start of the last search to its goal (INFINITY if there is none).
+ */
+float NAV_PathCost(const NAV_Grid* grid);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* NAV_H_ */
@@ -0,0 +1,116 @@
+#include <stdlib.h>
+#include <string.h>
+#include "objtable.h"
+#include "platform.h"
+
+/// Number of floats in one OBJTABLE_ALIGNMENT block - capacities are rounded up to it
+#define OBJTABLE_FLOATS_PER_BLOCK (OBJTABLE_ALIGNMENT / sizeof(float))
+
+static uint32_t* OBJTABLE_IndexSlot(const OBJTABLE_Table* table, uint16_t objectNo) {
+	uint32_t* page = table->indexPages[objectNo / OBJTABLE_PAGE_SIZE];
+	return (page != NULL) ? &page[objectNo % OBJTABLE_PAGE_SIZE] : NULL;
+}
+
+static bool OBJTABLE_GrowArray(void** array, size_t elementSize, uint32_t count, uint32_t capacity) {
+	void* grown = PLATFORM_AlignedAlloc(capacity * elementSize, OBJTABLE_ALIGNMENT);
+	if(grown == NULL){
+	    return false;
+	}
+	if(*array != NULL){
+	    memcpy(grown, *array, count * elementSize);
+	    PLATFORM_AlignedFree(*array);
+	}
+	*array = grown;
+	return true;
+}
+
+static bool OBJTABLE_Reserve(OBJTABLE_Table* table, uint32_t capacity) {
+	if(capacity <= table->capacity){
+	    return true;
+	}
+	capacity = (uint32_t)((capacity + OBJTABLE_FLOATS_PER_BLOCK - 1) / OBJTABLE_FLOATS_PER_BLOCK * OBJTABLE_FLOATS_PER_BLOCK);
+	if(!OBJTABLE_GrowArray((void**)&table->x, sizeof(float), table->count, capacity) ||
+	   !OBJTABLE_GrowArray((void**)&table->y, sizeof(float), table->count, capacity) ||
+	   !OBJTABLE_GrowArray((void**)&table->hp, sizeof(float), table->count, capacity) ||
+	   !OBJTABLE_GrowArray((void**)&table->objectNo, sizeof(uint16_t), table->count, capacity)){
+	    // arrays that were grown keep working, the capacity stays at the smallest common size
+	    return false;
+	}
+	table->capacity = capacity;
+	return true;
+}
+
+void OBJTABLE_Init(OBJTABLE_Table* table, uint32_t initialCapacity) {
+	memset(table, 0, sizeof(OBJTABLE_Table));
+	OBJTABLE_Reserve(table, initialCapacity);
+}
+
+void OBJTABLE_Free(OBJTABLE_Table* table) {
+	for(uint32_t i = 0; i < OBJTABLE_PAGE_COUNT; i++){
+	    free(table->indexPages[i]);
+	}
+	PLATFORM_AlignedFree(table->x);
+	PLATFORM_AlignedFree(table->y);
+	PLATFORM_AlignedFree(table->hp);
+	PLATFORM_AlignedFree(table->objectNo);
+	memset(table, 0, sizeof(OBJTABLE_Table));
+}
+
+void OBJTABLE_Clear(OBJTABLE_Table* table) {
+	for(uint32_t i = 0; i < table->count; i++){
+	    *OBJTABLE_IndexSlot(table, table->objectNo[i]) = 0;
+	}
+	table->count = 0;
+}
+
+int32_t OBJTABLE_Find(const OBJTABLE_Table* table, uint16_t objectNo) {
+	const uint32_t* slot = OBJTABLE_IndexSlot(table, objectNo);
+	if(slot == NULL || *slot == 0){
+	    return OBJTABLE_NOT_FOUND;
+	}
+	return (int32_t)(*slot - 1);
+}
+
+int32_t OBJTABLE_Upsert(OBJTABLE_Table* table, const AMCOM_ObjectState* object) {
+	uint16_t objectNo = object->objectNo;
+	uint32_t** page = &table->indexPages[objectNo / OBJTABLE_PAGE_SIZE];
+	if(*page == NULL){
+	    *page = (uint32_t*)calloc(OBJTABLE_PAGE_SIZE, sizeof(uint32_t));
+	    if(*page == NULL){
+	        return OBJTABLE_NOT_FOUND;
+	    }
+	}
+	uint32_t* slot = &(*page)[objectNo % OBJTABLE_PAGE_SIZE];
+	if(*slot == 0){
+	    if(table->count == table->capacity &&
+	       !OBJTABLE_Reserve(table, table->capacity ? table->capacity * 2 : 16)){
+	        return OBJTABLE_NOT_FOUND;
+	    }
+	    table->objectNo[table->count] = objectNo;
+	    *slot = ++table->count;
+	}
+	uint32_t position = *slot - 1;
+	table->x[position] = object->x;
+	table->y[position] = object->y;
+	table->hp[position] = object->hp;
+	return (int32_t)position;
+}
+
+bool OBJTABLE_Remove(OBJTABLE_Table* table, uint16_t objectNo) {
+	uint32_t* slot = OBJTABLE_IndexSlot(table, objectNo);
+	if(slot == NULL || *slot == 0){
+	    return false;
+	}
+	uint32_t position = *slot - 1;
+	uint32_t last = table->count - 1;
+	if(position != last){
+	    table->x[position] = table->x[last];
+	    table->y[position] = table->y[last];
+	    table->hp[position] = table->hp[last];
+	    table->objectNo[position] = table->objectNo[last];
+	    *OBJTABLE_IndexSlot(table, table->objectNo[position]) = position + 1;
+	}
+	*slot = 0;
+	table->count--;
+	return true;
+}
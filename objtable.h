@@ -0,0 +1,90 @@
+#ifndef OBJTABLE_H_
+#define OBJTABLE_H_
+
+/**
+ * Slot map of game objects of one class (players, transistors, sparks or glue), keyed by objectNo.
+ *
+ * Objects are stored densely in structure-of-arrays form (x[], y[], hp[], objectNo[]), so that the decision
+ * kernels can stream over aligned float arrays with SIMD loads. A sparse index maps objectNo to the position
+ * in the dense arrays. The index is split into pages of OBJTABLE_PAGE_SIZE entries which are allocated only
+ * when an objectNo from their range shows up, so lookups, inserts and removals are O(1) without reserving
+ * memory for all 65536 possible object numbers. The dense arrays grow on demand and are kept compacted
+ * (removal moves the last object into the freed slot).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "amcom_packets.h"
+
+enum {
+	/// Number of objectNo values covered by one page of the sparse index
+	OBJTABLE_PAGE_SIZE = 256,
+	/// Number of pages needed to cover the whole uint16_t objectNo range
+	OBJTABLE_PAGE_COUNT = 65536 / OBJTABLE_PAGE_SIZE,
+	/// Alignment of the dense arrays in bytes (one AVX register)
+	OBJTABLE_ALIGNMENT = 32
+};
+
+/// Value returned by the lookup functions when there is no such object
+#define OBJTABLE_NOT_FOUND (-1)
+
+/** Structure of the object table */
+typedef struct {
+	float* x;                                    ///< X positions (OBJTABLE_ALIGNMENT aligned)
+	float* y;                                    ///< Y positions (OBJTABLE_ALIGNMENT aligned)
+	float* hp;                                   ///< hit points (OBJTABLE_ALIGNMENT aligned)
+	uint16_t* objectNo;                          ///< object numbers
+	uint32_t count;                              ///< number of objects in the dense arrays
+	uint32_t capacity;                           ///< allocated size of the dense arrays
+	uint32_t* indexPages[OBJTABLE_PAGE_COUNT];   ///< sparse index: objectNo -> dense position + 1 (0 = absent)
+} OBJTABLE_Table;
+
+/**
+ * @brief Initializes an empty table.
+ *
+ * @param table table to initialize
+ * @param initialCapacity number of objects to reserve room for (0 = allocate on first insert)
+ */
+void OBJTABLE_Init(OBJTABLE_Table* table, uint32_t initialCapacity);
+
+/**
+ * @brief Releases all memory of the table. The table is empty afterwards and may be reused.
+ */
+void OBJTABLE_Free(OBJTABLE_Table* table);
+
+/**
+ * @brief Removes all objects but keeps the allocated memory.
+ */
+void OBJTABLE_Clear(OBJTABLE_Table* table);
+
+/**
+ * @brief Finds the object with the given number.
+ *
+ * @return position of the object in the dense arrays or @ref OBJTABLE_NOT_FOUND
+ */
+int32_t OBJTABLE_Find(const OBJTABLE_Table* table, uint16_t objectNo);
+
+/**
+ * @brief Inserts a new object or overwrites the existing object with the same objectNo.
+ *
+ * @return position of the stored object or @ref OBJTABLE_NOT_FOUND if memory could not be allocated
+ */
+int32_t OBJTABLE_Upsert(OBJTABLE_Table* table, const AMCOM_ObjectState* object);
+
+/**
+ * @brief Removes the object with the given number by moving the last object into its place.
+ *
+ * @return true if the object was present
+ */
+bool OBJTABLE_Remove(OBJTABLE_Table* table, uint16_t objectNo);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* OBJTABLE_H_ */
@@ -0,0 +1,267 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "occlusion.h"
+
+/// Pseudo-angles of the directions -pi and pi (ends of the atan2 range)
+#define OCCLUSION_PSEUDO_MIN (-2.0f)
+#define OCCLUSION_PSEUDO_MAX 2.0f
+/// Targets closer than this to an interval end (in pseudo-angle units) are checked exactly
+#define OCCLUSION_MARGIN 1e-5f
+/// Owner of the bounds that mark the ends of the atan2 range
+#define OCCLUSION_RANGE_END UINT32_MAX
+/// Number of values below which insertion sort beats the radix sort
+#define OCCLUSION_RADIX_SORT_MIN 64
+
+/**
+ * Maps a direction to [-2, 2] so that the order matches atan2(dy, dx) in [-pi, pi]
+ * (-pi/2 -> -1, 0 -> 0, pi/2 -> 1, the sign of a zero dy selects -pi or pi like atan2 does).
+ * The direction must not be the zero vector.
+ */
+static float OCCLUSION_PseudoAngle(float dx, float dy) {
+	float q = dy / (fabsf(dx) + fabsf(dy));
+	if(dx >= 0.0f){
+	    return q;
+	}
+	return signbit(dy) ? -2.0f - q : 2.0f - q;
+}
+
+/// Maps a float to an unsigned key with the same order (for the radix sort)
+static uint32_t OCCLUSION_SortKey(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+/// Sorts the bounds together with their owners (four pass, 8 bit LSD radix sort for many values)
+static void OCCLUSION_SortBounds(OCCLUSION_Map* map) {
+	float* bounds = map->bounds;
+	uint32_t* owners = map->boundOwners;
+	uint32_t count = map->boundCount;
+
+	if(count < OCCLUSION_RADIX_SORT_MIN){
+	    for(uint32_t i = 1; i < count; i++){
+	        float value = bounds[i];
+	        uint32_t owner = owners[i];
+	        uint32_t j = i;
+	        for(; j > 0 && bounds[j - 1] > value; j--){
+	            bounds[j] = bounds[j - 1];
+	            owners[j] = owners[j - 1];
+	        }
+	        bounds[j] = value;
+	        owners[j] = owner;
+	    }
+	    return;
+	}
+	float* fromBounds = bounds;
+	uint32_t* fromOwners = owners;
+	float* toBounds = map->sortBounds;
+	uint32_t* toOwners = map->sortOwners;
+	for(uint32_t shift = 0; shift < 32; shift += 8){
+	    uint32_t offsets[256] = { 0 };
+	    for(uint32_t i = 0; i < count; i++){
+	        offsets[(OCCLUSION_SortKey(fromBounds[i]) >> shift) & 255]++;
+	    }
+	    uint32_t total = 0;
+	    for(uint32_t b = 0; b < 256; b++){
+	        uint32_t bucket = offsets[b];
+	        offsets[b] = total;
+	        total += bucket;
+	    }
+	    for(uint32_t i = 0; i < count; i++){
+	        uint32_t position = offsets[(OCCLUSION_SortKey(fromBounds[i]) >> shift) & 255]++;
+	        toBounds[position] = fromBounds[i];
+	        toOwners[position] = fromOwners[i];
+	    }
+	    float* swapBounds = fromBounds;
+	    fromBounds = toBounds;
+	    toBounds = swapBounds;
+	    uint32_t* swapOwners = fromOwners;
+	    fromOwners = toOwners;
+	    toOwners = swapOwners;
+	}
+	// an even number of passes leaves the result in the original arrays
+}
+
+/// Returns the number of bounds that are <= value (branchless, the searches are unpredictable)
+static uint32_t OCCLUSION_UpperBound(const float* bounds, uint32_t count, float value) {
+	const float* base = bounds;
+	while(count > 1){
+	    uint32_t half = count / 2;
+	    base = (base[half] <= value) ? base + half : base;
+	    count -= half;
+	}
+	return (uint32_t)(base - bounds) + (count == 1 && *base <= value);
+}
+
+static bool OCCLUSION_Reserve(OCCLUSION_Map* map, uint32_t glueCount) {
+	if(glueCount <= map->capacity){
+	    return true;
+	}
+	uint32_t capacity = map->capacity ? map->capacity : 16;
+	while(capacity < glueCount){
+	    capacity *= 2;
+	}
+	uint32_t treeSize = 1;
+	while(treeSize < 2 * capacity + 3){
+	    treeSize *= 2;
+	}
+	OCCLUSION_Free(map);
+	map->glueDistance = (float*)malloc(capacity * sizeof(float));
+	map->glueX = (float*)malloc(capacity * sizeof(float));
+	map->glueY = (float*)malloc(capacity * sizeof(float));
+	map->bounds = (float*)malloc((2 * capacity + 2) * sizeof(float));
+	map->boundOwners = (uint32_t*)malloc((2 * capacity + 2) * sizeof(uint32_t));
+	map->sortBounds = (float*)malloc((2 * capacity + 2) * sizeof(float));
+	map->sortOwners = (uint32_t*)malloc((2 * capacity + 2) * sizeof(uint32_t));
+	map->lowerPositions = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+	map->segmentDistance = (float*)malloc(2 * treeSize * sizeof(float));
+	if(map->glueDistance == NULL || map->glueX == NULL || map->glueY == NULL ||
+	   map->bounds == NULL || map->boundOwners == NULL || map->sortBounds == NULL || map->sortOwners == NULL ||
+	   map->lowerPositions == NULL || map->segmentDistance == NULL){
+	    OCCLUSION_Free(map);
+	    return false;
+	}
+	map->capacity = capacity;
+	return true;
+}
+
+/**
+ * The exact original test - used for targets too close to an interval end to trust the pseudo-angles.
+ */
+static bool OCCLUSION_IsBlockedExact(const OCCLUSION_Map* map, float dx, float dy, float distance) {
+	float targetAngle = atan2f(dy, dx);
+	for(uint32_t j = 0; j < map->glueCount; j++){
+	    if(map->glueDistance[j] < distance){
+	        float glueAngle = atan2f(map->radius, map->glueDistance[j]);
+	        float glueTargetAngle = atan2f(map->glueY[j], map->glueX[j]);
+	        if(targetAngle < glueTargetAngle + glueAngle && targetAngle > glueTargetAngle - glueAngle){
+	            return true;
+	        }
+	    }
+	}
+	return false;
+}
+
+void OCCLUSION_Init(OCCLUSION_Map* map) {
+	memset(map, 0, sizeof(OCCLUSION_Map));
+}
+
+void OCCLUSION_Free(OCCLUSION_Map* map) {
+	free(map->glueDistance);
+	free(map->glueX);
+	free(map->glueY);
+	free(map->bounds);
+	free(map->boundOwners);
+	free(map->sortBounds);
+	free(map->sortOwners);
+	free(map->lowerPositions);
+	free(map->segmentDistance);
+	memset(map, 0, sizeof(OCCLUSION_Map));
+}
+
+bool OCCLUSION_Build(OCCLUSION_Map* map, const OBJTABLE_Table* glue, float originX, float originY, float radius) {
+	map->glueCount = 0;
+	map->boundCount = 0;
+	if(!OCCLUSION_Reserve(map, glue->count)){
+	    return false;
+	}
+	map->radius = radius;
+
+	// blocked interval of every active glue spot: the direction to the glue rotated by +-atan2(radius, glueDistance).
+	// The rotation uses cos = glueDistance and sin = radius scaled by the same factor, so no trigonometry is needed.
+	for(uint32_t i = 0; i < glue->count; i++){
+	    if(glue->hp[i] <= 0) continue;
+
+	    float glueX = glue->x[i] - originX;
+	    float glueY = glue->y[i] - originY;
+	    float glueDistance = sqrtf(glueX*glueX + glueY*glueY) - radius;
+	    if(isnan(glueDistance)) continue;
+
+	    uint32_t j = map->glueCount++;
+	    map->glueX[j] = glueX;
+	    map->glueY[j] = glueY;
+	    map->glueDistance[j] = glueDistance;
+
+	    double directionX = glueX, directionY = glueY;
+	    if(glueX == 0.0f && glueY == 0.0f){
+	        // we stand in the middle of the glue - use the direction atan2 reports for a zero vector
+	        directionX = signbit(glueX) ? -1.0 : 1.0;
+	        directionY = copysign(0.0, glueY);
+	    }
+	    double cosine = glueDistance, sine = radius;
+	    float center = OCCLUSION_PseudoAngle((float)directionX, (float)directionY);
+	    float lower = OCCLUSION_PseudoAngle((float)(directionX * cosine + directionY * sine),
+	                                        (float)(directionY * cosine - directionX * sine));
+	    float upper = OCCLUSION_PseudoAngle((float)(directionX * cosine - directionY * sine),
+	                                        (float)(directionY * cosine + directionX * sine));
+	    // the interval does not wrap around +-pi: an end that went past it is clamped to the end of the range
+	    map->bounds[map->boundCount] = (lower > center + OCCLUSION_MARGIN) ? OCCLUSION_PSEUDO_MIN : lower;
+	    map->boundOwners[map->boundCount++] = 2 * j;
+	    map->bounds[map->boundCount] = (upper < center - OCCLUSION_MARGIN) ? OCCLUSION_PSEUDO_MAX : upper;
+	    map->boundOwners[map->boundCount++] = 2 * j + 1;
+	}
+	if(map->glueCount == 0){
+	    return true;
+	}
+	// the ends of the atan2 range are treated as interval ends, so that directions near +-pi are checked exactly
+	map->bounds[map->boundCount] = OCCLUSION_PSEUDO_MIN;
+	map->boundOwners[map->boundCount++] = OCCLUSION_RANGE_END;
+	map->bounds[map->boundCount] = OCCLUSION_PSEUDO_MAX;
+	map->boundOwners[map->boundCount++] = OCCLUSION_RANGE_END;
+	OCCLUSION_SortBounds(map);
+
+	// segment s lies between bounds[s - 1] and bounds[s] and remembers the closest glue spot covering it:
+	// every interval lowers the range of segments between its ends in a min tree, then the minima are pushed
+	// down to the leaves
+	float* tree = map->segmentDistance;
+	uint32_t base = 1;
+	while(base < map->boundCount + 1){
+	    base *= 2;
+	}
+	map->segmentBase = base;
+	for(uint32_t n = 1; n < 2 * base; n++){
+	    tree[n] = INFINITY;
+	}
+	for(uint32_t position = 0; position < map->boundCount; position++){
+	    uint32_t owner = map->boundOwners[position];
+	    if(owner == OCCLUSION_RANGE_END) continue;
+	    if((owner & 1) == 0){
+	        map->lowerPositions[owner / 2] = position;
+	        continue;
+	    }
+	    float glueDistance = map->glueDistance[owner / 2];
+	    uint32_t low = map->lowerPositions[owner / 2] + 1 + base;
+	    uint32_t high = position + 1 + base;
+	    for(; low < high; low /= 2, high /= 2){
+	        if(low & 1){
+	            if(glueDistance < tree[low]) tree[low] = glueDistance;
+	            low++;
+	        }
+	        if(high & 1){
+	            high--;
+	            if(glueDistance < tree[high]) tree[high] = glueDistance;
+	        }
+	    }
+	}
+	for(uint32_t n = 2; n < 2 * base; n++){
+	    if(tree[n / 2] < tree[n]) tree[n] = tree[n / 2];
+	}
+	return true;
+}
+
+bool OCCLUSION_IsBlocked(const OCCLUSION_Map* map, float dx, float dy, float distance) {
+	if(map->glueCount == 0){
+	    return false;
+	}
+	if(!(fabsf(dx) + fabsf(dy) > 0.0f)){
+	    return OCCLUSION_IsBlockedExact(map, dx, dy, distance);
+	}
+	float pseudo = OCCLUSION_PseudoAngle(dx, dy);
+	uint32_t segment = OCCLUSION_UpperBound(map->bounds, map->boundCount, pseudo);
+	if((segment > 0 && pseudo - map->bounds[segment - 1] < OCCLUSION_MARGIN) ||
+	   (segment < map->boundCount && map->bounds[segment] - pseudo < OCCLUSION_MARGIN)){
+	    return OCCLUSION_IsBlockedExact(map, dx, dy, distance);
+	}
+	return map->segmentDistance[map->segmentBase + segment] < distance;
+}
@@ -0,0 +1,84 @@
+#ifndef OCCLUSION_H_
+#define OCCLUSION_H_
+
+/**
+ * Per-tick glue occlusion map: tells whether the straight path from our position to a target passes a glue spot.
+ *
+ * The rule is the one the decision code always used: a glue spot at distance d (measured to its edge) with angular
+ * half-width atan2(radius, d) around the direction atan2(glueY, glueX) blocks every target that is further away
+ * than d and whose direction lies strictly inside that angular interval (the interval does not wrap around +-pi).
+ *
+ * @ref OCCLUSION_Build finds the interval ends by rotating the direction to the glue (the sine and cosine of the
+ * half-width are just the glue radius and distance) and stores them as "pseudo-angles" - a monotonic function of
+ * the direction computed with one division instead of atan2. The interval ends are sorted and every elementary
+ * segment between them remembers the closest glue covering it. A target is then classified with one pseudo-angle
+ * and a binary search, without trigonometry. Targets whose pseudo-angle lies within rounding distance of an
+ * interval end are checked with the exact original computation, so the result is always identical to it.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "objtable.h"
+
+/** Structure of the occlusion map */
+typedef struct {
+	uint32_t glueCount;          ///< number of active glue spots
+	float* glueDistance;         ///< distance to the edge of every glue spot
+	float* glueX;                ///< X offset of every glue spot from the observer
+	float* glueY;                ///< Y offset of every glue spot from the observer
+	float radius;                ///< radius of a glue spot
+	uint32_t boundCount;         ///< number of entries in bounds
+	float* bounds;               ///< sorted pseudo-angles of all interval ends
+	uint32_t* boundOwners;       ///< interval end stored in each entry of bounds (2 * glue + 1 for upper ends)
+	float* sortBounds;           ///< work array for sorting bounds
+	uint32_t* sortOwners;        ///< work array for sorting boundOwners
+	uint32_t* lowerPositions;    ///< position of the lower end of every interval in bounds
+	float* segmentDistance;      ///< min tree of the closest glue covering each segment between bounds
+	uint32_t segmentBase;        ///< position of the first segment (leaf) in segmentDistance
+	uint32_t capacity;           ///< number of glue spots the arrays have room for
+} OCCLUSION_Map;
+
+/**
+ * @brief Initializes an empty map.
+ */
+void OCCLUSION_Init(OCCLUSION_Map* map);
+
+/**
+ * @brief Releases all memory of the map.
+ */
+void OCCLUSION_Free(OCCLUSION_Map* map);
+
+/**
+ * @brief Builds the map for the given observer position.
+ *
+ * @param map map to build
+ * @param glue glue spots (only the ones with hp > 0 are active)
+ * @param originX X of the observer (our position)
+ * @param originY Y of the observer (our position)
+ * @param radius radius of a glue spot
+ *
+ * @return true on success, false if memory could not be allocated (the map is empty then)
+ */
+bool OCCLUSION_Build(OCCLUSION_Map* map, const OBJTABLE_Table* glue, float originX, float originY, float radius);
+
+/**
+ * @brief Checks whether a glue spot lies between the observer and a target.
+ *
+ * @param map map built for the observer
+ * @param dx target X offset from the observer
+ * @param dy target Y offset from the observer
+ * @param distance distance of the target from the observer
+ *
+ * @return true if the target is behind a glue spot
+ */
+bool OCCLUSION_IsBlocked(const OCCLUSION_Map* map, float dx, float dy, float distance);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* OCCLUSION_H_ */
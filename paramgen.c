@@ -0,0 +1,68 @@
+/**
+ * Generates params_fixed.h - the strategy parameters of a parameter file (see params.h) as compile-time constants.
+ *
+ * Usage: mniam_paramgen params_file header
+ *
+ * Run by the build when MNIAM_STRATEGY_PARAMS is set: the decision code then reads the parameters from the
+ * generated static const structure instead of GameState, so the compiler folds them into the expressions that
+ * use them (sums of radii, comparisons, the glue penalty) like the macros the strategy was written with. The
+ * constants derived from them (squares, cosines and sines, see PARAMS_Derived) are computed here as well, so
+ * the specialized build does not compute them at run time.
+ */
+#include <stdio.h>
+#include <math.h>
+#include "params.h"
+
+/// Writes a float constant as a C literal that gives back exactly the same float
+static void writeFloat(FILE* header, float value, const char* name) {
+    if (isnan(value)) {
+        fprintf(header, "\tNAN, // %s\n", name);
+    } else if (isinf(value)) {
+        fprintf(header, "\t%sINFINITY, // %s\n", value < 0 ? "-" : "", name);
+    } else {
+        // 9 significant digits give back exactly the float
+        fprintf(header, "\t%#.9gf, // %s\n", value, name);
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        printf("Usage: %s params_file header\n", argv[0]);
+        return 1;
+    }
+    PARAMS_Strategy params;
+    if (!PARAMS_Load(argv[1], &params)) {
+        printf("Unable to load strategy parameters from %s\n", argv[1]);
+        return 1;
+    }
+    FILE* header = fopen(argv[2], "w");
+    if (header == NULL) {
+        printf("Unable to create %s\n", argv[2]);
+        return 1;
+    }
+    fprintf(header, "/* Generated by mniam_paramgen from %s - do not edit */\n", argv[1]);
+    fprintf(header, "#ifndef PARAMS_FIXED_H_\n#define PARAMS_FIXED_H_\n\n#include <math.h>\n#include \"params.h\"\n\n");
+    fprintf(header, "/// Strategy parameters compiled into the decision code\n");
+    fprintf(header, "static const PARAMS_Strategy PARAMS_FIXED_VALUES = {\n");
+    for (unsigned f = 0; f < PARAMS_FIELD_COUNT; f++) {
+        // 17 significant digits give back exactly the loaded double
+        fprintf(header, "\t%.17g, // %s\n", PARAMS_Get(&params, f), PARAMS_FIELDS[f].name);
+    }
+    fprintf(header, "};\n\n");
+
+    PARAMS_Derived derived;
+    PARAMS_Derive(&params, &derived);
+    fprintf(header, "/// Constants derived from the parameters (computed by mniam_paramgen)\n");
+    fprintf(header, "static const PARAMS_Derived PARAMS_FIXED_DERIVED = {\n");
+    writeFloat(header, derived.attackRangeSquared, "attackRangeSquared");
+    writeFloat(header, derived.gluePenaltySquared, "gluePenaltySquared");
+    writeFloat(header, derived.sparkAvoidanceCosine, "sparkAvoidanceCosine");
+    writeFloat(header, derived.evasionCosine, "evasionCosine");
+    writeFloat(header, derived.evasionSine, "evasionSine");
+    fprintf(header, "};\n\n#endif /* PARAMS_FIXED_H_ */\n");
+    if (fclose(header) != 0) {
+        printf("Writing %s failed\n", argv[2]);
+        return 1;
+    }
+    return 0;
+}
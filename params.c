@@ -0,0 +1,94 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "params.h"
+
+/// Longest line of a parameter file
+#define PARAMS_LINE_LENGTH 256
+
+const PARAMS_Field PARAMS_FIELDS[PARAMS_FIELD_COUNT] = {
+	{ "danger_detection_range", offsetof(PARAMS_Strategy, dangerDetectionRange), 100.0, 0.0, 400.0 },
+	{ "attack_range", offsetof(PARAMS_Strategy, attackRange), 150.0, 0.0, 600.0 },
+	{ "spark_detection_range", offsetof(PARAMS_Strategy, sparkDetectionRange), 20.0, 0.0, 200.0 },
+	{ "spark_avoidance_radius", offsetof(PARAMS_Strategy, sparkAvoidanceRadius), 50.0, 0.0, 300.0 },
+	{ "glue_movement_penalty", offsetof(PARAMS_Strategy, glueMovementPenalty), 20.0, 1.0, 50.0 },
+	{ "spark_avoidance_angle", offsetof(PARAMS_Strategy, sparkAvoidanceAngle), M_PI / 3, 0.0, M_PI },
+	{ "evasion_angle", offsetof(PARAMS_Strategy, evasionAngle), M_PI / 2, 0.0, M_PI },
+	{ "spark_lookahead", offsetof(PARAMS_Strategy, sparkLookahead), 0.0, 0.0, 50.0 },
+	{ "player_lookahead", offsetof(PARAMS_Strategy, playerLookahead), 0.0, 0.0, 50.0 },
+};
+
+void PARAMS_Default(PARAMS_Strategy* params) {
+	for(unsigned f = 0; f < PARAMS_FIELD_COUNT; f++){
+	    *PARAMS_Value(params, f) = PARAMS_FIELDS[f].defaultValue;
+	}
+}
+
+void PARAMS_Derive(const PARAMS_Strategy* params, PARAMS_Derived* derived) {
+	const float attackRange = (float)params->attackRange;
+	const float penalty = (float)params->glueMovementPenalty;
+	derived->attackRangeSquared = attackRange * attackRange;
+	derived->gluePenaltySquared = penalty * penalty;
+	derived->sparkAvoidanceCosine = (float)cos(params->sparkAvoidanceAngle);
+	derived->evasionCosine = (float)cos(params->evasionAngle);
+	derived->evasionSine = (float)sin(params->evasionAngle);
+}
+
+/// Returns the index of the parameter with the given name or -1
+static int PARAMS_Find(const char* name) {
+	for(unsigned f = 0; f < PARAMS_FIELD_COUNT; f++){
+	    if(strcmp(PARAMS_FIELDS[f].name, name) == 0){
+	        return (int)f;
+	    }
+	}
+	return -1;
+}
+
+bool PARAMS_Load(const char* path, PARAMS_Strategy* params) {
+	FILE* file = fopen(path, "r");
+	if(file == NULL){
+	    return false;
+	}
+	PARAMS_Strategy loaded;
+	PARAMS_Default(&loaded);
+	char line[PARAMS_LINE_LENGTH];
+	bool valid = true;
+	while(valid && fgets(line, sizeof(line), file) != NULL){
+	    char name[PARAMS_LINE_LENGTH];
+	    char value[PARAMS_LINE_LENGTH];
+	    char extra;
+	    int fields = sscanf(line, "%255s %255s %c", name, value, &extra);
+	    if(fields <= 0 || name[0] == '#'){
+	        continue;
+	    }
+	    int field = PARAMS_Find(name);
+	    char* end;
+	    double number = (fields == 2) ? strtod(value, &end) : NAN;
+	    if(field < 0 || fields != 2 || *end != '\0' || !isfinite(number)){
+	        valid = false;
+	        break;
+	    }
+	    *PARAMS_Value(&loaded, (unsigned)field) = number;
+	}
+	fclose(file);
+	if(valid){
+	    *params = loaded;
+	}
+	return valid;
+}
+
+bool PARAMS_Save(const char* path, const PARAMS_Strategy* params, const char* comment) {
+	FILE* file = fopen(path, "w");
+	if(file == NULL){
+	    return false;
+	}
+	if(comment != NULL){
+	    fprintf(file, "# %s\n", comment);
+	}
+	for(unsigned f = 0; f < PARAMS_FIELD_COUNT; f++){
+	    // 17 significant digits read back to the same double
+	    fprintf(file, "%s %.17g\n", PARAMS_FIELDS[f].name, PARAMS_Get(params, f));
+	}
+	return fclose(file) == 0;
+}
@@ -0,0 +1,114 @@
+#ifndef PARAMS_H_
+#define PARAMS_H_
+
+/**
+ * Strategy constants of the decision code, loadable at run time.
+ *
+ * A parameter file is plain text with one "name value" pair per line (names from @ref PARAMS_FIELDS, angles in
+ * radians); empty lines and lines starting with '#' are ignored and parameters that are not listed keep their
+ * defaults. The defaults are the values the strategy was written with. The values are doubles, so that the
+ * defaults give bit for bit the same decisions as the former double and integer constants.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#if defined(MNIAM_FIXED_PARAMS) && MNIAM_FIXED_PARAMS
+/// The decision code was built with the parameters of a file (params_fixed.h, see MNIAM_STRATEGY_PARAMS)
+/// and ignores GameState.params
+#define PARAMS_FIXED 1
+#else
+#define PARAMS_FIXED 0
+#endif
+
+/// Number of parameters in @ref PARAMS_Strategy
+#define PARAMS_FIELD_COUNT 9
+
+/** Strategy constants */
+typedef struct {
+	double dangerDetectionRange;   ///< distance (to our edge) within which a stronger player makes us escape
+	double attackRange;            ///< distance within which a weaker player is attacked
+	double sparkDetectionRange;    ///< distance (to our edge) within which a spark makes us run away
+	double sparkAvoidanceRadius;   ///< safety distance (to our edge) from sparks on our path
+	double glueMovementPenalty;    ///< factor applied to the distance of targets behind glue
+	double sparkAvoidanceAngle;    ///< a spark closer than this to our direction is on our path [rad]
+	double evasionAngle;           ///< turn made to avoid a spark on our path [rad]
+	double sparkLookahead;         ///< ticks a spark is followed on its estimated course (0 = sparks stand still)
+	double playerLookahead;        ///< ticks ahead a chased or dangerous player is predicted (0 = stands still)
+} PARAMS_Strategy;
+
+/** Constants derived from the strategy parameters (the values the decision code computes them to) */
+typedef struct {
+	float attackRangeSquared;      ///< square of the attack range (the range is compared as a float)
+	float gluePenaltySquared;      ///< square of the glue penalty (divides the squared scores of targets behind glue)
+	float sparkAvoidanceCosine;    ///< cosine of the spark avoidance angle
+	float evasionCosine;           ///< cosine of the evasion angle
+	float evasionSine;             ///< sine of the evasion angle
+} PARAMS_Derived;
+
+/** Description of one parameter */
+typedef struct {
+	const char* name;              ///< name in parameter files
+	size_t offset;                 ///< offset in PARAMS_Strategy
+	double defaultValue;           ///< value the strategy was written with
+	double minimum;                ///< smallest sensible value (used by the tuner)
+	double maximum;                ///< largest sensible value (used by the tuner)
+} PARAMS_Field;
+
+/// All parameters, in the order of PARAMS_Strategy
+extern const PARAMS_Field PARAMS_FIELDS[PARAMS_FIELD_COUNT];
+
+/**
+ * @brief Returns a pointer to the value of a parameter selected by its index in @ref PARAMS_FIELDS.
+ */
+static inline double* PARAMS_Value(PARAMS_Strategy* params, unsigned field) {
+	return (double*)((char*)params + PARAMS_FIELDS[field].offset);
+}
+
+/**
+ * @brief Reads the value of a parameter selected by its index in @ref PARAMS_FIELDS.
+ */
+static inline double PARAMS_Get(const PARAMS_Strategy* params, unsigned field) {
+	return *(const double*)((const char*)params + PARAMS_FIELDS[field].offset);
+}
+
+/**
+ * @brief Fills the parameters with the defaults.
+ */
+void PARAMS_Default(PARAMS_Strategy* params);
+
+/**
+ * @brief Computes the constants derived from the parameters.
+ */
+void PARAMS_Derive(const PARAMS_Strategy* params, PARAMS_Derived* derived);
+
+/**
+ * @brief Loads a parameter file.
+ *
+ * @param path path of the file
+ * @param params receives the defaults overridden by the values from the file (unchanged on failure)
+ *
+ * @return false if the file cannot be read or contains an unknown name or a value that is not a number
+ */
+bool PARAMS_Load(const char* path, PARAMS_Strategy* params);
+
+/**
+ * @brief Writes all parameters to a file (in a format read back exactly by @ref PARAMS_Load).
+ *
+ * @param path path of the file
+ * @param params parameters to write
+ * @param comment written as a comment at the top of the file, NULL for none
+ *
+ * @return false if the file cannot be written
+ */
+bool PARAMS_Save(const char* path, const PARAMS_Strategy* params, const char* comment);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* PARAMS_H_ */
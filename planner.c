@@ -0,0 +1,430 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdatomic.h>
+#include "planner.h"
+#include "platform.h"
+
+// Game mechanics assumed by the forward model (the same as in sim.h)
+#define PLANNER_PLAYER_BASE_RADIUS 25.0f   ///< radius of a player with no HP
+#define PLANNER_PLAYER_SPEED 5.0f          ///< distance we move per tick outside glue
+#define PLANNER_GLUE_RADIUS 100.0f         ///< radius of a glue spot
+#define PLANNER_GLUE_SLOWDOWN 20.0f        ///< speed divisor inside glue
+#define PLANNER_SPARK_DAMAGE 3.0f          ///< HP taken by a spark
+
+// Search
+#define PLANNER_BEAM_WIDTH 8               ///< sequences kept after every tick
+#define PLANNER_MOVES (PLANNER_HEADINGS + 1) ///< headings and the greedy move (first tick only)
+#define PLANNER_DISCOUNT 0.97f             ///< weight of a reward one tick later
+#define PLANNER_SPARK_WEIGHT 2.0f          ///< penalty per HP lost to a spark (the smaller radius costs too)
+#define PLANNER_DEATH_PENALTY 1000.0f      ///< value of a sequence in which we get eaten
+#define PLANNER_THREAT_TICKS 6             ///< ticks of movement towards us assumed for stronger players
+#define PLANNER_ESTIMATE_DECAY 0.0625f     ///< estimate of a target t ticks away: hp / (1 + t * decay)
+#define PLANNER_ESTIMATE_WEIGHT 0.5f       ///< weight of the estimate at the end of a sequence
+
+// Triple buffer: the middle slot index and the flag telling that the writer put a snapshot there
+#define PLANNER_SLOT_MASK 3u
+#define PLANNER_FRESH 4u
+
+/** End of a searched move sequence */
+typedef struct {
+	float x, y, hp;                ///< our position and health after the sequence
+	float value;                   ///< discounted rewards collected on the way
+	float score;                   ///< value plus the estimate of what can be reached afterwards (beam ranking)
+	uint32_t firstMove;            ///< first move of the sequence (index of the move tables)
+	bool alive;                    ///< we were not eaten on the way
+} PLANNER_Node;
+
+struct PLANNER_Planner {
+	_Alignas(64) atomic_uint_fast32_t middle;      ///< middle slot of the triple buffer | PLANNER_FRESH
+	_Alignas(64) atomic_uint_least64_t plan;       ///< sequence << 32 | bits of the angle of the best move
+	atomic_uint_fast32_t searched;                 ///< sequence number of the last snapshot whose search ended
+	atomic_uint_fast64_t searchedTicks;            ///< written by the searcher, read by GetStats
+	atomic_bool running;                           ///< cleared to stop the planner thread
+	atomic_bool idle;                              ///< the planner thread waits (or is about to) for wakeup
+	// owned by the publisher
+	_Alignas(64) uint32_t writeSlot;               ///< slot being filled
+	uint32_t sequence;                             ///< sequence number of the last published snapshot
+	uint64_t deadlineNs;                           ///< end of the time budget of that snapshot
+	uint64_t plannedMoves, unplannedMoves;         ///< counters of TakePlan
+	// owned by the searcher
+	_Alignas(64) uint32_t readSlot;                ///< slot being searched
+	float moveX[PLANNER_MOVES], moveY[PLANNER_MOVES], moveAngle[PLANNER_MOVES];
+	PLANNER_Node beam[PLANNER_BEAM_WIDTH];
+	uint32_t beamCount;
+	PLANNER_Node children[PLANNER_BEAM_WIDTH * PLANNER_HEADINGS + PLANNER_MOVES];
+	// constant
+	PLANNER_Snapshot slots[3];
+	uint32_t budgetUs;
+	uint32_t maxDepth;
+	bool background;
+	PLATFORM_Thread thread;
+	PLATFORM_Event wakeup;                         ///< set by Publish and Destroy when the thread is idle
+	PLATFORM_Event searchEnded;                    ///< set by the planner thread after every search
+};
+
+static inline float PLANNER_SquaredDistance(float x, float y, const PLANNER_Objects* objects, uint32_t i) {
+	float dx = objects->x[i] - x, dy = objects->y[i] - y;
+	return dx * dx + dy * dy;
+}
+
+/// Squared distance of a moving object, predicted the given number of ticks ahead
+static inline float PLANNER_SquaredDistanceAt(float x, float y, const PLANNER_Objects* objects, uint32_t i,
+                                              float ticks) {
+	float dx = objects->x[i] + objects->vx[i] * ticks - x, dy = objects->y[i] + objects->vy[i] * ticks - y;
+	return dx * dx + dy * dy;
+}
+
+static inline float PLANNER_Clamp(float value, float limit) {
+	return fminf(fmaxf(value, 0.0f), limit);
+}
+
+/**
+ * Simulates one tick of a sequence: we move by (directionX, directionY) times the speed (slowed down in glue), eat
+ * the transistors and weaker players our disc reaches, lose HP to the sparks it reaches and die if a stronger player
+ * can reach us. Players and sparks move on with their estimated velocity, the other objects stay where they are.
+ */
+static void PLANNER_Advance(const PLANNER_Snapshot* snapshot, const PLANNER_Node* from, float directionX,
+                            float directionY, uint32_t tick, float discount, PLANNER_Node* to) {
+	const PLANNER_Objects* glue = &snapshot->objects[PLANNER_GLUE];
+	float speed = PLANNER_PLAYER_SPEED;
+	for(uint32_t i = 0; i < glue->count; i++){
+	    if(PLANNER_SquaredDistance(from->x, from->y, glue, i) < PLANNER_GLUE_RADIUS * PLANNER_GLUE_RADIUS){
+	        speed /= PLANNER_GLUE_SLOWDOWN;
+	        break;
+	    }
+	}
+	*to = *from;
+	to->x = PLANNER_Clamp(from->x + speed * directionX, snapshot->mapWidth);
+	to->y = PLANNER_Clamp(from->y + speed * directionY, snapshot->mapHeight);
+
+	// objects that were within our reach before the move were counted on an earlier tick
+	const float radius = PLANNER_PLAYER_BASE_RADIUS + from->hp;
+	const float squared = radius * radius;
+	float reward = 0.0f;
+
+	const PLANNER_Objects* transistors = &snapshot->objects[PLANNER_TRANSISTORS];
+	for(uint32_t i = 0; i < transistors->count; i++){
+	    if(PLANNER_SquaredDistance(to->x, to->y, transistors, i) < squared &&
+	       !(PLANNER_SquaredDistance(from->x, from->y, transistors, i) < squared)){
+	        reward += transistors->hp[i];
+	        to->hp += transistors->hp[i];
+	    }
+	}
+	const float now = (float)tick, before = (float)(tick - 1);
+	const PLANNER_Objects* sparks = &snapshot->objects[PLANNER_SPARKS];
+	for(uint32_t i = 0; i < sparks->count; i++){
+	    if(PLANNER_SquaredDistanceAt(to->x, to->y, sparks, i, now) < squared &&
+	       !(PLANNER_SquaredDistanceAt(from->x, from->y, sparks, i, before) < squared)){
+	        reward -= PLANNER_SPARK_DAMAGE * PLANNER_SPARK_WEIGHT;
+	        to->hp -= PLANNER_SPARK_DAMAGE;
+	    }
+	}
+	const PLANNER_Objects* players = &snapshot->objects[PLANNER_PLAYERS];
+	const float threat = PLANNER_PLAYER_SPEED * (float)(tick < PLANNER_THREAT_TICKS ? tick : PLANNER_THREAT_TICKS);
+	for(uint32_t i = 0; i < players->count; i++){
+	    float playerSquared = PLANNER_SquaredDistanceAt(to->x, to->y, players, i, now);
+	    if(players->hp[i] > from->hp){
+	        float reach = PLANNER_PLAYER_BASE_RADIUS + players->hp[i] + threat;
+	        if(playerSquared < reach * reach){
+	            to->alive = false;
+	        }
+	    } else if(players->hp[i] < from->hp && playerSquared < squared &&
+	              !(PLANNER_SquaredDistanceAt(from->x, from->y, players, i, before) < squared)){
+	        reward += players->hp[i];
+	        to->hp += players->hp[i];
+	    }
+	}
+	if(to->hp <= 0.0f){
+	    to->alive = false;
+	}
+	to->value += reward * discount;
+	if(!to->alive){
+	    to->value -= PLANNER_DEATH_PENALTY * discount;
+	}
+}
+
+/**
+ * Estimates the value of what can be reached after a sequence: the best transistor or weaker player, worth less
+ * the more ticks it takes to get there
+ */
+static float PLANNER_Estimate(const PLANNER_Snapshot* snapshot, const PLANNER_Node* node, uint32_t tick) {
+	const float radius = PLANNER_PLAYER_BASE_RADIUS + node->hp;
+	const float decay = PLANNER_ESTIMATE_DECAY / PLANNER_PLAYER_SPEED;
+	float best = 0.0f;
+	// objects within our reach were eaten by the sequence already
+	const PLANNER_Objects* transistors = &snapshot->objects[PLANNER_TRANSISTORS];
+	for(uint32_t i = 0; i < transistors->count; i++){
+	    float gap = sqrtf(PLANNER_SquaredDistance(node->x, node->y, transistors, i)) - radius;
+	    if(gap > 0.0f){
+	        best = fmaxf(best, transistors->hp[i] / (1.0f + gap * decay));
+	    }
+	}
+	const PLANNER_Objects* players = &snapshot->objects[PLANNER_PLAYERS];
+	for(uint32_t i = 0; i < players->count; i++){
+	    float gap = sqrtf(PLANNER_SquaredDistanceAt(node->x, node->y, players, i, (float)tick)) - radius;
+	    if(players->hp[i] < node->hp && gap > 0.0f){
+	        best = fmaxf(best, players->hp[i] / (1.0f + gap * decay));
+	    }
+	}
+	return best * PLANNER_ESTIMATE_WEIGHT;
+}
+
+/// Keeps the PLANNER_BEAM_WIDTH best children (by score, sorted best first) as the new beam
+static void PLANNER_SelectBeam(PLANNER_Planner* planner, uint32_t childCount) {
+	uint32_t count = 0;
+	for(uint32_t c = 0; c < childCount; c++){
+	    const PLANNER_Node* child = &planner->children[c];
+	    if(count == PLANNER_BEAM_WIDTH && !(child->score > planner->beam[count - 1].score)){
+	        continue;
+	    }
+	    // earlier children win ties: the greedy move is tried first, then the headings in order
+	    uint32_t position = (count < PLANNER_BEAM_WIDTH) ? count++ : count - 1;
+	    while(position > 0 && child->score > planner->beam[position - 1].score){
+	        planner->beam[position] = planner->beam[position - 1];
+	        position--;
+	    }
+	    planner->beam[position] = *child;
+	}
+	planner->beamCount = count;
+}
+
+/// Publishes the first move of the best sequence in the beam
+static void PLANNER_StorePlan(PLANNER_Planner* planner, uint32_t sequence) {
+	uint32_t bits;
+	memcpy(&bits, &planner->moveAngle[planner->beam[0].firstMove], sizeof(bits));
+	atomic_store_explicit(&planner->plan, ((uint64_t)sequence << 32) | bits, memory_order_release);
+}
+
+/**
+ * Beam search over the move sequences of a snapshot, one tick deeper at a time
+ * @param deadlineNs time at which the search stops (0 = search to maxDepth)
+ */
+static void PLANNER_Search(PLANNER_Planner* planner, const PLANNER_Snapshot* snapshot, uint64_t deadlineNs) {
+	planner->moveX[PLANNER_HEADINGS] = cosf(snapshot->greedyAngle);
+	planner->moveY[PLANNER_HEADINGS] = sinf(snapshot->greedyAngle);
+	planner->moveAngle[PLANNER_HEADINGS] = snapshot->greedyAngle;
+
+	// the first tick: every move from our position, the greedy one first
+	PLANNER_Node root = { snapshot->myX, snapshot->myY, snapshot->myHP, 0.0f, 0.0f, 0, true };
+	uint32_t childCount = 0;
+	for(uint32_t m = 0; m < PLANNER_MOVES; m++){
+	    uint32_t move = (m + PLANNER_HEADINGS) % PLANNER_MOVES;
+	    PLANNER_Node* child = &planner->children[childCount++];
+	    PLANNER_Advance(snapshot, &root, planner->moveX[move], planner->moveY[move], 1, 1.0f, child);
+	    child->firstMove = move;
+	    child->score = child->value + PLANNER_DISCOUNT * PLANNER_Estimate(snapshot, child, 1);
+	}
+	PLANNER_SelectBeam(planner, childCount);
+	PLANNER_StorePlan(planner, snapshot->sequence);
+
+	uint32_t depth = 1;
+	float discount = 1.0f;
+	while(depth < planner->maxDepth){
+	    if(deadlineNs != 0 && (PLATFORM_NowNs() >= deadlineNs ||
+	                           (atomic_load_explicit(&planner->middle, memory_order_relaxed) & PLANNER_FRESH))){
+	        break;
+	    }
+	    discount *= PLANNER_DISCOUNT;
+	    childCount = 0;
+	    for(uint32_t b = 0; b < planner->beamCount; b++){
+	        const PLANNER_Node* parent = &planner->beam[b];
+	        if(!parent->alive){
+	            // the end of the game for this sequence, it competes with its final value
+	            planner->children[childCount++] = *parent;
+	            continue;
+	        }
+	        for(uint32_t h = 0; h < PLANNER_HEADINGS; h++){
+	            PLANNER_Node* child = &planner->children[childCount++];
+	            PLANNER_Advance(snapshot, parent, planner->moveX[h], planner->moveY[h], depth + 1, discount, child);
+	            child->score = child->value;
+	            if(child->alive){
+	                child->score += discount * PLANNER_DISCOUNT * PLANNER_Estimate(snapshot, child, depth + 1);
+	            }
+	        }
+	    }
+	    PLANNER_SelectBeam(planner, childCount);
+	    PLANNER_StorePlan(planner, snapshot->sequence);
+	    depth++;
+	}
+	atomic_fetch_add_explicit(&planner->searchedTicks, depth, memory_order_relaxed);
+	atomic_store_explicit(&planner->searched, snapshot->sequence, memory_order_release);
+}
+
+static void PLANNER_Thread(void* arg) {
+	PLANNER_Planner* planner = (PLANNER_Planner*)arg;
+	while(atomic_load_explicit(&planner->running, memory_order_acquire)){
+	    if(!(atomic_load_explicit(&planner->middle, memory_order_acquire) & PLANNER_FRESH)){
+	        // announce the wait first, then check again: a publisher either sees the flag and sets the event,
+	        // or published before the flag and the check finds its snapshot (both sides are sequentially
+	        // consistent); a stale set event only costs one extra round
+	        atomic_store(&planner->idle, true);
+	        if(!(atomic_load(&planner->middle) & PLANNER_FRESH) && atomic_load(&planner->running)){
+	            PLATFORM_WaitEvent(&planner->wakeup);
+	        }
+	        atomic_store_explicit(&planner->idle, false, memory_order_relaxed);
+	        continue;
+	    }
+	    // the own slot goes to the middle (not fresh), the fresh snapshot becomes the own slot
+	    planner->readSlot = (uint32_t)atomic_exchange_explicit(&planner->middle, planner->readSlot,
+	                                                           memory_order_acq_rel) & PLANNER_SLOT_MASK;
+	    const PLANNER_Snapshot* snapshot = &planner->slots[planner->readSlot];
+	    PLANNER_Search(planner, snapshot, snapshot->deadlineNs);
+	    PLATFORM_SetEvent(&planner->searchEnded);
+	}
+}
+
+static void PLANNER_FreeSnapshot(PLANNER_Snapshot* snapshot) {
+	for(int c = 0; c < PLANNER_CLASS_COUNT; c++){
+	    free(snapshot->objects[c].x);
+	    free(snapshot->objects[c].y);
+	    free(snapshot->objects[c].hp);
+	    free(snapshot->objects[c].vx);
+	    free(snapshot->objects[c].vy);
+	}
+}
+
+PLANNER_Planner* PLANNER_Create(uint32_t budgetUs, uint32_t maxDepth, bool background) {
+	if(maxDepth < 1 || maxDepth > PLANNER_DEFAULT_DEPTH){
+	    return NULL;
+	}
+	PLANNER_Planner* planner = (PLANNER_Planner*)PLATFORM_AlignedAlloc(sizeof(PLANNER_Planner), 64);
+	if(planner == NULL){
+	    return NULL;
+	}
+	memset(planner, 0, sizeof(PLANNER_Planner));
+	atomic_init(&planner->middle, 1);
+	atomic_init(&planner->plan, 0);
+	atomic_init(&planner->searched, 0);
+	atomic_init(&planner->searchedTicks, 0);
+	atomic_init(&planner->running, true);
+	atomic_init(&planner->idle, false);
+	planner->writeSlot = 0;
+	planner->readSlot = 2;
+	planner->budgetUs = budgetUs;
+	planner->maxDepth = maxDepth;
+	planner->background = background;
+	for(uint32_t h = 0; h < PLANNER_HEADINGS; h++){
+	    planner->moveAngle[h] = (float)(2.0 * M_PI * h / PLANNER_HEADINGS);
+	    planner->moveX[h] = (float)cos(2.0 * M_PI * h / PLANNER_HEADINGS);
+	    planner->moveY[h] = (float)sin(2.0 * M_PI * h / PLANNER_HEADINGS);
+	}
+	if(background && !PLATFORM_CreateEvent(&planner->wakeup)){
+	    PLATFORM_AlignedFree(planner);
+	    return NULL;
+	}
+	if(background && !PLATFORM_CreateEvent(&planner->searchEnded)){
+	    PLATFORM_DestroyEvent(&planner->wakeup);
+	    PLATFORM_AlignedFree(planner);
+	    return NULL;
+	}
+	if(background && !PLATFORM_StartThread(&planner->thread, PLANNER_Thread, planner)){
+	    PLATFORM_DestroyEvent(&planner->searchEnded);
+	    PLATFORM_DestroyEvent(&planner->wakeup);
+	    PLATFORM_AlignedFree(planner);
+	    return NULL;
+	}
+	return planner;
+}
+
+void PLANNER_Destroy(PLANNER_Planner* planner) {
+	if(planner == NULL){
+	    return;
+	}
+	if(planner->background){
+	    atomic_store(&planner->running, false);
+	    PLATFORM_SetEvent(&planner->wakeup);
+	    PLATFORM_JoinThread(&planner->thread);
+	    PLATFORM_DestroyEvent(&planner->searchEnded);
+	    PLATFORM_DestroyEvent(&planner->wakeup);
+	}
+	for(int s = 0; s < 3; s++){
+	    PLANNER_FreeSnapshot(&planner->slots[s]);
+	}
+	PLATFORM_AlignedFree(planner);
+}
+
+PLANNER_Snapshot* PLANNER_BeginSnapshot(PLANNER_Planner* planner) {
+	return &planner->slots[planner->writeSlot];
+}
+
+bool PLANNER_CopyObjects(PLANNER_Snapshot* snapshot, PLANNER_Class objectClass, const OBJTABLE_Table* table,
+                         int32_t excluded, const MOTION_Tracker* motion) {
+	PLANNER_Objects* objects = &snapshot->objects[objectClass];
+	objects->count = 0;
+	if(table->count > objects->capacity){
+	    float* x = (float*)realloc(objects->x, table->count * sizeof(float));
+	    if(x != NULL) objects->x = x;
+	    float* y = (float*)realloc(objects->y, table->count * sizeof(float));
+	    if(y != NULL) objects->y = y;
+	    float* hp = (float*)realloc(objects->hp, table->count * sizeof(float));
+	    if(hp != NULL) objects->hp = hp;
+	    float* vx = (float*)realloc(objects->vx, table->count * sizeof(float));
+	    if(vx != NULL) objects->vx = vx;
+	    float* vy = (float*)realloc(objects->vy, table->count * sizeof(float));
+	    if(vy != NULL) objects->vy = vy;
+	    if(x == NULL || y == NULL || hp == NULL || vx == NULL || vy == NULL){
+	        return false;
+	    }
+	    objects->capacity = table->count;
+	}
+	for(uint32_t i = 0; i < table->count; i++){
+	    if(table->hp[i] > 0.0f && (int32_t)i != excluded){
+	        objects->x[objects->count] = table->x[i];
+	        objects->y[objects->count] = table->y[i];
+	        objects->hp[objects->count] = table->hp[i];
+	        const MOTION_Track* track = (motion != NULL) ? MOTION_Find(motion, table->objectNo[i]) : NULL;
+	        objects->vx[objects->count] = (track != NULL) ? track->vx : 0.0f;
+	        objects->vy[objects->count] = (track != NULL) ? track->vy : 0.0f;
+	        objects->count++;
+	    }
+	}
+	return true;
+}
+
+uint32_t PLANNER_Publish(PLANNER_Planner* planner, uint64_t receivedNs) {
+	if(++planner->sequence == 0){
+	    planner->sequence = 1;
+	}
+	PLANNER_Snapshot* snapshot = &planner->slots[planner->writeSlot];
+	snapshot->sequence = planner->sequence;
+	snapshot->deadlineNs = (receivedNs != 0 ? receivedNs : PLATFORM_NowNs()) + (uint64_t)planner->budgetUs * 1000u;
+	planner->deadlineNs = snapshot->deadlineNs;
+	if(!planner->background){
+	    PLANNER_Search(planner, snapshot, 0);
+	} else {
+	    // the snapshot goes to the middle, whatever was there (searched or not) becomes the next one to fill
+	    planner->writeSlot = (uint32_t)atomic_exchange(&planner->middle, planner->writeSlot | PLANNER_FRESH) &
+	                         PLANNER_SLOT_MASK;
+	    if(atomic_load(&planner->idle)){
+	        PLATFORM_SetEvent(&planner->wakeup);
+	    }
+	}
+	return snapshot->sequence;
+}
+
+bool PLANNER_TakePlan(PLANNER_Planner* planner, uint32_t sequence, float* angle) {
+	if(planner->background && sequence != 0 && sequence == planner->sequence){
+	    // the search of the current snapshot gets the rest of its time budget (nothing to do when it ended);
+	    // blocking leaves the CPU to the search, the event set after an older search only costs one more round
+	    while(atomic_load_explicit(&planner->searched, memory_order_acquire) != sequence &&
+	          PLATFORM_WaitEventUntil(&planner->searchEnded, planner->deadlineNs)){
+	    }
+	}
+	uint64_t plan = atomic_load_explicit(&planner->plan, memory_order_acquire);
+	if(sequence == 0 || (uint32_t)(plan >> 32) != sequence){
+	    planner->unplannedMoves++;
+	    return false;
+	}
+	uint32_t bits = (uint32_t)plan;
+	memcpy(angle, &bits, sizeof(bits));
+	planner->plannedMoves++;
+	return true;
+}
+
+void PLANNER_GetStats(const PLANNER_Planner* planner, PLANNER_Stats* stats) {
+	stats->snapshots = planner->sequence;
+	stats->searchedTicks = atomic_load_explicit(&planner->searchedTicks, memory_order_relaxed);
+	stats->plannedMoves = planner->plannedMoves;
+	stats->unplannedMoves = planner->unplannedMoves;
+}
@@ -0,0 +1,154 @@
+#ifndef PLANNER_H_
+#define PLANNER_H_
+
+/**
+ * Time-budgeted lookahead planner running beside the thread that plays the game.
+ *
+ * The game thread keeps applying updates to its own GameState. When it has processed the updates of a tick it
+ * copies the inputs of the decision into a @ref PLANNER_Snapshot and publishes it. Snapshots are exchanged through
+ * a triple buffer: the writer fills the back slot and swaps it with the shared middle slot in one atomic exchange,
+ * the planner swaps the middle slot with its own slot when a fresh snapshot is there. Neither side ever waits for
+ * the other and a snapshot never changes while the planner reads it.
+ *
+ * The planner searches sequences of moves several ticks ahead (beam search over PLANNER_HEADINGS directions, plus
+ * the move chosen by the greedy decision) with a forward model of our motion: glue slowdown, transistors and weaker
+ * players eaten when our HP dependent radius reaches them, spark damage, and stronger players that can reach us.
+ * Players and sparks move on with the velocity estimated from their motion history (motion.h).
+ * The search deepens one tick at a time and after every tick publishes the first move of the best sequence found
+ * so far, tagged with the sequence number of the snapshot, in one atomic word. The search of a snapshot ends at its
+ * deadline (time budget from the receipt of the data), at the depth limit or when a newer snapshot arrives. MOVE
+ * waits until the search of the current snapshot has ended or its deadline has passed, then reads that word with
+ * one atomic load and uses the move only if it was planned for the current snapshot. When the server sends MOVE
+ * together with the object updates (usual over TCP), the snapshot is published by MOVE and the answer leaves about
+ * one budget after the receipt; when MOVE comes later, the search has usually ended and the answer does not wait.
+ *
+ * A planner created without a background thread searches to the depth limit inside @ref PLANNER_Publish - slower
+ * but deterministic, for evaluation in the simulator.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "motion.h"
+#include "objtable.h"
+
+/// Number of evenly spaced directions searched at every tick
+#define PLANNER_HEADINGS 16
+/// Default (and largest sensible) number of ticks searched ahead
+#define PLANNER_DEFAULT_DEPTH 32
+
+/** Object classes of a snapshot */
+typedef enum {
+	PLANNER_PLAYERS = 0,           ///< other players (we are not included)
+	PLANNER_TRANSISTORS,
+	PLANNER_SPARKS,
+	PLANNER_GLUE,
+	PLANNER_CLASS_COUNT
+} PLANNER_Class;
+
+/** Objects of one class in a snapshot (only the living ones) */
+typedef struct {
+	float* x;                      ///< X positions
+	float* y;                      ///< Y positions
+	float* hp;                     ///< hit points
+	float* vx;                     ///< estimated X velocity [distance per tick]
+	float* vy;                     ///< estimated Y velocity [distance per tick]
+	uint32_t count;                ///< number of objects
+	uint32_t capacity;             ///< allocated length of the arrays
+} PLANNER_Objects;
+
+/** Inputs of a decision, copied from the game state */
+typedef struct {
+	uint32_t sequence;                             ///< number of the snapshot (set by @ref PLANNER_Publish)
+	uint64_t deadlineNs;                           ///< end of the time budget (set by @ref PLANNER_Publish)
+	float mapWidth, mapHeight;                     ///< map dimensions
+	float myX, myY, myHP;                          ///< our position and health
+	float greedyAngle;                             ///< move of the greedy decision (searched too)
+	PLANNER_Objects objects[PLANNER_CLASS_COUNT];  ///< objects of every class
+} PLANNER_Snapshot;
+
+/** Counters of a planner */
+typedef struct {
+	uint64_t snapshots;            ///< snapshots published
+	uint64_t searchedTicks;        ///< ticks of lookahead completed over all searches
+	uint64_t plannedMoves;         ///< moves answered with a plan
+	uint64_t unplannedMoves;       ///< moves with no plan for the current snapshot (greedy decision used)
+} PLANNER_Stats;
+
+/** Opaque structure of the planner */
+typedef struct PLANNER_Planner PLANNER_Planner;
+
+/**
+ * @brief Creates a planner.
+ *
+ * @param budgetUs time a snapshot is searched for, counted from the receipt of its data [us] (background planner
+ * only)
+ * @param maxDepth number of ticks searched ahead at most (1 .. PLANNER_DEFAULT_DEPTH)
+ * @param background start a planner thread; false: search in @ref PLANNER_Publish, to maxDepth
+ *
+ * @return the planner or NULL if the parameters are invalid or the planner could not be started
+ */
+PLANNER_Planner* PLANNER_Create(uint32_t budgetUs, uint32_t maxDepth, bool background);
+
+/**
+ * @brief Stops the planner thread and releases the planner. NULL is ignored.
+ */
+void PLANNER_Destroy(PLANNER_Planner* planner);
+
+/**
+ * @brief Returns the snapshot to fill (owned by the caller until @ref PLANNER_Publish). Only one thread may
+ * publish snapshots.
+ */
+PLANNER_Snapshot* PLANNER_BeginSnapshot(PLANNER_Planner* planner);
+
+/**
+ * @brief Copies the living objects (hp > 0) of a table into the snapshot.
+ *
+ * @param snapshot snapshot from @ref PLANNER_BeginSnapshot
+ * @param objectClass class of the objects
+ * @param table table to copy
+ * @param excluded dense position of an object to leave out (our player), OBJTABLE_NOT_FOUND for none
+ * @param motion motion history of the objects, NULL for objects that do not move
+ *
+ * @return false if memory could not be allocated (the class is left empty)
+ */
+bool PLANNER_CopyObjects(PLANNER_Snapshot* snapshot, PLANNER_Class objectClass, const OBJTABLE_Table* table,
+                         int32_t excluded, const MOTION_Tracker* motion);
+
+/**
+ * @brief Publishes the snapshot filled since @ref PLANNER_BeginSnapshot. A snapshot the planner has not started
+ * on yet is replaced.
+ *
+ * @param planner planner
+ * @param receivedNs time the data of the snapshot was received (PLATFORM_NowNs), the time budget starts here;
+ * 0 = now
+ *
+ * @return sequence number of the snapshot (never 0)
+ */
+uint32_t PLANNER_Publish(PLANNER_Planner* planner, uint64_t receivedNs);
+
+/**
+ * @brief Takes the best move found for a snapshot. For the last published snapshot of a background planner blocks
+ * until its search has ended or its time budget is used up.
+ *
+ * @param planner planner
+ * @param sequence sequence number of the snapshot of the current game state, 0 if there is none
+ * @param angle receives the movement angle in radians
+ *
+ * @return false if nothing was planned for this snapshot yet
+ */
+bool PLANNER_TakePlan(PLANNER_Planner* planner, uint32_t sequence, float* angle);
+
+/**
+ * @brief Reads the counters of the planner.
+ */
+void PLANNER_GetStats(const PLANNER_Planner* planner, PLANNER_Stats* stats);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* PLANNER_H_ */
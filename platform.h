@@ -0,0 +1,150 @@
+#ifndef PLATFORM_H_
+#define PLATFORM_H_
+
+/**
+ * This header file defines the thin operating system layer used by the mniAM player and its tools:
+ * a monotonic clock, threads, events, CPU affinity, aligned memory and read-only file mappings.
+ *
+ * Implemented by platform_posix.c (pthreads) and platform_win32.c (Win32 API).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/** Type of a function executed by a thread */
+typedef void (*PLATFORM_ThreadFunction)(void* arg);
+
+/** Structure describing a thread */
+typedef struct {
+	/// Native thread handle (pthread_t or HANDLE)
+	uintptr_t handle;
+} PLATFORM_Thread;
+
+/** Structure describing an auto-reset event (a thread waits until another one sets it) */
+typedef struct {
+	/// Native event (mutex, condition and flag on POSIX, event HANDLE on Windows)
+	uintptr_t handle;
+} PLATFORM_Event;
+
+/** Structure describing a file mapped into memory */
+typedef struct {
+	/// First byte of the file (NULL for an empty file)
+	const uint8_t* data;
+	/// Size of the file in bytes
+	size_t size;
+	/// Native mapping handle (unused on POSIX, file mapping object on Windows)
+	uintptr_t handle;
+} PLATFORM_MappedFile;
+
+/**
+ * @brief Returns a monotonic timestamp in nanoseconds.
+ */
+uint64_t PLATFORM_NowNs(void);
+
+/**
+ * @brief Returns the number of logical CPUs available to the process.
+ */
+int PLATFORM_CpuCount(void);
+
+/**
+ * @brief Starts a new thread.
+ *
+ * @param thread thread structure to initialize
+ * @param function function to execute
+ * @param arg argument passed to the function
+ *
+ * @return true if the thread was started
+ */
+bool PLATFORM_StartThread(PLATFORM_Thread* thread, PLATFORM_ThreadFunction function, void* arg);
+
+/**
+ * @brief Waits for the thread to finish.
+ */
+void PLATFORM_JoinThread(PLATFORM_Thread* thread);
+
+/**
+ * @brief Creates an event that is not set.
+ *
+ * @return true on success
+ */
+bool PLATFORM_CreateEvent(PLATFORM_Event* event);
+
+/**
+ * @brief Releases an event created with @ref PLATFORM_CreateEvent (no thread may wait for it).
+ */
+void PLATFORM_DestroyEvent(PLATFORM_Event* event);
+
+/**
+ * @brief Sets the event: wakes the thread waiting for it, or the next one to wait if none does yet.
+ */
+void PLATFORM_SetEvent(PLATFORM_Event* event);
+
+/**
+ * @brief Waits until the event is set and resets it.
+ */
+void PLATFORM_WaitEvent(PLATFORM_Event* event);
+
+/**
+ * @brief Waits until the event is set (and resets it) or until a deadline, whichever comes first.
+ *
+ * @param event event
+ * @param deadlineNs time to give up (@ref PLATFORM_NowNs; rounded up to milliseconds on Windows)
+ *
+ * @return true if the event was set, false at the deadline
+ */
+bool PLATFORM_WaitEventUntil(PLATFORM_Event* event, uint64_t deadlineNs);
+
+/**
+ * @brief Pins the calling thread to one CPU.
+ *
+ * @param cpu index of the CPU (0 .. PLATFORM_CpuCount() - 1)
+ *
+ * @return true on success
+ */
+bool PLATFORM_PinCurrentThread(int cpu);
+
+/**
+ * @brief Allocates memory aligned to the given boundary.
+ *
+ * @param size number of bytes to allocate
+ * @param alignment alignment in bytes (power of two)
+ *
+ * @return pointer to the memory (release with @ref PLATFORM_AlignedFree) or NULL
+ */
+void* PLATFORM_AlignedAlloc(size_t size, size_t alignment);
+
+/**
+ * @brief Releases memory allocated with @ref PLATFORM_AlignedAlloc. NULL is ignored.
+ */
+void PLATFORM_AlignedFree(void* memory);
+
+/**
+ * @brief Maps a whole file into memory for reading.
+ *
+ * @param path path of the file
+ * @param file structure to initialize
+ *
+ * @return true on success
+ */
+bool PLATFORM_MapFile(const char* path, PLATFORM_MappedFile* file);
+
+/**
+ * @brief Unmaps a file mapped with @ref PLATFORM_MapFile.
+ */
+void PLATFORM_UnmapFile(PLATFORM_MappedFile* file);
+
+/**
+ * @brief Suspends the calling thread for the given number of milliseconds.
+ */
+void PLATFORM_SleepMs(uint32_t milliseconds);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* PLATFORM_H_ */
@@ -0,0 +1,217 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "platform.h"
+
+/// Function and argument of a thread started with PLATFORM_StartThread
+typedef struct {
+	PLATFORM_ThreadFunction function;
+	void* arg;
+} PLATFORM_ThreadStart;
+
+/// State of an event
+typedef struct {
+	pthread_mutex_t mutex;
+	pthread_cond_t condition;
+	bool set;
+} PLATFORM_EventState;
+
+static void* PLATFORM_ThreadEntry(void* param) {
+	PLATFORM_ThreadStart start = *(PLATFORM_ThreadStart*)param;
+	free(param);
+	start.function(start.arg);
+	return NULL;
+}
+
+uint64_t PLATFORM_NowNs(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+int PLATFORM_CpuCount(void) {
+#ifdef __linux__
+	cpu_set_t set;
+	if(sched_getaffinity(0, sizeof(set), &set) == 0){
+	    return CPU_COUNT(&set);
+	}
+#endif
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return (count > 0) ? (int)count : 1;
+}
+
+bool PLATFORM_StartThread(PLATFORM_Thread* thread, PLATFORM_ThreadFunction function, void* arg) {
+	if(thread == NULL || function == NULL){
+	    return false;
+	}
+	PLATFORM_ThreadStart* start = (PLATFORM_ThreadStart*)malloc(sizeof(PLATFORM_ThreadStart));
+	if(start == NULL){
+	    return false;
+	}
+	start->function = function;
+	start->arg = arg;
+	pthread_t handle;
+	if(pthread_create(&handle, NULL, PLATFORM_ThreadEntry, start) != 0){
+	    free(start);
+	    return false;
+	}
+	thread->handle = (uintptr_t)handle;
+	return true;
+}
+
+void PLATFORM_JoinThread(PLATFORM_Thread* thread) {
+	if(thread == NULL){
+	    return;
+	}
+	pthread_join((pthread_t)thread->handle, NULL);
+}
+
+bool PLATFORM_CreateEvent(PLATFORM_Event* event) {
+	PLATFORM_EventState* state = (PLATFORM_EventState*)malloc(sizeof(PLATFORM_EventState));
+	if(state == NULL){
+	    return false;
+	}
+	if(pthread_mutex_init(&state->mutex, NULL) != 0){
+	    free(state);
+	    return false;
+	}
+	// timed waits count on the clock of PLATFORM_NowNs (macOS waits for a relative time instead)
+	pthread_condattr_t attributes;
+	pthread_condattr_init(&attributes);
+#ifndef __APPLE__
+	pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+#endif
+	int result = pthread_cond_init(&state->condition, &attributes);
+	pthread_condattr_destroy(&attributes);
+	if(result != 0){
+	    pthread_mutex_destroy(&state->mutex);
+	    free(state);
+	    return false;
+	}
+	state->set = false;
+	event->handle = (uintptr_t)state;
+	return true;
+}
+
+void PLATFORM_DestroyEvent(PLATFORM_Event* event) {
+	PLATFORM_EventState* state = (PLATFORM_EventState*)event->handle;
+	if(state == NULL){
+	    return;
+	}
+	pthread_cond_destroy(&state->condition);
+	pthread_mutex_destroy(&state->mutex);
+	free(state);
+	event->handle = 0;
+}
+
+void PLATFORM_SetEvent(PLATFORM_Event* event) {
+	PLATFORM_EventState* state = (PLATFORM_EventState*)event->handle;
+	pthread_mutex_lock(&state->mutex);
+	state->set = true;
+	pthread_cond_signal(&state->condition);
+	pthread_mutex_unlock(&state->mutex);
+}
+
+void PLATFORM_WaitEvent(PLATFORM_Event* event) {
+	PLATFORM_EventState* state = (PLATFORM_EventState*)event->handle;
+	pthread_mutex_lock(&state->mutex);
+	while(!state->set){
+	    pthread_cond_wait(&state->condition, &state->mutex);
+	}
+	state->set = false;
+	pthread_mutex_unlock(&state->mutex);
+}
+
+bool PLATFORM_WaitEventUntil(PLATFORM_Event* event, uint64_t deadlineNs) {
+	PLATFORM_EventState* state = (PLATFORM_EventState*)event->handle;
+	pthread_mutex_lock(&state->mutex);
+	while(!state->set){
+	    uint64_t now = PLATFORM_NowNs();
+	    if(now >= deadlineNs){
+	        break;
+	    }
+#ifdef __APPLE__
+	    uint64_t remaining = deadlineNs - now;
+	    struct timespec wait = { (time_t)(remaining / 1000000000ull), (long)(remaining % 1000000000ull) };
+	    pthread_cond_timedwait_relative_np(&state->condition, &state->mutex, &wait);
+#else
+	    struct timespec until = { (time_t)(deadlineNs / 1000000000ull), (long)(deadlineNs % 1000000000ull) };
+	    pthread_cond_timedwait(&state->condition, &state->mutex, &until);
+#endif
+	}
+	bool set = state->set;
+	state->set = false;
+	pthread_mutex_unlock(&state->mutex);
+	return set;
+}
+
+bool PLATFORM_PinCurrentThread(int cpu) {
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+	(void)cpu;
+	return false;
+#endif
+}
+
+void* PLATFORM_AlignedAlloc(size_t size, size_t alignment) {
+	void* memory = NULL;
+	if(alignment < sizeof(void*)){
+	    alignment = sizeof(void*);
+	}
+	return (posix_memalign(&memory, alignment, size) == 0) ? memory : NULL;
+}
+
+void PLATFORM_AlignedFree(void* memory) {
+	free(memory);
+}
+
+void PLATFORM_SleepMs(uint32_t milliseconds) {
+	struct timespec ts = { milliseconds / 1000, (long)(milliseconds % 1000) * 1000000L };
+	while(nanosleep(&ts, &ts) != 0) {
+	}
+}
+
+bool PLATFORM_MapFile(const char* path, PLATFORM_MappedFile* file) {
+	file->data = NULL;
+	file->size = 0;
+	file->handle = 0;
+	int fd = open(path, O_RDONLY);
+	if(fd < 0){
+	    return false;
+	}
+	struct stat info;
+	if(fstat(fd, &info) != 0){
+	    close(fd);
+	    return false;
+	}
+	if(info.st_size > 0){
+	    void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	    if(data == MAP_FAILED){
+	        close(fd);
+	        return false;
+	    }
+	    file->data = (const uint8_t*)data;
+	    file->size = (size_t)info.st_size;
+	}
+	// the mapping stays valid after the descriptor is closed
+	close(fd);
+	return true;
+}
+
+void PLATFORM_UnmapFile(PLATFORM_MappedFile* file) {
+	if(file->data != NULL){
+	    munmap((void*)file->data, file->size);
+	}
+	file->data = NULL;
+	file->size = 0;
+}
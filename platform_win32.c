@@ -0,0 +1,151 @@
+#undef UNICODE
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#include <stdlib.h>
+#include <malloc.h>
+#include "platform.h"
+
+/// Function and argument of a thread started with PLATFORM_StartThread
+typedef struct {
+	PLATFORM_ThreadFunction function;
+	void* arg;
+} PLATFORM_ThreadStart;
+
+static DWORD WINAPI PLATFORM_ThreadEntry(LPVOID param) {
+	PLATFORM_ThreadStart start = *(PLATFORM_ThreadStart*)param;
+	free(param);
+	start.function(start.arg);
+	return 0;
+}
+
+uint64_t PLATFORM_NowNs(void) {
+	static LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+	if(frequency.QuadPart == 0){
+	    QueryPerformanceFrequency(&frequency);
+	}
+	QueryPerformanceCounter(&counter);
+	return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000ull +
+	       (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000ull / (uint64_t)frequency.QuadPart;
+}
+
+int PLATFORM_CpuCount(void) {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (info.dwNumberOfProcessors > 0) ? (int)info.dwNumberOfProcessors : 1;
+}
+
+bool PLATFORM_StartThread(PLATFORM_Thread* thread, PLATFORM_ThreadFunction function, void* arg) {
+	if(thread == NULL || function == NULL){
+	    return false;
+	}
+	PLATFORM_ThreadStart* start = (PLATFORM_ThreadStart*)malloc(sizeof(PLATFORM_ThreadStart));
+	if(start == NULL){
+	    return false;
+	}
+	start->function = function;
+	start->arg = arg;
+	HANDLE handle = CreateThread(NULL, 0, PLATFORM_ThreadEntry, start, 0, NULL);
+	if(handle == NULL){
+	    free(start);
+	    return false;
+	}
+	thread->handle = (uintptr_t)handle;
+	return true;
+}
+
+void PLATFORM_JoinThread(PLATFORM_Thread* thread) {
+	if(thread == NULL){
+	    return;
+	}
+	WaitForSingleObject((HANDLE)thread->handle, INFINITE);
+	CloseHandle((HANDLE)thread->handle);
+}
+
+bool PLATFORM_CreateEvent(PLATFORM_Event* event) {
+	HANDLE handle = CreateEventA(NULL, FALSE, FALSE, NULL);
+	if(handle == NULL){
+	    return false;
+	}
+	event->handle = (uintptr_t)handle;
+	return true;
+}
+
+void PLATFORM_DestroyEvent(PLATFORM_Event* event) {
+	if(event->handle == 0){
+	    return;
+	}
+	CloseHandle((HANDLE)event->handle);
+	event->handle = 0;
+}
+
+void PLATFORM_SetEvent(PLATFORM_Event* event) {
+	SetEvent((HANDLE)event->handle);
+}
+
+void PLATFORM_WaitEvent(PLATFORM_Event* event) {
+	WaitForSingleObject((HANDLE)event->handle, INFINITE);
+}
+
+bool PLATFORM_WaitEventUntil(PLATFORM_Event* event, uint64_t deadlineNs) {
+	uint64_t now = PLATFORM_NowNs();
+	DWORD timeoutMs = (now < deadlineNs) ? (DWORD)((deadlineNs - now + 999999u) / 1000000u) : 0;
+	return WaitForSingleObject((HANDLE)event->handle, timeoutMs) == WAIT_OBJECT_0;
+}
+
+bool PLATFORM_PinCurrentThread(int cpu) {
+	return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+}
+
+void* PLATFORM_AlignedAlloc(size_t size, size_t alignment) {
+	return _aligned_malloc(size, alignment);
+}
+
+void PLATFORM_AlignedFree(void* memory) {
+	_aligned_free(memory);
+}
+
+void PLATFORM_SleepMs(uint32_t milliseconds) {
+	Sleep(milliseconds);
+}
+
+bool PLATFORM_MapFile(const char* path, PLATFORM_MappedFile* file) {
+	file->data = NULL;
+	file->size = 0;
+	file->handle = 0;
+	HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(handle == INVALID_HANDLE_VALUE){
+	    return false;
+	}
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(handle, &size)){
+	    CloseHandle(handle);
+	    return false;
+	}
+	if(size.QuadPart > 0){
+	    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	    void* data = (mapping != NULL) ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+	    if(data == NULL){
+	        if(mapping != NULL) CloseHandle(mapping);
+	        CloseHandle(handle);
+	        return false;
+	    }
+	    file->data = (const uint8_t*)data;
+	    file->size = (size_t)size.QuadPart;
+	    file->handle = (uintptr_t)mapping;
+	}
+	// the view stays valid after the file handle is closed
+	CloseHandle(handle);
+	return true;
+}
+
+void PLATFORM_UnmapFile(PLATFORM_MappedFile* file) {
+	if(file->data != NULL){
+	    UnmapViewOfFile(file->data);
+	    CloseHandle((HANDLE)file->handle);
+	}
+	file->data = NULL;
+	file->size = 0;
+	file->handle = 0;
+}
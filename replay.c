@@ -0,0 +1,405 @@
+/**
+ * Offline replay of recorded packet traces (see trace.h) through the decision code of the player.
+ *
+ * Usage: mniam_replay [--threads T] [--tolerance RAD] [--log-level L] [--params FILE] [--field-dump TICKS]
+ *                     [--no-target-cache] trace...
+ *
+ * The inbound packets of every trace are fed through AMCOM_Deserialize and handleGamePacket exactly like the
+ * player does it, only without a socket and as fast as the CPU allows. Every response is compared with the one
+ * that was recorded: MOVE.response angles must match within the tolerance (default: bit for bit), other
+ * responses must have the same type. Moves are decided ahead (precomputeMove) where the player did it: after the
+ * packets received by one recv() call. Traces are replayed in parallel, one worker thread per core by default,
+ * and the results are printed in the order of the command line. The exit code is 0 only if every response matched.
+ * With --field-dump the potential field (field.h) is maintained along (the decisions do not use it) and written to
+ * TRACE.field every TICKS ticks of game time. The report shows how often the decisions reused the targets of the
+ * previous ones (see memo.h) and the time of the decisions made ahead; --no-target-cache selects every target
+ * again for comparison.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <math.h>
+#include "amcom.h"
+#include "amcom_packets.h"
+#include "bot.h"
+#include "histogram.h"
+#include "log.h"
+#include "params.h"
+#include "platform.h"
+#include "trace.h"
+
+// Records buffered per worker before the logger thread writes them out
+#define LOG_RING_CAPACITY 4096
+
+/**
+ * Result of replaying one trace
+ */
+typedef struct {
+    const char* path;                              // Path of the trace
+    bool readable;                                 // The trace could be opened
+    uint64_t packets;                              // Number of recorded packets
+    uint64_t moves;                                // Number of MOVE requests replayed
+    uint64_t mismatches;                           // Responses that differ from the recorded ones
+    float maxAngleDifference;                      // Largest difference of a MOVE angle [rad]
+    uint16_t firstMismatchGame;                    // Game of the first mismatch
+    uint32_t firstMismatchTime;                    // Game time of the first mismatch
+    uint64_t targetHits[3];                        // Decisions that reused the players, sparks, transistors targets
+    uint64_t targetMisses[3];                      // Decisions that selected them again
+} ReplayResult;
+
+/**
+ * State of the trace being replayed by a worker
+ */
+typedef struct {
+    GameState gameState;                           // Game state driven by the replayed packets
+    AMCOM_Receiver receiver;                       // Packet receiver, its userContext points to this structure
+    uint8_t response[AMCOM_MAX_PACKET_SIZE];       // Last response produced by handleGamePacket
+    size_t responseSize;                           // Size of the response, 0 if none is pending
+    HISTOGRAM_Histogram* decisionLatency;          // Histogram of the worker: time spent in handleGamePacket for MOVE
+    HISTOGRAM_Histogram* aheadLatency;             // Histogram of the worker: time spent in precomputeMove
+} Replay;
+
+/**
+ * Work shared by the worker threads
+ */
+typedef struct {
+    ReplayResult* results;                         // One result per trace
+    int traceCount;                                // Number of traces
+    atomic_int nextTrace;                          // Next trace to be taken by a worker
+    float tolerance;                               // Allowed difference of MOVE angles [rad]
+    PARAMS_Strategy params;                        // Strategy parameters the traces were recorded with
+    uint32_t fieldDumpTicks;                       // Game time between dumps of the potential field (0 = none)
+    bool targetCaching;                            // Reuse the targets of earlier decisions
+} ReplayQueue;
+
+/**
+ * Worker thread replaying traces taken from the queue
+ */
+typedef struct {
+    ReplayQueue* queue;                            // Shared work
+    PLATFORM_Thread thread;                        // Worker thread
+    HISTOGRAM_Histogram decisionLatency;           // Time spent deciding a MOVE [ns]
+    HISTOGRAM_Histogram aheadLatency;              // Time spent deciding moves ahead [ns]
+    LOG_Ring* log;                                 // Log ring written by this worker (NULL = no logging)
+} ReplayWorker;
+
+static void replayPacketHandler(const AMCOM_PacketView* packet, void* userContext) {
+    Replay* replay = (Replay*)userContext;
+    uint64_t start = PLATFORM_NowNs();
+    replay->responseSize = handleGamePacket(&replay->gameState, packet, replay->response);
+    if (packet->header.type == AMCOM_MOVE_REQUEST) {
+        HISTOGRAM_Record(replay->decisionLatency, PLATFORM_NowNs() - start);
+    }
+}
+
+/**
+ * Returns the difference between two angles on the circle
+ */
+static float angleDifference(float a, float b) {
+    float difference = fmodf(fabsf(a - b), 2.0f * (float)M_PI);
+    return (difference > (float)M_PI) ? 2.0f * (float)M_PI - difference : difference;
+}
+
+/**
+ * Compares the response produced by the replay with the recorded one
+ * @return true if they match
+ */
+static bool compareResponse(const Replay* replay, const TRACE_Packet* recorded, float tolerance, ReplayResult* result) {
+    if (replay->responseSize < sizeof(AMCOM_PacketHeader) || recorded->size < sizeof(AMCOM_PacketHeader)) {
+        return false;
+    }
+    const AMCOM_PacketHeader* produced = (const AMCOM_PacketHeader*)replay->response;
+    const AMCOM_PacketHeader* expected = (const AMCOM_PacketHeader*)recorded->data;
+    if (produced->type != expected->type) {
+        return false;
+    }
+    if (produced->type != AMCOM_MOVE_RESPONSE) {
+        return true;
+    }
+    if (produced->length < sizeof(AMCOM_MoveResponsePayload) || expected->length < sizeof(AMCOM_MoveResponsePayload)) {
+        return false;
+    }
+    float producedAngle, expectedAngle;
+    memcpy(&producedAngle, replay->response + sizeof(AMCOM_PacketHeader), sizeof(float));
+    memcpy(&expectedAngle, recorded->data + sizeof(AMCOM_PacketHeader), sizeof(float));
+    if (memcmp(&producedAngle, &expectedAngle, sizeof(float)) == 0) {
+        return true;
+    }
+    float difference = angleDifference(producedAngle, expectedAngle);
+    if (!(difference <= result->maxAngleDifference)) {
+        result->maxAngleDifference = difference;
+    }
+    return difference <= tolerance;
+}
+
+/**
+ * Replays one trace and fills its result
+ */
+static void replayTrace(Replay* replay, LOG_Ring* log, const ReplayQueue* queue, ReplayResult* result) {
+    TRACE_Reader reader;
+    result->readable = TRACE_OpenReader(&reader, result->path);
+    if (!result->readable) {
+        return;
+    }
+    initGameState(&replay->gameState, log);
+    replay->gameState.params = queue->params;
+    replay->gameState.fieldMaintained = (queue->fieldDumpTicks > 0);
+    replay->gameState.targetCaching = queue->targetCaching;
+    FILE* fieldDump = NULL;
+    if (queue->fieldDumpTicks > 0) {
+        char path[1024];
+        snprintf(path, sizeof(path), "%s.field", result->path);
+        fieldDump = fopen(path, "w");
+    }
+    AMCOM_InitViewReceiver(&replay->receiver, replayPacketHandler, replay);
+    replay->responseSize = 0;
+
+    TRACE_Cursor cursor = TRACE_Begin(&reader);
+    TRACE_Packet packet;
+    uint64_t receiveTimeNs = 0;
+    while (TRACE_Next(&reader, &cursor, &packet)) {
+        result->packets++;
+        bool matches = true;
+        if (packet.direction == TRACE_INBOUND) {
+            // packets of one recv() share the timestamp; the player decides ahead once the data is processed
+            if (packet.timestampNs != receiveTimeNs) {
+                uint64_t start = PLATFORM_NowNs();
+                uint64_t version = replay->gameState.speculativeVersion;
+                precomputeMove(&replay->gameState);
+                if (replay->gameState.speculativeVersion != version) {
+                    HISTOGRAM_Record(replay->aheadLatency, PLATFORM_NowNs() - start);
+                }
+                receiveTimeNs = packet.timestampNs;
+            }
+            // a response the server did not get (e.g. the connection broke) is simply discarded
+            replay->responseSize = 0;
+            AMCOM_Deserialize(&replay->receiver, packet.data, packet.size);
+            if (packet.size > 1 && packet.data[1] == AMCOM_MOVE_REQUEST) {
+                result->moves++;
+                if (fieldDump != NULL && packet.gameTime % queue->fieldDumpTicks == 0) {
+                    fprintf(fieldDump, "# game %u, time %u\n", (unsigned)packet.game, (unsigned)packet.gameTime);
+                    FIELD_Dump(&replay->gameState.field, fieldDump);
+                }
+            }
+        } else {
+            matches = compareResponse(replay, &packet, queue->tolerance, result);
+            replay->responseSize = 0;
+        }
+        if (!matches) {
+            if (result->mismatches == 0) {
+                result->firstMismatchGame = packet.game;
+                result->firstMismatchTime = packet.gameTime;
+            }
+            result->mismatches++;
+        }
+    }
+    if (fieldDump != NULL) {
+        fclose(fieldDump);
+    }
+    const MEMO_Class* memos[3] = { &replay->gameState.playerTargets, &replay->gameState.sparkTargets,
+                                   &replay->gameState.transistorTargets };
+    for (int c = 0; c < 3; c++) {
+        result->targetHits[c] = memos[c]->hits;
+        result->targetMisses[c] = memos[c]->misses;
+    }
+    freeGameState(&replay->gameState);
+    TRACE_CloseReader(&reader);
+}
+
+static void runWorker(void* arg) {
+    ReplayWorker* worker = (ReplayWorker*)arg;
+    ReplayQueue* queue = worker->queue;
+    Replay* replay = (Replay*)malloc(sizeof(Replay));
+    if (replay == NULL) {
+        return;
+    }
+    replay->decisionLatency = &worker->decisionLatency;
+    replay->aheadLatency = &worker->aheadLatency;
+    for (;;) {
+        int trace = atomic_fetch_add(&queue->nextTrace, 1);
+        if (trace >= queue->traceCount) {
+            break;
+        }
+        replayTrace(replay, worker->log, queue, &queue->results[trace]);
+    }
+    free(replay);
+}
+
+static void printUsage(const char* program) {
+    printf("Usage: %s [--threads T] [--tolerance RAD] [--log-level L] [--params FILE] [--field-dump TICKS]\n"
+           "       [--no-target-cache] trace...\n", program);
+    printf("  --threads T     number of worker threads (default: min(traces, CPUs))\n");
+    printf("  --tolerance RAD allowed difference of MOVE angles (default 0 - bit for bit)\n");
+    printf("  --log-level L   off, error, info or debug (default off)\n");
+    printf("  --params FILE   strategy parameters the traces were recorded with (default: the defaults)\n");
+    printf("  --field-dump TICKS  write the potential field to TRACE.field every TICKS ticks\n");
+    printf("  --no-target-cache   select every target again at every decision\n");
+}
+
+int main(int argc, char** argv) {
+    int threadCount = 0;
+    float tolerance = 0.0f;
+    LOG_Level logLevel = LOG_LEVEL_OFF;
+    int firstTrace = argc;
+    int fieldDumpTicks = 0;
+    bool targetCaching = true;
+    PARAMS_Strategy params;
+    PARAMS_Default(&params);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            if (!LOG_ParseLevel(argv[++i], &logLevel)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--params") == 0 && i + 1 < argc) {
+            if (PARAMS_FIXED) {
+                printf("The strategy parameters are compiled into this build, --params is not available\n");
+                return 1;
+            }
+            if (!PARAMS_Load(argv[++i], &params)) {
+                printf("Unable to load strategy parameters from %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--field-dump") == 0 && i + 1 < argc) {
+            fieldDumpTicks = atoi(argv[++i]);
+            if (fieldDumpTicks <= 0) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--no-target-cache") == 0) {
+            targetCaching = false;
+        } else if (argv[i][0] != '-') {
+            firstTrace = i;
+            break;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    const int traceCount = argc - firstTrace;
+    if (traceCount < 1 || threadCount < 0 || !(tolerance >= 0.0f)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (threadCount == 0) {
+        threadCount = PLATFORM_CpuCount();
+    }
+    if (threadCount > traceCount) {
+        threadCount = traceCount;
+    }
+
+    ReplayQueue queue;
+    queue.results = (ReplayResult*)calloc((size_t)traceCount, sizeof(ReplayResult));
+    queue.traceCount = traceCount;
+    atomic_init(&queue.nextTrace, 0);
+    queue.tolerance = tolerance;
+    queue.params = params;
+    queue.fieldDumpTicks = (uint32_t)fieldDumpTicks;
+    queue.targetCaching = targetCaching;
+    ReplayWorker* workers = (ReplayWorker*)calloc((size_t)threadCount, sizeof(ReplayWorker));
+    if (queue.results == NULL || workers == NULL) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    for (int t = 0; t < traceCount; t++) {
+        queue.results[t].path = argv[firstTrace + t];
+    }
+
+    LOG_Logger* logger = NULL;
+    if (logLevel != LOG_LEVEL_OFF) {
+        logger = LOG_Create(stdout, logLevel, (uint32_t)threadCount, LOG_RING_CAPACITY);
+    }
+    uint64_t start = PLATFORM_NowNs();
+    for (int w = 0; w < threadCount; w++) {
+        workers[w].queue = &queue;
+        workers[w].log = LOG_GetRing(logger, (uint32_t)w);
+        HISTOGRAM_Init(&workers[w].decisionLatency);
+        HISTOGRAM_Init(&workers[w].aheadLatency);
+    }
+    if (threadCount == 1) {
+        runWorker(&workers[0]);
+    } else {
+        for (int w = 0; w < threadCount; w++) {
+            if (!PLATFORM_StartThread(&workers[w].thread, runWorker, &workers[w])) {
+                printf("Unable to start worker thread %d\n", w);
+                workers[w].thread.handle = 0;
+            }
+        }
+        for (int w = 0; w < threadCount; w++) {
+            if (workers[w].thread.handle != 0) {
+                PLATFORM_JoinThread(&workers[w].thread);
+            }
+        }
+    }
+    uint64_t elapsed = PLATFORM_NowNs() - start;
+    LOG_Destroy(logger);
+
+    // Report: one line per trace, then the totals
+    uint64_t moves = 0, mismatches = 0;
+    uint64_t targetHits[3] = { 0 }, targetMisses[3] = { 0 };
+    int failedTraces = 0;
+    for (int t = 0; t < traceCount; t++) {
+        const ReplayResult* result = &queue.results[t];
+        if (!result->readable) {
+            printf("%s: not a readable trace\n", result->path);
+            failedTraces++;
+            continue;
+        }
+        printf("%s: %llu packets, %llu moves, %llu mismatches", result->path,
+               (unsigned long long)result->packets, (unsigned long long)result->moves,
+               (unsigned long long)result->mismatches);
+        if (result->mismatches > 0) {
+            printf(" (first in game %u at time %u, max angle difference %.6f rad)",
+                   result->firstMismatchGame, result->firstMismatchTime, result->maxAngleDifference);
+            failedTraces++;
+        }
+        printf("\n");
+        moves += result->moves;
+        mismatches += result->mismatches;
+        for (int c = 0; c < 3; c++) {
+            targetHits[c] += result->targetHits[c];
+            targetMisses[c] += result->targetMisses[c];
+        }
+    }
+    HISTOGRAM_Histogram decisionLatency, aheadLatency;
+    HISTOGRAM_Init(&decisionLatency);
+    HISTOGRAM_Init(&aheadLatency);
+    for (int w = 0; w < threadCount; w++) {
+        HISTOGRAM_Merge(&decisionLatency, &workers[w].decisionLatency);
+        HISTOGRAM_Merge(&aheadLatency, &workers[w].aheadLatency);
+    }
+    printf("Traces: %d (%d failed), moves: %llu, mismatches: %llu, threads: %d, %.3f s (%.0f moves/s)\n",
+           traceCount, failedTraces, (unsigned long long)moves, (unsigned long long)mismatches, threadCount,
+           elapsed / 1e9, elapsed > 0 ? moves * 1e9 / elapsed : 0.0);
+    if (decisionLatency.count > 0) {
+        printf("MOVE decision time: p50 %.1f us, p99 %.1f us, max %.1f us\n",
+               HISTOGRAM_Percentile(&decisionLatency, 0.50) / 1e3,
+               HISTOGRAM_Percentile(&decisionLatency, 0.99) / 1e3,
+               decisionLatency.max / 1e3);
+    }
+    if (aheadLatency.count > 0) {
+        printf("Decisions ahead: %llu, time p50 %.1f us, p99 %.1f us, max %.1f us\n",
+               (unsigned long long)aheadLatency.count,
+               HISTOGRAM_Percentile(&aheadLatency, 0.50) / 1e3,
+               HISTOGRAM_Percentile(&aheadLatency, 0.99) / 1e3,
+               aheadLatency.max / 1e3);
+    }
+    static const char* const classNames[3] = { "players", "sparks", "transistors" };
+    printf("Targets reused:");
+    for (int c = 0; c < 3; c++) {
+        uint64_t lookups = targetHits[c] + targetMisses[c];
+        printf("%s %s %llu/%llu (%.1f%%)", (c == 0) ? "" : ",", classNames[c], (unsigned long long)targetHits[c],
+               (unsigned long long)lookups, lookups > 0 ? 100.0 * targetHits[c] / lookups : 0.0);
+    }
+    printf("\n");
+
+    free(workers);
+    free(queue.results);
+    return failedTraces == 0 ? 0 : 1;
+}
@@ -0,0 +1,475 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "sim.h"
+#include "platform.h"
+
+/// Golden ratio increment used to derive the seed of every game
+#define SIM_SEED_STEP 0x9E3779B9u
+
+/// Object types in AMCOM_ObjectState.objectType
+enum {
+	SIM_PLAYER = 0,
+	SIM_TRANSISTOR = 1,
+	SIM_SPARK = 2,
+	SIM_GLUE = 3,
+	SIM_OBJECT_TYPES = 4
+};
+
+/** Simulated object */
+typedef struct {
+	float x, y;          ///< position
+	float vx, vy;        ///< velocity (sparks only)
+	int8_t hp;           ///< HP (0 = dead player)
+	bool changed;        ///< must be sent in the next OBJECT_UPDATE
+} SIM_Object;
+
+struct SIM_World {
+	SIM_Config config;
+	SIM_Object* objects[SIM_OBJECT_TYPES];           ///< objects of every type
+	uint32_t counts[SIM_OBJECT_TYPES];               ///< number of objects of every type
+	uint32_t random;                                 ///< xorshift32 state of the current game
+	uint32_t nextGame;                               ///< number of the next game (selects its seed)
+	SIM_TickObserver observer;                       ///< called after every tick
+	void* observerContext;                           ///< context of the observer
+	float angles[SIM_MAX_PLAYERS];                   ///< last direction requested by every player
+	bool connected[SIM_MAX_PLAYERS];                 ///< the player is still connected
+	uint8_t awaited[SIM_MAX_PLAYERS];                ///< type of the awaited response, AMCOM_NO_PACKET if none
+	SIM_Result* result;                              ///< result of the game being played
+};
+
+/// xorshift32 step
+static uint32_t SIM_Random(SIM_World* world) {
+	uint32_t x = world->random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	world->random = x;
+	return x;
+}
+
+/// Uniform random number in [0, limit)
+static float SIM_RandomFloat(SIM_World* world, float limit) {
+	return (float)(SIM_Random(world) >> 8) * (limit / 16777216.0f);
+}
+
+static float SIM_PlayerRadius(const SIM_Object* player) {
+	return SIM_PLAYER_BASE_RADIUS + player->hp;
+}
+
+static float SIM_DistanceSquared(const SIM_Object* a, const SIM_Object* b) {
+	float dx = a->x - b->x;
+	float dy = a->y - b->y;
+	return dx*dx + dy*dy;
+}
+
+static int8_t SIM_AddHp(int8_t hp, int gain) {
+	int sum = hp + gain;
+	return (int8_t)(sum > INT8_MAX ? INT8_MAX : sum);
+}
+
+static void SIM_Place(SIM_World* world, SIM_Object* object) {
+	object->x = SIM_RandomFloat(world, world->config.mapWidth);
+	object->y = SIM_RandomFloat(world, world->config.mapHeight);
+	object->changed = true;
+}
+
+static void SIM_PlaceSpark(SIM_World* world, SIM_Object* spark) {
+	SIM_Place(world, spark);
+	spark->hp = SIM_SPARK_DAMAGE;
+	float direction = SIM_RandomFloat(world, 2.0f * (float)M_PI);
+	spark->vx = SIM_SPARK_SPEED * cosf(direction);
+	spark->vy = SIM_SPARK_SPEED * sinf(direction);
+}
+
+static void SIM_PlaceTransistor(SIM_World* world, SIM_Object* transistor) {
+	SIM_Place(world, transistor);
+	transistor->hp = (int8_t)(1 + SIM_Random(world) % SIM_MAX_TRANSISTOR_HP);
+}
+
+/// Sends a request to one player and remembers the awaited response
+static void SIM_Request(SIM_World* world, const SIM_Transport* transport, uint32_t player, const uint8_t* packet,
+                        size_t size, uint8_t responseType) {
+	if(!world->connected[player]){
+	    return;
+	}
+	world->awaited[player] = responseType;
+	transport->send(transport->context, player, packet, size);
+}
+
+/// Lets the transport deliver the responses, players that did not answer are counted as timed out
+static void SIM_Wait(SIM_World* world, const SIM_Transport* transport) {
+	transport->wait(transport->context);
+	for(uint32_t p = 0; p < world->config.playerCount; p++){
+	    if(world->awaited[p] != AMCOM_NO_PACKET){
+	        world->awaited[p] = AMCOM_NO_PACKET;
+	        if(world->result != NULL){
+	            world->result->timeouts[p]++;
+	        }
+	    }
+	}
+}
+
+/// Sends the objects that changed since the last update to every connected player
+static void SIM_SendUpdates(SIM_World* world, const SIM_Transport* transport) {
+	AMCOM_ObjectUpdateRequestPayload update;
+	uint8_t packet[AMCOM_MAX_PACKET_SIZE];
+	uint32_t pending = 0;
+	for(uint8_t type = 0; type < SIM_OBJECT_TYPES; type++){
+	    for(uint32_t i = 0; i < world->counts[type]; i++){
+	        SIM_Object* object = &world->objects[type][i];
+	        if(!object->changed) continue;
+	        object->changed = false;
+
+	        AMCOM_ObjectState* state = &update.objectState[pending++];
+	        state->objectType = type;
+	        state->objectNo = (uint16_t)i;
+	        state->hp = object->hp;
+	        state->x = object->x;
+	        state->y = object->y;
+	        if(pending == AMCOM_MAX_OBJECT_UPDATES){
+	            size_t size = AMCOM_Serialize(AMCOM_OBJECT_UPDATE_REQUEST, &update, pending * sizeof(AMCOM_ObjectState), packet);
+	            for(uint32_t p = 0; p < world->config.playerCount; p++){
+	                if(world->connected[p]) transport->send(transport->context, p, packet, size);
+	            }
+	            pending = 0;
+	        }
+	    }
+	}
+	if(pending > 0){
+	    size_t size = AMCOM_Serialize(AMCOM_OBJECT_UPDATE_REQUEST, &update, pending * sizeof(AMCOM_ObjectState), packet);
+	    for(uint32_t p = 0; p < world->config.playerCount; p++){
+	        if(world->connected[p]) transport->send(transport->context, p, packet, size);
+	    }
+	}
+}
+
+/// Moves the players and the sparks by one tick and resolves all collisions
+static void SIM_Step(SIM_World* world) {
+	SIM_Object* players = world->objects[SIM_PLAYER];
+	SIM_Object* transistors = world->objects[SIM_TRANSISTOR];
+	SIM_Object* sparks = world->objects[SIM_SPARK];
+	const SIM_Object* glue = world->objects[SIM_GLUE];
+	const float width = world->config.mapWidth, height = world->config.mapHeight;
+	SIM_Result* result = world->result;
+
+	for(uint32_t p = 0; p < world->counts[SIM_PLAYER]; p++){
+	    SIM_Object* player = &players[p];
+	    if(player->hp <= 0 || !isfinite(world->angles[p])) continue;
+	    float speed = SIM_PLAYER_SPEED;
+	    for(uint32_t g = 0; g < world->counts[SIM_GLUE]; g++){
+	        if(SIM_DistanceSquared(player, &glue[g]) < SIM_GLUE_RADIUS * SIM_GLUE_RADIUS){
+	            speed /= SIM_GLUE_SLOWDOWN;
+	            break;
+	        }
+	    }
+	    player->x = fminf(fmaxf(player->x + speed * cosf(world->angles[p]), 0.0f), width);
+	    player->y = fminf(fmaxf(player->y + speed * sinf(world->angles[p]), 0.0f), height);
+	    player->changed = true;
+	}
+
+	for(uint32_t s = 0; s < world->counts[SIM_SPARK]; s++){
+	    SIM_Object* spark = &sparks[s];
+	    spark->x += spark->vx;
+	    spark->y += spark->vy;
+	    if(spark->x < 0.0f || spark->x > width){
+	        spark->vx = -spark->vx;
+	        spark->x = fminf(fmaxf(spark->x, 0.0f), width);
+	    }
+	    if(spark->y < 0.0f || spark->y > height){
+	        spark->vy = -spark->vy;
+	        spark->y = fminf(fmaxf(spark->y, 0.0f), height);
+	    }
+	    spark->changed = true;
+	}
+
+	for(uint32_t p = 0; p < world->counts[SIM_PLAYER]; p++){
+	    SIM_Object* player = &players[p];
+	    if(player->hp <= 0) continue;
+	    for(uint32_t t = 0; t < world->counts[SIM_TRANSISTOR]; t++){
+	        float radius = SIM_PlayerRadius(player);
+	        if(SIM_DistanceSquared(player, &transistors[t]) < radius * radius){
+	            player->hp = SIM_AddHp(player->hp, transistors[t].hp);
+	            player->changed = true;
+	            result->transistorsEaten[p]++;
+	            SIM_PlaceTransistor(world, &transistors[t]);
+	        }
+	    }
+	    for(uint32_t s = 0; s < world->counts[SIM_SPARK] && player->hp > 0; s++){
+	        float radius = SIM_PlayerRadius(player);
+	        if(SIM_DistanceSquared(player, &sparks[s]) < radius * radius){
+	            player->hp = (int8_t)(player->hp > SIM_SPARK_DAMAGE ? player->hp - SIM_SPARK_DAMAGE : 0);
+	            player->changed = true;
+	            result->sparkHits[p]++;
+	            SIM_PlaceSpark(world, &sparks[s]);
+	        }
+	    }
+	}
+
+	for(uint32_t p = 0; p < world->counts[SIM_PLAYER]; p++){
+	    SIM_Object* hunter = &players[p];
+	    if(hunter->hp <= 0) continue;
+	    for(uint32_t q = 0; q < world->counts[SIM_PLAYER]; q++){
+	        SIM_Object* prey = &players[q];
+	        if(q == p || prey->hp <= 0 || prey->hp >= hunter->hp) continue;
+	        float radius = SIM_PlayerRadius(hunter);
+	        if(SIM_DistanceSquared(hunter, prey) < radius * radius){
+	            hunter->hp = SIM_AddHp(hunter->hp, prey->hp);
+	            hunter->changed = true;
+	            prey->hp = 0;
+	            prey->changed = true;
+	            result->playersEaten[p]++;
+	        }
+	    }
+	}
+}
+
+/// Number of living, connected players
+static uint32_t SIM_LivingPlayers(const SIM_World* world) {
+	uint32_t living = 0;
+	for(uint32_t p = 0; p < world->counts[SIM_PLAYER]; p++){
+	    if(world->objects[SIM_PLAYER][p].hp > 0 && world->connected[p]) living++;
+	}
+	return living;
+}
+
+void SIM_DefaultConfig(SIM_Config* config) {
+	config->playerCount = 2;
+	config->mapWidth = 1000.0f;
+	config->mapHeight = 1000.0f;
+	config->transistorCount = 100;
+	config->sparkCount = 10;
+	config->glueCount = 5;
+	config->maxTicks = 1000;
+	config->seed = 1;
+}
+
+SIM_World* SIM_Create(const SIM_Config* config) {
+	if(config->playerCount == 0 || config->playerCount > SIM_MAX_PLAYERS ||
+	   !(config->mapWidth > 0.0f) || !(config->mapHeight > 0.0f) ||
+	   config->transistorCount > UINT16_MAX || config->sparkCount > UINT16_MAX || config->glueCount > UINT16_MAX){
+	    return NULL;
+	}
+	SIM_World* world = (SIM_World*)calloc(1, sizeof(SIM_World));
+	if(world == NULL){
+	    return NULL;
+	}
+	world->config = *config;
+	world->counts[SIM_PLAYER] = config->playerCount;
+	world->counts[SIM_TRANSISTOR] = config->transistorCount;
+	world->counts[SIM_SPARK] = config->sparkCount;
+	world->counts[SIM_GLUE] = config->glueCount;
+	for(int type = 0; type < SIM_OBJECT_TYPES; type++){
+	    world->objects[type] = (SIM_Object*)calloc(world->counts[type] + 1, sizeof(SIM_Object));
+	    if(world->objects[type] == NULL){
+	        SIM_Destroy(world);
+	        return NULL;
+	    }
+	}
+	for(uint32_t p = 0; p < config->playerCount; p++){
+	    world->connected[p] = true;
+	}
+	return world;
+}
+
+void SIM_Destroy(SIM_World* world) {
+	if(world == NULL){
+	    return;
+	}
+	for(int type = 0; type < SIM_OBJECT_TYPES; type++){
+	    free(world->objects[type]);
+	}
+	free(world);
+}
+
+void SIM_SeekGame(SIM_World* world, uint32_t game) {
+	world->nextGame = game;
+}
+
+void SIM_SetTickObserver(SIM_World* world, SIM_TickObserver observer, void* context) {
+	world->observer = observer;
+	world->observerContext = context;
+}
+
+void SIM_Identify(SIM_World* world, const SIM_Transport* transport) {
+	AMCOM_IdentifyRequestPayload identify = { 1, 0, 0 };
+	uint8_t packet[AMCOM_MAX_PACKET_SIZE];
+	size_t size = AMCOM_Serialize(AMCOM_IDENTIFY_REQUEST, &identify, sizeof(identify), packet);
+	for(uint32_t p = 0; p < world->config.playerCount; p++){
+	    SIM_Request(world, transport, p, packet, size, AMCOM_IDENTIFY_RESPONSE);
+	}
+	SIM_Wait(world, transport);
+}
+
+void SIM_PlayGame(SIM_World* world, const SIM_Transport* transport, SIM_Result* result) {
+	const SIM_Config* config = &world->config;
+	uint8_t packet[AMCOM_MAX_PACKET_SIZE];
+	memset(result, 0, sizeof(SIM_Result));
+	world->result = result;
+	world->random = (config->seed + world->nextGame++ * SIM_SEED_STEP) | 1u;
+
+	// fresh map
+	for(uint32_t p = 0; p < world->counts[SIM_PLAYER]; p++){
+	    SIM_Place(world, &world->objects[SIM_PLAYER][p]);
+	    world->objects[SIM_PLAYER][p].hp = world->connected[p] ? SIM_START_HP : 0;
+	    world->angles[p] = NAN;
+	}
+	for(uint32_t t = 0; t < world->counts[SIM_TRANSISTOR]; t++){
+	    SIM_PlaceTransistor(world, &world->objects[SIM_TRANSISTOR][t]);
+	}
+	for(uint32_t s = 0; s < world->counts[SIM_SPARK]; s++){
+	    SIM_PlaceSpark(world, &world->objects[SIM_SPARK][s]);
+	}
+	for(uint32_t g = 0; g < world->counts[SIM_GLUE]; g++){
+	    SIM_Place(world, &world->objects[SIM_GLUE][g]);
+	    world->objects[SIM_GLUE][g].hp = SIM_GLUE_HP;
+	}
+
+	for(uint32_t p = 0; p < config->playerCount; p++){
+	    AMCOM_NewGameRequestPayload newGame = { (uint8_t)p, (uint8_t)config->playerCount, config->mapWidth, config->mapHeight };
+	    size_t size = AMCOM_Serialize(AMCOM_NEW_GAME_REQUEST, &newGame, sizeof(newGame), packet);
+	    SIM_Request(world, transport, p, packet, size, AMCOM_NEW_GAME_RESPONSE);
+	}
+	SIM_Wait(world, transport);
+
+	uint32_t tick = 0;
+	uint32_t minimumLiving = (config->playerCount > 1) ? 2 : 1;
+	while(tick < config->maxTicks && SIM_LivingPlayers(world) >= minimumLiving){
+	    tick++;
+	    SIM_SendUpdates(world, transport);
+	    AMCOM_MoveRequestPayload move = { tick };
+	    size_t size = AMCOM_Serialize(AMCOM_MOVE_REQUEST, &move, sizeof(move), packet);
+	    for(uint32_t p = 0; p < config->playerCount; p++){
+	        if(world->objects[SIM_PLAYER][p].hp > 0){
+	            SIM_Request(world, transport, p, packet, size, AMCOM_MOVE_RESPONSE);
+	        }
+	    }
+	    SIM_Wait(world, transport);
+	    SIM_Step(world);
+
+	    int8_t hp[SIM_MAX_PLAYERS];
+	    for(uint32_t p = 0; p < config->playerCount; p++){
+	        hp[p] = world->objects[SIM_PLAYER][p].hp;
+	        if(hp[p] <= 0 && result->survivedTicks[p] == 0){
+	            result->survivedTicks[p] = tick;
+	        }
+	    }
+	    if(world->observer != NULL){
+	        world->observer(world->observerContext, tick, hp);
+	    }
+	}
+	result->ticks = tick;
+	for(uint32_t p = 0; p < config->playerCount; p++){
+	    if(result->survivedTicks[p] == 0){
+	        result->survivedTicks[p] = tick;
+	    }
+	}
+
+	AMCOM_GameOverRequestPayload gameOver;
+	result->winner = SIM_NO_WINNER;
+	for(uint32_t p = 0; p < config->playerCount; p++){
+	    const SIM_Object* player = &world->objects[SIM_PLAYER][p];
+	    AMCOM_ObjectState state = { SIM_PLAYER, (uint16_t)p, player->hp, player->x, player->y };
+	    gameOver.playerState[p] = state;
+	    result->hp[p] = player->hp;
+	    if(player->hp > 0 && world->connected[p] &&
+	       (result->winner == SIM_NO_WINNER || player->hp > result->hp[result->winner])){
+	        result->winner = p;
+	    }
+	}
+	size_t size = AMCOM_Serialize(AMCOM_GAME_OVER_REQUEST, &gameOver, config->playerCount * sizeof(AMCOM_ObjectState), packet);
+	for(uint32_t p = 0; p < config->playerCount; p++){
+	    SIM_Request(world, transport, p, packet, size, AMCOM_GAME_OVER_RESPONSE);
+	}
+	SIM_Wait(world, transport);
+	world->result = NULL;
+}
+
+void SIM_HandleResponse(SIM_World* world, uint32_t player, const AMCOM_PacketView* packet) {
+	if(player >= world->config.playerCount || world->awaited[player] != packet->header.type){
+	    return;
+	}
+	world->awaited[player] = AMCOM_NO_PACKET;
+	if(packet->header.type == AMCOM_MOVE_RESPONSE && packet->payloadSize >= sizeof(AMCOM_MoveResponsePayload)){
+	    memcpy(&world->angles[player], packet->payload, sizeof(float));
+	}
+}
+
+void SIM_Disconnect(SIM_World* world, uint32_t player) {
+	if(player >= world->config.playerCount){
+	    return;
+	}
+	world->connected[player] = false;
+	world->awaited[player] = AMCOM_NO_PACKET;
+	if(world->objects[SIM_PLAYER][player].hp > 0){
+	    world->objects[SIM_PLAYER][player].hp = 0;
+	    world->objects[SIM_PLAYER][player].changed = true;
+	}
+}
+
+uint32_t SIM_PendingResponses(const SIM_World* world) {
+	uint32_t pending = 0;
+	for(uint32_t p = 0; p < world->config.playerCount; p++){
+	    pending += (world->awaited[p] != AMCOM_NO_PACKET);
+	}
+	return pending;
+}
+
+/**
+ * Player running in this process: its packets are deserialized and handled directly, the response is passed back
+ * to the simulator through a receiver of its own
+ */
+typedef struct {
+	GameState* gameState;            ///< game state of the player
+	AMCOM_Receiver playerReceiver;   ///< receives the packets of the simulator on the player side
+	AMCOM_Receiver serverReceiver;   ///< receives the responses of the player on the simulator side
+	SIM_World* world;                ///< simulated world
+	uint32_t player;                 ///< index of the player
+	HISTOGRAM_Histogram* decisionLatency; ///< time spent handling MOVE.request, or NULL
+} SIM_LocalPlayer;
+
+static void SIM_LocalServerHandler(const AMCOM_PacketView* packet, void* userContext) {
+	SIM_LocalPlayer* local = (SIM_LocalPlayer*)userContext;
+	SIM_HandleResponse(local->world, local->player, packet);
+}
+
+static void SIM_LocalPlayerHandler(const AMCOM_PacketView* packet, void* userContext) {
+	SIM_LocalPlayer* local = (SIM_LocalPlayer*)userContext;
+	uint8_t response[AMCOM_MAX_PACKET_SIZE];
+	uint64_t start = (local->decisionLatency != NULL) ? PLATFORM_NowNs() : 0;
+	size_t size = handleGamePacket(local->gameState, packet, response);
+	if(local->decisionLatency != NULL && packet->header.type == AMCOM_MOVE_REQUEST){
+	    HISTOGRAM_Record(local->decisionLatency, PLATFORM_NowNs() - start);
+	}
+	if(size > 0){
+	    AMCOM_Deserialize(&local->serverReceiver, response, size);
+	}
+}
+
+static void SIM_LocalSend(void* context, uint32_t player, const uint8_t* packet, size_t size) {
+	SIM_LocalPlayer* locals = (SIM_LocalPlayer*)context;
+	AMCOM_Deserialize(&locals[player].playerReceiver, packet, size);
+}
+
+static void SIM_LocalWait(void* context) {
+	// the players answered synchronously in SIM_LocalSend
+	(void)context;
+}
+
+void SIM_PlayLocalGame(SIM_World* world, GameState* const* players, bool identify,
+                       HISTOGRAM_Histogram* decisionLatency, SIM_Result* result) {
+	SIM_LocalPlayer locals[SIM_MAX_PLAYERS];
+	for(uint32_t p = 0; p < world->config.playerCount; p++){
+	    locals[p].gameState = players[p];
+	    locals[p].world = world;
+	    locals[p].player = p;
+	    locals[p].decisionLatency = (decisionLatency != NULL) ? &decisionLatency[p] : NULL;
+	    AMCOM_InitViewReceiver(&locals[p].playerReceiver, SIM_LocalPlayerHandler, &locals[p]);
+	    AMCOM_InitViewReceiver(&locals[p].serverReceiver, SIM_LocalServerHandler, &locals[p]);
+	}
+	SIM_Transport transport = { SIM_LocalSend, SIM_LocalWait, locals };
+	if(identify){
+	    SIM_Identify(world, &transport);
+	}
+	SIM_PlayGame(world, &transport, result);
+}
@@ -0,0 +1,195 @@
+#ifndef SIM_H_
+#define SIM_H_
+
+/**
+ * Headless stand-in for the mniAM game server, used for self-play and evaluation of the player.
+ *
+ * The simulator speaks the AMCOM protocol from amcom_packets.h: IDENTIFY once per connection, then for every game
+ * NEW_GAME, a sequence of ticks (OBJECT_UPDATE packets with the objects that changed, MOVE.request to every living
+ * player) and GAME_OVER. A tick is simulated as soon as all living players answered their MOVE.request, so games
+ * run as fast as the players decide, not on wall-clock time.
+ *
+ * Mechanics (the ones the player assumes):
+ *  - a player is a disc of radius SIM_PLAYER_BASE_RADIUS + HP moving SIM_PLAYER_SPEED per tick in the requested
+ *    direction, SIM_GLUE_SLOWDOWN times slower while it is within SIM_GLUE_RADIUS of a glue spot;
+ *  - a player touching a transistor gains its HP, the transistor reappears elsewhere;
+ *  - a spark touching a player takes SIM_SPARK_DAMAGE HP from it and reappears elsewhere; sparks move in straight
+ *    lines and bounce off the map border;
+ *  - a player whose disc covers the centre of a player with less HP eats it and gains its HP;
+ *  - a player with no HP left is dead; the game ends after maxTicks ticks or when at most one player is alive;
+ *  - every object is sent with HP > 0 while it is on the map (HP 0 means gone): a spark with the HP it takes
+ *    (SIM_SPARK_DAMAGE), a glue spot with SIM_GLUE_HP.
+ *
+ * The packets are exchanged through a @ref SIM_Transport: @ref SIM_PlayLocalGame connects the simulator directly
+ * to player GameStates in the same process (no sockets), mniam_sim also serves TCP connections.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "amcom.h"
+#include "amcom_packets.h"
+#include "bot.h"
+#include "histogram.h"
+
+/// Maximum number of players in a game (all of them fit in one GAME_OVER.request)
+#define SIM_MAX_PLAYERS AMCOM_MAX_PLAYER_UPDATES
+/// Value of SIM_Result.winner when no player survived
+#define SIM_NO_WINNER UINT32_MAX
+
+// Game mechanics
+#define SIM_PLAYER_BASE_RADIUS 25.0f   ///< radius of a player with no HP
+#define SIM_PLAYER_SPEED 5.0f          ///< distance a player moves per tick outside glue
+#define SIM_START_HP 10                ///< HP of a player at the start of a game
+#define SIM_GLUE_RADIUS 100.0f         ///< radius of a glue spot
+#define SIM_GLUE_SLOWDOWN 20.0f        ///< speed divisor inside glue
+#define SIM_GLUE_HP 1                  ///< HP sent for a glue spot (HP 0 would mean that it is gone)
+#define SIM_SPARK_SPEED 3.0f           ///< distance a spark moves per tick
+#define SIM_SPARK_DAMAGE 3             ///< HP taken by a spark (and sent as its HP)
+#define SIM_MAX_TRANSISTOR_HP 3        ///< transistors are worth 1..SIM_MAX_TRANSISTOR_HP HP
+
+/** Configuration of the simulated games */
+typedef struct {
+	uint32_t playerCount;          ///< number of players (1..SIM_MAX_PLAYERS)
+	float mapWidth;                ///< width of the map
+	float mapHeight;               ///< height of the map
+	uint32_t transistorCount;      ///< number of transistors on the map
+	uint32_t sparkCount;           ///< number of sparks on the map
+	uint32_t glueCount;            ///< number of glue spots on the map
+	uint32_t maxTicks;             ///< length of a game in ticks
+	uint32_t seed;                 ///< seed of the first game (game n uses a seed derived from seed and n)
+} SIM_Config;
+
+/** Outcome of one game */
+typedef struct {
+	uint32_t ticks;                                ///< number of ticks played
+	uint32_t winner;                               ///< living player with the most HP, SIM_NO_WINNER if none
+	int8_t hp[SIM_MAX_PLAYERS];                    ///< HP of every player at the end (0 = dead)
+	uint32_t transistorsEaten[SIM_MAX_PLAYERS];    ///< transistors collected by every player
+	uint32_t playersEaten[SIM_MAX_PLAYERS];        ///< players eaten by every player
+	uint32_t sparkHits[SIM_MAX_PLAYERS];           ///< sparks that hit every player
+	uint32_t timeouts[SIM_MAX_PLAYERS];            ///< requests every player did not answer in time
+	uint32_t survivedTicks[SIM_MAX_PLAYERS];       ///< tick at which every player died (ticks if it survived)
+} SIM_Result;
+
+/**
+ * Type of a function that sends one packet to a player.
+ *
+ * @param context context of the transport
+ * @param player index of the player
+ * @param packet serialized packet
+ * @param size number of bytes in the packet
+ */
+typedef void (*SIM_SendFunction)(void* context, uint32_t player, const uint8_t* packet, size_t size);
+
+/**
+ * Type of a function that delivers the responses of the players (through @ref SIM_HandleResponse) until no
+ * response is awaited or the players timed out.
+ *
+ * @param context context of the transport
+ */
+typedef void (*SIM_WaitFunction)(void* context);
+
+/**
+ * Type of a function called after every simulated tick.
+ *
+ * @param context context given to @ref SIM_SetTickObserver
+ * @param tick number of the tick (1 for the first one)
+ * @param hp HP of every player after the tick (0 = dead)
+ */
+typedef void (*SIM_TickObserver)(void* context, uint32_t tick, const int8_t* hp);
+
+/** Connection between the simulator and the players */
+typedef struct {
+	SIM_SendFunction send;         ///< sends a packet to a player (may buffer it until wait)
+	SIM_WaitFunction wait;         ///< delivers the responses
+	void* context;                 ///< passed to both functions
+} SIM_Transport;
+
+/** Opaque structure of the simulated world */
+typedef struct SIM_World SIM_World;
+
+/**
+ * @brief Fills the configuration with the defaults (2 players, 1000x1000 map, 100 transistors, 10 sparks,
+ * 5 glue spots, 1000 ticks).
+ */
+void SIM_DefaultConfig(SIM_Config* config);
+
+/**
+ * @brief Creates a world for the given configuration.
+ *
+ * @return the world or NULL if the configuration is invalid or memory could not be allocated
+ */
+SIM_World* SIM_Create(const SIM_Config* config);
+
+/**
+ * @brief Releases the world. NULL is ignored.
+ */
+void SIM_Destroy(SIM_World* world);
+
+/**
+ * @brief Selects the number of the next game played in the world.
+ *
+ * The map of a game depends only on the seed and the game number, so games can be played in any order (or in
+ * different worlds) and still be reproducible.
+ */
+void SIM_SeekGame(SIM_World* world, uint32_t game);
+
+/**
+ * @brief Sets a function called after every tick (NULL removes it).
+ */
+void SIM_SetTickObserver(SIM_World* world, SIM_TickObserver observer, void* context);
+
+/**
+ * @brief Sends IDENTIFY.request to every player and waits for the responses.
+ */
+void SIM_Identify(SIM_World* world, const SIM_Transport* transport);
+
+/**
+ * @brief Plays one whole game: NEW_GAME, the ticks and GAME_OVER.
+ *
+ * @param world world to play in (every game starts from a freshly generated map)
+ * @param transport connection to the players
+ * @param result filled with the outcome of the game
+ */
+void SIM_PlayGame(SIM_World* world, const SIM_Transport* transport, SIM_Result* result);
+
+/**
+ * @brief Passes a response of a player to the simulator. Called by the transport from its wait function.
+ *
+ * Responses that are not awaited (wrong type, or after a timeout) are ignored.
+ */
+void SIM_HandleResponse(SIM_World* world, uint32_t player, const AMCOM_PacketView* packet);
+
+/**
+ * @brief Marks a player as disconnected: it loses the game and no response is awaited from it anymore.
+ */
+void SIM_Disconnect(SIM_World* world, uint32_t player);
+
+/**
+ * @brief Returns the number of players whose response is awaited.
+ */
+uint32_t SIM_PendingResponses(const SIM_World* world);
+
+/**
+ * @brief Plays one game against players running in this process, without sockets.
+ *
+ * The packets still go through AMCOM_Serialize / AMCOM_Deserialize and handleGamePacket, like over a connection.
+ * @param world world to play in (its playerCount must match the number of game states)
+ * @param players game states of the players (initialized with initGameState), one per player
+ * @param identify send IDENTIFY.request first (the first game of a connection)
+ * @param decisionLatency histograms of the time every player spends handling a MOVE.request [ns], or NULL
+ * @param result filled with the outcome of the game
+ */
+void SIM_PlayLocalGame(SIM_World* world, GameState* const* players, bool identify,
+                       HISTOGRAM_Histogram* decisionLatency, SIM_Result* result);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* SIM_H_ */
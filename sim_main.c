@@ -0,0 +1,286 @@
+/**
+ * mniam_sim - headless local game server for self-play (see sim.h for the simulated mechanics).
+ *
+ * Usage: mniam_sim [--local] [--players N] [--games G] [--ticks T] [--seed S] [--port P] [--timeout MS]
+ *                  [--move-delay MS]
+ *
+ * By default the simulator listens on the port (2001, like the real server), waits for N players to connect and
+ * plays G games with them. Ticks advance as soon as every living player answered, or after the timeout.
+ * The object updates and the MOVE request of a tick are sent together, unless --move-delay separates them (like
+ * a server that asks for moves some time after publishing the world, which lets the players decide ahead).
+ * With --local the players are mniAM bots running in this process and no socket is used at all.
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include "amcom.h"
+#include "bot.h"
+#include "platform.h"
+#include "sim.h"
+#include "transport.h"
+
+#define DEFAULT_PORT "2001"
+#define DEFAULT_TIMEOUT_MS 1000
+#define SEND_BUFFER_SIZE 8192
+
+/**
+ * Player connected over TCP
+ */
+typedef struct {
+    TRANSPORT_Connection connection;               // Connection of the player
+    AMCOM_Receiver receiver;                       // Receives the responses of the player
+    bool connected;                                // Cleared when the connection has been closed
+    uint8_t sendBuffer[SEND_BUFFER_SIZE];          // Packets waiting to be sent
+    size_t sendSize;                               // Bytes in sendBuffer
+    uint32_t index;                                // Index of the player in the game
+    struct SocketServer* server;                   // Server the player belongs to
+} SocketPlayer;
+
+/**
+ * Context of the socket transport
+ */
+typedef struct SocketServer {
+    SIM_World* world;                              // Simulated world
+    SocketPlayer* players;                         // Connected players
+    uint32_t playerCount;                          // Number of players
+    TRANSPORT_Poller* poller;                      // Waits for responses of the players
+    int timeoutMs;                                 // Time a player has for a response
+    int moveDelayMs;                               // Pause between the updates and the MOVE requests of a tick
+    bool moveDelayed;                              // The pause of the current tick is over
+} SocketServer;
+
+static void socketResponseHandler(const AMCOM_PacketView* packet, void* userContext) {
+    SocketPlayer* player = (SocketPlayer*)userContext;
+    SIM_HandleResponse(player->server->world, player->index, packet);
+}
+
+static void disconnectPlayer(SocketServer* server, SocketPlayer* player) {
+    if (!player->connected) {
+        return;
+    }
+    printf("Player %u disconnected\n", player->index);
+    TRANSPORT_PollerRemove(server->poller, &player->connection);
+    TRANSPORT_Close(&player->connection);
+    player->connected = false;
+    SIM_Disconnect(server->world, player->index);
+}
+
+static bool flushPlayer(SocketPlayer* player) {
+    if (player->sendSize == 0 || !player->connected) {
+        return true;
+    }
+    bool sent = TRANSPORT_Send(&player->connection, player->sendBuffer, player->sendSize);
+    player->sendSize = 0;
+    return sent;
+}
+
+static void flushPlayers(SocketServer* server) {
+    for (uint32_t p = 0; p < server->playerCount; p++) {
+        if (!flushPlayer(&server->players[p])) {
+            disconnectPlayer(server, &server->players[p]);
+        }
+    }
+}
+
+static void socketSend(void* context, uint32_t index, const uint8_t* packet, size_t size) {
+    SocketServer* server = (SocketServer*)context;
+    SocketPlayer* player = &server->players[index];
+    if (!player->connected) {
+        return;
+    }
+    if (server->moveDelayMs > 0 && !server->moveDelayed && size > 1 && packet[1] == AMCOM_MOVE_REQUEST) {
+        // the updates of the tick go out first, the MOVE requests after the pause
+        flushPlayers(server);
+        PLATFORM_SleepMs((uint32_t)server->moveDelayMs);
+        server->moveDelayed = true;
+    }
+    if (player->sendSize + size > sizeof(player->sendBuffer) && !flushPlayer(player)) {
+        disconnectPlayer(server, player);
+        return;
+    }
+    memcpy(player->sendBuffer + player->sendSize, packet, size);
+    player->sendSize += size;
+}
+
+static void socketWait(void* context) {
+    SocketServer* server = (SocketServer*)context;
+    flushPlayers(server);
+    server->moveDelayed = false;
+    uint64_t deadline = PLATFORM_NowNs() + (uint64_t)server->timeoutMs * 1000000ull;
+    char recvbuf[4096];
+    void* ready[SIM_MAX_PLAYERS];
+    while (SIM_PendingResponses(server->world) > 0) {
+        uint64_t now = PLATFORM_NowNs();
+        if (now >= deadline) {
+            break;
+        }
+        int waitMs = (int)((deadline - now + 999999) / 1000000);
+        int readyCount = TRANSPORT_PollerWait(server->poller, ready, SIM_MAX_PLAYERS, waitMs);
+        if (readyCount < 0) {
+            printf("Poll failed with error: %d\n", TRANSPORT_LastError());
+            break;
+        }
+        for (int i = 0; i < readyCount; i++) {
+            SocketPlayer* player = (SocketPlayer*)ready[i];
+            for (;;) {
+                int received = TRANSPORT_Receive(&player->connection, recvbuf, sizeof(recvbuf));
+                if (received > 0) {
+                    AMCOM_Deserialize(&player->receiver, recvbuf, (size_t)received);
+                } else {
+                    if (received != TRANSPORT_WOULD_BLOCK) {
+                        disconnectPlayer(server, player);
+                    }
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static void printResult(uint32_t game, const SIM_Result* result, uint32_t playerCount) {
+    printf("Game %u: %u ticks, ", game + 1, result->ticks);
+    if (result->winner == SIM_NO_WINNER) {
+        printf("no winner\n");
+    } else {
+        printf("winner: player %u\n", result->winner);
+    }
+    for (uint32_t p = 0; p < playerCount; p++) {
+        printf("  player %u: hp %d, transistors %u, players eaten %u, spark hits %u, timeouts %u\n", p,
+               result->hp[p], result->transistorsEaten[p], result->playersEaten[p], result->sparkHits[p],
+               result->timeouts[p]);
+    }
+}
+
+static void printUsage(const char* program) {
+    printf("Usage: %s [--local] [--players N] [--games G] [--ticks T] [--seed S] [--port P] [--timeout MS]"
+           " [--move-delay MS]\n", program);
+    printf("  --local       play with mniAM bots in this process instead of TCP players\n");
+    printf("  --players N   number of players (1..%d, default 2)\n", SIM_MAX_PLAYERS);
+    printf("  --games G     number of games (default 1)\n");
+    printf("  --ticks T     length of a game in ticks (default 1000)\n");
+    printf("  --seed S      seed of the first map (default 1)\n");
+    printf("  --port P      port to listen on (default %s)\n", DEFAULT_PORT);
+    printf("  --timeout MS  time a TCP player has for a response (default %d)\n", DEFAULT_TIMEOUT_MS);
+    printf("  --move-delay MS send the MOVE requests MS after the object updates of a tick (default 0)\n");
+}
+
+int main(int argc, char** argv) {
+    SIM_Config config;
+    SIM_DefaultConfig(&config);
+    bool local = false;
+    int games = 1;
+    const char* port = DEFAULT_PORT;
+    int timeoutMs = DEFAULT_TIMEOUT_MS;
+    int moveDelayMs = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--local") == 0) {
+            local = true;
+        } else if (strcmp(argv[i], "--players") == 0 && i + 1 < argc) {
+            config.playerCount = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            config.maxTicks = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = argv[++i];
+        } else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+            timeoutMs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--move-delay") == 0 && i + 1 < argc) {
+            moveDelayMs = atoi(argv[++i]);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    SIM_World* world = SIM_Create(&config);
+    if (world == NULL || games < 1 || timeoutMs < 0 || moveDelayMs < 0) {
+        printUsage(argv[0]);
+        SIM_Destroy(world);
+        return 1;
+    }
+
+    SIM_Result result;
+    uint64_t totalTicks = 0;
+    uint64_t start = PLATFORM_NowNs();
+    if (local) {
+        GameState* players[SIM_MAX_PLAYERS];
+        for (uint32_t p = 0; p < config.playerCount; p++) {
+            players[p] = (GameState*)malloc(sizeof(GameState));
+            if (players[p] == NULL) {
+                printf("Out of memory\n");
+                return 1;
+            }
+            initGameState(players[p], NULL);
+        }
+        for (int g = 0; g < games; g++) {
+            SIM_PlayLocalGame(world, players, g == 0, NULL, &result);
+            printResult((uint32_t)g, &result, config.playerCount);
+            totalTicks += result.ticks;
+        }
+        for (uint32_t p = 0; p < config.playerCount; p++) {
+            freeGameState(players[p]);
+            free(players[p]);
+        }
+    } else {
+        if (!TRANSPORT_Init()) {
+            printf("Transport initialization failed with error: %d\n", TRANSPORT_LastError());
+            return 1;
+        }
+        TRANSPORT_Connection listener;
+        SocketServer server;
+        server.world = world;
+        server.playerCount = config.playerCount;
+        server.timeoutMs = timeoutMs;
+        server.moveDelayMs = moveDelayMs;
+        server.moveDelayed = false;
+        server.players = (SocketPlayer*)calloc(config.playerCount, sizeof(SocketPlayer));
+        server.poller = TRANSPORT_CreatePoller();
+        if (server.players == NULL || server.poller == NULL || !TRANSPORT_Listen(&listener, port)) {
+            printf("Unable to listen on port %s, error: %d\n", port, TRANSPORT_LastError());
+            return 1;
+        }
+        printf("Waiting for %u player(s) on port %s...\n", config.playerCount, port);
+        for (uint32_t p = 0; p < config.playerCount; p++) {
+            SocketPlayer* player = &server.players[p];
+            player->index = p;
+            player->server = &server;
+            AMCOM_InitViewReceiver(&player->receiver, socketResponseHandler, player);
+            if (!TRANSPORT_Accept(&listener, &player->connection) ||
+                !TRANSPORT_PollerAdd(server.poller, &player->connection, player)) {
+                printf("Accepting player %u failed with error: %d\n", p, TRANSPORT_LastError());
+                return 1;
+            }
+            player->connected = true;
+            printf("Player %u connected\n", p);
+        }
+        TRANSPORT_Close(&listener);
+
+        SIM_Transport transport = { socketSend, socketWait, &server };
+        SIM_Identify(world, &transport);
+        start = PLATFORM_NowNs();
+        for (int g = 0; g < games; g++) {
+            SIM_PlayGame(world, &transport, &result);
+            printResult((uint32_t)g, &result, config.playerCount);
+            totalTicks += result.ticks;
+        }
+        for (uint32_t p = 0; p < config.playerCount; p++) {
+            if (server.players[p].connected) {
+                TRANSPORT_PollerRemove(server.poller, &server.players[p].connection);
+                TRANSPORT_Close(&server.players[p].connection);
+            }
+        }
+        TRANSPORT_DestroyPoller(server.poller);
+        free(server.players);
+        TRANSPORT_Cleanup();
+    }
+    uint64_t elapsed = PLATFORM_NowNs() - start;
+
+    printf("Games: %d, ticks: %llu, %.3f s (%.0f ticks/s, %.2f M ticks/min)\n", games,
+           (unsigned long long)totalTicks, elapsed / 1e9, elapsed > 0 ? totalTicks * 1e9 / elapsed : 0.0,
+           elapsed > 0 ? totalTicks * 60e9 / elapsed / 1e6 : 0.0);
+    SIM_Destroy(world);
+    return 0;
+}
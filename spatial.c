@@ -0,0 +1,332 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "spatial.h"
+
+/// Type of the function called for every cell of a ring
+typedef void (*SPATIAL_CellVisitor)(const SPATIAL_Grid* grid, uint32_t cell, void* context);
+
+/** Context of the visitor that collects object indices */
+typedef struct {
+	uint32_t* indices;
+	uint32_t count;
+} SPATIAL_Collector;
+
+/** Context of the visitor used by SPATIAL_QueryNearest */
+typedef struct {
+	const OBJTABLE_Table* table;
+	float x;
+	float y;
+	uint32_t k;
+	uint32_t* indices;
+	uint32_t count;
+} SPATIAL_NearestSearch;
+
+static uint32_t SPATIAL_Coordinate(float value, float inverseCellSize, uint32_t cells) {
+	float cell = value * inverseCellSize;
+	if(!(cell >= 0.0f)){
+	    // negative or NaN
+	    return 0;
+	}
+	if(cell >= (float)cells){
+	    return cells - 1;
+	}
+	return (uint32_t)cell;
+}
+
+static uint32_t SPATIAL_CellOf(const SPATIAL_Grid* grid, float x, float y) {
+	return SPATIAL_Coordinate(y, grid->inverseCellSize, grid->rows) * grid->columns +
+	       SPATIAL_Coordinate(x, grid->inverseCellSize, grid->columns);
+}
+
+static bool SPATIAL_Reserve(SPATIAL_Grid* grid, uint32_t count) {
+	if(count <= grid->capacity){
+	    return true;
+	}
+	uint32_t capacity = grid->capacity ? grid->capacity : 16;
+	while(capacity < count){
+	    capacity *= 2;
+	}
+	int32_t* next = (int32_t*)realloc(grid->next, capacity * sizeof(int32_t));
+	if(next != NULL) grid->next = next;
+	int32_t* previous = (int32_t*)realloc(grid->previous, capacity * sizeof(int32_t));
+	if(previous != NULL) grid->previous = previous;
+	uint32_t* cellOf = (uint32_t*)realloc(grid->cellOf, capacity * sizeof(uint32_t));
+	if(cellOf != NULL) grid->cellOf = cellOf;
+	float* nearestDistances = (float*)realloc(grid->nearestDistances, capacity * sizeof(float));
+	if(nearestDistances != NULL) grid->nearestDistances = nearestDistances;
+	if(next == NULL || previous == NULL || cellOf == NULL || nearestDistances == NULL){
+	    // arrays that were grown keep working, the capacity stays at the smallest common size
+	    return false;
+	}
+	grid->capacity = capacity;
+	return true;
+}
+
+static void SPATIAL_Link(SPATIAL_Grid* grid, uint32_t index, uint32_t cell) {
+	int32_t head = grid->cellHeads[cell];
+	grid->cellOf[index] = cell;
+	grid->previous[index] = -1;
+	grid->next[index] = head;
+	if(head >= 0){
+	    grid->previous[head] = (int32_t)index;
+	}
+	grid->cellHeads[cell] = (int32_t)index;
+}
+
+static void SPATIAL_Unlink(SPATIAL_Grid* grid, uint32_t index) {
+	int32_t previous = grid->previous[index];
+	int32_t next = grid->next[index];
+	if(previous >= 0){
+	    grid->next[previous] = next;
+	} else {
+	    grid->cellHeads[grid->cellOf[index]] = next;
+	}
+	if(next >= 0){
+	    grid->previous[next] = previous;
+	}
+}
+
+static void SPATIAL_ForEachRingCell(const SPATIAL_Grid* grid, float x, float y, uint32_t ring,
+                                    SPATIAL_CellVisitor visit, void* context) {
+	int64_t column = SPATIAL_Coordinate(x, grid->inverseCellSize, grid->columns);
+	int64_t row = SPATIAL_Coordinate(y, grid->inverseCellSize, grid->rows);
+	int64_t firstColumn = column - ring, lastColumn = column + ring;
+	int64_t firstRow = row - ring, lastRow = row + ring;
+	int64_t fromColumn = firstColumn < 0 ? 0 : firstColumn;
+	int64_t toColumn = lastColumn >= grid->columns ? grid->columns - 1 : lastColumn;
+
+	if(ring == 0){
+	    visit(grid, (uint32_t)(row * grid->columns + column), context);
+	    return;
+	}
+	// top and bottom edge of the ring (with the corners)
+	if(firstRow >= 0){
+	    for(int64_t c = fromColumn; c <= toColumn; c++){
+	        visit(grid, (uint32_t)(firstRow * grid->columns + c), context);
+	    }
+	}
+	if(lastRow < grid->rows){
+	    for(int64_t c = fromColumn; c <= toColumn; c++){
+	        visit(grid, (uint32_t)(lastRow * grid->columns + c), context);
+	    }
+	}
+	// left and right edge of the ring (without the corners)
+	int64_t fromRow = firstRow + 1 < 0 ? 0 : firstRow + 1;
+	int64_t toRow = lastRow - 1 >= grid->rows ? grid->rows - 1 : lastRow - 1;
+	for(int64_t r = fromRow; r <= toRow; r++){
+	    if(firstColumn >= 0){
+	        visit(grid, (uint32_t)(r * grid->columns + firstColumn), context);
+	    }
+	    if(lastColumn < grid->columns){
+	        visit(grid, (uint32_t)(r * grid->columns + lastColumn), context);
+	    }
+	}
+}
+
+static void SPATIAL_CollectCell(const SPATIAL_Grid* grid, uint32_t cell, void* context) {
+	SPATIAL_Collector* collector = (SPATIAL_Collector*)context;
+	for(int32_t i = grid->cellHeads[cell]; i >= 0; i = grid->next[i]){
+	    collector->indices[collector->count++] = (uint32_t)i;
+	}
+}
+
+static void SPATIAL_NearestCell(const SPATIAL_Grid* grid, uint32_t cell, void* context) {
+	SPATIAL_NearestSearch* search = (SPATIAL_NearestSearch*)context;
+	float* distances = grid->nearestDistances;
+	for(int32_t i = grid->cellHeads[cell]; i >= 0; i = grid->next[i]){
+	    float dx = search->table->x[i] - search->x;
+	    float dy = search->table->y[i] - search->y;
+	    float distance = sqrtf(dx*dx + dy*dy);
+	    if(search->count == search->k && !(distance < distances[search->count - 1])){
+	        continue;
+	    }
+	    // insertion into the sorted list of the k best candidates
+	    uint32_t position = (search->count < search->k) ? search->count++ : search->k - 1;
+	    while(position > 0 && distances[position - 1] > distance){
+	        distances[position] = distances[position - 1];
+	        search->indices[position] = search->indices[position - 1];
+	        position--;
+	    }
+	    distances[position] = distance;
+	    search->indices[position] = (uint32_t)i;
+	}
+}
+
+static int SPATIAL_CompareIndices(const void* a, const void* b) {
+	uint32_t left = *(const uint32_t*)a;
+	uint32_t right = *(const uint32_t*)b;
+	return (left > right) - (left < right);
+}
+
+bool SPATIAL_Init(SPATIAL_Grid* grid) {
+	memset(grid, 0, sizeof(SPATIAL_Grid));
+	grid->cellHeads = (int32_t*)malloc(sizeof(int32_t));
+	if(grid->cellHeads == NULL){
+	    return false;
+	}
+	grid->cellHeads[0] = -1;
+	grid->cellSize = INFINITY;
+	grid->inverseCellSize = 0.0f;
+	grid->columns = 1;
+	grid->rows = 1;
+	return true;
+}
+
+void SPATIAL_Free(SPATIAL_Grid* grid) {
+	free(grid->cellHeads);
+	free(grid->next);
+	free(grid->previous);
+	free(grid->cellOf);
+	free(grid->nearestDistances);
+	memset(grid, 0, sizeof(SPATIAL_Grid));
+}
+
+bool SPATIAL_Reset(SPATIAL_Grid* grid, const OBJTABLE_Table* table, float width, float height, float cellSize) {
+	float largest = (width > height) ? width : height;
+	if(!(largest > 0.0f) || !(cellSize > 0.0f)){
+	    return false;
+	}
+	if(largest / cellSize > SPATIAL_MAX_CELLS_PER_AXIS){
+	    cellSize = largest / SPATIAL_MAX_CELLS_PER_AXIS;
+	}
+	uint32_t columns = (width > 0.0f) ? (uint32_t)ceilf(width / cellSize) : 1;
+	uint32_t rows = (height > 0.0f) ? (uint32_t)ceilf(height / cellSize) : 1;
+	columns = (columns < 1) ? 1 : (columns > SPATIAL_MAX_CELLS_PER_AXIS) ? SPATIAL_MAX_CELLS_PER_AXIS : columns;
+	rows = (rows < 1) ? 1 : (rows > SPATIAL_MAX_CELLS_PER_AXIS) ? SPATIAL_MAX_CELLS_PER_AXIS : rows;
+
+	int32_t* cellHeads = (int32_t*)malloc((size_t)columns * rows * sizeof(int32_t));
+	if(cellHeads == NULL || !SPATIAL_Reserve(grid, table->count)){
+	    free(cellHeads);
+	    return false;
+	}
+	memset(cellHeads, 0xFF, (size_t)columns * rows * sizeof(int32_t));
+	free(grid->cellHeads);
+	grid->cellHeads = cellHeads;
+	grid->cellSize = cellSize;
+	grid->inverseCellSize = 1.0f / cellSize;
+	grid->columns = columns;
+	grid->rows = rows;
+	for(uint32_t i = 0; i < table->count; i++){
+	    SPATIAL_Link(grid, i, SPATIAL_CellOf(grid, table->x[i], table->y[i]));
+	}
+	return true;
+}
+
+bool SPATIAL_Insert(SPATIAL_Grid* grid, const OBJTABLE_Table* table, uint32_t index) {
+	if(!SPATIAL_Reserve(grid, index + 1)){
+	    return false;
+	}
+	SPATIAL_Link(grid, index, SPATIAL_CellOf(grid, table->x[index], table->y[index]));
+	return true;
+}
+
+void SPATIAL_Move(SPATIAL_Grid* grid, const OBJTABLE_Table* table, uint32_t index) {
+	uint32_t cell = SPATIAL_CellOf(grid, table->x[index], table->y[index]);
+	if(cell != grid->cellOf[index]){
+	    SPATIAL_Unlink(grid, index);
+	    SPATIAL_Link(grid, index, cell);
+	}
+}
+
+void SPATIAL_Remove(SPATIAL_Grid* grid, uint32_t index) {
+	SPATIAL_Unlink(grid, index);
+}
+
+void SPATIAL_Relocate(SPATIAL_Grid* grid, uint32_t from, uint32_t to) {
+	int32_t previous = grid->previous[from];
+	int32_t next = grid->next[from];
+	grid->previous[to] = previous;
+	grid->next[to] = next;
+	grid->cellOf[to] = grid->cellOf[from];
+	if(previous >= 0){
+	    grid->next[previous] = (int32_t)to;
+	} else {
+	    grid->cellHeads[grid->cellOf[to]] = (int32_t)to;
+	}
+	if(next >= 0){
+	    grid->previous[next] = (int32_t)to;
+	}
+}
+
+uint32_t SPATIAL_QueryRadius(const SPATIAL_Grid* grid, float x, float y, float radius, uint32_t* indices) {
+	// a small margin makes sure that rounding never drops an object lying exactly on the circle
+	radius = radius * 1.001f + 0.01f;
+	uint32_t firstColumn = SPATIAL_Coordinate(x - radius, grid->inverseCellSize, grid->columns);
+	uint32_t lastColumn = SPATIAL_Coordinate(x + radius, grid->inverseCellSize, grid->columns);
+	uint32_t firstRow = SPATIAL_Coordinate(y - radius, grid->inverseCellSize, grid->rows);
+	uint32_t lastRow = SPATIAL_Coordinate(y + radius, grid->inverseCellSize, grid->rows);
+	SPATIAL_Collector collector = { indices, 0 };
+
+	for(uint32_t row = firstRow; row <= lastRow; row++){
+	    for(uint32_t column = firstColumn; column <= lastColumn; column++){
+	        SPATIAL_CollectCell(grid, row * grid->columns + column, &collector);
+	    }
+	}
+	qsort(indices, collector.count, sizeof(uint32_t), SPATIAL_CompareIndices);
+	return collector.count;
+}
+
+uint32_t SPATIAL_LastRing(const SPATIAL_Grid* grid, float x, float y) {
+	uint32_t column = SPATIAL_Coordinate(x, grid->inverseCellSize, grid->columns);
+	uint32_t row = SPATIAL_Coordinate(y, grid->inverseCellSize, grid->rows);
+	uint32_t last = column;
+	if(grid->columns - 1 - column > last) last = grid->columns - 1 - column;
+	if(row > last) last = row;
+	if(grid->rows - 1 - row > last) last = grid->rows - 1 - row;
+	return last;
+}
+
+float SPATIAL_RingDistance(const SPATIAL_Grid* grid, float x, float y, uint32_t ring) {
+	if(ring == 0){
+	    return 0.0f;
+	}
+	int64_t column = SPATIAL_Coordinate(x, grid->inverseCellSize, grid->columns);
+	int64_t row = SPATIAL_Coordinate(y, grid->inverseCellSize, grid->rows);
+	// distances are measured from the point clamped to the grid, like the object positions
+	float width = grid->columns * grid->cellSize;
+	float height = grid->rows * grid->cellSize;
+	x = !(x > 0.0f) ? 0.0f : (x > width) ? width : x;
+	y = !(y > 0.0f) ? 0.0f : (y > height) ? height : y;
+
+	float distance = INFINITY;
+	if(column - (int64_t)ring >= 0){
+	    distance = fminf(distance, x - (float)(column - ring + 1) * grid->cellSize);
+	}
+	if(column + (int64_t)ring < grid->columns){
+	    distance = fminf(distance, (float)(column + ring) * grid->cellSize - x);
+	}
+	if(row - (int64_t)ring >= 0){
+	    distance = fminf(distance, y - (float)(row - ring + 1) * grid->cellSize);
+	}
+	if(row + (int64_t)ring < grid->rows){
+	    distance = fminf(distance, (float)(row + ring) * grid->cellSize - y);
+	}
+	// leave room for rounding of the cell boundaries
+	return fmaxf(0.0f, distance - grid->cellSize * 0.001f);
+}
+
+uint32_t SPATIAL_QueryRing(const SPATIAL_Grid* grid, float x, float y, uint32_t ring, uint32_t* indices) {
+	SPATIAL_Collector collector = { indices, 0 };
+	SPATIAL_ForEachRingCell(grid, x, y, ring, SPATIAL_CollectCell, &collector);
+	return collector.count;
+}
+
+uint32_t SPATIAL_QueryNearest(SPATIAL_Grid* grid, const OBJTABLE_Table* table, float x, float y, uint32_t k,
+                              uint32_t* indices) {
+	if(k > table->count){
+	    k = table->count;
+	}
+	SPATIAL_NearestSearch search = { table, x, y, k, indices, 0 };
+	if(k == 0){
+	    return 0;
+	}
+	uint32_t lastRing = SPATIAL_LastRing(grid, x, y);
+	for(uint32_t ring = 0; ring <= lastRing; ring++){
+	    if(search.count == k && grid->nearestDistances[k - 1] <= SPATIAL_RingDistance(grid, x, y, ring)){
+	        break;
+	    }
+	    SPATIAL_ForEachRingCell(grid, x, y, ring, SPATIAL_NearestCell, &search);
+	}
+	return search.count;
+}
@@ -0,0 +1,144 @@
+#ifndef SPATIAL_H_
+#define SPATIAL_H_
+
+/**
+ * Uniform grid over the game map used to find the objects of one @ref OBJTABLE_Table near a point.
+ *
+ * The map is divided into square cells (the cell size is chosen from the map size announced in NEW_GAME).
+ * Every object of the table is linked into the list of the cell that contains it. The lists are intrusive
+ * and indexed by the dense position of the object in the table, so the grid has to be told about every
+ * insert, move and removal (including the move of the last object done by @ref OBJTABLE_Remove) - see
+ * @ref SPATIAL_Insert, @ref SPATIAL_Move, @ref SPATIAL_Remove and @ref SPATIAL_Relocate.
+ *
+ * Positions outside the map are clamped to the border cells. Clamping never makes two points further
+ * apart, so the distance bounds reported by the grid stay valid for such objects too. Queries return
+ * candidates - cells are selected by their distance to the query point and the caller is expected to
+ * check the exact distance of each returned object.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "objtable.h"
+
+/// Maximum number of cells along one axis of the grid (larger maps get larger cells)
+#define SPATIAL_MAX_CELLS_PER_AXIS 256
+
+/** Structure of the grid */
+typedef struct {
+	float cellSize;              ///< length of the cell side
+	float inverseCellSize;       ///< 1 / cellSize
+	uint32_t columns;            ///< number of cells along the X axis
+	uint32_t rows;               ///< number of cells along the Y axis
+	int32_t* cellHeads;          ///< first object of every cell, -1 if the cell is empty
+	int32_t* next;               ///< next object in the same cell, -1 at the end of the list
+	int32_t* previous;           ///< previous object in the same cell, -1 at the start of the list
+	uint32_t* cellOf;            ///< cell of every object
+	float* nearestDistances;     ///< work array of @ref SPATIAL_QueryNearest
+	uint32_t capacity;           ///< allocated size of the per-object arrays
+} SPATIAL_Grid;
+
+/**
+ * @brief Initializes a grid with a single cell (every query returns all objects until @ref SPATIAL_Reset).
+ *
+ * @return true on success
+ */
+bool SPATIAL_Init(SPATIAL_Grid* grid);
+
+/**
+ * @brief Releases all memory of the grid.
+ */
+void SPATIAL_Free(SPATIAL_Grid* grid);
+
+/**
+ * @brief Changes the grid geometry for a map of the given size and links all objects of the table again.
+ *
+ * @param grid grid to reset
+ * @param table objects tracked by the grid
+ * @param width map width
+ * @param height map height
+ * @param cellSize preferred cell size (increased if the map would need more than SPATIAL_MAX_CELLS_PER_AXIS cells)
+ *
+ * @return true on success, on failure the grid keeps its previous geometry
+ */
+bool SPATIAL_Reset(SPATIAL_Grid* grid, const OBJTABLE_Table* table, float width, float height, float cellSize);
+
+/**
+ * @brief Links a new object (at dense position index of the table) into its cell.
+ *
+ * @return true on success, false if memory could not be allocated
+ */
+bool SPATIAL_Insert(SPATIAL_Grid* grid, const OBJTABLE_Table* table, uint32_t index);
+
+/**
+ * @brief Updates the cell of an object after its position in the table has changed.
+ */
+void SPATIAL_Move(SPATIAL_Grid* grid, const OBJTABLE_Table* table, uint32_t index);
+
+/**
+ * @brief Unlinks an object. Must be called before the object is removed from the table.
+ */
+void SPATIAL_Remove(SPATIAL_Grid* grid, uint32_t index);
+
+/**
+ * @brief Tells the grid that the object at dense position from was moved to position to (swap removal).
+ */
+void SPATIAL_Relocate(SPATIAL_Grid* grid, uint32_t from, uint32_t to);
+
+/**
+ * @brief Finds the objects that may lie within the given radius of a point.
+ *
+ * @param grid grid to search
+ * @param x X coordinate of the point
+ * @param y Y coordinate of the point
+ * @param radius search radius
+ * @param indices receives dense positions of the candidates in ascending order (room for the whole table needed)
+ *
+ * @return number of candidates written to indices
+ */
+uint32_t SPATIAL_QueryRadius(const SPATIAL_Grid* grid, float x, float y, float radius, uint32_t* indices);
+
+/**
+ * @brief Returns the number of the last ring around the point that still contains grid cells.
+ *
+ * Ring r consists of the cells whose row or column differs by exactly r from the cell of the point.
+ */
+uint32_t SPATIAL_LastRing(const SPATIAL_Grid* grid, float x, float y);
+
+/**
+ * @brief Returns a lower bound of the distance between the point and any object in the given ring or further.
+ */
+float SPATIAL_RingDistance(const SPATIAL_Grid* grid, float x, float y, uint32_t ring);
+
+/**
+ * @brief Returns the objects of one ring of cells around a point.
+ *
+ * @param indices receives dense positions of the objects (in no particular order)
+ *
+ * @return number of objects written to indices
+ */
+uint32_t SPATIAL_QueryRing(const SPATIAL_Grid* grid, float x, float y, uint32_t ring, uint32_t* indices);
+
+/**
+ * @brief Finds the k objects closest to a point.
+ *
+ * @param grid grid to search
+ * @param table objects tracked by the grid (for their positions)
+ * @param x X coordinate of the point
+ * @param y Y coordinate of the point
+ * @param k number of objects to find
+ * @param indices receives dense positions of the found objects, closest first (room for k entries needed)
+ *
+ * @return number of objects written to indices (less than k only if the table is smaller)
+ */
+uint32_t SPATIAL_QueryNearest(SPATIAL_Grid* grid, const OBJTABLE_Table* table, float x, float y, uint32_t k,
+                              uint32_t* indices);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* SPATIAL_H_ */
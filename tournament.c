@@ -0,0 +1,433 @@
+/**
+ * Tournament of many independent simulated games (see sim.h) between mniAM bots, played on all cores.
+ *
+ * Usage: mniam_tournament [--matches M] [--threads T] [--players N] [--ticks T] [--seed S] [--curve-step K]
+ *                         [--params FILE]... [--planner-depth D] [--field] [--paths] [--summary FILE]
+ *
+ * Every match is one task: it gets its own GameState per player (created for the match and released after it),
+ * its map is selected by the match number (SIM_SeekGame), so the results do not depend on which worker played it.
+ * The matches are split into one contiguous range per worker; a worker plays its range from the end and, when it
+ * runs out, steals the first half of the range of another worker. The per-worker statistics are merged at the end
+ * and written to the summary file: win rate, survival time, the mean HP curve and the MOVE decision-time histogram
+ * of every player. The n-th --params option gives the strategy parameters (see params.h) of player n, so two
+ * parameter sets can be compared; the other players use the defaults. With --planner-depth player 0 replaces its
+ * greedy decisions with the moves of the lookahead planner (planner.h), searched D ticks ahead on every MOVE in the
+ * worker thread - deterministic, and its decision time shows the cost of the search. With --field player 0 moves
+ * along the gradient of the potential field (field.h) instead, with --paths it routes to its targets around glue
+ * and sparks (nav.h).
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "bot.h"
+#include "histogram.h"
+#include "params.h"
+#include "planner.h"
+#include "platform.h"
+#include "sim.h"
+
+#define DEFAULT_MATCHES 1000
+#define DEFAULT_CURVE_STEP 50
+#define DEFAULT_SUMMARY "tournament_summary.txt"
+
+/**
+ * Statistics of every player, summed over the matches of a worker (or of the whole tournament)
+ */
+typedef struct {
+    uint64_t matches;                                            // Number of matches played
+    uint64_t wins[SIM_MAX_PLAYERS];                              // Matches won by every player
+    uint64_t survivedTicks[SIM_MAX_PLAYERS];                     // Sum of the ticks every player survived
+    uint64_t finalHp[SIM_MAX_PLAYERS];                           // Sum of the final HP of every player
+    uint64_t transistorsEaten[SIM_MAX_PLAYERS];                  // Sum of the collected transistors
+    uint64_t playersEaten[SIM_MAX_PLAYERS];                      // Sum of the eaten players
+    uint64_t sparkHits[SIM_MAX_PLAYERS];                         // Sum of the spark hits
+    uint64_t* hpCurve;                                           // Sum of the HP at every sample [sample][player]
+    HISTOGRAM_Histogram decisionLatency[SIM_MAX_PLAYERS];        // Time spent deciding a MOVE [ns]
+} TournamentStats;
+
+/**
+ * Settings shared by the workers
+ */
+typedef struct {
+    SIM_Config config;                                           // Configuration of every match
+    PARAMS_Strategy params[SIM_MAX_PLAYERS];                     // Strategy parameters of every player
+    uint32_t curveStep;                                          // Ticks between two samples of the HP curve
+    uint32_t curveSamples;                                       // Number of samples (tick 0 included)
+    uint32_t plannerDepth;                                       // Lookahead of player 0 in ticks (0 = greedy)
+    bool fieldSteering;                                          // Player 0 moves along the potential field
+    bool pathfinding;                                            // Player 0 routes around glue and sparks
+    struct TournamentWorker* workers;                            // All workers (victims of stealing)
+    int workerCount;                                             // Number of workers
+} Tournament;
+
+/**
+ * Worker thread playing matches
+ */
+typedef struct TournamentWorker {
+    Tournament* tournament;                                      // Shared settings
+    PLATFORM_Thread thread;                                      // Worker thread
+    int index;                                                   // Index of the worker
+    int cpu;                                                     // CPU to pin the worker to, -1 = no pinning
+    _Alignas(64) atomic_uint_least64_t range;                    // Matches left to the worker: begin << 32 | end
+    uint64_t steals;                                             // Successful steals from other workers
+    uint32_t nextSample;                                         // Next HP curve sample of the current match
+    TournamentStats stats;                                       // Statistics of the matches played
+} TournamentWorker;
+
+static inline uint64_t packRange(uint32_t begin, uint32_t end) {
+    return ((uint64_t)begin << 32) | end;
+}
+
+/**
+ * Takes the last match of the own range
+ * @return true if a match was taken
+ */
+static bool popMatch(TournamentWorker* worker, uint32_t* match) {
+    uint64_t range = atomic_load(&worker->range);
+    for (;;) {
+        uint32_t begin = (uint32_t)(range >> 32), end = (uint32_t)range;
+        if (begin >= end) {
+            return false;
+        }
+        if (atomic_compare_exchange_weak(&worker->range, &range, packRange(begin, end - 1))) {
+            *match = end - 1;
+            return true;
+        }
+    }
+}
+
+/**
+ * Takes the first half of the range of another worker, keeps the first match of it and moves the rest
+ * into the own (empty) range. Ranges only shrink or move between workers, so a range seen by a thief can
+ * never come back and a compare-and-swap on the whole range is enough.
+ * @return true if a match was stolen
+ */
+static bool stealMatch(TournamentWorker* thief, uint32_t* match) {
+    Tournament* tournament = thief->tournament;
+    for (int i = 1; i < tournament->workerCount; i++) {
+        TournamentWorker* victim = &tournament->workers[(thief->index + i) % tournament->workerCount];
+        uint64_t range = atomic_load(&victim->range);
+        for (;;) {
+            uint32_t begin = (uint32_t)(range >> 32), end = (uint32_t)range;
+            if (begin >= end) {
+                break;
+            }
+            uint32_t taken = (end - begin + 1) / 2;
+            if (atomic_compare_exchange_weak(&victim->range, &range, packRange(begin + taken, end))) {
+                atomic_store(&thief->range, packRange(begin + 1, begin + taken));
+                thief->steals++;
+                *match = begin;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void sampleHp(TournamentWorker* worker, const int8_t* hp) {
+    const Tournament* tournament = worker->tournament;
+    uint64_t* sample = &worker->stats.hpCurve[(size_t)worker->nextSample * SIM_MAX_PLAYERS];
+    for (uint32_t p = 0; p < tournament->config.playerCount; p++) {
+        sample[p] += (hp[p] > 0) ? (uint64_t)hp[p] : 0;
+    }
+    worker->nextSample++;
+}
+
+static void tickObserver(void* context, uint32_t tick, const int8_t* hp) {
+    TournamentWorker* worker = (TournamentWorker*)context;
+    if (tick % worker->tournament->curveStep == 0 && worker->nextSample < worker->tournament->curveSamples) {
+        sampleHp(worker, hp);
+    }
+}
+
+static void playMatch(TournamentWorker* worker, SIM_World* world, GameState* const* players,
+                      PLANNER_Planner* planner, uint32_t match) {
+    const Tournament* tournament = worker->tournament;
+    const uint32_t playerCount = tournament->config.playerCount;
+    TournamentStats* stats = &worker->stats;
+    for (uint32_t p = 0; p < playerCount; p++) {
+        initGameState(players[p], NULL);
+        players[p]->params = tournament->params[p];
+    }
+    players[0]->planner = planner;
+    players[0]->fieldMaintained = players[0]->fieldSteering = tournament->fieldSteering;
+    players[0]->pathfinding = tournament->pathfinding;
+    int8_t startHp[SIM_MAX_PLAYERS];
+    memset(startHp, SIM_START_HP, sizeof(startHp));
+    worker->nextSample = 0;
+    sampleHp(worker, startHp);
+
+    SIM_Result result;
+    SIM_SeekGame(world, match);
+    SIM_PlayLocalGame(world, players, true, stats->decisionLatency, &result);
+
+    // a game that ended early keeps its final HP until the end of the curve
+    while (worker->nextSample < tournament->curveSamples) {
+        sampleHp(worker, result.hp);
+    }
+    stats->matches++;
+    if (result.winner != SIM_NO_WINNER) {
+        stats->wins[result.winner]++;
+    }
+    for (uint32_t p = 0; p < playerCount; p++) {
+        stats->survivedTicks[p] += result.survivedTicks[p];
+        stats->finalHp[p] += (result.hp[p] > 0) ? (uint64_t)result.hp[p] : 0;
+        stats->transistorsEaten[p] += result.transistorsEaten[p];
+        stats->playersEaten[p] += result.playersEaten[p];
+        stats->sparkHits[p] += result.sparkHits[p];
+        freeGameState(players[p]);
+    }
+}
+
+static void runWorker(void* arg) {
+    TournamentWorker* worker = (TournamentWorker*)arg;
+    const Tournament* tournament = worker->tournament;
+    if (worker->cpu >= 0 && !PLATFORM_PinCurrentThread(worker->cpu)) {
+        printf("Unable to pin worker to CPU %d\n", worker->cpu);
+    }
+    SIM_World* world = SIM_Create(&tournament->config);
+    GameState* players[SIM_MAX_PLAYERS] = { NULL };
+    PLANNER_Planner* planner = NULL;
+    if (tournament->plannerDepth > 0) {
+        planner = PLANNER_Create(0, tournament->plannerDepth, false);
+    }
+    bool allocated = (world != NULL) && (planner != NULL || tournament->plannerDepth == 0);
+    for (uint32_t p = 0; p < tournament->config.playerCount; p++) {
+        players[p] = (GameState*)malloc(sizeof(GameState));
+        allocated = allocated && players[p] != NULL;
+    }
+    if (!allocated) {
+        // the matches of the worker are left to be stolen by the others
+        printf("Worker %d: out of memory\n", worker->index);
+    } else {
+        SIM_SetTickObserver(world, tickObserver, worker);
+        uint32_t match;
+        while (popMatch(worker, &match) || stealMatch(worker, &match)) {
+            playMatch(worker, world, players, planner, match);
+        }
+    }
+    for (uint32_t p = 0; p < tournament->config.playerCount; p++) {
+        free(players[p]);
+    }
+    PLANNER_Destroy(planner);
+    SIM_Destroy(world);
+}
+
+static bool initStats(TournamentStats* stats, uint32_t curveSamples) {
+    memset(stats, 0, sizeof(TournamentStats));
+    for (int p = 0; p < SIM_MAX_PLAYERS; p++) {
+        HISTOGRAM_Init(&stats->decisionLatency[p]);
+    }
+    stats->hpCurve = (uint64_t*)calloc((size_t)curveSamples * SIM_MAX_PLAYERS, sizeof(uint64_t));
+    return stats->hpCurve != NULL;
+}
+
+static void mergeStats(TournamentStats* destination, const TournamentStats* source, uint32_t curveSamples) {
+    destination->matches += source->matches;
+    for (int p = 0; p < SIM_MAX_PLAYERS; p++) {
+        destination->wins[p] += source->wins[p];
+        destination->survivedTicks[p] += source->survivedTicks[p];
+        destination->finalHp[p] += source->finalHp[p];
+        destination->transistorsEaten[p] += source->transistorsEaten[p];
+        destination->playersEaten[p] += source->playersEaten[p];
+        destination->sparkHits[p] += source->sparkHits[p];
+        HISTOGRAM_Merge(&destination->decisionLatency[p], &source->decisionLatency[p]);
+    }
+    for (size_t i = 0; i < (size_t)curveSamples * SIM_MAX_PLAYERS; i++) {
+        destination->hpCurve[i] += source->hpCurve[i];
+    }
+}
+
+static bool writeSummary(const char* path, const Tournament* tournament, const TournamentStats* stats,
+                         double seconds) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return false;
+    }
+    const SIM_Config* config = &tournament->config;
+    const double matches = stats->matches > 0 ? (double)stats->matches : 1.0;
+    fprintf(file, "# mniam_tournament summary\n");
+    fprintf(file, "matches %llu\nplayers %u\nticks %u\nseed %u\nthreads %d\nseconds %.3f\n\n",
+            (unsigned long long)stats->matches, config->playerCount, config->maxTicks, config->seed,
+            tournament->workerCount, seconds);
+
+    fprintf(file, "# player win_rate mean_survived_ticks mean_final_hp mean_transistors mean_players_eaten "
+                  "mean_spark_hits decision_p50_ns decision_p99_ns decision_max_ns\n");
+    for (uint32_t p = 0; p < config->playerCount; p++) {
+        const HISTOGRAM_Histogram* latency = &stats->decisionLatency[p];
+        fprintf(file, "player %u %.4f %.1f %.2f %.2f %.3f %.2f %llu %llu %llu\n", p, stats->wins[p] / matches,
+                stats->survivedTicks[p] / matches, stats->finalHp[p] / matches,
+                stats->transistorsEaten[p] / matches, stats->playersEaten[p] / matches,
+                stats->sparkHits[p] / matches, (unsigned long long)HISTOGRAM_Percentile(latency, 0.50),
+                (unsigned long long)HISTOGRAM_Percentile(latency, 0.99), (unsigned long long)latency->max);
+    }
+
+    fprintf(file, "\n# hp_curve tick mean_hp_of_every_player\n");
+    for (uint32_t s = 0; s < tournament->curveSamples; s++) {
+        fprintf(file, "hp %u", s * tournament->curveStep);
+        for (uint32_t p = 0; p < config->playerCount; p++) {
+            fprintf(file, " %.3f", stats->hpCurve[(size_t)s * SIM_MAX_PLAYERS + p] / matches);
+        }
+        fprintf(file, "\n");
+    }
+
+    for (uint32_t p = 0; p < config->playerCount; p++) {
+        fprintf(file, "\n# decision_latency player %u: upper_bound_ns count\n", p);
+        HISTOGRAM_Write(&stats->decisionLatency[p], file);
+    }
+    return fclose(file) == 0;
+}
+
+static void printUsage(const char* program) {
+    printf("Usage: %s [--matches M] [--threads T] [--players N] [--ticks T] [--seed S] [--curve-step K] "
+           "[--params FILE]... [--planner-depth D] [--field] [--paths] [--summary FILE]\n", program);
+    printf("  --matches M     number of matches (default %d)\n", DEFAULT_MATCHES);
+    printf("  --threads T     number of worker threads (default: one per CPU)\n");
+    printf("  --players N     players in a match (1..%d, default 2)\n", SIM_MAX_PLAYERS);
+    printf("  --ticks T       length of a match in ticks (default 1000)\n");
+    printf("  --seed S        seed of the maps (default 1)\n");
+    printf("  --curve-step K  ticks between the samples of the HP curve (default %d)\n", DEFAULT_CURVE_STEP);
+    printf("  --params FILE   strategy parameters of the next player (default: the defaults)\n");
+    printf("  --planner-depth D  player 0 plans its moves D ticks ahead (1..%d, default: greedy decisions)\n",
+           PLANNER_DEFAULT_DEPTH);
+    printf("  --field         player 0 moves along the gradient of the potential field\n");
+    printf("  --paths         player 0 routes to its targets around glue and sparks\n");
+    printf("  --summary FILE  summary file (default %s)\n", DEFAULT_SUMMARY);
+}
+
+int main(int argc, char** argv) {
+    Tournament tournament;
+    SIM_DefaultConfig(&tournament.config);
+    tournament.curveStep = DEFAULT_CURVE_STEP;
+    tournament.plannerDepth = 0;
+    tournament.fieldSteering = false;
+    tournament.pathfinding = false;
+    int matchCount = DEFAULT_MATCHES;
+    int threadCount = 0;
+    const char* summaryPath = DEFAULT_SUMMARY;
+    uint32_t paramsCount = 0;
+    for (int p = 0; p < SIM_MAX_PLAYERS; p++) {
+        PARAMS_Default(&tournament.params[p]);
+    }
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--matches") == 0 && i + 1 < argc) {
+            matchCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--players") == 0 && i + 1 < argc) {
+            tournament.config.playerCount = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            tournament.config.maxTicks = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            tournament.config.seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--curve-step") == 0 && i + 1 < argc) {
+            tournament.curveStep = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--params") == 0 && i + 1 < argc && paramsCount < SIM_MAX_PLAYERS) {
+            if (PARAMS_FIXED) {
+                printf("The strategy parameters are compiled into this build, --params is not available\n");
+                return 1;
+            }
+            if (!PARAMS_Load(argv[++i], &tournament.params[paramsCount++])) {
+                printf("Unable to load strategy parameters from %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--planner-depth") == 0 && i + 1 < argc) {
+            tournament.plannerDepth = (uint32_t)atoi(argv[++i]);
+            if (tournament.plannerDepth < 1 || tournament.plannerDepth > PLANNER_DEFAULT_DEPTH) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--field") == 0) {
+            tournament.fieldSteering = true;
+        } else if (strcmp(argv[i], "--paths") == 0) {
+            tournament.pathfinding = true;
+        } else if (strcmp(argv[i], "--summary") == 0 && i + 1 < argc) {
+            summaryPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    // the configuration is validated by SIM_Create
+    SIM_World* check = SIM_Create(&tournament.config);
+    if (check == NULL || matchCount < 1 || threadCount < 0 || tournament.curveStep < 1) {
+        printUsage(argv[0]);
+        SIM_Destroy(check);
+        return 1;
+    }
+    SIM_Destroy(check);
+    const int cpuCount = PLATFORM_CpuCount();
+    if (threadCount == 0) {
+        threadCount = cpuCount;
+    }
+    if (threadCount > matchCount) {
+        threadCount = matchCount;
+    }
+    tournament.curveSamples = tournament.config.maxTicks / tournament.curveStep + 1;
+    tournament.workerCount = threadCount;
+    tournament.workers = (TournamentWorker*)PLATFORM_AlignedAlloc((size_t)threadCount * sizeof(TournamentWorker), 64);
+    TournamentStats total;
+    if (tournament.workers == NULL || !initStats(&total, tournament.curveSamples)) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    for (int w = 0; w < threadCount; w++) {
+        TournamentWorker* worker = &tournament.workers[w];
+        worker->tournament = &tournament;
+        worker->index = w;
+        worker->cpu = (threadCount > 1 && threadCount <= cpuCount) ? w : -1;
+        worker->steals = 0;
+        atomic_init(&worker->range, packRange((uint32_t)((uint64_t)matchCount * w / threadCount),
+                                              (uint32_t)((uint64_t)matchCount * (w + 1) / threadCount)));
+        if (!initStats(&worker->stats, tournament.curveSamples)) {
+            printf("Out of memory\n");
+            return 1;
+        }
+    }
+
+    uint64_t start = PLATFORM_NowNs();
+    if (threadCount == 1) {
+        runWorker(&tournament.workers[0]);
+    } else {
+        for (int w = 0; w < threadCount; w++) {
+            if (!PLATFORM_StartThread(&tournament.workers[w].thread, runWorker, &tournament.workers[w])) {
+                // the matches of the worker are stolen by the others
+                printf("Unable to start worker thread %d\n", w);
+                tournament.workers[w].thread.handle = 0;
+            }
+        }
+        for (int w = 0; w < threadCount; w++) {
+            if (tournament.workers[w].thread.handle != 0) {
+                PLATFORM_JoinThread(&tournament.workers[w].thread);
+            }
+        }
+    }
+    uint64_t elapsed = PLATFORM_NowNs() - start;
+
+    uint64_t steals = 0;
+    for (int w = 0; w < threadCount; w++) {
+        mergeStats(&total, &tournament.workers[w].stats, tournament.curveSamples);
+        steals += tournament.workers[w].steals;
+        free(tournament.workers[w].stats.hpCurve);
+    }
+    const double matches = total.matches > 0 ? (double)total.matches : 1.0;
+    printf("Matches: %llu of %d, threads: %d, steals: %llu, %.3f s (%.1f matches/s)\n",
+           (unsigned long long)total.matches, matchCount, threadCount, (unsigned long long)steals, elapsed / 1e9,
+           elapsed > 0 ? total.matches * 1e9 / elapsed : 0.0);
+    for (uint32_t p = 0; p < tournament.config.playerCount; p++) {
+        const HISTOGRAM_Histogram* latency = &total.decisionLatency[p];
+        printf("  player %u: win rate %.1f%%, survived %.1f ticks, final hp %.2f, decision p99 %.1f us\n", p,
+               100.0 * total.wins[p] / matches, total.survivedTicks[p] / matches, total.finalHp[p] / matches,
+               HISTOGRAM_Percentile(latency, 0.99) / 1e3);
+    }
+    bool written = writeSummary(summaryPath, &tournament, &total, elapsed / 1e9);
+    if (!written) {
+        printf("Unable to write %s\n", summaryPath);
+    }
+
+    free(total.hpCurve);
+    PLATFORM_AlignedFree(tournament.workers);
+    return (written && total.matches == (uint64_t)matchCount) ? 0 : 1;
+}
@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+#include "amcom_packets.h"
+
+/// Smallest allowed block size
+#define TRACE_MIN_BLOCK_SIZE 1024
+
+struct TRACE_Recorder {
+	FILE* file;                     ///< trace file (unbuffered, every write is one whole block)
+	TRACE_FileHeader header;        ///< file header, rewritten on close
+	uint8_t* block;                 ///< block being filled
+	uint32_t used;                  ///< bytes used in the block
+	uint32_t recordCount;           ///< records in the block
+	uint64_t firstKey;              ///< key of the first record in the block
+	uint64_t lastKey;               ///< key of the last record in the block
+	TRACE_IndexEntry* index;        ///< index entries of the written blocks
+	uint32_t blockCount;            ///< number of written blocks
+	uint32_t indexCapacity;         ///< allocated length of index
+	uint16_t game;                  ///< current game number
+	uint32_t gameTime;              ///< game time of the last MOVE.request
+	bool failed;                    ///< a write failed, recording stopped
+};
+
+/// Size of a record with the given number of packet bytes, including the padding
+static uint32_t TRACE_RecordSize(uint32_t packetSize) {
+	uint32_t size = (uint32_t)sizeof(TRACE_RecordHeader) + packetSize;
+	return (size + TRACE_RECORD_ALIGNMENT - 1) & ~(uint32_t)(TRACE_RECORD_ALIGNMENT - 1);
+}
+
+/// Writes the block being filled to the file and adds it to the index
+static void TRACE_FlushBlock(TRACE_Recorder* recorder) {
+	if(recorder->recordCount == 0 || recorder->failed){
+	    return;
+	}
+	if(recorder->blockCount == recorder->indexCapacity){
+	    uint32_t capacity = recorder->indexCapacity ? recorder->indexCapacity * 2 : 64;
+	    TRACE_IndexEntry* index = (TRACE_IndexEntry*)realloc(recorder->index, capacity * sizeof(TRACE_IndexEntry));
+	    if(index == NULL){
+	        recorder->failed = true;
+	        return;
+	    }
+	    recorder->index = index;
+	    recorder->indexCapacity = capacity;
+	}
+	TRACE_BlockHeader blockHeader = { TRACE_BLOCK_MAGIC, recorder->recordCount, recorder->used, 0,
+	                                  recorder->firstKey, recorder->lastKey };
+	memcpy(recorder->block, &blockHeader, sizeof(blockHeader));
+	memset(recorder->block + recorder->used, 0, recorder->header.blockSize - recorder->used);
+	if(fwrite(recorder->block, recorder->header.blockSize, 1, recorder->file) != 1){
+	    recorder->failed = true;
+	    return;
+	}
+	recorder->index[recorder->blockCount].firstKey = recorder->firstKey;
+	recorder->index[recorder->blockCount].lastKey = recorder->lastKey;
+	recorder->blockCount++;
+	recorder->used = sizeof(TRACE_BlockHeader);
+	recorder->recordCount = 0;
+}
+
+TRACE_Recorder* TRACE_CreateRecorder(const char* path, uint32_t blockSize) {
+	if(blockSize == 0){
+	    blockSize = TRACE_DEFAULT_BLOCK_SIZE;
+	}
+	if(blockSize < TRACE_MIN_BLOCK_SIZE){
+	    return NULL;
+	}
+	blockSize &= ~(uint32_t)(TRACE_RECORD_ALIGNMENT - 1);
+	TRACE_Recorder* recorder = (TRACE_Recorder*)calloc(1, sizeof(TRACE_Recorder));
+	if(recorder == NULL){
+	    return NULL;
+	}
+	recorder->block = (uint8_t*)malloc(blockSize);
+	recorder->file = fopen(path, "wb");
+	if(recorder->block == NULL || recorder->file == NULL){
+	    if(recorder->file != NULL) fclose(recorder->file);
+	    free(recorder->block);
+	    free(recorder);
+	    return NULL;
+	}
+	// whole blocks are written at once, stdio buffering would only add a copy
+	setvbuf(recorder->file, NULL, _IONBF, 0);
+	memcpy(recorder->header.magic, TRACE_MAGIC, sizeof(recorder->header.magic));
+	recorder->header.version = TRACE_VERSION;
+	recorder->header.blockSize = blockSize;
+	recorder->header.startTimeNs = PLATFORM_NowNs();
+	recorder->used = sizeof(TRACE_BlockHeader);
+	if(fwrite(&recorder->header, sizeof(recorder->header), 1, recorder->file) != 1){
+	    recorder->failed = true;
+	}
+	return recorder;
+}
+
+void TRACE_Record(TRACE_Recorder* recorder, TRACE_Direction direction, uint64_t timestampNs,
+                  const AMCOM_PacketHeader* header, const uint8_t* payload) {
+	if(recorder == NULL || recorder->failed){
+	    return;
+	}
+	if(direction == TRACE_INBOUND){
+	    if(header->type == AMCOM_NEW_GAME_REQUEST){
+	        recorder->game++;
+	        recorder->gameTime = 0;
+	    } else if(header->type == AMCOM_MOVE_REQUEST && header->length >= sizeof(AMCOM_MoveRequestPayload)){
+	        memcpy(&recorder->gameTime, payload, sizeof(recorder->gameTime));
+	    }
+	}
+	uint32_t packetSize = (uint32_t)sizeof(AMCOM_PacketHeader) + header->length;
+	uint32_t recordSize = TRACE_RecordSize(packetSize);
+	if(recorder->used + recordSize > recorder->header.blockSize){
+	    TRACE_FlushBlock(recorder);
+	    if(recorder->failed){
+	        return;
+	    }
+	}
+	uint64_t key = TRACE_Key(recorder->game, recorder->gameTime);
+	if(recorder->recordCount == 0){
+	    recorder->firstKey = key;
+	}
+	recorder->lastKey = key;
+	recorder->recordCount++;
+
+	TRACE_RecordHeader recordHeader = { timestampNs, recorder->gameTime, recorder->game,
+	                                    (uint8_t)direction, (uint8_t)packetSize };
+	uint8_t* record = recorder->block + recorder->used;
+	memcpy(record, &recordHeader, sizeof(recordHeader));
+	memcpy(record + sizeof(recordHeader), header, sizeof(AMCOM_PacketHeader));
+	if(header->length > 0){
+	    memcpy(record + sizeof(recordHeader) + sizeof(AMCOM_PacketHeader), payload, header->length);
+	}
+	memset(record + sizeof(recordHeader) + packetSize, 0, recordSize - sizeof(recordHeader) - packetSize);
+	recorder->used += recordSize;
+}
+
+bool TRACE_CloseRecorder(TRACE_Recorder* recorder) {
+	if(recorder == NULL){
+	    return true;
+	}
+	TRACE_FlushBlock(recorder);
+	if(!recorder->failed && recorder->blockCount > 0){
+	    uint64_t indexOffset = sizeof(TRACE_FileHeader) + (uint64_t)recorder->blockCount * recorder->header.blockSize;
+	    if(fwrite(recorder->index, sizeof(TRACE_IndexEntry), recorder->blockCount, recorder->file) != recorder->blockCount ||
+	       fseek(recorder->file, 0, SEEK_SET) != 0){
+	        recorder->failed = true;
+	    } else {
+	        recorder->header.indexOffset = indexOffset;
+	        recorder->header.blockCount = recorder->blockCount;
+	        if(fwrite(&recorder->header, sizeof(recorder->header), 1, recorder->file) != 1){
+	            recorder->failed = true;
+	        }
+	    }
+	}
+	bool success = (fclose(recorder->file) == 0) && !recorder->failed;
+	free(recorder->index);
+	free(recorder->block);
+	free(recorder);
+	return success;
+}
+
+bool TRACE_OpenReader(TRACE_Reader* reader, const char* path) {
+	memset(reader, 0, sizeof(TRACE_Reader));
+	if(!PLATFORM_MapFile(path, &reader->file)){
+	    return false;
+	}
+	const TRACE_FileHeader* header = (const TRACE_FileHeader*)reader->file.data;
+	if(reader->file.size < sizeof(TRACE_FileHeader) || memcmp(header->magic, TRACE_MAGIC, sizeof(header->magic)) != 0 ||
+	   header->version != TRACE_VERSION || header->blockSize < TRACE_MIN_BLOCK_SIZE ||
+	   header->blockSize % TRACE_RECORD_ALIGNMENT != 0){
+	    TRACE_CloseReader(reader);
+	    return false;
+	}
+	reader->header = header;
+	reader->blockSize = header->blockSize;
+	uint64_t blocksInFile = (reader->file.size - sizeof(TRACE_FileHeader)) / header->blockSize;
+	if(header->indexOffset != 0 && header->blockCount <= blocksInFile &&
+	   header->indexOffset + (uint64_t)header->blockCount * sizeof(TRACE_IndexEntry) <= reader->file.size){
+	    reader->index = (const TRACE_IndexEntry*)(reader->file.data + header->indexOffset);
+	    reader->blockCount = header->blockCount;
+	} else {
+	    // the recorder did not finish - use the complete blocks
+	    reader->blockCount = (uint32_t)blocksInFile;
+	}
+	return true;
+}
+
+void TRACE_CloseReader(TRACE_Reader* reader) {
+	PLATFORM_UnmapFile(&reader->file);
+	memset(reader, 0, sizeof(TRACE_Reader));
+}
+
+static const TRACE_BlockHeader* TRACE_GetBlock(const TRACE_Reader* reader, uint32_t block) {
+	return (const TRACE_BlockHeader*)(reader->file.data + sizeof(TRACE_FileHeader) + (uint64_t)block * reader->blockSize);
+}
+
+/// Last key of a block, from the index when there is one
+static uint64_t TRACE_LastKey(const TRACE_Reader* reader, uint32_t block) {
+	if(reader->index != NULL){
+	    return reader->index[block].lastKey;
+	}
+	const TRACE_BlockHeader* header = TRACE_GetBlock(reader, block);
+	return (header->magic == TRACE_BLOCK_MAGIC) ? header->lastKey : UINT64_MAX;
+}
+
+TRACE_Cursor TRACE_Begin(const TRACE_Reader* reader) {
+	(void)reader;
+	TRACE_Cursor cursor = { 0, 0 };
+	return cursor;
+}
+
+TRACE_Cursor TRACE_Seek(const TRACE_Reader* reader, uint16_t game, uint32_t gameTime) {
+	uint64_t key = TRACE_Key(game, gameTime);
+	// first block whose last key is >= key
+	uint32_t low = 0, high = reader->blockCount;
+	while(low < high){
+	    uint32_t middle = low + (high - low) / 2;
+	    if(TRACE_LastKey(reader, middle) < key){
+	        low = middle + 1;
+	    } else {
+	        high = middle;
+	    }
+	}
+	TRACE_Cursor cursor = { low, 0 };
+	TRACE_Cursor previous = cursor;
+	TRACE_Packet packet;
+	while(TRACE_Next(reader, &cursor, &packet)){
+	    if(TRACE_Key(packet.game, packet.gameTime) >= key){
+	        return previous;
+	    }
+	    previous = cursor;
+	}
+	return cursor;
+}
+
+bool TRACE_Next(const TRACE_Reader* reader, TRACE_Cursor* cursor, TRACE_Packet* packet) {
+	while(cursor->block < reader->blockCount){
+	    const TRACE_BlockHeader* block = TRACE_GetBlock(reader, cursor->block);
+	    if(block->magic != TRACE_BLOCK_MAGIC || block->usedBytes > reader->blockSize){
+	        break;
+	    }
+	    if(cursor->offset < sizeof(TRACE_BlockHeader)){
+	        cursor->offset = sizeof(TRACE_BlockHeader);
+	    }
+	    if(cursor->offset + sizeof(TRACE_RecordHeader) > block->usedBytes){
+	        cursor->block++;
+	        cursor->offset = 0;
+	        continue;
+	    }
+	    const uint8_t* record = (const uint8_t*)block + cursor->offset;
+	    const TRACE_RecordHeader* header = (const TRACE_RecordHeader*)record;
+	    uint32_t recordSize = TRACE_RecordSize(header->size);
+	    if(cursor->offset + recordSize > block->usedBytes){
+	        break;
+	    }
+	    packet->timestampNs = header->timestampNs;
+	    packet->gameTime = header->gameTime;
+	    packet->game = header->game;
+	    packet->direction = (TRACE_Direction)header->direction;
+	    packet->data = record + sizeof(TRACE_RecordHeader);
+	    packet->size = header->size;
+	    cursor->offset += recordSize;
+	    return true;
+	}
+	// end of the trace (or a damaged block, which ends it too)
+	cursor->block = reader->blockCount;
+	cursor->offset = 0;
+	return false;
+}
@@ -0,0 +1,207 @@
+#ifndef TRACE_H_
+#define TRACE_H_
+
+/**
+ * Binary trace of the AMCOM packets exchanged with the game server, for offline analysis and replay.
+ *
+ * File layout (all fields little-endian and naturally aligned, so the file can be read in place through mmap):
+ *
+ * +--------------------+-----------------+-----------------+-----+-----------------+---------------+
+ * | TRACE_FileHeader   | block 0         | block 1         | ... | block N-1       | index         |
+ * | 64B                | blockSize bytes | blockSize bytes |     | blockSize bytes | N entries     |
+ * +--------------------+-----------------+-----------------+-----+-----------------+---------------+
+ *
+ * Every block starts with a TRACE_BlockHeader followed by records; a record is a TRACE_RecordHeader followed by
+ * the raw packet bytes (header and payload), padded to TRACE_RECORD_ALIGNMENT. The unused tail of a block is
+ * zero. The index (one TRACE_IndexEntry per block) is appended when the recorder is closed and its offset is
+ * stored in the file header. Because blocks have a fixed size, a trace cut short by a crash (no index) can still
+ * be searched by reading the block headers at their fixed offsets.
+ *
+ * Records are ordered by their key: the number of the game in the trace (counted from NEW_GAME.request) and the
+ * game time of the last MOVE.request, so seeking to a game time is a binary search over the blocks followed by
+ * a scan of one block.
+ *
+ * The recorder fills one block in memory and writes it with a single call when it is full, so recording a packet
+ * is a copy and costs no system call.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "amcom.h"
+#include "platform.h"
+
+/// Magic bytes at the start of a trace file
+#define TRACE_MAGIC "MNIAMTRC"
+/// Version of the file format
+#define TRACE_VERSION 1
+/// Magic value at the start of every block ("BLK1")
+#define TRACE_BLOCK_MAGIC 0x314B4C42u
+/// Records start at multiples of this many bytes within a block
+#define TRACE_RECORD_ALIGNMENT 8
+/// Default size of a block
+#define TRACE_DEFAULT_BLOCK_SIZE 65536
+
+/** Direction of a recorded packet */
+typedef enum {
+	TRACE_INBOUND = 0,      ///< received from the game server
+	TRACE_OUTBOUND = 1      ///< sent to the game server
+} TRACE_Direction;
+
+/** Header at the start of the file */
+typedef struct {
+	char magic[8];              ///< TRACE_MAGIC
+	uint32_t version;           ///< TRACE_VERSION
+	uint32_t blockSize;         ///< size of every block in bytes
+	uint64_t startTimeNs;       ///< monotonic time at which recording started
+	uint64_t indexOffset;       ///< offset of the block index, 0 if the recorder was not closed
+	uint32_t blockCount;        ///< number of blocks (valid when indexOffset != 0)
+	uint32_t reserved[7];
+} TRACE_FileHeader;
+static_assert(64 == sizeof(TRACE_FileHeader), "64 != sizeof(TRACE_FileHeader)");
+
+/** Header at the start of every block */
+typedef struct {
+	uint32_t magic;             ///< TRACE_BLOCK_MAGIC
+	uint32_t recordCount;       ///< number of records in the block
+	uint32_t usedBytes;         ///< bytes used by the header and the records
+	uint32_t reserved;
+	uint64_t firstKey;          ///< key of the first record
+	uint64_t lastKey;           ///< key of the last record
+} TRACE_BlockHeader;
+static_assert(32 == sizeof(TRACE_BlockHeader), "32 != sizeof(TRACE_BlockHeader)");
+
+/** Header of every record */
+typedef struct {
+	uint64_t timestampNs;       ///< monotonic time at which the packet was received or sent
+	uint32_t gameTime;          ///< game time of the last MOVE.request
+	uint16_t game;              ///< number of NEW_GAME.request packets up to and including this packet
+	uint8_t direction;          ///< TRACE_Direction
+	uint8_t size;               ///< number of packet bytes following the header
+} TRACE_RecordHeader;
+static_assert(16 == sizeof(TRACE_RecordHeader), "16 != sizeof(TRACE_RecordHeader)");
+
+/** Entry of the block index */
+typedef struct {
+	uint64_t firstKey;          ///< key of the first record in the block
+	uint64_t lastKey;           ///< key of the last record in the block
+} TRACE_IndexEntry;
+static_assert(16 == sizeof(TRACE_IndexEntry), "16 != sizeof(TRACE_IndexEntry)");
+
+/** Packet read from a trace */
+typedef struct {
+	uint64_t timestampNs;       ///< monotonic time at which the packet was received or sent
+	uint32_t gameTime;          ///< game time of the last MOVE.request
+	uint16_t game;              ///< game number within the trace
+	TRACE_Direction direction;  ///< direction of the packet
+	const uint8_t* data;        ///< packet bytes (header and payload), valid while the reader is open
+	size_t size;                ///< number of packet bytes
+} TRACE_Packet;
+
+/** Opaque structure of the recorder */
+typedef struct TRACE_Recorder TRACE_Recorder;
+
+/** Structure of the reader of a mapped trace */
+typedef struct {
+	PLATFORM_MappedFile file;         ///< mapped trace file
+	const TRACE_FileHeader* header;   ///< file header
+	const TRACE_IndexEntry* index;    ///< block index, NULL if the trace was not closed properly
+	uint32_t blockSize;               ///< size of every block
+	uint32_t blockCount;              ///< number of complete blocks in the file
+} TRACE_Reader;
+
+/** Position of the next packet returned by @ref TRACE_Next */
+typedef struct {
+	uint32_t block;             ///< block of the next record
+	uint32_t offset;            ///< offset of the next record within the block
+} TRACE_Cursor;
+
+/**
+ * @brief Builds the key under which records are ordered.
+ */
+static inline uint64_t TRACE_Key(uint16_t game, uint32_t gameTime) {
+	return ((uint64_t)game << 32) | gameTime;
+}
+
+/**
+ * @brief Creates a trace file and starts recording.
+ *
+ * @param path path of the file (overwritten if it exists)
+ * @param blockSize size of a block in bytes (0 selects TRACE_DEFAULT_BLOCK_SIZE, at least 1024)
+ *
+ * @return the recorder or NULL if the file could not be created
+ */
+TRACE_Recorder* TRACE_CreateRecorder(const char* path, uint32_t blockSize);
+
+/**
+ * @brief Appends one packet to the trace.
+ *
+ * NEW_GAME.request and MOVE.request packets also advance the game number and the game time of the recorder.
+ * After a write error the recorder stops recording (see @ref TRACE_CloseRecorder).
+ *
+ * @param recorder recorder (NULL is ignored)
+ * @param direction direction of the packet
+ * @param timestampNs monotonic time at which the packet was received or sent
+ * @param header header of the packet
+ * @param payload payload of the packet (header->length bytes)
+ */
+void TRACE_Record(TRACE_Recorder* recorder, TRACE_Direction direction, uint64_t timestampNs,
+                  const AMCOM_PacketHeader* header, const uint8_t* payload);
+
+/**
+ * @brief Writes the last block and the index, then closes the file and releases the recorder.
+ *
+ * @param recorder recorder (NULL is ignored)
+ *
+ * @return true if the whole trace was written successfully
+ */
+bool TRACE_CloseRecorder(TRACE_Recorder* recorder);
+
+/**
+ * @brief Maps a trace file for reading.
+ *
+ * @param reader reader to initialize
+ * @param path path of the trace file
+ *
+ * @return true if the file is a valid trace
+ */
+bool TRACE_OpenReader(TRACE_Reader* reader, const char* path);
+
+/**
+ * @brief Unmaps the trace file.
+ */
+void TRACE_CloseReader(TRACE_Reader* reader);
+
+/**
+ * @brief Returns a cursor at the first packet of the trace.
+ */
+TRACE_Cursor TRACE_Begin(const TRACE_Reader* reader);
+
+/**
+ * @brief Returns a cursor at the first packet whose key is >= TRACE_Key(game, gameTime).
+ *
+ * Binary search over the blocks (through the index, or the block headers if there is none) and a scan of one
+ * block.
+ */
+TRACE_Cursor TRACE_Seek(const TRACE_Reader* reader, uint16_t game, uint32_t gameTime);
+
+/**
+ * @brief Reads the packet at the cursor and advances the cursor.
+ *
+ * @param reader reader of the trace
+ * @param cursor position of the packet, updated
+ * @param packet filled with the packet
+ *
+ * @return false at the end of the trace
+ */
+bool TRACE_Next(const TRACE_Reader* reader, TRACE_Cursor* cursor, TRACE_Packet* packet);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,166 @@
+#ifndef TRANSPORT_H_
+#define TRANSPORT_H_
+
+/**
+ * This header file defines a small, platform independent TCP transport used by the mniAM player.
+ *
+ * Two back ends implement it:
+ *  - transport_posix.c   - BSD sockets + epoll (Linux)
+ *  - transport_winsock.c - Winsock 2 + WSAPoll (Windows)
+ *
+ * The back end is selected at configure time (see MNIAM_TRANSPORT in CMakeLists.txt). All connections are
+ * non-blocking and have Nagle's algorithm disabled (TCP_NODELAY), because the game protocol consists of small
+ * request/response packets where latency matters more than throughput.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/// Value of TRANSPORT_Connection.handle for a connection that is not open
+#define TRANSPORT_INVALID_HANDLE ((uintptr_t)-1)
+
+/** Special return values of @ref TRANSPORT_Receive */
+enum {
+	/// Receiving failed, use @ref TRANSPORT_LastError for details
+	TRANSPORT_ERROR = -1,
+	/// No data is available right now (the connection is non-blocking)
+	TRANSPORT_WOULD_BLOCK = -2
+};
+
+/** Structure describing a single TCP connection */
+typedef struct {
+	/// Native socket handle (SOCKET on Windows, file descriptor elsewhere)
+	uintptr_t handle;
+} TRANSPORT_Connection;
+
+/** Opaque structure of the readiness poller (epoll instance or WSAPoll set) */
+typedef struct TRANSPORT_Poller TRANSPORT_Poller;
+
+/**
+ * @brief Initializes the transport layer. Must be called once before any other function.
+ *
+ * @return true on success
+ */
+bool TRANSPORT_Init(void);
+
+/**
+ * @brief Releases the resources of the transport layer.
+ */
+void TRANSPORT_Cleanup(void);
+
+/**
+ * @brief Connects to the given host and port.
+ *
+ * The connection is established in blocking mode and then switched to non-blocking mode with TCP_NODELAY set.
+ * @param connection connection structure to initialize
+ * @param host host name or address of the server
+ * @param port port number or service name
+ *
+ * @return true if the connection was established
+ */
+bool TRANSPORT_Connect(TRANSPORT_Connection* connection, const char* host, const char* port);
+
+/**
+ * @brief Opens a listening socket on the given port (all local addresses).
+ *
+ * @param listener connection structure to initialize with the listening socket
+ * @param port port number or service name
+ *
+ * @return true if the socket is listening
+ */
+bool TRANSPORT_Listen(TRANSPORT_Connection* listener, const char* port);
+
+/**
+ * @brief Waits for an incoming connection and accepts it.
+ *
+ * The accepted connection is configured like the ones opened by @ref TRANSPORT_Connect (non-blocking, TCP_NODELAY).
+ * @param listener listening socket opened by @ref TRANSPORT_Listen
+ * @param connection connection structure to initialize
+ *
+ * @return true if a connection was accepted
+ */
+bool TRANSPORT_Accept(TRANSPORT_Connection* listener, TRANSPORT_Connection* connection);
+
+/**
+ * @brief Receives data that is available on the connection without blocking.
+ *
+ * @param connection open connection
+ * @param buffer place to store the received bytes
+ * @param bufferSize size of the buffer
+ *
+ * @return number of bytes received, 0 if the peer closed the connection, @ref TRANSPORT_WOULD_BLOCK if no data
+ * is available or @ref TRANSPORT_ERROR on failure
+ */
+int TRANSPORT_Receive(TRANSPORT_Connection* connection, void* buffer, size_t bufferSize);
+
+/**
+ * @brief Sends the whole buffer, waiting for the socket to become writable if the send buffer is full.
+ *
+ * @param connection open connection
+ * @param data bytes to send
+ * @param dataSize number of bytes to send
+ *
+ * @return true if all bytes were sent
+ */
+bool TRANSPORT_Send(TRANSPORT_Connection* connection, const void* data, size_t dataSize);
+
+/**
+ * @brief Closes the connection. Safe to call on a connection that is already closed.
+ */
+void TRANSPORT_Close(TRANSPORT_Connection* connection);
+
+/**
+ * @brief Returns the last transport error code (errno or WSAGetLastError()).
+ */
+int TRANSPORT_LastError(void);
+
+/**
+ * @brief Creates a poller that waits for incoming data on many connections.
+ *
+ * @return new poller or NULL on failure
+ */
+TRANSPORT_Poller* TRANSPORT_CreatePoller(void);
+
+/**
+ * @brief Destroys the poller. Connections registered in it are not closed.
+ */
+void TRANSPORT_DestroyPoller(TRANSPORT_Poller* poller);
+
+/**
+ * @brief Registers a connection in the poller.
+ *
+ * @param poller poller instance
+ * @param connection connection to watch for incoming data
+ * @param userData pointer reported back by @ref TRANSPORT_PollerWait when the connection is readable
+ *
+ * @return true on success
+ */
+bool TRANSPORT_PollerAdd(TRANSPORT_Poller* poller, TRANSPORT_Connection* connection, void* userData);
+
+/**
+ * @brief Removes a connection from the poller. Must be called before the connection is closed.
+ */
+void TRANSPORT_PollerRemove(TRANSPORT_Poller* poller, TRANSPORT_Connection* connection);
+
+/**
+ * @brief Waits until at least one registered connection is readable (or was closed by the peer).
+ *
+ * @param poller poller instance
+ * @param readyUserData array filled with the userData of the ready connections
+ * @param maxReady capacity of the readyUserData array
+ * @param timeoutMs maximum time to wait in milliseconds, -1 to wait forever
+ *
+ * @return number of entries written to readyUserData, 0 on timeout or -1 on failure
+ */
+int TRANSPORT_PollerWait(TRANSPORT_Poller* poller, void** readyUserData, int maxReady, int timeoutMs);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* TRANSPORT_H_ */
@@ -0,0 +1,265 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "transport.h"
+
+/// Maximum number of epoll events fetched by one TRANSPORT_PollerWait call
+#define TRANSPORT_MAX_EPOLL_EVENTS 64
+
+struct TRANSPORT_Poller {
+	int epollFd;
+};
+
+static _Thread_local int lastError = 0;
+
+bool TRANSPORT_Init(void) {
+	return true;
+}
+
+void TRANSPORT_Cleanup(void) {
+}
+
+/// Switches a connected socket to non-blocking mode with TCP_NODELAY and stores it in the connection
+static bool TRANSPORT_Configure(TRANSPORT_Connection* connection, int fd) {
+	int flag = 1;
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+	int flags = fcntl(fd, F_GETFL, 0);
+	if(flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0){
+	    lastError = errno;
+	    close(fd);
+	    return false;
+	}
+	connection->handle = (uintptr_t)fd;
+	return true;
+}
+
+bool TRANSPORT_Connect(TRANSPORT_Connection* connection, const char* host, const char* port) {
+	if(connection == NULL || host == NULL || port == NULL){
+	    return false;
+	}
+	connection->handle = TRANSPORT_INVALID_HANDLE;
+
+	struct addrinfo hints, *result = NULL, *ptr = NULL;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+
+	int iResult = getaddrinfo(host, port, &hints, &result);
+	if(iResult != 0){
+	    lastError = iResult;
+	    return false;
+	}
+
+	int fd = -1;
+	for(ptr = result; ptr != NULL; ptr = ptr->ai_next){
+	    fd = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
+	    if(fd < 0){
+	        lastError = errno;
+	        continue;
+	    }
+	    if(connect(fd, ptr->ai_addr, ptr->ai_addrlen) != 0){
+	        lastError = errno;
+	        close(fd);
+	        fd = -1;
+	        continue;
+	    }
+	    break;
+	}
+	freeaddrinfo(result);
+	if(fd < 0){
+	    return false;
+	}
+
+	return TRANSPORT_Configure(connection, fd);
+}
+
+bool TRANSPORT_Listen(TRANSPORT_Connection* listener, const char* port) {
+	if(listener == NULL || port == NULL){
+	    return false;
+	}
+	listener->handle = TRANSPORT_INVALID_HANDLE;
+
+	struct addrinfo hints, *result = NULL;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+	hints.ai_flags = AI_PASSIVE;
+
+	int iResult = getaddrinfo(NULL, port, &hints, &result);
+	if(iResult != 0){
+	    lastError = iResult;
+	    return false;
+	}
+	int fd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+	if(fd < 0){
+	    lastError = errno;
+	    freeaddrinfo(result);
+	    return false;
+	}
+	int flag = 1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+	if(bind(fd, result->ai_addr, result->ai_addrlen) != 0 || listen(fd, SOMAXCONN) != 0){
+	    lastError = errno;
+	    close(fd);
+	    freeaddrinfo(result);
+	    return false;
+	}
+	freeaddrinfo(result);
+	listener->handle = (uintptr_t)fd;
+	return true;
+}
+
+bool TRANSPORT_Accept(TRANSPORT_Connection* listener, TRANSPORT_Connection* connection) {
+	if(listener == NULL || connection == NULL || listener->handle == TRANSPORT_INVALID_HANDLE){
+	    return false;
+	}
+	connection->handle = TRANSPORT_INVALID_HANDLE;
+	int fd;
+	do {
+	    fd = accept((int)listener->handle, NULL, NULL);
+	} while(fd < 0 && errno == EINTR);
+	if(fd < 0){
+	    lastError = errno;
+	    return false;
+	}
+	return TRANSPORT_Configure(connection, fd);
+}
+
+int TRANSPORT_Receive(TRANSPORT_Connection* connection, void* buffer, size_t bufferSize) {
+	if(connection == NULL || connection->handle == TRANSPORT_INVALID_HANDLE){
+	    return TRANSPORT_ERROR;
+	}
+	for(;;){
+	    ssize_t received = recv((int)connection->handle, buffer, bufferSize, 0);
+	    if(received >= 0){
+	        return (int)received;
+	    }
+	    if(errno == EINTR){
+	        continue;
+	    }
+	    if(errno == EAGAIN || errno == EWOULDBLOCK){
+	        return TRANSPORT_WOULD_BLOCK;
+	    }
+	    lastError = errno;
+	    return TRANSPORT_ERROR;
+	}
+}
+
+bool TRANSPORT_Send(TRANSPORT_Connection* connection, const void* data, size_t dataSize) {
+	if(connection == NULL || connection->handle == TRANSPORT_INVALID_HANDLE){
+	    return false;
+	}
+	const uint8_t* bytes = (const uint8_t*)data;
+	while(dataSize > 0){
+	    ssize_t sent = send((int)connection->handle, bytes, dataSize, MSG_NOSIGNAL);
+	    if(sent >= 0){
+	        bytes += sent;
+	        dataSize -= (size_t)sent;
+	        continue;
+	    }
+	    if(errno == EINTR){
+	        continue;
+	    }
+	    if(errno == EAGAIN || errno == EWOULDBLOCK){
+	        // send buffer is full - wait until the socket becomes writable
+	        struct pollfd pfd = { (int)connection->handle, POLLOUT, 0 };
+	        if(poll(&pfd, 1, -1) < 0 && errno != EINTR){
+	            lastError = errno;
+	            return false;
+	        }
+	        continue;
+	    }
+	    lastError = errno;
+	    return false;
+	}
+	return true;
+}
+
+void TRANSPORT_Close(TRANSPORT_Connection* connection) {
+	if(connection == NULL || connection->handle == TRANSPORT_INVALID_HANDLE){
+	    return;
+	}
+	close((int)connection->handle);
+	connection->handle = TRANSPORT_INVALID_HANDLE;
+}
+
+int TRANSPORT_LastError(void) {
+	return lastError;
+}
+
+TRANSPORT_Poller* TRANSPORT_CreatePoller(void) {
+	TRANSPORT_Poller* poller = (TRANSPORT_Poller*)malloc(sizeof(TRANSPORT_Poller));
+	if(poller == NULL){
+	    return NULL;
+	}
+	poller->epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if(poller->epollFd < 0){
+	    lastError = errno;
+	    free(poller);
+	    return NULL;
+	}
+	return poller;
+}
+
+void TRANSPORT_DestroyPoller(TRANSPORT_Poller* poller) {
+	if(poller == NULL){
+	    return;
+	}
+	close(poller->epollFd);
+	free(poller);
+}
+
+bool TRANSPORT_PollerAdd(TRANSPORT_Poller* poller, TRANSPORT_Connection* connection, void* userData) {
+	if(poller == NULL || connection == NULL || connection->handle == TRANSPORT_INVALID_HANDLE){
+	    return false;
+	}
+	struct epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN | EPOLLRDHUP;
+	event.data.ptr = userData;
+	if(epoll_ctl(poller->epollFd, EPOLL_CTL_ADD, (int)connection->handle, &event) != 0){
+	    lastError = errno;
+	    return false;
+	}
+	return true;
+}
+
+void TRANSPORT_PollerRemove(TRANSPORT_Poller* poller, TRANSPORT_Connection* connection) {
+	if(poller == NULL || connection == NULL || connection->handle == TRANSPORT_INVALID_HANDLE){
+	    return;
+	}
+	epoll_ctl(poller->epollFd, EPOLL_CTL_DEL, (int)connection->handle, NULL);
+}
+
+int TRANSPORT_PollerWait(TRANSPORT_Poller* poller, void** readyUserData, int maxReady, int timeoutMs) {
+	if(poller == NULL || readyUserData == NULL || maxReady <= 0){
+	    return -1;
+	}
+	struct epoll_event events[TRANSPORT_MAX_EPOLL_EVENTS];
+	if(maxReady > TRANSPORT_MAX_EPOLL_EVENTS){
+	    maxReady = TRANSPORT_MAX_EPOLL_EVENTS;
+	}
+	int ready;
+	do {
+	    ready = epoll_wait(poller->epollFd, events, maxReady, timeoutMs);
+	} while(ready < 0 && errno == EINTR);
+	if(ready < 0){
+	    lastError = errno;
+	    return -1;
+	}
+	for(int i = 0; i < ready; i++){
+	    readyUserData[i] = events[i].data.ptr;
+	}
+	return ready;
+}
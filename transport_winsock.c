@@ -0,0 +1,244 @@
+#undef UNICODE
+#define WIN32_LEAN_AND_MEAN
+
+#include <windows.h>
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <stdlib.h>
+#include <string.h>
+#include "transport.h"
+
+struct TRANSPORT_Poller {
+	WSAPOLLFD* fds;            ///< sockets watched by WSAPoll
+	void** userData;           ///< user data of each watched socket
+	size_t count;              ///< number of watched sockets
+	size_t capacity;           ///< allocated size of the arrays
+	size_t nextReady;          ///< round-robin start index, so that no connection is starved
+};
+
+bool TRANSPORT_Init(void) {
+	WSADATA wsaData;
+	return WSAStartup(MAKEWORD(2,2), &wsaData) == 0;
+}
+
+void TRANSPORT_Cleanup(void) {
+	WSACleanup();
+}
+
+/// Switches a connected socket to non-blocking mode with TCP_NODELAY and stores it in the connection
+static bool TRANSPORT_Configure(TRANSPORT_Connection* connection, SOCKET handle) {
+	BOOL flag = TRUE;
+	setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, (const char*)&flag, sizeof(flag));
+	u_long nonBlocking = 1;
+	if(ioctlsocket(handle, FIONBIO, &nonBlocking) == SOCKET_ERROR){
+	    closesocket(handle);
+	    return false;
+	}
+	connection->handle = (uintptr_t)handle;
+	return true;
+}
+
+bool TRANSPORT_Connect(TRANSPORT_Connection* connection, const char* host, const char* port) {
+	if(connection == NULL || host == NULL || port == NULL){
+	    return false;
+	}
+	connection->handle = TRANSPORT_INVALID_HANDLE;
+
+	struct addrinfo hints, *result = NULL, *ptr = NULL;
+	ZeroMemory(&hints, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+
+	if(getaddrinfo(host, port, &hints, &result) != 0){
+	    return false;
+	}
+
+	SOCKET ConnectSocket = INVALID_SOCKET;
+	for(ptr = result; ptr != NULL; ptr = ptr->ai_next){
+	    ConnectSocket = socket(ptr->ai_family, ptr->ai_socktype, ptr->ai_protocol);
+	    if(ConnectSocket == INVALID_SOCKET){
+	        continue;
+	    }
+	    if(connect(ConnectSocket, ptr->ai_addr, (int)ptr->ai_addrlen) == SOCKET_ERROR){
+	        closesocket(ConnectSocket);
+	        ConnectSocket = INVALID_SOCKET;
+	        continue;
+	    }
+	    break;
+	}
+	freeaddrinfo(result);
+	if(ConnectSocket == INVALID_SOCKET){
+	    return false;
+	}
+
+	return TRANSPORT_Configure(connection, ConnectSocket);
+}
+
+bool TRANSPORT_Listen(TRANSPORT_Connection* listener, const char* port) {
+	if(listener == NULL || port == NULL){
+	    return false;
+	}
+	listener->handle = TRANSPORT_INVALID_HANDLE;
+
+	struct addrinfo hints, *result = NULL;
+	ZeroMemory(&hints, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+	hints.ai_flags = AI_PASSIVE;
+
+	if(getaddrinfo(NULL, port, &hints, &result) != 0){
+	    return false;
+	}
+	SOCKET ListenSocket = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+	if(ListenSocket == INVALID_SOCKET){
+	    freeaddrinfo(result);
+	    return false;
+	}
+	if(bind(ListenSocket, result->ai_addr, (int)result->ai_addrlen) == SOCKET_ERROR ||
+	   listen(ListenSocket, SOMAXCONN) == SOCKET_ERROR){
+	    closesocket(ListenSocket);
+	    freeaddrinfo(result);
+	    return false;
+	}
+	freeaddrinfo(result);
+	listener->handle = (uintptr_t)ListenSocket;
+	return true;
+}
+
+bool TRANSPORT_Accept(TRANSPORT_Connection* listener, TRANSPORT_Connection* connection) {
+	if(listener == NULL || connection == NULL || listener->handle == TRANSPORT_INVALID_HANDLE){
+	    return false;
+	}
+	connection->handle = TRANSPORT_INVALID_HANDLE;
+	SOCKET ClientSocket = accept((SOCKET)listener->handle, NULL, NULL);
+	if(ClientSocket == INVALID_SOCKET){
+	    return false;
+	}
+	return TRANSPORT_Configure(connection, ClientSocket);
+}
+
+int TRANSPORT_Receive(TRANSPORT_Connection* connection, void* buffer, size_t bufferSize) {
+	if(connection == NULL || connection->handle == TRANSPORT_INVALID_HANDLE){
+	    return TRANSPORT_ERROR;
+	}
+	int received = recv((SOCKET)connection->handle, (char*)buffer, (int)bufferSize, 0);
+	if(received == SOCKET_ERROR){
+	    return (WSAGetLastError() == WSAEWOULDBLOCK) ? TRANSPORT_WOULD_BLOCK : TRANSPORT_ERROR;
+	}
+	return received;
+}
+
+bool TRANSPORT_Send(TRANSPORT_Connection* connection, const void* data, size_t dataSize) {
+	if(connection == NULL || connection->handle == TRANSPORT_INVALID_HANDLE){
+	    return false;
+	}
+	const char* bytes = (const char*)data;
+	while(dataSize > 0){
+	    int sent = send((SOCKET)connection->handle, bytes, (int)dataSize, 0);
+	    if(sent != SOCKET_ERROR){
+	        bytes += sent;
+	        dataSize -= (size_t)sent;
+	        continue;
+	    }
+	    if(WSAGetLastError() != WSAEWOULDBLOCK){
+	        return false;
+	    }
+	    // send buffer is full - wait until the socket becomes writable
+	    WSAPOLLFD pfd = { (SOCKET)connection->handle, POLLWRNORM, 0 };
+	    if(WSAPoll(&pfd, 1, -1) == SOCKET_ERROR){
+	        return false;
+	    }
+	}
+	return true;
+}
+
+void TRANSPORT_Close(TRANSPORT_Connection* connection) {
+	if(connection == NULL || connection->handle == TRANSPORT_INVALID_HANDLE){
+	    return;
+	}
+	closesocket((SOCKET)connection->handle);
+	connection->handle = TRANSPORT_INVALID_HANDLE;
+}
+
+int TRANSPORT_LastError(void) {
+	return WSAGetLastError();
+}
+
+TRANSPORT_Poller* TRANSPORT_CreatePoller(void) {
+	TRANSPORT_Poller* poller = (TRANSPORT_Poller*)calloc(1, sizeof(TRANSPORT_Poller));
+	return poller;
+}
+
+void TRANSPORT_DestroyPoller(TRANSPORT_Poller* poller) {
+	if(poller == NULL){
+	    return;
+	}
+	free(poller->fds);
+	free(poller->userData);
+	free(poller);
+}
+
+bool TRANSPORT_PollerAdd(TRANSPORT_Poller* poller, TRANSPORT_Connection* connection, void* userData) {
+	if(poller == NULL || connection == NULL || connection->handle == TRANSPORT_INVALID_HANDLE){
+	    return false;
+	}
+	if(poller->count == poller->capacity){
+	    size_t capacity = poller->capacity ? poller->capacity * 2 : 16;
+	    WSAPOLLFD* fds = (WSAPOLLFD*)realloc(poller->fds, capacity * sizeof(WSAPOLLFD));
+	    if(fds == NULL){
+	        return false;
+	    }
+	    poller->fds = fds;
+	    void** data = (void**)realloc(poller->userData, capacity * sizeof(void*));
+	    if(data == NULL){
+	        return false;
+	    }
+	    poller->userData = data;
+	    poller->capacity = capacity;
+	}
+	poller->fds[poller->count].fd = (SOCKET)connection->handle;
+	poller->fds[poller->count].events = POLLRDNORM;
+	poller->fds[poller->count].revents = 0;
+	poller->userData[poller->count] = userData;
+	poller->count++;
+	return true;
+}
+
+void TRANSPORT_PollerRemove(TRANSPORT_Poller* poller, TRANSPORT_Connection* connection) {
+	if(poller == NULL || connection == NULL){
+	    return;
+	}
+	for(size_t i = 0; i < poller->count; i++){
+	    if(poller->fds[i].fd == (SOCKET)connection->handle){
+	        poller->count--;
+	        poller->fds[i] = poller->fds[poller->count];
+	        poller->userData[i] = poller->userData[poller->count];
+	        return;
+	    }
+	}
+}
+
+int TRANSPORT_PollerWait(TRANSPORT_Poller* poller, void** readyUserData, int maxReady, int timeoutMs) {
+	if(poller == NULL || readyUserData == NULL || maxReady <= 0){
+	    return -1;
+	}
+	if(poller->count == 0){
+	    Sleep(timeoutMs < 0 ? 0 : (DWORD)timeoutMs);
+	    return 0;
+	}
+	int result = WSAPoll(poller->fds, (ULONG)poller->count, timeoutMs);
+	if(result == SOCKET_ERROR){
+	    return -1;
+	}
+	int ready = 0;
+	for(size_t n = 0; n < poller->count && ready < maxReady; n++){
+	    size_t i = (poller->nextReady + n) % poller->count;
+	    if(poller->fds[i].revents != 0){
+	        readyUserData[ready++] = poller->userData[i];
+	    }
+	}
+	poller->nextReady = (poller->nextReady + 1) % poller->count;
+	return ready;
+}
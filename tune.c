@@ -0,0 +1,472 @@
+/**
+ * Tuner of the strategy parameters (see params.h) by self-play in the simulator (see sim.h).
+ *
+ * Usage: mniam_tune [--population P] [--generations G] [--matches M] [--threads T] [--players N] [--ticks T]
+ *                   [--seed S] [--opponent FILE] [--output FILE] [--checkpoint FILE] [--resume]
+ *
+ * A genetic algorithm: every generation each candidate parameter set plays M matches against bots with the
+ * opponent parameters (the defaults unless --opponent is given), taking the seats in turn. All candidates of a
+ * generation play the same maps, selected by the generation and match number, so the tuning is deterministic for
+ * a given seed, whatever the number of threads. The matches of a generation are played in parallel, one match
+ * per task. The fitness of a candidate is its win rate plus a tenth of its mean share of the HP left at the end.
+ * The next generation keeps the best candidates and breeds the rest by tournament selection, blend crossover
+ * and Gaussian mutation within the ranges of PARAMS_FIELDS.
+ *
+ * After every generation the best candidate found so far is written to the output file (loaded by the player
+ * with --params) and the whole state of the tuner to the checkpoint file; --resume continues from the
+ * checkpoint (the other options must be the same as in the interrupted run).
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <math.h>
+#include "bot.h"
+#include "params.h"
+#include "platform.h"
+#include "sim.h"
+
+#define DEFAULT_POPULATION 16
+#define DEFAULT_GENERATIONS 20
+#define DEFAULT_MATCHES 32
+#define DEFAULT_OUTPUT "tuned.params"
+#define DEFAULT_CHECKPOINT "mniam_tune.checkpoint"
+#define CHECKPOINT_MAGIC "mniam_tune_checkpoint 1"
+
+// Genetic algorithm settings
+#define ELITE_COUNT 2                  // Best candidates copied to the next generation unchanged
+#define TOURNAMENT_SIZE 3              // Candidates compared to select one parent
+#define BLEND_EXTENSION 0.25           // Children may lie this far (relative) outside the segment between parents
+#define MUTATION_SCALE 0.1             // Standard deviation of a mutation relative to the range of the parameter
+#define HP_SHARE_WEIGHT 0.1            // Weight of the HP share in the fitness (the win rate weighs 1)
+
+/**
+ * One parameter set of the population
+ */
+typedef struct {
+    PARAMS_Strategy params;                        // Parameters of the candidate
+    double fitness;                                // Fitness in the current generation
+} Candidate;
+
+/**
+ * State of the tuner (everything that is saved in the checkpoint)
+ */
+typedef struct {
+    uint32_t generation;                           // Next generation to evaluate
+    uint64_t random;                               // State of the random generator
+    int populationSize;                            // Number of candidates
+    Candidate* population;                         // Candidates of the generation
+    Candidate best;                                // Best candidate found so far (fitness < 0 = none yet)
+} Tuner;
+
+/**
+ * Matches of one generation, shared by the worker threads
+ */
+typedef struct {
+    SIM_Config config;                             // Configuration of every match
+    PARAMS_Strategy opponent;                      // Parameters of the other players
+    const Tuner* tuner;                            // Evaluated population
+    int matches;                                   // Matches per candidate
+    double* scores;                                // Score of every match [candidate * matches + match]
+    atomic_int nextTask;                           // Next match to be taken by a worker
+} Evaluation;
+
+/**
+ * Worker thread playing matches of the evaluation
+ */
+typedef struct {
+    Evaluation* evaluation;                        // Shared work
+    PLATFORM_Thread thread;                        // Worker thread
+    bool failed;                                   // The worker could not allocate its world and players
+} TuneWorker;
+
+/**
+ * Returns the next number of the random generator (xorshift64*)
+ */
+static uint64_t nextRandom(uint64_t* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1Dull;
+}
+
+/// Uniformly distributed number in [0, 1)
+static double uniformRandom(uint64_t* state) {
+    return (nextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/// Normally distributed number (Box-Muller)
+static double gaussianRandom(uint64_t* state) {
+    double u = 1.0 - uniformRandom(state);
+    double v = uniformRandom(state);
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+static double clampField(unsigned field, double value) {
+    const PARAMS_Field* description = &PARAMS_FIELDS[field];
+    return fmin(fmax(value, description->minimum), description->maximum);
+}
+
+/**
+ * Plays one match of a candidate and returns its score
+ */
+static double playMatch(const Evaluation* evaluation, SIM_World* world, GameState* const* players, int task) {
+    const uint32_t playerCount = evaluation->config.playerCount;
+    const Candidate* candidate = &evaluation->tuner->population[task / evaluation->matches];
+    const uint32_t match = (uint32_t)(task % evaluation->matches);
+    const uint32_t seat = match % playerCount;
+    for (uint32_t p = 0; p < playerCount; p++) {
+        initGameState(players[p], NULL);
+        players[p]->params = (p == seat) ? candidate->params : evaluation->opponent;
+    }
+    SIM_Result result;
+    SIM_SeekGame(world, evaluation->tuner->generation * (uint32_t)evaluation->matches + match);
+    SIM_PlayLocalGame(world, players, true, NULL, &result);
+
+    int totalHp = 0;
+    for (uint32_t p = 0; p < playerCount; p++) {
+        totalHp += (result.hp[p] > 0) ? result.hp[p] : 0;
+        freeGameState(players[p]);
+    }
+    double hpShare = (totalHp > 0 && result.hp[seat] > 0) ? (double)result.hp[seat] / totalHp : 0.0;
+    return (result.winner == seat ? 1.0 : 0.0) + HP_SHARE_WEIGHT * hpShare;
+}
+
+static void runWorker(void* arg) {
+    TuneWorker* worker = (TuneWorker*)arg;
+    Evaluation* evaluation = worker->evaluation;
+    const int taskCount = evaluation->tuner->populationSize * evaluation->matches;
+    SIM_World* world = SIM_Create(&evaluation->config);
+    GameState* players[SIM_MAX_PLAYERS] = { NULL };
+    worker->failed = (world == NULL);
+    for (uint32_t p = 0; p < evaluation->config.playerCount; p++) {
+        players[p] = (GameState*)malloc(sizeof(GameState));
+        worker->failed = worker->failed || players[p] == NULL;
+    }
+    while (!worker->failed) {
+        int task = atomic_fetch_add(&evaluation->nextTask, 1);
+        if (task >= taskCount) {
+            break;
+        }
+        evaluation->scores[task] = playMatch(evaluation, world, players, task);
+    }
+    for (uint32_t p = 0; p < evaluation->config.playerCount; p++) {
+        free(players[p]);
+    }
+    SIM_Destroy(world);
+}
+
+/**
+ * Plays the matches of the generation on the worker threads and sets the fitness of every candidate
+ * @return false if some matches could not be played
+ */
+static bool evaluateGeneration(Evaluation* evaluation, Tuner* tuner, TuneWorker* workers, int threadCount) {
+    atomic_store(&evaluation->nextTask, 0);
+    for (int w = 0; w < threadCount; w++) {
+        workers[w].evaluation = evaluation;
+    }
+    if (threadCount == 1) {
+        runWorker(&workers[0]);
+    } else {
+        for (int w = 0; w < threadCount; w++) {
+            if (!PLATFORM_StartThread(&workers[w].thread, runWorker, &workers[w])) {
+                workers[w].thread.handle = 0;
+            }
+        }
+        for (int w = 0; w < threadCount; w++) {
+            if (workers[w].thread.handle != 0) {
+                PLATFORM_JoinThread(&workers[w].thread);
+            }
+        }
+    }
+    // the matches of a failed worker were taken by the others, unless every worker failed
+    if (atomic_load(&evaluation->nextTask) < tuner->populationSize * evaluation->matches) {
+        return false;
+    }
+    for (int c = 0; c < tuner->populationSize; c++) {
+        double sum = 0.0;
+        for (int m = 0; m < evaluation->matches; m++) {
+            sum += evaluation->scores[c * evaluation->matches + m];
+        }
+        tuner->population[c].fitness = sum / evaluation->matches;
+    }
+    return true;
+}
+
+/**
+ * Selects a parent: the fittest of TOURNAMENT_SIZE random candidates
+ */
+static const Candidate* selectParent(Tuner* tuner) {
+    const Candidate* selected = NULL;
+    for (int i = 0; i < TOURNAMENT_SIZE; i++) {
+        const Candidate* candidate = &tuner->population[nextRandom(&tuner->random) % (uint64_t)tuner->populationSize];
+        if (selected == NULL || candidate->fitness > selected->fitness) {
+            selected = candidate;
+        }
+    }
+    return selected;
+}
+
+/**
+ * Replaces the evaluated population with the next generation
+ */
+static void breedGeneration(Tuner* tuner, Candidate* next) {
+    // by decreasing fitness; insertion sort is stable (deterministic ties) and the population is small
+    for (int i = 1; i < tuner->populationSize; i++) {
+        Candidate candidate = tuner->population[i];
+        int j = i;
+        while (j > 0 && candidate.fitness > tuner->population[j - 1].fitness) {
+            tuner->population[j] = tuner->population[j - 1];
+            j--;
+        }
+        tuner->population[j] = candidate;
+    }
+    int elite = (tuner->populationSize < ELITE_COUNT) ? tuner->populationSize : ELITE_COUNT;
+    for (int c = 0; c < elite; c++) {
+        next[c] = tuner->population[c];
+    }
+    for (int c = elite; c < tuner->populationSize; c++) {
+        const Candidate* first = selectParent(tuner);
+        const Candidate* second = selectParent(tuner);
+        Candidate child = *first;
+        for (unsigned f = 0; f < PARAMS_FIELD_COUNT; f++) {
+            double a = PARAMS_Get(&first->params, f);
+            double b = PARAMS_Get(&second->params, f);
+            double blend = -BLEND_EXTENSION + (1.0 + 2.0 * BLEND_EXTENSION) * uniformRandom(&tuner->random);
+            double value = a + blend * (b - a);
+            if (uniformRandom(&tuner->random) < 1.0 / PARAMS_FIELD_COUNT) {
+                const PARAMS_Field* description = &PARAMS_FIELDS[f];
+                value += gaussianRandom(&tuner->random) * MUTATION_SCALE * (description->maximum - description->minimum);
+            }
+            *PARAMS_Value(&child.params, f) = clampField(f, value);
+        }
+        child.fitness = 0.0;
+        next[c] = child;
+    }
+    memcpy(tuner->population, next, (size_t)tuner->populationSize * sizeof(Candidate));
+}
+
+static void writeParams(FILE* file, const PARAMS_Strategy* params) {
+    for (unsigned f = 0; f < PARAMS_FIELD_COUNT; f++) {
+        fprintf(file, " %.17g", PARAMS_Get(params, f));
+    }
+    fprintf(file, "\n");
+}
+
+static bool readParams(FILE* file, PARAMS_Strategy* params) {
+    for (unsigned f = 0; f < PARAMS_FIELD_COUNT; f++) {
+        if (fscanf(file, "%lf", PARAMS_Value(params, f)) != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Writes the state of the tuner (to a temporary file first, so an interrupted write leaves the old checkpoint)
+ */
+static bool saveCheckpoint(const char* path, const Tuner* tuner) {
+    char temporary[1024];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+    FILE* file = fopen(temporary, "w");
+    if (file == NULL) {
+        return false;
+    }
+    fprintf(file, "%s\n", CHECKPOINT_MAGIC);
+    fprintf(file, "generation %u\nrandom %llu\npopulation %d\n", tuner->generation,
+            (unsigned long long)tuner->random, tuner->populationSize);
+    fprintf(file, "best %.17g", tuner->best.fitness);
+    writeParams(file, &tuner->best.params);
+    for (int c = 0; c < tuner->populationSize; c++) {
+        fprintf(file, "candidate");
+        writeParams(file, &tuner->population[c].params);
+    }
+    if (fclose(file) != 0) {
+        return false;
+    }
+    remove(path);
+    return rename(temporary, path) == 0;
+}
+
+/**
+ * Restores the state of the tuner (the population is allocated here)
+ */
+static bool loadCheckpoint(const char* path, Tuner* tuner) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+    char magic[64];
+    unsigned long long random;
+    bool valid = fgets(magic, sizeof(magic), file) != NULL && strncmp(magic, CHECKPOINT_MAGIC, strlen(CHECKPOINT_MAGIC)) == 0 &&
+                 fscanf(file, " generation %u random %llu population %d best %lf", &tuner->generation, &random,
+                        &tuner->populationSize, &tuner->best.fitness) == 4 &&
+                 tuner->populationSize > 0 && readParams(file, &tuner->best.params);
+    tuner->random = random;
+    tuner->population = valid ? (Candidate*)calloc((size_t)tuner->populationSize, sizeof(Candidate)) : NULL;
+    valid = valid && tuner->population != NULL;
+    for (int c = 0; valid && c < tuner->populationSize; c++) {
+        valid = fscanf(file, " candidate") == 0 && readParams(file, &tuner->population[c].params);
+    }
+    fclose(file);
+    return valid;
+}
+
+static void printUsage(const char* program) {
+    printf("Usage: %s [--population P] [--generations G] [--matches M] [--threads T] [--players N] [--ticks T]\n"
+           "          [--seed S] [--opponent FILE] [--output FILE] [--checkpoint FILE] [--resume]\n", program);
+    printf("  --population P    candidates per generation (default %d)\n", DEFAULT_POPULATION);
+    printf("  --generations G   number of generations (default %d)\n", DEFAULT_GENERATIONS);
+    printf("  --matches M       matches of every candidate per generation (default %d)\n", DEFAULT_MATCHES);
+    printf("  --threads T       number of worker threads (default: one per CPU)\n");
+    printf("  --players N       players in a match (2..%d, default 2)\n", SIM_MAX_PLAYERS);
+    printf("  --ticks T         length of a match in ticks (default 1000)\n");
+    printf("  --seed S          seed of the maps and of the algorithm (default 1)\n");
+    printf("  --opponent FILE   parameters of the other players (default: the defaults)\n");
+    printf("  --output FILE     best parameters found (default %s)\n", DEFAULT_OUTPUT);
+    printf("  --checkpoint FILE state of the tuner, written after every generation (default %s)\n", DEFAULT_CHECKPOINT);
+    printf("  --resume          continue from the checkpoint\n");
+}
+
+int main(int argc, char** argv) {
+    Evaluation evaluation;
+    SIM_DefaultConfig(&evaluation.config);
+    PARAMS_Default(&evaluation.opponent);
+    evaluation.matches = DEFAULT_MATCHES;
+    int populationSize = DEFAULT_POPULATION;
+    int generations = DEFAULT_GENERATIONS;
+    int threadCount = 0;
+    const char* outputPath = DEFAULT_OUTPUT;
+    const char* checkpointPath = DEFAULT_CHECKPOINT;
+    bool resume = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--population") == 0 && i + 1 < argc) {
+            populationSize = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--generations") == 0 && i + 1 < argc) {
+            generations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--matches") == 0 && i + 1 < argc) {
+            evaluation.matches = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threadCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--players") == 0 && i + 1 < argc) {
+            evaluation.config.playerCount = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            evaluation.config.maxTicks = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            evaluation.config.seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--opponent") == 0 && i + 1 < argc) {
+            if (!PARAMS_Load(argv[++i], &evaluation.opponent)) {
+                printf("Unable to load strategy parameters from %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            checkpointPath = argv[++i];
+        } else if (strcmp(argv[i], "--resume") == 0) {
+            resume = true;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    // the configuration is validated by SIM_Create
+    SIM_World* check = SIM_Create(&evaluation.config);
+    if (check == NULL || evaluation.config.playerCount < 2 || populationSize < 1 || generations < 1 ||
+        evaluation.matches < 1 || threadCount < 0) {
+        printUsage(argv[0]);
+        SIM_Destroy(check);
+        return 1;
+    }
+    SIM_Destroy(check);
+
+    Tuner tuner;
+    if (resume) {
+        if (!loadCheckpoint(checkpointPath, &tuner)) {
+            printf("Unable to resume from %s\n", checkpointPath);
+            return 1;
+        }
+        printf("Resuming at generation %u from %s\n", tuner.generation + 1, checkpointPath);
+    } else {
+        // the defaults are one of the candidates, the others are spread over the ranges
+        tuner.generation = 0;
+        tuner.random = 0x9E3779B97F4A7C15ull ^ evaluation.config.seed;
+        tuner.populationSize = populationSize;
+        tuner.population = (Candidate*)calloc((size_t)populationSize, sizeof(Candidate));
+        tuner.best.fitness = -1.0;
+        PARAMS_Default(&tuner.best.params);
+        if (tuner.population == NULL) {
+            printf("Out of memory\n");
+            return 1;
+        }
+        PARAMS_Default(&tuner.population[0].params);
+        for (int c = 1; c < populationSize; c++) {
+            for (unsigned f = 0; f < PARAMS_FIELD_COUNT; f++) {
+                const PARAMS_Field* description = &PARAMS_FIELDS[f];
+                *PARAMS_Value(&tuner.population[c].params, f) = description->minimum +
+                    uniformRandom(&tuner.random) * (description->maximum - description->minimum);
+            }
+        }
+    }
+    if (threadCount == 0) {
+        threadCount = PLATFORM_CpuCount();
+    }
+    const int taskCount = tuner.populationSize * evaluation.matches;
+    if (threadCount > taskCount) {
+        threadCount = taskCount;
+    }
+    evaluation.tuner = &tuner;
+    evaluation.scores = (double*)calloc((size_t)taskCount, sizeof(double));
+    TuneWorker* workers = (TuneWorker*)calloc((size_t)threadCount, sizeof(TuneWorker));
+    Candidate* next = (Candidate*)calloc((size_t)tuner.populationSize, sizeof(Candidate));
+    if (evaluation.scores == NULL || workers == NULL || next == NULL) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    atomic_init(&evaluation.nextTask, 0);
+
+    int status = 0;
+    while (tuner.generation < (uint32_t)generations) {
+        uint64_t start = PLATFORM_NowNs();
+        if (!evaluateGeneration(&evaluation, &tuner, workers, threadCount)) {
+            printf("Generation %u could not be played\n", tuner.generation + 1);
+            status = 1;
+            break;
+        }
+        double sum = 0.0;
+        const Candidate* generationBest = &tuner.population[0];
+        for (int c = 0; c < tuner.populationSize; c++) {
+            sum += tuner.population[c].fitness;
+            if (tuner.population[c].fitness > generationBest->fitness) {
+                generationBest = &tuner.population[c];
+            }
+        }
+        if (generationBest->fitness > tuner.best.fitness) {
+            tuner.best = *generationBest;
+        }
+        printf("Generation %u: best %.4f, mean %.4f, best so far %.4f, %.2f s\n", tuner.generation + 1,
+               generationBest->fitness, sum / tuner.populationSize, tuner.best.fitness,
+               (PLATFORM_NowNs() - start) / 1e9);
+
+        breedGeneration(&tuner, next);
+        tuner.generation++;
+        char comment[128];
+        snprintf(comment, sizeof(comment), "mniam_tune: best of %u generation(s), fitness %.4f", tuner.generation,
+                 tuner.best.fitness);
+        if (!PARAMS_Save(outputPath, &tuner.best.params, comment) || !saveCheckpoint(checkpointPath, &tuner)) {
+            printf("Unable to write %s or %s\n", outputPath, checkpointPath);
+            status = 1;
+            break;
+        }
+    }
+    if (status == 0) {
+        printf("Best parameters (fitness %.4f) written to %s\n", tuner.best.fitness, outputPath);
+    }
+
+    free(next);
+    free(workers);
+    free(evaluation.scores);
+    free(tuner.population);
+    return status;
+}